@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+#include "armazenamento.h"
+#include "mapeamento.h"
+#include "formato.h"
+
+/**
+ * @brief Inicializa um pool vazio para registros do tamanho informado.
+ * Nenhuma memória é alocada até o primeiro slot ser pedido.
+ * @param pool Ponteiro para o pool.
+ * @param tam_registro Tamanho (sizeof) de cada registro.
+ */
+void pool_inicializar(PoolRegistros *pool, size_t tam_registro) {
+    pool->blocos = NULL;
+    pool->num_blocos = 0;
+    pool->cap_diretorio = 0;
+    pool->usados = 0;
+    pool->tam_registro = tam_registro;
+    pool->mapa = NULL;
+    pool->fonte = NULL;
+    pool->paginas_invalidas = 0;
+    pool->versoes = NULL;
+    pool->compartilhado = NULL;
+    pool->blocos_compartilhados = 0;
+}
+
+/**
+ * @brief Libera todos os blocos e o diretório do pool.
+ * Num pool mapeado, os blocos são desmapeados e o arquivo é fechado. Blocos
+ * que ainda pertencem a fotos abertas ficam com elas (liberados pelo gerente).
+ * @param pool Ponteiro para o pool.
+ */
+void pool_liberar(PoolRegistros *pool) {
+    if (pool->versoes != NULL) {
+        versoes_soltar_pool(pool);
+    }
+    if (pool->mapa != NULL) {
+        mapa_fechar(pool);
+    }
+    if (pool->fonte != NULL) {
+        formato_fechar_fonte(pool->fonte);
+    }
+    for (int b = 0; b < pool->num_blocos; b++) {
+        free(pool->blocos[b]);
+    }
+    free(pool->blocos);
+    pool_inicializar(pool, pool->tam_registro);
+}
+
+/**
+ * @brief Garante espaço para pelo menos 'quantidade' slots.
+ * Os blocos novos são zerados, então todo slot ainda não usado tem ativo == 0.
+ * Num pool mapeado, os blocos novos são acrescentados ao arquivo.
+ * @param pool Ponteiro para o pool.
+ * @param quantidade Número total de slots desejado.
+ * @return int 1 se a capacidade foi garantida, 0 se faltou memória.
+ */
+int pool_reservar(PoolRegistros *pool, int quantidade) {
+    int blocos_necessarios = (quantidade + REGISTROS_POR_BLOCO - 1) >> BITS_POR_BLOCO;
+
+    if (blocos_necessarios > pool->cap_diretorio) {
+        int nova_cap = pool->cap_diretorio > 0 ? pool->cap_diretorio : 8;
+        while (nova_cap < blocos_necessarios) nova_cap *= 2;
+
+        char **novo = realloc(pool->blocos, (size_t)nova_cap * sizeof(char *));
+        if (novo == NULL) return 0;
+        pool->blocos = novo;
+        pool->cap_diretorio = nova_cap;
+    }
+
+    while (pool->num_blocos < blocos_necessarios) {
+        char *bloco = pool->mapa != NULL ? mapa_novo_bloco(pool->mapa, pool->num_blocos)
+                                         : calloc(REGISTROS_POR_BLOCO, pool->tam_registro);
+        if (bloco == NULL) return 0;
+        pool->blocos[pool->num_blocos++] = bloco;
+    }
+    return 1;
+}
+
+/**
+ * @brief Entrega o próximo slot livre no final do pool (O(1) amortizado).
+ * @param pool Ponteiro para o pool.
+ * @return int Índice do novo slot, ou -1 se faltou memória.
+ */
+int pool_novo_slot(PoolRegistros *pool) {
+    if (!pool_reservar(pool, pool->usados + 1)) return -1;
+    return pool->usados++;
+}
+
+/**
+ * @brief Garante que os slots [0, quantidade) existam, avançando a marca d'água se preciso.
+ * Slots novos chegam zerados (inativos).
+ * @param pool Ponteiro para o pool.
+ * @param quantidade Número mínimo de slots em uso.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int pool_estender(PoolRegistros *pool, int quantidade) {
+    if (!pool_reservar(pool, quantidade)) return 0;
+    if (pool->usados < quantidade) pool->usados = quantidade;
+    return 1;
+}
+
+/**
+ * @brief Recua a marca d'água para 'quantidade' slots (ex: ao desfazer uma transação).
+ * Os slots devolvidos são zerados, como chegariam de pool_reservar; os blocos continuam alocados.
+ * @param pool Ponteiro para o pool.
+ * @param quantidade Número de slots que continuam em uso (<= pool->usados).
+ */
+void pool_truncar(PoolRegistros *pool, int quantidade) {
+    for (int i = quantidade; i < pool->usados; i++) {
+        memset(pool_slot_escrita(pool, i), 0, pool->tam_registro);
+    }
+    if (quantidade < pool->usados) pool->usados = quantidade;
+}
+
+/**
+ * @brief Associa ao pool (vazio) as páginas de uma tabela que ainda estão no arquivo base.
+ * Os blocos ficam no diretório como NULL e são lidos no primeiro acesso (pool_slot).
+ * @param pool Ponteiro para o pool (vazio).
+ * @param fonte Fonte das páginas (o pool passa a ser o dono).
+ * @param num_blocos Número de páginas da tabela.
+ * @param usados Marca d'água gravada no arquivo.
+ * @return int 1 se bem-sucedido, 0 se faltou memória (a fonte não é associada).
+ */
+int pool_associar_fonte(PoolRegistros *pool, struct FontePaginas *fonte, int num_blocos, int usados) {
+    char **diretorio = calloc((size_t)(num_blocos > 0 ? num_blocos : 1), sizeof(char *));
+    if (diretorio == NULL) return 0;
+
+    pool->blocos = diretorio;
+    pool->num_blocos = num_blocos;
+    pool->cap_diretorio = num_blocos > 0 ? num_blocos : 1;
+    pool->usados = usados;
+    pool->fonte = fonte;
+    return 1;
+}
+
+/**
+ * @brief Lê do arquivo base o bloco ainda não carregado (chamada por pool_slot).
+ * Uma página corrompida é carregada zerada (registros inativos) e contada em
+ * paginas_invalidas, para que o arquivo base não seja sobrescrito por cima dela.
+ * A carga sob demanda não muda o conteúdo lógico do pool, por isso aceita um
+ * pool const. Sem memória para o bloco, o programa é encerrado: pool_slot não
+ * tem como devolver erro.
+ * @param pool Ponteiro para o pool.
+ * @param bloco Índice do bloco.
+ * @return char* Endereço do bloco carregado.
+ */
+char *pool_carregar_bloco(const PoolRegistros *pool, int bloco) {
+    PoolRegistros *p = (PoolRegistros *)pool;
+    char *dados = calloc(REGISTROS_POR_BLOCO, p->tam_registro);
+    if (dados == NULL) {
+        fprintf(stderr, "ERRO: Memoria insuficiente para carregar os dados. Encerrando.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!formato_ler_pagina(p->fonte, bloco, dados, p->tam_registro)) {
+        printf("ERRO: Pagina %d do arquivo de dados esta corrompida ou ilegivel.\n", bloco);
+        p->paginas_invalidas++;
+    }
+    p->blocos[bloco] = dados;
+
+    // Todas as páginas em memória: o arquivo base não é mais necessário
+    if (--p->fonte->pendentes == 0) {
+        formato_fechar_fonte(p->fonte);
+        p->fonte = NULL;
+    }
+    return dados;
+}
+
+/**
+ * @brief Lê todas as páginas que ainda estão só no arquivo base.
+ * @param pool Ponteiro para o pool.
+ * @return int 1 se todas as páginas do pool estão íntegras, 0 se alguma estava corrompida.
+ */
+int pool_carregar_tudo(PoolRegistros *pool) {
+    for (int b = 0; pool->fonte != NULL && b < pool->num_blocos; b++) {
+        if (pool->blocos[b] == NULL) pool_carregar_bloco(pool, b);
+    }
+    return pool->paginas_invalidas == 0;
+}
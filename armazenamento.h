@@ -0,0 +1,78 @@
+#ifndef ARMAZENAMENTO_H
+#define ARMAZENAMENTO_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// --- Pool de Registros (Armazenamento Crescente em Blocos) ---
+//
+// Os registros (Turma, Aluno) ficam em blocos de tamanho fixo, alocados sob
+// demanda. Um diretório de ponteiros para blocos cresce por duplicação, então
+// a inserção é O(1) amortizada e nenhum registro é copiado quando a tabela
+// cresce (ponteiros para registros continuam válidos). Como todos os blocos
+// têm o mesmo tamanho, o crescimento não fragmenta o heap.
+
+#define BITS_POR_BLOCO 12
+#define REGISTROS_POR_BLOCO (1 << BITS_POR_BLOCO) // 4096 registros por bloco
+#define MASCARA_BLOCO (REGISTROS_POR_BLOCO - 1)
+
+struct MapaArquivo;
+struct FontePaginas;
+struct GerenteVersoes;
+
+typedef struct {
+    char **blocos;       // Diretório: blocos[b] guarda REGISTROS_POR_BLOCO registros
+    int num_blocos;      // Quantidade de blocos já alocados
+    int cap_diretorio;   // Capacidade do diretório (cresce por duplicação)
+    int usados;          // Marca d'água: os slots [0, usados) já foram entregues
+    size_t tam_registro; // sizeof do registro armazenado
+    struct MapaArquivo *mapa; // Arquivo mapeado onde ficam os blocos (NULL = blocos no heap)
+    struct FontePaginas *fonte; // Blocos ainda no arquivo base (NULL = todos em memória)
+    int paginas_invalidas; // Páginas que falharam na leitura ou no CRC (carregadas zeradas)
+    struct GerenteVersoes *versoes; // Fotos que podem ver blocos deste pool (NULL = nenhuma, ver versoes.h)
+    unsigned char *compartilhado;   // compartilhado[b] = 1: o bloco b também pertence a uma foto aberta
+    int blocos_compartilhados;      // Tamanho de 'compartilhado' (0 = nenhum bloco compartilhado)
+} PoolRegistros;
+
+void pool_inicializar(PoolRegistros *pool, size_t tam_registro);
+void pool_liberar(PoolRegistros *pool);
+int pool_reservar(PoolRegistros *pool, int quantidade);
+int pool_novo_slot(PoolRegistros *pool);
+int pool_estender(PoolRegistros *pool, int quantidade);
+void pool_truncar(PoolRegistros *pool, int quantidade);
+int pool_associar_fonte(PoolRegistros *pool, struct FontePaginas *fonte, int num_blocos, int usados);
+char *pool_carregar_bloco(const PoolRegistros *pool, int bloco);
+int pool_carregar_tudo(PoolRegistros *pool);
+void versoes_separar_bloco(PoolRegistros *pool, int bloco);  // versoes.c
+void versoes_soltar_pool(PoolRegistros *pool);               // versoes.c
+
+/**
+ * @brief Retorna o endereço do registro no slot indicado (O(1), sem verificação de limites).
+ * Se o bloco do slot ainda está só no arquivo base, ele é lido agora.
+ * @param pool Ponteiro para o pool.
+ * @param idx Índice do slot (0 <= idx < pool->usados).
+ * @return void* Endereço do registro.
+ */
+static inline void *pool_slot(const PoolRegistros *pool, int idx) {
+    char *bloco = pool->blocos[idx >> BITS_POR_BLOCO];
+    if (bloco == NULL) bloco = pool_carregar_bloco(pool, idx >> BITS_POR_BLOCO);
+    return bloco + (size_t)(idx & MASCARA_BLOCO) * pool->tam_registro;
+}
+
+/**
+ * @brief Endereço do registro no slot, para alteração (O(1)).
+ * Se o bloco do slot está numa foto aberta, o pool passa a usar uma cópia
+ * do bloco antes (cópia na escrita): a foto continua vendo o conteúdo antigo.
+ * Ponteiros obtidos antes por pool_slot para o mesmo bloco passam a apontar
+ * para a versão da foto: releia-os depois da escrita.
+ * @param pool Ponteiro para o pool.
+ * @param idx Índice do slot (0 <= idx < pool->usados).
+ * @return void* Endereço do registro.
+ */
+static inline void *pool_slot_escrita(PoolRegistros *pool, int idx) {
+    int bloco = idx >> BITS_POR_BLOCO;
+    if (bloco < pool->blocos_compartilhados && pool->compartilhado[bloco]) versoes_separar_bloco(pool, bloco);
+    return pool_slot(pool, idx);
+}
+
+#endif // ARMAZENAMENTO_H
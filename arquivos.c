@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "arquivos.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#endif
+
+/**
+ * @brief Acumula o CRC-32 (polinômio 0xEDB88320, o mesmo do zlib) sobre um bloco de bytes.
+ * Comece com crc = 0; para dados em pedaços, passe o resultado anterior.
+ * @param crc CRC acumulado até aqui.
+ * @param dados Bytes a incluir.
+ * @param tamanho Quantidade de bytes.
+ * @return uint32_t O novo CRC acumulado.
+ */
+uint32_t crc32_calcular(uint32_t crc, const void *dados, size_t tamanho) {
+    static uint32_t tabela[256];
+    static int tabela_pronta = 0;
+
+    if (!tabela_pronta) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            tabela[i] = c;
+        }
+        tabela_pronta = 1;
+    }
+
+    const unsigned char *p = dados;
+    crc = ~crc;
+    for (size_t i = 0; i < tamanho; i++) {
+        crc = tabela[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Descarrega o buffer do FILE e força a gravação no disco (fsync).
+ * @param f Arquivo aberto para escrita.
+ * @return int 1 se os dados estão no disco, 0 em caso de falha.
+ */
+int arquivo_sincronizar(FILE *f) {
+    if (fflush(f) != 0) return 0;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+/**
+ * @brief Substitui 'destino' por 'origem' de forma atômica (rename).
+ * Quem ler 'destino' vê o arquivo antigo inteiro ou o novo inteiro, nunca uma mistura.
+ * @param origem Arquivo temporário já gravado e sincronizado.
+ * @param destino Arquivo a ser substituído.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int arquivo_substituir(const char *origem, const char *destino) {
+#ifdef _WIN32
+    return MoveFileExA(origem, destino, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(origem, destino) == 0;
+#endif
+}
+
+/**
+ * @brief Trunca o arquivo para o tamanho informado (descarta o final).
+ * @param caminho Caminho do arquivo.
+ * @param tamanho Novo tamanho em bytes.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int arquivo_truncar(const char *caminho, long tamanho) {
+#ifdef _WIN32
+    FILE *f = fopen(caminho, "r+b");
+    if (f == NULL) return 0;
+    int ok = _chsize(_fileno(f), tamanho) == 0;
+    fclose(f);
+    return ok;
+#else
+    return truncate(caminho, (off_t)tamanho) == 0;
+#endif
+}
+
+/**
+ * @brief Retorna o tamanho do arquivo aberto, preservando a posição atual.
+ * @param f Arquivo aberto.
+ * @return long Tamanho em bytes, ou -1 em caso de falha.
+ */
+long arquivo_tamanho(FILE *f) {
+    long atual = ftell(f);
+    if (atual < 0 || fseek(f, 0, SEEK_END) != 0) return -1;
+    long tamanho = ftell(f);
+    fseek(f, atual, SEEK_SET);
+    return tamanho;
+}
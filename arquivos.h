@@ -0,0 +1,18 @@
+#ifndef ARQUIVOS_H
+#define ARQUIVOS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Utilitários de Arquivo (Persistência) ---
+//
+// Funções portáveis (POSIX / Windows) usadas pelo arquivo base e pelo diário.
+
+uint32_t crc32_calcular(uint32_t crc, const void *dados, size_t tamanho);
+int arquivo_sincronizar(FILE *f);
+int arquivo_substituir(const char *origem, const char *destino);
+int arquivo_truncar(const char *caminho, long tamanho);
+long arquivo_tamanho(FILE *f);
+
+#endif // ARQUIVOS_H
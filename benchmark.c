@@ -0,0 +1,624 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "servicos.h"
+#include "consultas.h"
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#define chdir _chdir
+#define dup _dup
+#define fdopen _fdopen
+#define criar_diretorio(caminho) _mkdir(caminho)
+#define DISPOSITIVO_NULO "NUL"
+#else
+#include <unistd.h>
+#include <sys/stat.h>
+#define criar_diretorio(caminho) mkdir(caminho, 0755)
+#define DISPOSITIVO_NULO "/dev/null"
+#endif
+
+// --- Benchmark das Operações de servicos.h ---
+//
+// Gera uma base sintética (alunos com nomes e RAs realistas, turmas com
+// tamanhos assimétricos: poucas turmas grandes e muitas pequenas) e mede cada
+// operação pública, chamada a chamada. O resultado é CSV, uma linha por
+// operação e tamanho de base:
+//
+//   operacao,alunos,turmas,chamadas,ops_por_seg,p50_ns,p99_ns,max_ns
+//
+// Os arquivos de dados ficam num diretório próprio (--dir), nunca no atual.
+// As mensagens do sistema vão para o dispositivo nulo; o progresso, para stderr.
+//
+// Uso: benchmark [--alunos 1000,100000,...] [--turmas N] [--chamadas K]
+//                [--repeticoes R] [--dir caminho] [--saida arquivo.csv]
+
+#define ALUNOS_PADRAO "1000,100000"
+#define ALUNOS_POR_TURMA 200    // Média usada quando --turmas não é informado
+#define CHAMADAS_PADRAO 10000   // Operações pontuais (busca, lançamento, edição...)
+#define REPETICOES_PADRAO 3     // Operações sobre a base inteira (carga, gravação, ordenação...)
+#define ASSIMETRIA_TURMAS 0.8   // Expoente de Zipf dos tamanhos das turmas (0 = todas iguais)
+#define FOLGA_VAGAS 10          // Vagas além do tamanho gerado (%), para transferências
+#define MAX_TAMANHOS 16         // Tamanhos de base por execução
+#define DIRETORIO_PADRAO "bench_dados"
+
+typedef struct {
+    long alunos;
+    int turmas;
+    int chamadas;
+    int repeticoes;
+} ConfigBenchmark;
+
+typedef struct {
+    long long *amostras;  // Duração de cada chamada, em ns
+    long quantidade;
+    long capacidade;
+    long long total_ns;
+} Medicao;
+
+static unsigned long long estado_aleatorio = 88172645463325252ULL;
+
+// --- 1. Utilitários ---
+
+/**
+ * @brief Gerador pseudoaleatório xorshift64 (a mesma sequência em toda execução).
+ * @return unsigned long long O próximo número da sequência.
+ */
+static unsigned long long aleatorio(void) {
+    estado_aleatorio ^= estado_aleatorio << 13;
+    estado_aleatorio ^= estado_aleatorio >> 7;
+    estado_aleatorio ^= estado_aleatorio << 17;
+    return estado_aleatorio;
+}
+
+/**
+ * @brief Relógio monotônico, em nanossegundos.
+ */
+static long long agora_ns(void) {
+    struct timespec t;
+#ifdef _WIN32
+    timespec_get(&t, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &t);
+#endif
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static int comparar_duracoes(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+// --- 2. Medições ---
+
+/**
+ * @brief Prepara uma medição para até 'capacidade' chamadas.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int medicao_iniciar(Medicao *medicao, long capacidade) {
+    medicao->amostras = malloc((size_t)(capacidade > 0 ? capacidade : 1) * sizeof(long long));
+    medicao->quantidade = 0;
+    medicao->capacidade = capacidade;
+    medicao->total_ns = 0;
+    if (medicao->amostras == NULL) fprintf(stderr, "ERRO: Memoria insuficiente para as amostras.\n");
+    return medicao->amostras != NULL;
+}
+
+static void medicao_registrar(Medicao *medicao, long long inicio) {
+    long long duracao = agora_ns() - inicio;
+    if (medicao->quantidade < medicao->capacidade) medicao->amostras[medicao->quantidade++] = duracao;
+    medicao->total_ns += duracao;
+}
+
+// Mede uma chamada: MEDIR(&medicao, funcao(argumentos));
+#define MEDIR(medicao, chamada) \
+    do { long long inicio_ = agora_ns(); chamada; medicao_registrar((medicao), inicio_); } while (0)
+
+/**
+ * @brief Escreve a linha CSV da operação e libera as amostras.
+ * @param medicao Medição concluída.
+ * @param operacao Função de servicos.h (e a variante, após '/').
+ * @param config Tamanho da base medida.
+ * @param destino Arquivo de resultados.
+ */
+static void medicao_relatar(Medicao *medicao, const char *operacao, const ConfigBenchmark *config, FILE *destino) {
+    long n = medicao->quantidade;
+    if (n > 0) {
+        qsort(medicao->amostras, (size_t)n, sizeof(long long), comparar_duracoes);
+        double ops_por_seg = medicao->total_ns > 0 ? (double)n * 1e9 / (double)medicao->total_ns : 0.0;
+        fprintf(destino, "%s,%ld,%d,%ld,%.1f,%lld,%lld,%lld\n", operacao, config->alunos, config->turmas, n,
+                ops_por_seg, medicao->amostras[n / 2], medicao->amostras[(n * 99) / 100], medicao->amostras[n - 1]);
+        fflush(destino);
+    }
+    free(medicao->amostras);
+    medicao->amostras = NULL;
+}
+
+// --- 3. Base Sintética ---
+
+static const char *const primeiros_nomes[] = {
+    "Ana", "Bruno", "Carla", "Daniel", "Eduarda", "Felipe", "Gabriela", "Henrique", "Isabela", "Joao",
+    "Larissa", "Lucas", "Mariana", "Mateus", "Natalia", "Otavio", "Paula", "Rafael", "Sofia", "Thiago",
+    "Vitoria", "Arthur", "Beatriz", "Caio", "Helena", "Igor", "Julia", "Miguel", "Pedro", "Yasmin"
+};
+static const char *const sobrenomes[] = {
+    "Silva", "Santos", "Oliveira", "Souza", "Rodrigues", "Ferreira", "Alves", "Pereira", "Lima", "Gomes",
+    "Costa", "Ribeiro", "Martins", "Carvalho", "Almeida", "Lopes", "Soares", "Fernandes", "Vieira", "Barbosa",
+    "Rocha", "Dias", "Nascimento", "Andrade", "Moreira", "Nunes", "Marques", "Machado", "Mendes", "Freitas"
+};
+#define QTD_NOMES ((int)(sizeof(primeiros_nomes) / sizeof(primeiros_nomes[0])))
+#define QTD_SOBRENOMES ((int)(sizeof(sobrenomes) / sizeof(sobrenomes[0])))
+
+/**
+ * @brief Nome completo aleatório ("Nome Sobrenome Sobrenome").
+ */
+static void gerar_nome(char *nome) {
+    snprintf(nome, TAM_NOME, "%s %s %s", primeiros_nomes[aleatorio() % QTD_NOMES],
+             sobrenomes[aleatorio() % QTD_SOBRENOMES], sobrenomes[aleatorio() % QTD_SOBRENOMES]);
+}
+
+/**
+ * @brief RA do i-ésimo aluno gerado: 9 dígitos, únicos e fora de ordem
+ * (multiplicar por uma constante módulo um primo permuta [1, primo)).
+ */
+static void gerar_ra(long i, char *ra) {
+    char texto[24];
+    snprintf(texto, sizeof(texto), "%09lld", ((long long)(i + 1) * 48271LL) % 999999937LL);
+    memcpy(ra, texto, TAM_RA);
+}
+
+/**
+ * @brief Tamanho de cada turma segundo Zipf: a turma de posição k recebe uma
+ * fração dos alunos proporcional a 1/(k+1)^ASSIMETRIA_TURMAS.
+ * @param config Tamanho da base.
+ * @param tamanhos Recebe o tamanho de cada turma (config->turmas posições).
+ */
+static void gerar_tamanhos(const ConfigBenchmark *config, long *tamanhos) {
+    double soma = 0.0;
+    for (int k = 0; k < config->turmas; k++) soma += pow(k + 1, -ASSIMETRIA_TURMAS);
+
+    long distribuidos = 0;
+    for (int k = 0; k < config->turmas; k++) {
+        tamanhos[k] = (long)((double)config->alunos * pow(k + 1, -ASSIMETRIA_TURMAS) / soma);
+        distribuidos += tamanhos[k];
+    }
+    for (int k = 0; distribuidos < config->alunos; k = (k + 1) % config->turmas) {
+        tamanhos[k]++; // Sobras do arredondamento, a partir das maiores
+        distribuidos++;
+    }
+}
+
+/**
+ * @brief Cadastra as turmas e os alunos da base, medindo cada inserção.
+ * Os alunos chegam em ordem aleatória de turma, como numa matrícula real.
+ * @param ids Recebe o ID de cada turma cadastrada.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int gerar_base(DadosSistema *sistema, const ConfigBenchmark *config, int *ids, FILE *destino) {
+    long *tamanhos = malloc((size_t)config->turmas * sizeof(long));
+    int *turma_do_aluno = malloc((size_t)(config->alunos > 0 ? config->alunos : 1) * sizeof(int));
+    Medicao medicao;
+    if (tamanhos == NULL || turma_do_aluno == NULL || !medicao_iniciar(&medicao, config->turmas)) {
+        free(tamanhos);
+        free(turma_do_aluno);
+        return 0;
+    }
+    gerar_tamanhos(config, tamanhos);
+
+    char nome[TAM_NOME], ra[TAM_RA];
+    for (int k = 0; k < config->turmas; k++) {
+        snprintf(nome, sizeof(nome), "Turma %d", k + 1);
+        int vagas = (int)(tamanhos[k] + tamanhos[k] * FOLGA_VAGAS / 100 + 10);
+        MEDIR(&medicao, adicionar_turma(sistema, nome, vagas));
+        ids[k] = sistema->proximo_id_turma - 1;
+    }
+    medicao_relatar(&medicao, "adicionar_turma", config, destino);
+
+    long posicao = 0;
+    for (int k = 0; k < config->turmas; k++) {
+        for (long j = 0; j < tamanhos[k]; j++) turma_do_aluno[posicao++] = k;
+    }
+    for (long i = config->alunos - 1; i > 0; i--) { // Embaralhamento de Fisher-Yates
+        long j = (long)(aleatorio() % (unsigned long long)(i + 1));
+        int t = turma_do_aluno[i];
+        turma_do_aluno[i] = turma_do_aluno[j];
+        turma_do_aluno[j] = t;
+    }
+
+    int ok = medicao_iniciar(&medicao, config->alunos);
+    for (long i = 0; ok && i < config->alunos; i++) {
+        gerar_nome(nome);
+        gerar_ra(i, ra);
+        MEDIR(&medicao, adicionar_aluno(sistema, nome, ra, ids[turma_do_aluno[i]]));
+    }
+    if (ok) medicao_relatar(&medicao, "adicionar_aluno", config, destino);
+
+    free(tamanhos);
+    free(turma_do_aluno);
+    return ok;
+}
+
+static void remover_arquivos_dados(void) {
+    remove(NOME_ARQUIVO);
+    remove(NOME_DIARIO);
+    remove(NOME_MAPA_TURMAS);
+    remove(NOME_MAPA_ALUNOS);
+}
+
+// --- 4. Rodada de Medições ---
+
+/**
+ * @brief Mede todas as operações sobre uma base do tamanho configurado.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+// Visita das consultas medidas: só conta os alunos
+static int contar_aluno(const DadosSistema *sistema, int slot, void *contexto) {
+    (void)sistema;
+    (void)slot;
+    (*(long *)contexto)++;
+    return 1;
+}
+
+static int executar_rodada(const ConfigBenchmark *config, FILE *destino) {
+    DadosSistema sistema;
+    Medicao medicao;
+    char nome[TAM_NOME], ra[TAM_RA];
+    int *ids = malloc((size_t)config->turmas * sizeof(int));
+    if (ids == NULL) return 0;
+
+    int pontuais = config->chamadas;
+    int por_turma = config->chamadas / 10 > 0 ? config->chamadas / 10 : 1; // Operações O(tamanho da turma)
+    int repeticoes = config->repeticoes;
+#define ALUNO_QUALQUER() gerar_ra((long)(aleatorio() % (unsigned long long)config->alunos), ra)
+#define TURMA_QUALQUER() ids[aleatorio() % (unsigned long long)config->turmas]
+
+    fprintf(stderr, "Base de %ld alunos em %d turmas...\n", config->alunos, config->turmas);
+    remover_arquivos_dados();
+    carregar_dados(&sistema);
+    if (!gerar_base(&sistema, config, ids, destino)) {
+        liberar_dados(&sistema);
+        free(ids);
+        return 0;
+    }
+
+    // Persistência: gravação, checkpoint, carga e montagem dos índices
+    if (medicao_iniciar(&medicao, 1)) {
+        MEDIR(&medicao, salvar_dados(&sistema));
+        medicao_relatar(&medicao, "salvar_dados/base_nova", config, destino);
+    }
+    if (medicao_iniciar(&medicao, repeticoes)) {
+        for (int r = 0; r < repeticoes; r++) MEDIR(&medicao, checkpoint_dados(&sistema));
+        medicao_relatar(&medicao, "checkpoint_dados", config, destino);
+    }
+    Medicao indices;
+    int carga_ok = medicao_iniciar(&medicao, repeticoes);
+    int indices_ok = medicao_iniciar(&indices, repeticoes);
+    for (int r = 0; carga_ok && indices_ok && r < repeticoes; r++) {
+        liberar_dados(&sistema);
+        MEDIR(&medicao, carregar_dados(&sistema));
+        MEDIR(&indices, preparar_indices(&sistema));
+    }
+    medicao_relatar(&medicao, "carregar_dados", config, destino);
+    medicao_relatar(&indices, "preparar_indices", config, destino);
+
+    // Consultas pontuais
+    if (medicao_iniciar(&medicao, pontuais)) {
+        for (int c = 0; c < pontuais; c++) {
+            ALUNO_QUALQUER();
+            MEDIR(&medicao, buscar_aluno_por_ra(&sistema, ra));
+        }
+        medicao_relatar(&medicao, "buscar_aluno_por_ra", config, destino);
+    }
+    if (medicao_iniciar(&medicao, pontuais)) {
+        for (int c = 0; c < pontuais; c++) {
+            int id = TURMA_QUALQUER();
+            MEDIR(&medicao, buscar_turma_por_id(&sistema, id));
+        }
+        medicao_relatar(&medicao, "buscar_turma_por_id", config, destino);
+    }
+    if (medicao_iniciar(&medicao, pontuais)) {
+        for (int c = 0; c < pontuais; c++) MEDIR(&medicao, autenticar_usuario("222", "senha222"));
+        medicao_relatar(&medicao, "autenticar_usuario", config, destino);
+    }
+    if (medicao_iniciar(&medicao, pontuais)) {
+        ResumoTurma resumo;
+        for (int c = 0; c < pontuais; c++) {
+            int id = TURMA_QUALQUER();
+            MEDIR(&medicao, resumir_turma(&sistema, id, &resumo));
+        }
+        medicao_relatar(&medicao, "resumir_turma", config, destino);
+    }
+
+    // Alterações pontuais e a gravação incremental delas
+    if (medicao_iniciar(&medicao, pontuais)) {
+        for (int c = 0; c < pontuais; c++) {
+            ALUNO_QUALQUER();
+            float n1 = (float)(aleatorio() % 101) / 10.0f, n2 = (float)(aleatorio() % 101) / 10.0f;
+            float n3 = (float)(aleatorio() % 101) / 10.0f;
+            MEDIR(&medicao, lancar_notas_e_atualizar_media(&sistema, ra, n1, n2, n3, NIVEL_ADMIN));
+        }
+        medicao_relatar(&medicao, "lancar_notas_e_atualizar_media", config, destino);
+    }
+    if (medicao_iniciar(&medicao, 1)) {
+        MEDIR(&medicao, salvar_dados(&sistema));
+        medicao_relatar(&medicao, "salvar_dados/lancamentos", config, destino);
+    }
+    // Os mesmos lançamentos numa transação desfeita (imagens guardadas + desfazer em memória)
+    if (medicao_iniciar(&medicao, 1)) {
+        iniciar_transacao(&sistema);
+        for (int c = 0; c < pontuais; c++) {
+            ALUNO_QUALQUER();
+            lancar_notas_e_atualizar_media(&sistema, ra, 5.0f, 5.0f, 5.0f, NIVEL_ADMIN);
+        }
+        MEDIR(&medicao, desfazer_transacao(&sistema));
+        medicao_relatar(&medicao, "desfazer_transacao", config, destino);
+        preparar_indices(&sistema); // Fora da medição das operações seguintes
+    }
+    if (medicao_iniciar(&medicao, pontuais)) {
+        for (int c = 0; c < pontuais; c++) { // Alterna renomeação e transferência de turma
+            ALUNO_QUALQUER();
+            gerar_nome(nome);
+            int id = TURMA_QUALQUER();
+            MEDIR(&medicao, editar_dados_aluno(&sistema, ra, c % 2 ? nome : "", c % 2 ? 0 : id));
+        }
+        medicao_relatar(&medicao, "editar_dados_aluno", config, destino);
+    }
+
+    // Relatórios (O(tamanho da turma ou do resultado))
+    if (medicao_iniciar(&medicao, por_turma)) {
+        for (int c = 0; c < por_turma; c++) {
+            int id = TURMA_QUALQUER();
+            MEDIR(&medicao, gerar_relatorio_turma(&sistema, id));
+        }
+        medicao_relatar(&medicao, "gerar_relatorio_turma", config, destino);
+    }
+    if (medicao_iniciar(&medicao, por_turma)) {
+        for (int c = 0; c < por_turma; c++) {
+            int id = TURMA_QUALQUER();
+            MEDIR(&medicao, exibir_estatisticas_turma(&sistema, id));
+        }
+        medicao_relatar(&medicao, "exibir_estatisticas_turma", config, destino);
+    }
+    if (medicao_iniciar(&medicao, por_turma)) {
+        for (int c = 0; c < por_turma; c++) { // Prefixo "Nome Sobrenome"
+            snprintf(nome, sizeof(nome), "%s %s", primeiros_nomes[aleatorio() % QTD_NOMES],
+                     sobrenomes[aleatorio() % QTD_SOBRENOMES]);
+            MEDIR(&medicao, listar_alunos_por_nome(&sistema, nome));
+        }
+        medicao_relatar(&medicao, "listar_alunos_por_nome", config, destino);
+    }
+    if (medicao_iniciar(&medicao, por_turma)) {
+        ResultadoNome resultados[MAX_RESULTADOS_BUSCA];
+        for (int c = 0; c < por_turma; c++) { // Trecho de um sobrenome, sem as duas primeiras letras
+            const char *sobrenome = sobrenomes[aleatorio() % QTD_SOBRENOMES];
+            MEDIR(&medicao, buscar_nomes(&sistema, sobrenome + 2, 0, resultados, MAX_RESULTADOS_BUSCA));
+        }
+        medicao_relatar(&medicao, "buscar_nomes/trecho", config, destino);
+    }
+    if (medicao_iniciar(&medicao, por_turma)) {
+        ResultadoNome resultados[MAX_RESULTADOS_BUSCA];
+        for (int c = 0; c < por_turma; c++) { // "Nome Sobrenome" com duas letras trocadas
+            snprintf(nome, sizeof(nome), "%s %s", primeiros_nomes[aleatorio() % QTD_NOMES],
+                     sobrenomes[aleatorio() % QTD_SOBRENOMES]);
+            char troca = nome[1];
+            nome[1] = nome[2];
+            nome[2] = troca;
+            MEDIR(&medicao, buscar_nomes(&sistema, nome, 1, resultados, MAX_RESULTADOS_BUSCA));
+        }
+        medicao_relatar(&medicao, "buscar_nomes/aproximada", config, destino);
+    }
+
+    if (medicao_iniciar(&medicao, por_turma)) {
+        int slots[10];
+        for (int c = 0; c < por_turma; c++) {
+            int id = TURMA_QUALQUER();
+            MEDIR(&medicao, ranking_medias(&sistema, id, 10, c % 2 ? RANKING_MELHORES : RANKING_PIORES, slots));
+        }
+        medicao_relatar(&medicao, "ranking_medias/turma", config, destino);
+    }
+    if (medicao_iniciar(&medicao, por_turma)) {
+        static const float quartis[] = {25.0f, 50.0f, 75.0f};
+        float valores[3];
+        for (int c = 0; c < por_turma; c++) {
+            int id = TURMA_QUALQUER();
+            MEDIR(&medicao, percentis_medias(&sistema, id, quartis, 3, valores));
+        }
+        medicao_relatar(&medicao, "percentis_medias/turma", config, destino);
+    }
+
+    // Operações sobre a base inteira
+    if (medicao_iniciar(&medicao, repeticoes)) {
+        int slots[100];
+        for (int r = 0; r < repeticoes; r++) {
+            MEDIR(&medicao, ranking_medias(&sistema, TURMAS_TODAS, 100, RANKING_MELHORES, slots));
+        }
+        medicao_relatar(&medicao, "ranking_medias/todas", config, destino);
+    }
+    if (medicao_iniciar(&medicao, repeticoes)) {
+        static const float decis[] = {10.0f, 20.0f, 30.0f, 40.0f, 50.0f, 60.0f, 70.0f, 80.0f, 90.0f};
+        float valores[9];
+        for (int r = 0; r < repeticoes; r++) {
+            MEDIR(&medicao, percentis_medias(&sistema, TURMAS_TODAS, decis, 9, valores));
+        }
+        medicao_relatar(&medicao, "percentis_medias/todas", config, destino);
+    }
+    if (medicao_iniciar(&medicao, repeticoes)) {
+        for (int r = 0; r < repeticoes; r++) MEDIR(&medicao, listar_todas_turmas(&sistema));
+        medicao_relatar(&medicao, "listar_todas_turmas", config, destino);
+    }
+    if (medicao_iniciar(&medicao, repeticoes)) {
+        for (int r = 0; r < repeticoes; r++) MEDIR(&medicao, ordenar_alunos_por_nome(&sistema));
+        medicao_relatar(&medicao, "ordenar_alunos_por_nome", config, destino);
+    }
+    FiltroAlunos filtro;
+    const char *erro;
+    long encontrados = 0;
+    if (medicao_iniciar(&medicao, repeticoes) && filtro_interpretar("situacao=recup n2<4", &filtro, &erro)) {
+        for (int r = 0; r < repeticoes; r++) MEDIR(&medicao, consultar_alunos(&sistema, &filtro, contar_aluno, &encontrados));
+        medicao_relatar(&medicao, "consultar_alunos/varredura", config, destino);
+    }
+    if (medicao_iniciar(&medicao, por_turma)) {
+        for (int c = 0; c < por_turma; c++) { // Sete turmas seguidas
+            int id = TURMA_QUALQUER();
+            snprintf(nome, sizeof(nome), "turma=%d..%d n2<4", id, id + 6);
+            filtro_interpretar(nome, &filtro, &erro);
+            MEDIR(&medicao, consultar_alunos(&sistema, &filtro, contar_aluno, &encontrados));
+        }
+        medicao_relatar(&medicao, "consultar_alunos/turmas", config, destino);
+    }
+    if (medicao_iniciar(&medicao, por_turma)) {
+        for (int c = 0; c < por_turma; c++) { // Prefixo "Nome Sobrenome"
+            snprintf(nome, sizeof(nome), "media>=5 nome=\"%s %s\"", primeiros_nomes[aleatorio() % QTD_NOMES],
+                     sobrenomes[aleatorio() % QTD_SOBRENOMES]);
+            filtro_interpretar(nome, &filtro, &erro);
+            MEDIR(&medicao, consultar_alunos(&sistema, &filtro, contar_aluno, &encontrados));
+        }
+        medicao_relatar(&medicao, "consultar_alunos/nomes", config, destino);
+    }
+    if (medicao_iniciar(&medicao, repeticoes)) {
+        for (int r = 0; r < repeticoes; r++) MEDIR(&medicao, recalcular_medias(&sistema));
+        medicao_relatar(&medicao, "recalcular_medias", config, destino);
+    }
+
+    // Exclusões e compactação
+    if (medicao_iniciar(&medicao, pontuais)) {
+        for (int c = 0; c < pontuais; c++) {
+            ALUNO_QUALQUER();
+            MEDIR(&medicao, excluir_aluno_por_ra(&sistema, ra));
+        }
+        medicao_relatar(&medicao, "excluir_aluno_por_ra", config, destino);
+    }
+    int turmas_excluidas = config->turmas / 10 > 0 ? config->turmas / 10 : 1;
+    if (turmas_excluidas > por_turma) turmas_excluidas = por_turma;
+    if (medicao_iniciar(&medicao, turmas_excluidas)) {
+        for (int c = 0; c < turmas_excluidas; c++) {
+            int id = TURMA_QUALQUER();
+            MEDIR(&medicao, excluir_turma_por_id(&sistema, id));
+        }
+        medicao_relatar(&medicao, "excluir_turma_por_id", config, destino);
+    }
+    // A metade mais antiga sai (formandos): slots seguidos ficam inativos, e a
+    // varredura pula 64 deles por palavra do mapa de ativos (ver colunas.h)
+    for (long i = 0; i < config->alunos / 2; i++) {
+        gerar_ra(i, ra);
+        excluir_aluno_por_ra(&sistema, ra);
+    }
+    if (medicao_iniciar(&medicao, repeticoes) && filtro_interpretar("situacao=recup n2<4", &filtro, &erro)) {
+        for (int r = 0; r < repeticoes; r++) MEDIR(&medicao, consultar_alunos(&sistema, &filtro, contar_aluno, &encontrados));
+        medicao_relatar(&medicao, "consultar_alunos/varredura_metade_excluida", config, destino);
+    }
+    if (medicao_iniciar(&medicao, 1)) {
+        MEDIR(&medicao, compactar_dados(&sistema));
+        medicao_relatar(&medicao, "compactar_dados", config, destino);
+    }
+#undef ALUNO_QUALQUER
+#undef TURMA_QUALQUER
+
+    liberar_dados(&sistema);
+    remover_arquivos_dados();
+    free(ids);
+    return 1;
+}
+
+// --- 5. Função Principal ---
+
+/**
+ * @brief Lê a lista de tamanhos de base ("1000,100000,...").
+ * @return int Quantidade de tamanhos lidos (0 se a lista é inválida).
+ */
+static int ler_tamanhos(const char *texto, long *tamanhos) {
+    int n = 0;
+    while (*texto != '\0' && n < MAX_TAMANHOS) {
+        char *fim;
+        long valor = strtol(texto, &fim, 10);
+        if (fim == texto || valor <= 0 || (*fim != ',' && *fim != '\0')) return 0;
+        tamanhos[n++] = valor;
+        texto = *fim == ',' ? fim + 1 : fim;
+    }
+    return n;
+}
+
+/**
+ * @brief Converte o valor de uma opção numérica (inteiro positivo, sem sobras).
+ * @return int 1 se válido, 0 caso contrário.
+ */
+static int ler_positivo(const char *texto, int *valor) {
+    char *fim;
+    errno = 0;
+    long v = strtol(texto, &fim, 10);
+    if (fim == texto || *fim != '\0' || errno != 0 || v <= 0 || v > INT_MAX) return 0;
+    *valor = (int)v;
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *lista_alunos = ALUNOS_PADRAO;
+    const char *diretorio = DIRETORIO_PADRAO;
+    const char *caminho_saida = NULL;
+    int turmas = 0;
+    ConfigBenchmark config = {0, 0, CHAMADAS_PADRAO, REPETICOES_PADRAO};
+
+    for (int i = 1; i < argc; i += 2) {
+        int ok = 1;
+        if (strcmp(argv[i], "--alunos") != 0 && strcmp(argv[i], "--turmas") != 0 &&
+            strcmp(argv[i], "--chamadas") != 0 && strcmp(argv[i], "--repeticoes") != 0 &&
+            strcmp(argv[i], "--dir") != 0 && strcmp(argv[i], "--saida") != 0) {
+            fprintf(stderr, "ERRO: Opcao desconhecida '%s'.\n", argv[i]);
+            return 1;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "ERRO: Falta o valor de '%s'.\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--alunos") == 0) lista_alunos = argv[i + 1];
+        else if (strcmp(argv[i], "--turmas") == 0) ok = ler_positivo(argv[i + 1], &turmas);
+        else if (strcmp(argv[i], "--chamadas") == 0) ok = ler_positivo(argv[i + 1], &config.chamadas);
+        else if (strcmp(argv[i], "--repeticoes") == 0) ok = ler_positivo(argv[i + 1], &config.repeticoes);
+        else if (strcmp(argv[i], "--dir") == 0) diretorio = argv[i + 1];
+        else caminho_saida = argv[i + 1];
+        if (!ok) {
+            fprintf(stderr, "ERRO: Valor invalido para '%s': '%s' (use um inteiro positivo).\n", argv[i], argv[i + 1]);
+            return 1;
+        }
+    }
+    long tamanhos[MAX_TAMANHOS];
+    int quantidade = ler_tamanhos(lista_alunos, tamanhos);
+    if (quantidade == 0 || config.chamadas <= 0 || config.repeticoes <= 0) {
+        fprintf(stderr, "ERRO: Use --alunos N[,N...] --chamadas K --repeticoes R com valores positivos.\n");
+        return 1;
+    }
+
+    // Resultados no destino (ou no stdout original); mensagens do sistema no dispositivo nulo
+    fflush(stdout);
+    FILE *destino = caminho_saida != NULL ? fopen(caminho_saida, "w") : fdopen(dup(fileno(stdout)), "w");
+    if (destino == NULL) {
+        fprintf(stderr, "ERRO: Nao foi possivel abrir o destino dos resultados.\n");
+        return 1;
+    }
+    criar_diretorio(diretorio); // Pode já existir
+    if (chdir(diretorio) != 0) {
+        fprintf(stderr, "ERRO: Nao foi possivel usar o diretorio '%s'.\n", diretorio);
+        return 1;
+    }
+    if (freopen(DISPOSITIVO_NULO, "w", stdout) == NULL) {
+        fprintf(stderr, "AVISO: As mensagens do sistema serao misturadas aos resultados.\n");
+    }
+    definir_modo_silencioso(1);
+
+    fprintf(destino, "operacao,alunos,turmas,chamadas,ops_por_seg,p50_ns,p99_ns,max_ns\n");
+    int ok = 1;
+    for (int t = 0; ok && t < quantidade; t++) {
+        config.alunos = tamanhos[t];
+        config.turmas = turmas > 0 ? turmas : (int)(tamanhos[t] / ALUNOS_POR_TURMA);
+        if (config.turmas < 1) config.turmas = 1;
+        ok = executar_rodada(&config, destino);
+        if (!ok) fprintf(stderr, "ERRO: Memoria insuficiente para a base de %ld alunos.\n", tamanhos[t]);
+    }
+    if (fclose(destino) != 0) ok = 0;
+    if (ok) fprintf(stderr, "SUCESSO: Benchmark concluido.\n");
+    return ok ? 0 : 1;
+}
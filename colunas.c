@@ -0,0 +1,249 @@
+#include <stdlib.h>
+#include <string.h>
+#include "servicos.h"
+#include "colunas.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define NUCLEO_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NUCLEO_SSE2 1
+#endif
+
+// --- 1. Montagem e Sincronização ---
+
+/**
+ * @brief Inicializa as colunas vazias (sem alocação).
+ * @param colunas Ponteiro para as colunas.
+ */
+void colunas_inicializar(ColunasNotas *colunas) {
+    memset(colunas, 0, sizeof(*colunas));
+}
+
+/**
+ * @brief Libera a memória das colunas.
+ * @param colunas Ponteiro para as colunas.
+ */
+void colunas_liberar(ColunasNotas *colunas) {
+    for (int n = 0; n < 3; n++) free(colunas->notas[n]);
+    free(colunas->media);
+    free(colunas->id_turma);
+    free(colunas->situacao);
+    free(colunas->ativos);
+    colunas_inicializar(colunas);
+}
+
+/**
+ * @brief Redimensiona um vetor das colunas (realloc que preserva o original se falhar).
+ */
+static int redimensionar(void **vetor, size_t tamanho) {
+    void *novo = realloc(*vetor, tamanho);
+    if (novo == NULL) return 0;
+    *vetor = novo;
+    return 1;
+}
+
+/**
+ * @brief Garante espaço para 'quantidade' slots em todos os vetores (capacidade dobra).
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int garantir_capacidade(ColunasNotas *colunas, int quantidade) {
+    if (quantidade <= colunas->capacidade) return 1;
+    int capacidade = colunas->capacidade > 0 ? colunas->capacidade : 1024;
+    while (capacidade < quantidade) capacidade *= 2;
+
+    size_t n = (size_t)capacidade;
+    for (int i = 0; i < 3; i++) {
+        if (!redimensionar((void **)&colunas->notas[i], n * sizeof(float))) return 0;
+    }
+    // A capacidade é múltipla de 1024, então o mapa de bits tem palavras inteiras
+    size_t palavras = n / BITS_POR_PALAVRA_ATIVOS;
+    size_t palavras_antes = (size_t)colunas->capacidade / BITS_POR_PALAVRA_ATIVOS;
+    if (!redimensionar((void **)&colunas->media, n * sizeof(float)) ||
+        !redimensionar((void **)&colunas->id_turma, n * sizeof(int)) ||
+        !redimensionar((void **)&colunas->situacao, n) ||
+        !redimensionar((void **)&colunas->ativos, palavras * sizeof(unsigned long long))) return 0;
+    memset(colunas->ativos + palavras_antes, 0, (palavras - palavras_antes) * sizeof(unsigned long long));
+    colunas->capacidade = capacidade;
+    return 1;
+}
+
+/**
+ * @brief Copia os campos do aluno do slot para as colunas.
+ */
+static void copiar_aluno(const DadosSistema *sistema, ColunasNotas *colunas, int slot) {
+    const Aluno *aluno = aluno_em(sistema, slot);
+    colunas->notas[0][slot] = aluno->notas[0];
+    colunas->notas[1][slot] = aluno->notas[1];
+    colunas->notas[2][slot] = aluno->notas[2];
+    colunas->media[slot] = aluno->media_final;
+    colunas->id_turma[slot] = aluno->id_turma;
+    colunas->situacao[slot] = politica_situacao(&politica_notas, aluno->media_final);
+    unsigned long long bit = 1ull << (slot % BITS_POR_PALAVRA_ATIVOS);
+    if (aluno->ativo == 1) colunas->ativos[slot / BITS_POR_PALAVRA_ATIVOS] |= bit;
+    else colunas->ativos[slot / BITS_POR_PALAVRA_ATIVOS] &= ~bit;
+}
+
+/**
+ * @brief Monta as colunas a partir de todos os slots da tabela de alunos.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param colunas Ponteiro para as colunas.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int colunas_reconstruir(const DadosSistema *sistema, ColunasNotas *colunas) {
+    colunas_liberar(colunas);
+    fragmentos_carregar_todos(sistema); // Modo fragmentado: lê os segmentos que faltam
+    if (!garantir_capacidade(colunas, sistema->alunos.usados)) {
+        colunas_liberar(colunas);
+        return 0;
+    }
+    for (int i = 0; i < sistema->alunos.usados; i++) copiar_aluno(sistema, colunas, i);
+    colunas->quantidade = sistema->alunos.usados;
+    colunas->pronto = 1;
+    return 1;
+}
+
+/**
+ * @brief Atualiza as colunas com o estado atual do aluno do slot (O(1) amortizado).
+ * Chamada depois de toda alteração de notas, turma ou situação de um aluno.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param colunas Ponteiro para as colunas.
+ * @param slot Slot alterado.
+ * @return int 1 se bem-sucedido (ou colunas ainda não montadas), 0 se faltou memória
+ * (as colunas são descartadas e remontadas no próximo uso).
+ */
+int colunas_atualizar(const DadosSistema *sistema, ColunasNotas *colunas, int slot) {
+    if (!colunas->pronto) return 1;
+    if (!garantir_capacidade(colunas, slot + 1)) {
+        colunas_liberar(colunas);
+        return 0;
+    }
+    // Slots pulados (estendidos por outra via) ainda não guardam ninguém: os
+    // bits deles já estão zerados desde garantir_capacidade
+    copiar_aluno(sistema, colunas, slot);
+    if (colunas->quantidade <= slot) colunas->quantidade = slot + 1;
+    return 1;
+}
+
+/**
+ * @brief Colunas do sistema prontas para uma varredura, montadas agora se preciso.
+ * Como os índices, são um cache derivado e podem ser montadas a partir de uma
+ * consulta const. Slots que a tabela ganhou sem passar por colunas_atualizar
+ * são copiados antes de retornar.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return const ColunasNotas* As colunas, ou NULL se faltou memória.
+ */
+const ColunasNotas *colunas_montadas(const DadosSistema *sistema) {
+    ColunasNotas *colunas = &((DadosSistema *)sistema)->colunas;
+    if (!colunas->pronto) {
+        return colunas_reconstruir(sistema, colunas) ? colunas : NULL;
+    }
+    for (int i = colunas->quantidade; i < sistema->alunos.usados; i++) {
+        if (!colunas_atualizar(sistema, colunas, i)) return NULL;
+    }
+    return colunas;
+}
+
+// --- 2. Recálculo em Massa ---
+
+/**
+ * @brief Grava a situação de um grupo de alunos a partir das máscaras de comparação
+ * (bit j = resultado do elemento j).
+ */
+static inline void gravar_situacoes(unsigned char *situacao, int largura,
+                                    int aprovado, int recuperacao, int alterado) {
+    for (int j = 0; j < largura; j++) {
+        unsigned char s = ((aprovado >> j) & 1) ? SITUACAO_APROVADO : (unsigned char)((recuperacao >> j) & 1);
+        situacao[j] = (unsigned char)(s | (((alterado >> j) & 1) ? COLUNA_ALTERADA : 0));
+    }
+}
+
+/**
+ * @brief Quantidade de bits 1 numa máscara de comparação.
+ */
+static inline int contar_bits(int mascara) {
+    int n = 0;
+    for (; mascara != 0; mascara &= mascara - 1) n++;
+    return n;
+}
+
+/**
+ * @brief Recalcula as médias e situações de todos os slots das colunas.
+ * A média é calculada exatamente como politica_media (mesmas operações, na
+ * mesma ordem), vários alunos por instrução. Os slots cuja média mudou
+ * recebem COLUNA_ALTERADA na situação, para que quem chama devolva só esses
+ * valores aos registros.
+ * @param colunas Ponteiro para as colunas (montadas).
+ * @param politica Critério de avaliação.
+ * @return long Número de slots cuja média mudou.
+ */
+long colunas_recalcular(ColunasNotas *colunas, const PoliticaNotas *politica) {
+    const float *n1 = colunas->notas[0], *n2 = colunas->notas[1], *n3 = colunas->notas[2];
+    float *media = colunas->media;
+    unsigned char *situacao = colunas->situacao;
+    int n = colunas->quantidade;
+    int i = 0;
+    long alterados = 0;
+
+#if defined(NUCLEO_AVX)
+    __m256 p1 = _mm256_set1_ps(politica->pesos[0]), p2 = _mm256_set1_ps(politica->pesos[1]);
+    __m256 p3 = _mm256_set1_ps(politica->pesos[2]);
+    __m256 divisor = _mm256_set1_ps(politica->pesos[0] + politica->pesos[1] + politica->pesos[2]);
+    __m256 corte_aprovacao = _mm256_set1_ps(politica->media_aprovacao);
+    __m256 corte_recuperacao = _mm256_set1_ps(politica->media_recuperacao);
+    for (; i + 8 <= n; i += 8) {
+        __m256 soma = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p1, _mm256_loadu_ps(n1 + i)),
+                                                  _mm256_mul_ps(p2, _mm256_loadu_ps(n2 + i))),
+                                    _mm256_mul_ps(p3, _mm256_loadu_ps(n3 + i)));
+        __m256 nova = _mm256_div_ps(soma, divisor);
+        int alterado = _mm256_movemask_ps(_mm256_cmp_ps(nova, _mm256_loadu_ps(media + i), _CMP_NEQ_UQ));
+        _mm256_storeu_ps(media + i, nova);
+        gravar_situacoes(situacao + i, 8,
+                         _mm256_movemask_ps(_mm256_cmp_ps(nova, corte_aprovacao, _CMP_GE_OQ)),
+                         _mm256_movemask_ps(_mm256_cmp_ps(nova, corte_recuperacao, _CMP_GE_OQ)), alterado);
+        alterados += contar_bits(alterado);
+    }
+#elif defined(NUCLEO_SSE2)
+    __m128 p1 = _mm_set1_ps(politica->pesos[0]), p2 = _mm_set1_ps(politica->pesos[1]);
+    __m128 p3 = _mm_set1_ps(politica->pesos[2]);
+    __m128 divisor = _mm_set1_ps(politica->pesos[0] + politica->pesos[1] + politica->pesos[2]);
+    __m128 corte_aprovacao = _mm_set1_ps(politica->media_aprovacao);
+    __m128 corte_recuperacao = _mm_set1_ps(politica->media_recuperacao);
+    for (; i + 4 <= n; i += 4) {
+        __m128 soma = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p1, _mm_loadu_ps(n1 + i)),
+                                            _mm_mul_ps(p2, _mm_loadu_ps(n2 + i))),
+                                 _mm_mul_ps(p3, _mm_loadu_ps(n3 + i)));
+        __m128 nova = _mm_div_ps(soma, divisor);
+        int alterado = _mm_movemask_ps(_mm_cmpneq_ps(nova, _mm_loadu_ps(media + i)));
+        _mm_storeu_ps(media + i, nova);
+        gravar_situacoes(situacao + i, 4,
+                         _mm_movemask_ps(_mm_cmpge_ps(nova, corte_aprovacao)),
+                         _mm_movemask_ps(_mm_cmpge_ps(nova, corte_recuperacao)), alterado);
+        alterados += contar_bits(alterado);
+    }
+#endif
+
+    // Laço escalar: final do vetor (ou tudo, sem instruções vetoriais)
+    for (; i < n; i++) {
+        float nova = politica_media(politica, n1[i], n2[i], n3[i]);
+        int alterado = !(nova == media[i]);
+        media[i] = nova;
+        situacao[i] = (unsigned char)(politica_situacao(politica, nova) | (alterado ? COLUNA_ALTERADA : 0));
+        alterados += alterado;
+    }
+    return alterados;
+}
+
+/**
+ * @brief Nome do núcleo vetorial escolhido na compilação (para mensagens).
+ */
+const char *colunas_nucleo(void) {
+#if defined(NUCLEO_AVX)
+    return "AVX";
+#elif defined(NUCLEO_SSE2)
+    return "SSE2";
+#else
+    return "escalar";
+#endif
+}
@@ -0,0 +1,110 @@
+#ifndef COLUNAS_H
+#define COLUNAS_H
+
+// --- Notas em Colunas (Structure of Arrays) ---
+//
+// Cópia opcional, em memória, dos campos numéricos dos alunos, com um vetor
+// contíguo por campo (n1, n2, n3, média, turma, situação) indexado pelo slot.
+// Serve às operações em massa: recalcular todas as médias percorre só os
+// vetores de notas (16 bytes por aluno, em vez do registro inteiro) com
+// instruções vetoriais. Como os índices, é montada no primeiro uso e mantida
+// em sincronia pelas operações de servicos.c enquanto estiver pronta.
+//
+// É também a parte "quente" da tabela de alunos: as varreduras leem o mapa de
+// bits de ativos, a turma e a média daqui, e só vão ao registro (RA, nome)
+// para os slots ativos. Quem ganha com o mapa são as varreduras de 64 slots
+// por vez (filtros de consultas.c, percentis e ranking de todos os alunos): a
+// palavra do mapa já é a máscara inicial, e 64 slots inativos seguidos custam
+// uma leitura. Na montagem dos índices a busca da turma de cada aluno domina
+// e o mapa não muda o tempo.
+//
+// O núcleo vetorial é escolhido na compilação: AVX (com -mavx ou -march=...),
+// SSE2 (padrão em x86-64) ou laço escalar nas demais arquiteturas.
+
+struct DadosSistema;
+
+// Situação do aluno (mesmo critério de situacao_aluno)
+#define SITUACAO_REPROVADO 0
+#define SITUACAO_RECUPERACAO 1
+#define SITUACAO_APROVADO 2
+#define COLUNA_ALTERADA 0x80 // Marca de colunas_recalcular: a média do slot mudou
+#define BITS_POR_PALAVRA_ATIVOS 64
+
+// Critério de avaliação: média ponderada das três notas e notas de corte.
+typedef struct {
+    float pesos[3];           // Peso de N1, N2 e N3
+    float media_aprovacao;    // Média mínima para "Aprovado"
+    float media_recuperacao;  // Média mínima para "Recup."
+} PoliticaNotas;
+
+/**
+ * @brief Média segundo a política: média ponderada, na mesma ordem de operações
+ * do núcleo vetorial (resultados idênticos ao de colunas_recalcular).
+ */
+static inline float politica_media(const PoliticaNotas *politica, float n1, float n2, float n3) {
+    float soma_pesos = politica->pesos[0] + politica->pesos[1] + politica->pesos[2];
+    return (politica->pesos[0] * n1 + politica->pesos[1] * n2 + politica->pesos[2] * n3) / soma_pesos;
+}
+
+/**
+ * @brief Situação (SITUACAO_*) correspondente à média, segundo a política.
+ */
+static inline unsigned char politica_situacao(const PoliticaNotas *politica, float media) {
+    if (media >= politica->media_aprovacao) return SITUACAO_APROVADO;
+    if (media >= politica->media_recuperacao) return SITUACAO_RECUPERACAO;
+    return SITUACAO_REPROVADO;
+}
+
+typedef struct {
+    float *notas[3];          // N1, N2 e N3 de cada slot
+    float *media;             // Média final de cada slot
+    int *id_turma;            // Turma de cada slot
+    unsigned char *situacao;  // SITUACAO_* de cada slot (com COLUNA_ALTERADA após recalcular)
+    unsigned long long *ativos; // Mapa de bits: bit (slot % 64) da palavra slot / 64 = aluno ativo
+    int quantidade;           // Slots cobertos: [0, quantidade)
+    int capacidade;           // Slots alocados em cada vetor
+    int pronto;               // 1 depois de montada por colunas_reconstruir
+} ColunasNotas;
+
+void colunas_inicializar(ColunasNotas *colunas);
+void colunas_liberar(ColunasNotas *colunas);
+int colunas_reconstruir(const struct DadosSistema *sistema, ColunasNotas *colunas);
+int colunas_atualizar(const struct DadosSistema *sistema, ColunasNotas *colunas, int slot);
+const ColunasNotas *colunas_montadas(const struct DadosSistema *sistema);
+long colunas_recalcular(ColunasNotas *colunas, const PoliticaNotas *politica);
+const char *colunas_nucleo(void);
+
+/**
+ * @brief Indica se o slot guarda um aluno ativo (O(1), 0 <= slot < quantidade).
+ */
+static inline int colunas_ativo(const ColunasNotas *colunas, int slot) {
+    return (int)((colunas->ativos[slot / BITS_POR_PALAVRA_ATIVOS] >> (slot % BITS_POR_PALAVRA_ATIVOS)) & 1u);
+}
+
+/**
+ * @brief Primeiro slot ativo a partir de 'slot' (inclusive), saltando palavras
+ * inteiras do mapa de bits sem nenhum ativo.
+ * @param colunas Ponteiro para as colunas.
+ * @param slot Slot inicial (>= 0).
+ * @return int O slot, ou -1 se não há mais alunos ativos.
+ */
+static inline int colunas_proximo_ativo(const ColunasNotas *colunas, int slot) {
+    if (slot >= colunas->quantidade) return -1;
+    int palavra = slot / BITS_POR_PALAVRA_ATIVOS;
+    int ultima = (colunas->quantidade - 1) / BITS_POR_PALAVRA_ATIVOS;
+    unsigned long long bits = colunas->ativos[palavra] & (~0ull << (slot % BITS_POR_PALAVRA_ATIVOS));
+    while (bits == 0) {
+        if (++palavra > ultima) return -1;
+        bits = colunas->ativos[palavra];
+    }
+#if defined(__GNUC__)
+    int bit = __builtin_ctzll(bits);
+#else
+    int bit = 0;
+    while (!((bits >> bit) & 1u)) bit++;
+#endif
+    slot = palavra * BITS_POR_PALAVRA_ATIVOS + bit;
+    return slot < colunas->quantidade ? slot : -1;
+}
+
+#endif // COLUNAS_H
@@ -0,0 +1,547 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include "consultas.h"
+#include "saida.h"
+#include "metricas.h"
+
+// --- 1. Filtro em Texto ---
+
+#define OPERADOR_IGUAL 0         // "=" (valor ou faixa "a..b")
+#define OPERADOR_MENOR 1         // "<"
+#define OPERADOR_MENOR_IGUAL 2   // "<="
+#define OPERADOR_MAIOR 3         // ">"
+#define OPERADOR_MAIOR_IGUAL 4   // ">="
+
+/**
+ * @brief Filtro sem restrição nenhuma (aceita todos os alunos ativos).
+ * @param filtro Ponteiro para o filtro.
+ */
+void filtro_iniciar(FiltroAlunos *filtro) {
+    filtro->turma_min = INT_MIN;
+    filtro->turma_max = INT_MAX;
+    for (int n = 0; n < 3; n++) {
+        filtro->notas_min[n] = -INFINITY;
+        filtro->notas_max[n] = INFINITY;
+    }
+    filtro->media_min = -INFINITY;
+    filtro->media_max = INFINITY;
+    filtro->situacoes = SITUACOES_TODAS;
+    filtro->limite = 0;
+    filtro->prefixo[0] = '\0';
+}
+
+/**
+ * @brief Lê o operador de comparação no início do texto.
+ * @return int OPERADOR_*, ou -1 se não há operador; avança 'texto'.
+ */
+static int ler_operador(const char **texto) {
+    const char *p = *texto;
+    int operador = -1;
+    if (p[0] == '=') operador = OPERADOR_IGUAL;
+    else if (p[0] == '<') operador = p[1] == '=' ? OPERADOR_MENOR_IGUAL : OPERADOR_MENOR;
+    else if (p[0] == '>') operador = p[1] == '=' ? OPERADOR_MAIOR_IGUAL : OPERADOR_MAIOR;
+    if (operador == OPERADOR_MENOR_IGUAL || operador == OPERADOR_MAIOR_IGUAL) p += 2;
+    else if (operador != -1) p += 1;
+    *texto = p;
+    return operador;
+}
+
+/**
+ * @brief Estreita a faixa [min, max] de um campo decimal. Comparações estritas
+ * viram faixas fechadas com o float vizinho (n2<4 -> n2 <= 3.9999998).
+ * @param valor Texto do valor ("4" ou, com '=', a faixa "3..5").
+ * @return int 1 se o valor é válido, 0 caso contrário.
+ */
+static int restringir_decimal(float *min, float *max, int operador, const char *valor) {
+    char *fim;
+    float a = strtof(valor, &fim), b = a;
+    if (fim == valor || !isfinite(a)) return 0;
+    if (operador == OPERADOR_IGUAL && strncmp(fim, "..", 2) == 0) {
+        const char *resto = fim + 2;
+        b = strtof(resto, &fim);
+        if (fim == resto || !isfinite(b)) return 0;
+    }
+    if (*fim != '\0') return 0;
+
+    float novo_min = -INFINITY, novo_max = INFINITY;
+    switch (operador) {
+        case OPERADOR_IGUAL:       novo_min = a; novo_max = b; break;
+        case OPERADOR_MENOR:       novo_max = nextafterf(a, -INFINITY); break;
+        case OPERADOR_MENOR_IGUAL: novo_max = a; break;
+        case OPERADOR_MAIOR:       novo_min = nextafterf(a, INFINITY); break;
+        case OPERADOR_MAIOR_IGUAL: novo_min = a; break;
+    }
+    if (novo_min > *min) *min = novo_min;
+    if (novo_max < *max) *max = novo_max;
+    return 1;
+}
+
+/**
+ * @brief Converte um inteiro do filtro (o texto inteiro precisa ser numérico).
+ * @return int 1 se válido, 0 caso contrário; avança 'texto' até o fim do número.
+ */
+static int ler_inteiro_filtro(const char **texto, long *valor) {
+    char *fim;
+    errno = 0;
+    long v = strtol(*texto, &fim, 10);
+    if (fim == *texto || errno != 0 || v < INT_MIN || v > INT_MAX) return 0;
+    *texto = fim;
+    *valor = v;
+    return 1;
+}
+
+/**
+ * @brief Estreita a faixa de IDs de turma (como restringir_decimal, com inteiros >= 0).
+ */
+static int restringir_turma(FiltroAlunos *filtro, int operador, const char *valor) {
+    long a, b;
+    if (!ler_inteiro_filtro(&valor, &a) || a < 0) return 0;
+    b = a;
+    if (operador == OPERADOR_IGUAL && strncmp(valor, "..", 2) == 0) {
+        valor += 2;
+        if (!ler_inteiro_filtro(&valor, &b) || b < 0) return 0;
+    }
+    if (*valor != '\0') return 0;
+
+    int novo_min = INT_MIN, novo_max = INT_MAX;
+    switch (operador) {
+        case OPERADOR_IGUAL:       novo_min = (int)a; novo_max = (int)b; break;
+        case OPERADOR_MENOR:       novo_max = (int)a - 1; break;
+        case OPERADOR_MENOR_IGUAL: novo_max = (int)a; break;
+        case OPERADOR_MAIOR:       novo_min = a < INT_MAX ? (int)a + 1 : INT_MAX; novo_max = a < INT_MAX ? INT_MAX : 0; break;
+        case OPERADOR_MAIOR_IGUAL: novo_min = (int)a; break;
+    }
+    if (novo_min > filtro->turma_min) filtro->turma_min = novo_min;
+    if (novo_max < filtro->turma_max) filtro->turma_max = novo_max;
+    return 1;
+}
+
+/**
+ * @brief Lê a lista de situações ("aprovado,recup") e mantém só as que estão nela.
+ */
+static int restringir_situacoes(FiltroAlunos *filtro, const char *valor) {
+    static const char *const nomes[][2] = { // Indexado por SITUACAO_*
+        {"reprovado", "reprovado"}, {"recup", "recup."}, {"aprovado", "aprovado"}
+    };
+    unsigned aceitas = 0;
+    while (*valor != '\0') {
+        size_t tam = strcspn(valor, ",");
+        int s = 0;
+        while (s < 3 && !((strlen(nomes[s][0]) == tam && strncmp(valor, nomes[s][0], tam) == 0) ||
+                          (strlen(nomes[s][1]) == tam && strncmp(valor, nomes[s][1], tam) == 0))) {
+            s++;
+        }
+        if (s == 3) return 0;
+        aceitas |= 1u << s;
+        valor += tam;
+        if (*valor == ',') valor++;
+    }
+    if (aceitas == 0) return 0;
+    filtro->situacoes &= aceitas;
+    return 1;
+}
+
+/**
+ * @brief Interpreta o filtro em texto (sintaxe em consultas.h).
+ * @param texto Filtro ("" = todos os alunos ativos).
+ * @param filtro Recebe o filtro.
+ * @param erro Recebe o motivo, se o filtro for inválido.
+ * @return int 1 se válido, 0 caso contrário.
+ */
+int filtro_interpretar(const char *texto, FiltroAlunos *filtro, const char **erro) {
+    char valor[64];
+    filtro_iniciar(filtro);
+
+    for (;;) {
+        while (*texto == ' ' || *texto == '\t') texto++;
+        if (*texto == '\0' || *texto == '\r' || *texto == '\n') return 1;
+
+        const char *campo = texto;
+        while ((*texto >= 'a' && *texto <= 'z') || (*texto >= '0' && *texto <= '9')) texto++;
+        size_t tam_campo = (size_t)(texto - campo);
+        int operador = ler_operador(&texto);
+        if (tam_campo == 0 || operador == -1) {
+            *erro = "Use termos como campo=valor, campo<valor ou campo=a..b.";
+            return 0;
+        }
+
+        // O nome vai até o próximo espaço, ou entre aspas se tiver espaços (nome="Ana Maria")
+        if (tam_campo == 4 && strncmp(campo, "nome", 4) == 0) {
+            int aspas = *texto == '"';
+            if (aspas) texto++;
+            size_t tam = aspas ? strcspn(texto, "\"\r\n") : strcspn(texto, " \t\r\n");
+            if (operador != OPERADOR_IGUAL || tam == 0 || tam >= TAM_NOME || (aspas && texto[tam] != '"')) {
+                *erro = "Use nome=prefixo ou nome=\"prefixo com espacos\".";
+                return 0;
+            }
+            memcpy(filtro->prefixo, texto, tam);
+            filtro->prefixo[tam] = '\0';
+            texto += tam + (aspas ? 1 : 0);
+            continue;
+        }
+
+        size_t tam_valor = strcspn(texto, " \t\r\n");
+        if (tam_valor == 0 || tam_valor >= sizeof(valor)) {
+            *erro = "Valor ausente ou longo demais no filtro.";
+            return 0;
+        }
+        memcpy(valor, texto, tam_valor);
+        valor[tam_valor] = '\0';
+        texto += tam_valor;
+
+        int ok;
+        if (tam_campo == 5 && strncmp(campo, "turma", 5) == 0) {
+            ok = restringir_turma(filtro, operador, valor);
+        } else if (tam_campo == 2 && campo[0] == 'n' && campo[1] >= '1' && campo[1] <= '3') {
+            int n = campo[1] - '1';
+            ok = restringir_decimal(&filtro->notas_min[n], &filtro->notas_max[n], operador, valor);
+        } else if (tam_campo == 5 && strncmp(campo, "media", 5) == 0) {
+            ok = restringir_decimal(&filtro->media_min, &filtro->media_max, operador, valor);
+        } else if (tam_campo == 8 && strncmp(campo, "situacao", 8) == 0) {
+            ok = operador == OPERADOR_IGUAL && restringir_situacoes(filtro, valor);
+        } else if (tam_campo == 6 && strncmp(campo, "limite", 6) == 0) {
+            const char *p = valor;
+            long limite;
+            ok = operador == OPERADOR_IGUAL && ler_inteiro_filtro(&p, &limite) && *p == '\0' && limite > 0;
+            if (ok) filtro->limite = limite;
+        } else {
+            *erro = "Campo desconhecido (use turma, n1, n2, n3, media, situacao, limite ou nome).";
+            return 0;
+        }
+        if (!ok) {
+            *erro = "Valor invalido no filtro (numero, faixa a..b, situacao aprovado/recup/reprovado ou limite > 0).";
+            return 0;
+        }
+    }
+}
+
+// --- 2. Filtro Compilado ---
+
+// Faixa fechada sobre uma coluna de floats
+typedef struct {
+    const float *valores;
+    float min;
+    float max;
+} FaixaColuna;
+
+// Filtro pronto para a execução: só os campos restritos, já apontando para as colunas
+typedef struct {
+    const DadosSistema *sistema;
+    const ColunasNotas *colunas;
+    int filtra_turma;
+    int turma_min;
+    int turma_max;
+    FaixaColuna faixas[4];        // Notas e média restritas
+    int num_faixas;
+    unsigned situacoes;           // SITUACOES_TODAS = sem teste de situação
+    const char *prefixo;          // NULL = sem teste de nome
+    size_t tam_prefixo;
+    int vazio;                    // 1 se alguma faixa não tem valor possível
+    long limite;
+    long entregues;
+    VisitaAluno visita;
+    void *contexto;
+    int parar;                    // 1 quando o limite foi atingido ou a visita pediu para parar
+} ConsultaCompilada;
+
+/**
+ * @brief Guarda a faixa de uma coluna, se ela restringe alguma coisa.
+ */
+static void compilar_faixa(ConsultaCompilada *consulta, const float *valores, float min, float max) {
+    if (min > max) consulta->vazio = 1;
+    if (min == -INFINITY && max == INFINITY) return;
+    consulta->faixas[consulta->num_faixas].valores = valores;
+    consulta->faixas[consulta->num_faixas].min = min;
+    consulta->faixas[consulta->num_faixas].max = max;
+    consulta->num_faixas++;
+}
+
+static void compilar_filtro(const DadosSistema *sistema, const ColunasNotas *colunas, const FiltroAlunos *filtro,
+                            VisitaAluno visita, void *contexto, ConsultaCompilada *consulta) {
+    consulta->sistema = sistema;
+    consulta->colunas = colunas;
+    consulta->filtra_turma = filtro->turma_min != INT_MIN || filtro->turma_max != INT_MAX;
+    consulta->turma_min = filtro->turma_min;
+    consulta->turma_max = filtro->turma_max;
+    consulta->num_faixas = 0;
+    consulta->vazio = filtro->turma_min > filtro->turma_max || (filtro->situacoes & SITUACOES_TODAS) == 0;
+    for (int n = 0; n < 3; n++) {
+        compilar_faixa(consulta, colunas->notas[n], filtro->notas_min[n], filtro->notas_max[n]);
+    }
+    compilar_faixa(consulta, colunas->media, filtro->media_min, filtro->media_max);
+    consulta->situacoes = filtro->situacoes & SITUACOES_TODAS;
+    consulta->tam_prefixo = strnlen(filtro->prefixo, TAM_NOME);
+    consulta->prefixo = consulta->tam_prefixo > 0 ? filtro->prefixo : NULL;
+    consulta->limite = filtro->limite;
+    consulta->entregues = 0;
+    consulta->visita = visita;
+    consulta->contexto = contexto;
+    consulta->parar = 0;
+}
+
+/**
+ * @brief Testa um aluno (slot) contra as faixas, a situação e o prefixo.
+ */
+static int aceitar_slot(const ConsultaCompilada *consulta, int slot, int testar_prefixo) {
+    const ColunasNotas *colunas = consulta->colunas;
+    if (consulta->filtra_turma &&
+        (colunas->id_turma[slot] < consulta->turma_min || colunas->id_turma[slot] > consulta->turma_max)) {
+        return 0;
+    }
+    for (int f = 0; f < consulta->num_faixas; f++) {
+        float v = consulta->faixas[f].valores[slot];
+        if (!(v >= consulta->faixas[f].min && v <= consulta->faixas[f].max)) return 0;
+    }
+    if (!((consulta->situacoes >> (colunas->situacao[slot] & 3)) & 1u)) return 0;
+    if (testar_prefixo && consulta->prefixo != NULL &&
+        strncmp(texto_em(consulta->sistema, aluno_em(consulta->sistema, slot)->nome),
+                consulta->prefixo, consulta->tam_prefixo) != 0) {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Entrega um aluno aceito a quem consultou.
+ * @return int 1 para continuar, 0 se a consulta terminou.
+ */
+static int entregar(ConsultaCompilada *consulta, int slot) {
+    consulta->entregues++;
+    if (!consulta->visita(consulta->sistema, slot, consulta->contexto) ||
+        (consulta->limite > 0 && consulta->entregues >= consulta->limite)) {
+        consulta->parar = 1;
+    }
+    return !consulta->parar;
+}
+
+// --- 3. Planos ---
+
+/**
+ * @brief Máscara dos 'largura' valores de uma coluna que estão na faixa (bit j = valores[j]).
+ * Sem desvios: o laço é o mesmo para qualquer dado.
+ */
+static inline unsigned long long mascara_faixa(const float *valores, int largura, float min, float max) {
+    unsigned long long mascara = 0;
+    for (int j = 0; j < largura; j++) {
+        mascara |= (unsigned long long)((valores[j] >= min) & (valores[j] <= max)) << j;
+    }
+    return mascara;
+}
+
+static inline unsigned long long mascara_turma(const int *ids, int largura, int min, int max) {
+    unsigned long long mascara = 0;
+    for (int j = 0; j < largura; j++) {
+        mascara |= (unsigned long long)((ids[j] >= min) & (ids[j] <= max)) << j;
+    }
+    return mascara;
+}
+
+static inline unsigned long long mascara_situacao(const unsigned char *situacao, int largura, unsigned aceitas) {
+    unsigned long long mascara = 0;
+    for (int j = 0; j < largura; j++) {
+        mascara |= (unsigned long long)((aceitas >> (situacao[j] & 3)) & 1u) << j;
+    }
+    return mascara;
+}
+
+static inline int menor_bit(unsigned long long bits) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int bit = 0;
+    while (!((bits >> bit) & 1u)) bit++;
+    return bit;
+#endif
+}
+
+/**
+ * @brief Varredura: 64 alunos por vez, partindo do mapa de ativos; cada
+ * restrição reduz a máscara, e as seguintes nem são avaliadas se ela zerar.
+ */
+static void executar_varredura(ConsultaCompilada *consulta) {
+    const ColunasNotas *colunas = consulta->colunas;
+    for (int base = 0; base < colunas->quantidade && !consulta->parar; base += BITS_POR_PALAVRA_ATIVOS) {
+        unsigned long long bits = colunas->ativos[base / BITS_POR_PALAVRA_ATIVOS];
+        if (bits == 0) continue;
+        int largura = colunas->quantidade - base < BITS_POR_PALAVRA_ATIVOS ? colunas->quantidade - base
+                                                                           : BITS_POR_PALAVRA_ATIVOS;
+        if (consulta->filtra_turma) {
+            bits &= mascara_turma(colunas->id_turma + base, largura, consulta->turma_min, consulta->turma_max);
+        }
+        for (int f = 0; f < consulta->num_faixas && bits != 0; f++) {
+            const FaixaColuna *faixa = &consulta->faixas[f];
+            bits &= mascara_faixa(faixa->valores + base, largura, faixa->min, faixa->max);
+        }
+        if (bits != 0 && consulta->situacoes != SITUACOES_TODAS) {
+            bits &= mascara_situacao(colunas->situacao + base, largura, consulta->situacoes);
+        }
+
+        for (; bits != 0; bits &= bits - 1) {
+            int slot = base + menor_bit(bits);
+            if (consulta->prefixo != NULL &&
+                strncmp(texto_em(consulta->sistema, aluno_em(consulta->sistema, slot)->nome),
+                        consulta->prefixo, consulta->tam_prefixo) != 0) {
+                continue;
+            }
+            if (!entregar(consulta, slot)) return;
+        }
+    }
+}
+
+/**
+ * @brief Turmas: percorre as listas de membros das turmas ativas da faixa de IDs.
+ */
+static void executar_por_turmas(ConsultaCompilada *consulta) {
+    const DadosSistema *sistema = consulta->sistema;
+    for (int t = 0; t < sistema->turmas.usados && !consulta->parar; t++) {
+        const Turma *turma = turma_em(sistema, t);
+        if (turma->ativo != 1 || turma->id < consulta->turma_min || turma->id > consulta->turma_max) continue;
+        for (int i = indice_turmas_primeiro(&sistema->membros, t); i != -1 && !consulta->parar;
+             i = indice_turmas_proximo(&sistema->membros, i)) {
+            if (aceitar_slot(consulta, i, 1)) entregar(consulta, i);
+        }
+    }
+}
+
+static int visitar_por_nome(const DadosSistema *sistema, int slot, void *contexto) {
+    ConsultaCompilada *consulta = contexto;
+    (void)sistema;
+    return !aceitar_slot(consulta, slot, 0) || entregar(consulta, slot);
+}
+
+/**
+ * @brief Alunos estimados pelo plano de turmas: soma das vagas ocupadas das
+ * turmas ativas da faixa de IDs (O(turmas), sem ler alunos).
+ */
+static long estimar_por_turmas(const DadosSistema *sistema, const FiltroAlunos *filtro) {
+    long alunos = 0;
+    for (int t = 0; t < sistema->turmas.usados; t++) {
+        const Turma *turma = turma_em(sistema, t);
+        if (turma->ativo == 1 && turma->id >= filtro->turma_min && turma->id <= filtro->turma_max) {
+            alunos += turma->vagas_ocupadas;
+        }
+    }
+    return alunos;
+}
+
+/**
+ * @brief Escolhe o plano da consulta (PLANO_*): as listas de turmas quando a
+ * faixa de IDs cobre até 1/8 dos alunos, o índice de nomes quando há prefixo,
+ * e a varredura das colunas nos demais casos.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param filtro Filtro da consulta.
+ * @return int PLANO_*.
+ */
+int planejar_consulta(const DadosSistema *sistema, const FiltroAlunos *filtro) {
+    if ((filtro->turma_min != INT_MIN || filtro->turma_max != INT_MAX) &&
+        estimar_por_turmas(sistema, filtro) * 8 <= sistema->total_alunos) {
+        return PLANO_TURMAS;
+    }
+    if (filtro->prefixo[0] != '\0') return PLANO_NOMES;
+    return PLANO_VARREDURA;
+}
+
+/**
+ * @brief Nome do plano, para exibição ("varredura", "turmas" ou "nomes").
+ */
+const char *nome_plano(int plano) {
+    static const char *const nomes[] = {"varredura", "turmas", "nomes"}; // Indexado por PLANO_*
+    return (plano >= 0 && plano <= PLANO_NOMES) ? nomes[plano] : "?";
+}
+
+// --- 4. Execução ---
+
+/**
+ * @brief Entrega a 'visita' cada aluno ativo que passa no filtro.
+ * A ordem depende do plano (ver planejar_consulta): tabela, turma ou nome.
+ * Monta no primeiro uso as colunas e o índice que o plano usar.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param filtro Filtro da consulta.
+ * @param visita Chamada para cada aluno encontrado; retornar 0 encerra a consulta.
+ * @param contexto Repassado a 'visita'.
+ * @return long Alunos entregues, ou -1 se faltou memória para as colunas ou o índice.
+ */
+long consultar_alunos(const DadosSistema *sistema, const FiltroAlunos *filtro, VisitaAluno visita, void *contexto) {
+    METRICA_MEDIR(METRICA_CONSULTAR_ALUNOS);
+    const ColunasNotas *colunas = colunas_montadas(sistema);
+    if (colunas == NULL) return -1;
+
+    ConsultaCompilada consulta;
+    compilar_filtro(sistema, colunas, filtro, visita, contexto, &consulta);
+    if (consulta.vazio) return 0;
+
+    // Os índices são caches derivados das tabelas (como em preparar_indices)
+    DadosSistema *cache = (DadosSistema *)sistema;
+    switch (planejar_consulta(sistema, filtro)) {
+        case PLANO_TURMAS:
+            if (!sistema->membros.pronto && !indice_turmas_reconstruir(sistema, &cache->membros)) return -1;
+            executar_por_turmas(&consulta);
+            break;
+        case PLANO_NOMES:
+            if (!sistema->nomes.pronto && !indice_nomes_reconstruir(sistema, &cache->nomes)) return -1;
+            indice_nomes_percorrer(sistema, &sistema->nomes, consulta.prefixo, visitar_por_nome, &consulta);
+            break;
+        default:
+            executar_varredura(&consulta);
+            break;
+    }
+    return consulta.entregues;
+}
+
+// --- 5. Saída em CSV ---
+
+static int escrever_linha_csv(const DadosSistema *sistema, int slot, void *contexto) {
+    SaidaBuffer *saida = contexto;
+    const Aluno *aluno = aluno_em(sistema, slot);
+    saida_campo_csv(saida, aluno->ra);
+    saida_caractere(saida, ',');
+    saida_campo_csv(saida, texto_em(sistema, aluno->nome));
+    saida_caractere(saida, ',');
+    saida_inteiro(saida, aluno->id_turma);
+    for (int n = 0; n < 3; n++) {
+        saida_caractere(saida, ',');
+        saida_decimal(saida, aluno->notas[n]);
+    }
+    saida_caractere(saida, ',');
+    saida_decimal(saida, aluno->media_final);
+    saida_caractere(saida, ',');
+    saida_texto(saida, situacao_aluno(aluno));
+    saida_caractere(saida, '\n');
+    return !saida->erro;
+}
+
+/**
+ * @brief Escreve em CSV os alunos que passam no filtro, à medida que são
+ * encontrados (ra,nome,id_turma,n1,n2,n3,media,situacao), pelo SaidaBuffer.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param filtro Filtro da consulta.
+ * @param destino Arquivo aberto para escrita (ex: stdout).
+ * @param total Recebe a quantidade de alunos escritos.
+ * @return int 1 se sucesso, 0 em caso de falta de memória ou falha de escrita.
+ */
+int exportar_consulta(const DadosSistema *sistema, const FiltroAlunos *filtro, FILE *destino, long *total) {
+    SaidaBuffer saida;
+    *total = 0;
+    if (!saida_iniciar(&saida, destino)) {
+        printf("ERRO: Memoria insuficiente para a consulta.\n");
+        return 0;
+    }
+
+    saida_texto(&saida, "ra,nome,id_turma,n1,n2,n3,media,situacao\n");
+    long encontrados = consultar_alunos(sistema, filtro, escrever_linha_csv, &saida);
+    int escrito = saida_concluir(&saida);
+    if (encontrados < 0) {
+        printf("ERRO: Memoria insuficiente para a consulta.\n");
+        return 0;
+    }
+    if (!escrito) {
+        printf("ERRO: Falha ao escrever o resultado da consulta.\n");
+        return 0;
+    }
+    *total = encontrados;
+    return 1;
+}
@@ -0,0 +1,55 @@
+#ifndef CONSULTAS_H
+#define CONSULTAS_H
+
+#include <stdio.h>
+#include "servicos.h"
+
+// --- Consultas de Alunos por Filtros ---
+//
+// Filtros combinados (todos precisam valer) sobre turma, notas, média,
+// situação e prefixo do nome, escritos como texto:
+//
+//   turma=3..9 situacao=recup n2<4
+//   media>=7 n1>=8 limite=50 nome=Ana
+//   nome="Ana Maria" situacao=aprovado
+//
+// Termos separados por espaço: turma, n1, n2, n3 e media aceitam =, <, <=,
+// >, >= e faixas "a..b" (inclusive); situacao aceita aprovado, recup e
+// reprovado, separados por vírgula; limite corta a quantidade de alunos; e
+// nome é o prefixo do nome, até o próximo espaço (entre aspas, pode ter espaços).
+// Termos repetidos no mesmo campo se acumulam (turma>=3 turma<=9).
+//
+// O filtro é compilado em faixas fechadas [min, max] sobre as colunas dos
+// alunos (colunas.h), só dos campos restritos. A execução escolhe um plano:
+//   - turmas: poucas turmas na faixa de IDs -> listas de membros das turmas;
+//   - nomes:  prefixo do nome -> índice alfabético (resultado em ordem de nome);
+//   - varredura: mapa de ativos, 64 alunos por vez, cada faixa reduzindo uma
+//     máscara de bits; o registro (nome) só é lido para quem passou.
+// Nos três planos o teste é o mesmo, então o resultado só muda de ordem.
+
+#define PLANO_VARREDURA 0
+#define PLANO_TURMAS 1
+#define PLANO_NOMES 2
+
+#define SITUACOES_TODAS 0x7u  // Bits (1 << SITUACAO_*): nenhuma restrição de situação
+
+typedef struct {
+    int turma_min;        // Faixa de IDs de turma (inclusive)
+    int turma_max;
+    float notas_min[3];   // Faixa de N1, N2 e N3 (inclusive)
+    float notas_max[3];
+    float media_min;      // Faixa da média final (inclusive)
+    float media_max;
+    unsigned situacoes;   // Situações aceitas: bits (1 << SITUACAO_*)
+    long limite;          // Máximo de alunos (0 = sem limite)
+    char prefixo[TAM_NOME]; // Prefixo do nome ("" = qualquer nome)
+} FiltroAlunos;
+
+void filtro_iniciar(FiltroAlunos *filtro);
+int filtro_interpretar(const char *texto, FiltroAlunos *filtro, const char **erro);
+int planejar_consulta(const DadosSistema *sistema, const FiltroAlunos *filtro);
+const char *nome_plano(int plano);
+long consultar_alunos(const DadosSistema *sistema, const FiltroAlunos *filtro, VisitaAluno visita, void *contexto);
+int exportar_consulta(const DadosSistema *sistema, const FiltroAlunos *filtro, FILE *destino, long *total);
+
+#endif // CONSULTAS_H
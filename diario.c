@@ -0,0 +1,445 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "servicos.h"
+#include "formato.h"
+#include "arquivos.h"
+#include "diario.h"
+#include "gravador.h"
+#include "metricas.h"
+
+// --- 1. Formato do Diário ---
+//
+// [CabecalhoDiario] seguido de grupos de registros. Cada grupo (uma
+// confirmação) é: N x ([RegistroDiario] + imagem da Turma, do Aluno ou da
+// célula do heap de textos) e, por fim,
+// [RegistroDiario tipo CONFIRMACAO] + [ConfirmacaoDiario]. O CRC da confirmação
+// cobre todos os bytes do grupo; um grupo incompleto ou com CRC errado (queda
+// no meio da escrita) encerra a reaplicação e é cortado do arquivo.
+//
+// Um diário da versão 1 (nome dentro do registro, sem células de texto) ainda
+// é reaplicado: as imagens são convertidas como no arquivo base antigo.
+
+#define ASSINATURA_DIARIO 0x4A414753 // "SGAJ"
+#define VERSAO_DIARIO 2 // 2: nomes no heap de textos (imagens DIARIO_TEXTO)
+
+#define DIARIO_TURMA 1
+#define DIARIO_ALUNO 2
+#define DIARIO_CONFIRMACAO 3
+#define DIARIO_TEXTO 4
+
+typedef struct {
+    int assinatura;
+    int versao;
+    int tam_turma;      // sizeof(Turma) de quem gravou: diário de outro layout é rejeitado
+    int tam_aluno;      // sizeof(Aluno) de quem gravou
+} CabecalhoDiario;
+
+typedef struct {
+    int tipo;           // DIARIO_TURMA, DIARIO_ALUNO, DIARIO_TEXTO ou DIARIO_CONFIRMACAO
+    int slot;           // Slot do registro (na confirmação: quantidade de registros do grupo)
+} RegistroDiario;
+
+typedef struct {
+    int total_turmas;   // Contadores do sistema após o grupo
+    int total_alunos;
+    unsigned crc;       // CRC-32 de todos os bytes do grupo antes da confirmação
+} ConfirmacaoDiario;
+
+// --- 2. Marcação de Registros Alterados ---
+
+/**
+ * @brief Inicializa o diário (nenhum arquivo é aberto até a primeira confirmação).
+ * @param diario Ponteiro para o diário.
+ */
+void diario_inicializar(Diario *diario) {
+    memset(diario, 0, sizeof(*diario));
+    diario->confirmacoes_por_fsync = 1;
+}
+
+/**
+ * @brief Sincroniza confirmações pendentes, fecha o arquivo e libera as listas.
+ * @param diario Ponteiro para o diário.
+ */
+void diario_liberar(Diario *diario) {
+    if (diario->arquivo != NULL) {
+        diario_sincronizar(diario);
+        fclose(diario->arquivo);
+    }
+    free(diario->turmas.slots);
+    free(diario->alunos.slots);
+    free(diario->textos.slots);
+    int por_fsync = diario->confirmacoes_por_fsync;
+    struct Gravador *gravador = diario->gravador;
+    diario_inicializar(diario);
+    diario->confirmacoes_por_fsync = por_fsync;
+    diario->gravador = gravador;
+}
+
+/**
+ * @brief Liga o group commit: um fsync a cada 'confirmacoes' confirmações
+ * (1 = toda confirmação durável ao retornar). Numa queda, as confirmações
+ * ainda sem fsync se perdem; confirmar uma transação, o checkpoint e o
+ * encerramento sincronizam sempre. Com um gravador ligado, quem junta as
+ * confirmações é a thread dele (ver gravador.h).
+ * @param diario Ponteiro para o diário.
+ * @param confirmacoes Confirmações por fsync (valores menores que 1 valem 1).
+ */
+void diario_definir_group_commit(Diario *diario, int confirmacoes) {
+    diario->confirmacoes_por_fsync = confirmacoes > 0 ? confirmacoes : 1;
+}
+
+/**
+ * @brief Registra que o slot foi alterado e deve ir para o diário na próxima confirmação.
+ * Marcar o mesmo slot várias vezes é permitido (as repetições são descartadas ao confirmar).
+ * @param diario Ponteiro para o diário.
+ * @param lista Lista de turmas, de alunos ou de células de texto do próprio diário.
+ * @param slot Slot alterado.
+ */
+void diario_marcar(Diario *diario, ListaSlots *lista, int slot) {
+    if (lista->quantidade > 0 && lista->slots[lista->quantidade - 1] == slot) return;
+
+    if (lista->quantidade == lista->capacidade) {
+        int nova = lista->capacidade > 0 ? lista->capacidade * 2 : 16;
+        int *novo = realloc(lista->slots, (size_t)nova * sizeof(int));
+        if (novo == NULL) {
+            diario->incompleto = 1; // Sem memória: o estado completo será gravado num checkpoint
+            return;
+        }
+        lista->slots = novo;
+        lista->capacidade = nova;
+    }
+    lista->slots[lista->quantidade++] = slot;
+}
+
+/**
+ * @brief Informa se há alterações marcadas ainda não confirmadas.
+ * @param diario Ponteiro para o diário.
+ * @return int 1 se há alterações pendentes, 0 caso contrário.
+ */
+int diario_tem_alteracoes(const Diario *diario) {
+    return diario->turmas.quantidade > 0 || diario->alunos.quantidade > 0 || diario->textos.quantidade > 0 ||
+           diario->incompleto;
+}
+
+/**
+ * @brief Estimativa (por cima) dos bytes que a próxima confirmação acrescentaria ao diário.
+ * @param diario Ponteiro para o diário.
+ * @return long Bytes, contando slots repetidos como se fossem distintos.
+ */
+long diario_tamanho_pendente(const Diario *diario) {
+    return (long)diario->turmas.quantidade * (long)(sizeof(RegistroDiario) + sizeof(Turma)) +
+           (long)diario->alunos.quantidade * (long)(sizeof(RegistroDiario) + sizeof(Aluno)) +
+           (long)diario->textos.quantidade * (long)(sizeof(RegistroDiario) + TAM_CELULA_TEXTO);
+}
+
+/**
+ * @brief Esquece as alterações marcadas (usado depois de um checkpoint, que já gravou tudo).
+ * @param diario Ponteiro para o diário.
+ */
+void diario_descartar_alteracoes(Diario *diario) {
+    diario->turmas.quantidade = 0;
+    diario->alunos.quantidade = 0;
+    diario->textos.quantidade = 0;
+    diario->incompleto = 0;
+}
+
+static int comparar_inteiros(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Ordena a lista e remove slots repetidos.
+ * @param lista Lista de slots.
+ */
+static void remover_repetidos(ListaSlots *lista) {
+    if (lista->quantidade < 2) return;
+    qsort(lista->slots, (size_t)lista->quantidade, sizeof(int), comparar_inteiros);
+
+    int n = 1;
+    for (int i = 1; i < lista->quantidade; i++) {
+        if (lista->slots[i] != lista->slots[n - 1]) lista->slots[n++] = lista->slots[i];
+    }
+    lista->quantidade = n;
+}
+
+// --- 3. Gravação (Confirmação e Group Commit) ---
+
+/**
+ * @brief Abre o diário para acréscimo, criando-o com cabeçalho se ainda não existir.
+ * @param diario Ponteiro para o diário.
+ * @return int 1 se o arquivo está pronto, 0 caso contrário.
+ */
+static int abrir_para_acrescimo(Diario *diario) {
+    if (diario->arquivo != NULL) return 1;
+
+    diario->arquivo = fopen(NOME_DIARIO, "ab");
+    if (diario->arquivo == NULL) return 0;
+
+    diario->tamanho = arquivo_tamanho(diario->arquivo);
+    if (diario->tamanho <= 0) {
+        CabecalhoDiario cab = { ASSINATURA_DIARIO, VERSAO_DIARIO, (int)sizeof(Turma), (int)sizeof(Aluno) };
+        if (fwrite(&cab, sizeof(cab), 1, diario->arquivo) != 1) return 0;
+        metricas_bytes_gravados(sizeof(cab));
+        diario->tamanho = (long)sizeof(cab);
+    }
+    return 1;
+}
+
+/**
+ * @brief Gravador em segundo plano ligado ao diário, ou NULL se não há nenhum rodando.
+ */
+static Gravador *gravador_ativo(const Diario *diario) {
+    return diario->gravador != NULL && diario->gravador->ativo ? diario->gravador : NULL;
+}
+
+/**
+ * @brief Acrescenta ao diário um grupo com as imagens atuais dos registros alterados.
+ * O grupo inteiro é montado em memória e escrito com um único fwrite. O fsync
+ * acontece a cada 'confirmacoes_por_fsync' confirmações (group commit).
+ * Com um gravador ligado, o grupo montado é entregue à thread dele, que o
+ * escreve junto com os seguintes (ver gravador.h): aqui não há E/S.
+ * As listas de alterados ficam ordenadas e sem repetição; quem chama as
+ * esvazia com diario_descartar_alteracoes depois de concluir a gravação.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param diario Ponteiro para o diário.
+ * @return int 1 se o grupo foi gravado (ou não havia alterações), 0 em caso de falha.
+ */
+int diario_confirmar(const DadosSistema *sistema, Diario *diario) {
+    int registros = diario->turmas.quantidade + diario->alunos.quantidade + diario->textos.quantidade;
+    if (registros == 0) return 1;
+    if (!abrir_para_acrescimo(diario)) return 0;
+
+    remover_repetidos(&diario->turmas);
+    remover_repetidos(&diario->alunos);
+    remover_repetidos(&diario->textos);
+    registros = diario->turmas.quantidade + diario->alunos.quantidade + diario->textos.quantidade;
+
+    size_t tamanho = (size_t)diario->textos.quantidade * (sizeof(RegistroDiario) + TAM_CELULA_TEXTO) +
+                     (size_t)diario->turmas.quantidade * (sizeof(RegistroDiario) + sizeof(Turma)) +
+                     (size_t)diario->alunos.quantidade * (sizeof(RegistroDiario) + sizeof(Aluno)) +
+                     sizeof(RegistroDiario) + sizeof(ConfirmacaoDiario);
+    char *grupo = malloc(tamanho);
+    if (grupo == NULL) return 0;
+
+    char *p = grupo;
+    for (int i = 0; i < diario->textos.quantidade; i++) {
+        RegistroDiario reg = { DIARIO_TEXTO, diario->textos.slots[i] };
+        memcpy(p, &reg, sizeof(reg));
+        memcpy(p + sizeof(reg), pool_slot(&sistema->textos, reg.slot), TAM_CELULA_TEXTO);
+        p += sizeof(reg) + TAM_CELULA_TEXTO;
+    }
+    for (int i = 0; i < diario->turmas.quantidade; i++) {
+        RegistroDiario reg = { DIARIO_TURMA, diario->turmas.slots[i] };
+        memcpy(p, &reg, sizeof(reg));
+        memcpy(p + sizeof(reg), turma_em(sistema, reg.slot), sizeof(Turma));
+        p += sizeof(reg) + sizeof(Turma);
+    }
+    for (int i = 0; i < diario->alunos.quantidade; i++) {
+        RegistroDiario reg = { DIARIO_ALUNO, diario->alunos.slots[i] };
+        memcpy(p, &reg, sizeof(reg));
+        memcpy(p + sizeof(reg), aluno_em(sistema, reg.slot), sizeof(Aluno));
+        p += sizeof(reg) + sizeof(Aluno);
+    }
+
+    RegistroDiario reg = { DIARIO_CONFIRMACAO, registros };
+    ConfirmacaoDiario conf = { sistema->total_turmas, sistema->total_alunos,
+                               crc32_calcular(0, grupo, (size_t)(p - grupo)) };
+    memcpy(p, &reg, sizeof(reg));
+    memcpy(p + sizeof(reg), &conf, sizeof(conf));
+
+    Gravador *gravador = gravador_ativo(diario);
+    if (gravador != NULL) {
+        int entregue = gravador_entregar(gravador, diario->arquivo, grupo, tamanho);
+        free(grupo);
+        if (entregue) diario->tamanho += (long)tamanho; // O tamanho que o arquivo terá
+        return entregue;
+    }
+
+    int ok = fwrite(grupo, tamanho, 1, diario->arquivo) == 1;
+    free(grupo);
+    if (!ok) return 0;
+    metricas_bytes_gravados(tamanho);
+
+    diario->tamanho += (long)tamanho;
+
+    if (++diario->confirmacoes_pendentes >= diario->confirmacoes_por_fsync) {
+        return diario_sincronizar(diario);
+    }
+    return fflush(diario->arquivo) == 0;
+}
+
+/**
+ * @brief Força o fsync das confirmações escritas e ainda não sincronizadas.
+ * Com um gravador ligado, é a barreira dele: espera a fila ser escrita.
+ * @param diario Ponteiro para o diário.
+ * @return int 1 se tudo que foi confirmado está no disco, 0 em caso de falha.
+ */
+int diario_sincronizar(Diario *diario) {
+    Gravador *gravador = gravador_ativo(diario);
+    if (gravador != NULL && !gravador_aguardar(gravador)) return 0;
+    if (diario->arquivo == NULL || diario->confirmacoes_pendentes == 0) return 1;
+    if (!arquivo_sincronizar(diario->arquivo)) return 0;
+    diario->confirmacoes_pendentes = 0;
+    return 1;
+}
+
+/**
+ * @brief Esvazia o diário depois de um checkpoint (o arquivo base já contém tudo).
+ * @param diario Ponteiro para o diário.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int diario_reiniciar(Diario *diario) {
+    Gravador *gravador = gravador_ativo(diario);
+    if (gravador != NULL) gravador_aguardar(gravador); // A thread não pode estar escrevendo no arquivo
+    if (diario->arquivo != NULL) {
+        fclose(diario->arquivo);
+        diario->arquivo = NULL;
+    }
+    diario->tamanho = 0;
+    diario->confirmacoes_pendentes = 0;
+
+    if (remove(NOME_DIARIO) != 0) {
+        FILE *f = fopen(NOME_DIARIO, "rb");
+        if (f != NULL) {
+            fclose(f);
+            return 0; // O diário existe e não pôde ser removido
+        }
+    }
+    return 1;
+}
+
+// --- 4. Reaplicação (Recuperação na Carga) ---
+
+/**
+ * @brief Tamanho da imagem gravada para o tipo de registro (0 = tipo desconhecido).
+ * @param tipo Tipo do RegistroDiario.
+ * @param antigo 1 se o diário é da versão 1 (registros com o nome dentro).
+ */
+static size_t tamanho_imagem(int tipo, int antigo) {
+    switch (tipo) {
+        case DIARIO_TURMA: return antigo ? sizeof(TurmaAntiga) : sizeof(Turma);
+        case DIARIO_ALUNO: return antigo ? sizeof(AlunoAntigo) : sizeof(Aluno);
+        case DIARIO_TEXTO: return antigo ? 0 : TAM_CELULA_TEXTO;
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Copia uma imagem para o slot, estendendo a tabela (ou o heap) se preciso.
+ * Imagens de um diário da versão 1 são convertidas para o layout atual.
+ * @return int 1 se aplicada, 0 se faltou memória.
+ */
+static int aplicar_imagem(DadosSistema *sistema, int tipo, int slot, const char *imagem, int antigo) {
+    PoolRegistros *pool = tipo == DIARIO_TURMA ? &sistema->turmas :
+                          tipo == DIARIO_ALUNO ? &sistema->alunos : &sistema->textos;
+    if (slot < 0 || !pool_estender(pool, slot + 1)) return 0;
+    if (!antigo) {
+        memcpy(pool_slot_escrita(pool, slot), imagem, pool->tam_registro);
+        return 1;
+    }
+    if (tipo == DIARIO_TURMA) {
+        TurmaAntiga turma;
+        memcpy(&turma, imagem, sizeof(turma));
+        return formato_converter_turma(sistema, &turma, pool_slot_escrita(pool, slot));
+    }
+    AlunoAntigo aluno;
+    memcpy(&aluno, imagem, sizeof(aluno));
+    return formato_converter_aluno(sistema, &aluno, pool_slot_escrita(pool, slot));
+}
+
+/**
+ * @brief Reaplica sobre as tabelas carregadas todos os grupos completos do diário.
+ * Um final incompleto ou corrompido (queda durante a escrita) é descartado e
+ * cortado do arquivo, para que novas confirmações não fiquem atrás dele.
+ * Os índices em memória NÃO são atualizados: quem chama deve reconstruí-los.
+ * Depois de um diário da versão 1, o diário fica marcado como incompleto: a
+ * próxima gravação precisa ser um checkpoint, e não um acréscimo ao arquivo antigo.
+ * @param sistema Ponteiro para a estrutura DadosSistema (tabelas do arquivo base).
+ * @param caminho Caminho do diário.
+ * @return int Número de confirmações reaplicadas, ou -1 se o diário é de outro formato.
+ */
+int diario_reaplicar(DadosSistema *sistema, const char *caminho) {
+    FILE *f = fopen(caminho, "rb");
+    if (f == NULL) return 0;
+
+    CabecalhoDiario cab;
+    if (fread(&cab, sizeof(cab), 1, f) != 1) {
+        fclose(f);
+        return 0; // Diário vazio (queda antes do cabeçalho)
+    }
+    int atual = cab.versao == VERSAO_DIARIO &&
+                cab.tam_turma == (int)sizeof(Turma) && cab.tam_aluno == (int)sizeof(Aluno);
+    int antigo = cab.versao == 1 &&
+                 cab.tam_turma == (int)sizeof(TurmaAntiga) && cab.tam_aluno == (int)sizeof(AlunoAntigo);
+    if (cab.assinatura != ASSINATURA_DIARIO || (!atual && !antigo)) {
+        fclose(f);
+        return -1;
+    }
+
+    size_t cap_grupo = 64 * 1024, tam_grupo = 0;
+    char *grupo = malloc(cap_grupo);
+    long valido = (long)sizeof(cab);
+    int aplicados = 0;
+    int sem_memoria = (grupo == NULL);
+
+    while (!sem_memoria) {
+        RegistroDiario reg;
+        if (fread(&reg, sizeof(reg), 1, f) != 1) break;
+
+        if (reg.tipo == DIARIO_CONFIRMACAO) {
+            ConfirmacaoDiario conf;
+            if (fread(&conf, sizeof(conf), 1, f) != 1 ||
+                conf.crc != crc32_calcular(0, grupo, tam_grupo)) break;
+
+            // Grupo íntegro: aplica todas as imagens na ordem em que foram gravadas
+            for (size_t pos = 0; pos < tam_grupo; ) {
+                RegistroDiario r;
+                memcpy(&r, grupo + pos, sizeof(r));
+                if (!aplicar_imagem(sistema, r.tipo, r.slot, grupo + pos + sizeof(r), antigo)) {
+                    free(grupo);
+                    fclose(f);
+                    return -1;
+                }
+                pos += sizeof(r) + tamanho_imagem(r.tipo, antigo);
+            }
+            sistema->total_turmas = conf.total_turmas;
+            sistema->total_alunos = conf.total_alunos;
+            aplicados++;
+            tam_grupo = 0;
+            valido = ftell(f);
+            continue;
+        }
+
+        size_t tam_imagem = tamanho_imagem(reg.tipo, antigo);
+        if (tam_imagem == 0) break; // Lixo no final do arquivo
+
+        if (tam_grupo + sizeof(reg) + tam_imagem > cap_grupo) {
+            cap_grupo *= 2;
+            char *novo = realloc(grupo, cap_grupo);
+            if (novo == NULL) {
+                sem_memoria = 1;
+                break;
+            }
+            grupo = novo;
+        }
+        memcpy(grupo + tam_grupo, &reg, sizeof(reg));
+        if (fread(grupo + tam_grupo + sizeof(reg), tam_imagem, 1, f) != 1) break;
+        tam_grupo += sizeof(reg) + tam_imagem;
+    }
+
+    long tamanho = arquivo_tamanho(f);
+    free(grupo);
+    fclose(f);
+    metricas_bytes_lidos((unsigned long long)valido);
+
+    if (sem_memoria) return -1; // Não dá para saber se o restante é válido: nada é cortado
+    if (antigo) sistema->diario.incompleto = 1;
+    // Células copiadas direto para o heap: o índice de internação é remontado no próximo uso
+    else if (aplicados > 0) indice_textos_liberar(&sistema->internados);
+    if (tamanho > valido) {
+        arquivo_truncar(caminho, valido);
+    }
+    return aplicados;
+}
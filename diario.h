@@ -0,0 +1,50 @@
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include <stdio.h>
+
+// --- Diário de Alterações (Write-Ahead Log) ---
+//
+// Em vez de regravar o arquivo base inteiro a cada operação, salvar_dados
+// acrescenta ao diário só as imagens dos registros alterados, seguidas de um
+// registro de confirmação com CRC. Periodicamente o estado completo é gravado
+// no arquivo base (checkpoint) e o diário recomeça vazio. carregar_dados lê o
+// arquivo base e reaplica as confirmações completas do diário.
+
+#define NOME_DIARIO "dados_sistema.log"
+#define LIMITE_DIARIO (4L * 1024 * 1024) // Checkpoint quando o diário passa de 4 MB
+
+struct DadosSistema;
+struct Gravador;
+
+typedef struct {
+    int *slots;
+    int quantidade;
+    int capacidade;
+} ListaSlots;
+
+typedef struct {
+    ListaSlots turmas;          // Slots de turma alterados desde a última confirmação
+    ListaSlots alunos;          // Slots de aluno alterados desde a última confirmação
+    ListaSlots textos;          // Células do heap de textos gravadas desde a última confirmação
+    int incompleto;             // Faltou memória ao marcar: a próxima gravação exige checkpoint
+    FILE *arquivo;              // Diário aberto para acréscimo (NULL até a primeira gravação)
+    long tamanho;               // Bytes gravados no diário
+    int confirmacoes_por_fsync; // Group commit: um fsync a cada N confirmações (1 = todas duráveis)
+    int confirmacoes_pendentes; // Confirmações já escritas que ainda aguardam fsync
+    struct Gravador *gravador;  // Gravação em segundo plano (NULL = no próprio salvar_dados, ver gravador.h)
+} Diario;
+
+void diario_inicializar(Diario *diario);
+void diario_liberar(Diario *diario);
+void diario_definir_group_commit(Diario *diario, int confirmacoes);
+void diario_marcar(Diario *diario, ListaSlots *lista, int slot);
+int diario_tem_alteracoes(const Diario *diario);
+long diario_tamanho_pendente(const Diario *diario);
+void diario_descartar_alteracoes(Diario *diario);
+int diario_confirmar(const struct DadosSistema *sistema, Diario *diario);
+int diario_sincronizar(Diario *diario);
+int diario_reiniciar(Diario *diario);
+int diario_reaplicar(struct DadosSistema *sistema, const char *caminho);
+
+#endif // DIARIO_H
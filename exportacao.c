@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "exportacao.h"
+#include "saida.h"
+
+// --- 1. Distribuição dos Alunos por Turma ---
+
+// Alunos agrupados por slot de turma: os slots dos alunos da turma t ficam em
+// alunos[inicio[t] .. inicio[t + 1]), na ordem em que estão na tabela.
+typedef struct {
+    int *inicio;          // turmas.usados + 1 posições
+    int *alunos;          // Slots de alunos, agrupados por turma
+} GruposTurma;
+
+/**
+ * @brief Agrupa os alunos ativos pela turma (counting sort pelo slot da turma).
+ * As colunas dos alunos são lidas uma única vez; alunos de turmas inativas ficam de fora.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param grupos Recebe os grupos (liberar com liberar_grupos).
+ * @return int 1 se sucesso, 0 se faltou memória.
+ */
+static int agrupar_por_turma(const DadosSistema *sistema, GruposTurma *grupos) {
+    // As colunas primeiro: no modo fragmentado, montá-las lê os segmentos que faltam
+    const ColunasNotas *colunas = colunas_montadas(sistema);
+    int num_turmas = sistema->turmas.usados;
+    int num_alunos = sistema->alunos.usados;
+    int *turma_do_aluno = malloc((size_t)(num_alunos > 0 ? num_alunos : 1) * sizeof(int));
+    grupos->inicio = calloc((size_t)num_turmas + 2, sizeof(int));
+    grupos->alunos = NULL;
+    if (colunas == NULL || turma_do_aluno == NULL || grupos->inicio == NULL) {
+        free(turma_do_aluno);
+        free(grupos->inicio);
+        return 0;
+    }
+
+    // Passada única pela parte quente (ativos e turma): slot da turma de cada
+    // aluno e tamanho de cada grupo, sem ler os registros
+    int total = 0;
+    for (int i = 0; i < num_alunos; i++) {
+        int t = colunas_ativo(colunas, i) ? buscar_turma_por_id(sistema, colunas->id_turma[i]) : -1;
+        turma_do_aluno[i] = t;
+        if (t != -1) {
+            grupos->inicio[t + 2]++;
+            total++;
+        }
+    }
+
+    // inicio[t + 1] passa a ser a posição de escrita da turma t; ao final do
+    // posicionamento, inicio[t] e inicio[t + 1] delimitam o grupo de t.
+    for (int t = 2; t <= num_turmas + 1; t++) grupos->inicio[t] += grupos->inicio[t - 1];
+
+    grupos->alunos = malloc((size_t)(total > 0 ? total : 1) * sizeof(int));
+    if (grupos->alunos == NULL) {
+        free(turma_do_aluno);
+        free(grupos->inicio);
+        return 0;
+    }
+    for (int i = 0; i < num_alunos; i++) {
+        if (turma_do_aluno[i] != -1) grupos->alunos[grupos->inicio[turma_do_aluno[i] + 1]++] = i;
+    }
+
+    free(turma_do_aluno);
+    return 1;
+}
+
+static void liberar_grupos(GruposTurma *grupos) {
+    free(grupos->inicio);
+    free(grupos->alunos);
+}
+
+// --- 2. Formatos ---
+
+/**
+ * @brief Escreve as linhas CSV dos alunos de uma turma.
+ */
+static void escrever_turma_csv(SaidaBuffer *saida, const DadosSistema *sistema, const Turma *turma,
+                               const int *slots, int quantidade) {
+    for (int k = 0; k < quantidade; k++) {
+        const Aluno *aluno = aluno_em(sistema, slots[k]);
+        saida_inteiro(saida, turma->id);
+        saida_caractere(saida, ',');
+        saida_campo_csv(saida, texto_em(sistema, turma->nome));
+        saida_caractere(saida, ',');
+        saida_campo_csv(saida, aluno->ra);
+        saida_caractere(saida, ',');
+        saida_campo_csv(saida, texto_em(sistema, aluno->nome));
+        for (int n = 0; n < 3; n++) {
+            saida_caractere(saida, ',');
+            saida_decimal(saida, aluno->notas[n]);
+        }
+        saida_caractere(saida, ',');
+        saida_decimal(saida, aluno->media_final);
+        saida_caractere(saida, ',');
+        saida_texto(saida, situacao_aluno(aluno));
+        saida_caractere(saida, '\n');
+    }
+}
+
+/**
+ * @brief Escreve o objeto JSON de uma turma, com a lista dos seus alunos.
+ */
+static void escrever_turma_json(SaidaBuffer *saida, const DadosSistema *sistema, const Turma *turma,
+                                const int *slots, int quantidade) {
+    saida_texto(saida, "{\"id\":");
+    saida_inteiro(saida, turma->id);
+    saida_texto(saida, ",\"nome\":");
+    saida_string_json(saida, texto_em(sistema, turma->nome));
+    saida_texto(saida, ",\"vagas_maximas\":");
+    saida_inteiro(saida, turma->vagas_maximas);
+    saida_texto(saida, ",\"vagas_ocupadas\":");
+    saida_inteiro(saida, turma->vagas_ocupadas);
+    saida_texto(saida, ",\"alunos\":[");
+
+    for (int k = 0; k < quantidade; k++) {
+        const Aluno *aluno = aluno_em(sistema, slots[k]);
+        if (k > 0) saida_caractere(saida, ',');
+        saida_texto(saida, "{\"ra\":");
+        saida_string_json(saida, aluno->ra);
+        saida_texto(saida, ",\"nome\":");
+        saida_string_json(saida, texto_em(sistema, aluno->nome));
+        saida_texto(saida, ",\"notas\":[");
+        for (int n = 0; n < 3; n++) {
+            if (n > 0) saida_caractere(saida, ',');
+            saida_decimal(saida, aluno->notas[n]);
+        }
+        saida_texto(saida, "],\"media\":");
+        saida_decimal(saida, aluno->media_final);
+        saida_texto(saida, ",\"situacao\":\"");
+        saida_texto(saida, situacao_aluno(aluno));
+        saida_texto(saida, "\"}");
+    }
+    saida_texto(saida, "]}");
+}
+
+// --- 3. Exportação ---
+
+/**
+ * @brief Exporta os relatórios de todas as turmas ativas (formatos em exportacao.h).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param destino Arquivo aberto para escrita (ex: stdout).
+ * @param formato EXPORTAR_CSV ou EXPORTAR_JSON.
+ * @param resumo Recebe a quantidade de turmas e alunos exportados.
+ * @return int 1 se sucesso, 0 em caso de falta de memória ou falha de escrita.
+ */
+int exportar_relatorios(const DadosSistema *sistema, FILE *destino, int formato, ResumoExportacao *resumo) {
+    GruposTurma grupos;
+    SaidaBuffer saida;
+    resumo->turmas = 0;
+    resumo->alunos = 0;
+
+    if (!agrupar_por_turma(sistema, &grupos)) {
+        printf("ERRO: Memoria insuficiente para a exportacao.\n");
+        return 0;
+    }
+    if (!saida_iniciar(&saida, destino)) {
+        printf("ERRO: Memoria insuficiente para a exportacao.\n");
+        liberar_grupos(&grupos);
+        return 0;
+    }
+
+    saida_texto(&saida, formato == EXPORTAR_JSON ? "[" : "id_turma,turma,ra,nome,n1,n2,n3,media,situacao\n");
+    for (int t = 0; t < sistema->turmas.usados; t++) {
+        const Turma *turma = turma_em(sistema, t);
+        if (turma->ativo != 1) continue;
+
+        const int *slots = grupos.alunos + grupos.inicio[t];
+        int quantidade = grupos.inicio[t + 1] - grupos.inicio[t];
+        if (formato == EXPORTAR_JSON) {
+            saida_texto(&saida, resumo->turmas > 0 ? ",\n" : "\n");
+            escrever_turma_json(&saida, sistema, turma, slots, quantidade);
+        } else {
+            escrever_turma_csv(&saida, sistema, turma, slots, quantidade);
+        }
+        resumo->turmas++;
+        resumo->alunos += quantidade;
+    }
+    if (formato == EXPORTAR_JSON) saida_texto(&saida, "\n]\n");
+
+    liberar_grupos(&grupos);
+    if (!saida_concluir(&saida)) {
+        printf("ERRO: Falha ao escrever a exportacao.\n");
+        return 0;
+    }
+    return 1;
+}
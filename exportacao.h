@@ -0,0 +1,29 @@
+#ifndef EXPORTACAO_H
+#define EXPORTACAO_H
+
+#include <stdio.h>
+#include "servicos.h"
+
+// --- Exportação dos Relatórios de Todas as Turmas ---
+//
+// Gera, de uma vez, o conteúdo de gerar_relatorio_turma para todas as turmas
+// ativas (notas, média e situação de cada aluno), em CSV ou JSON:
+//
+//   CSV:  id_turma,turma,ra,nome,n1,n2,n3,media,situacao   (uma linha por aluno)
+//   JSON: [ {"id":..,"nome":..,"vagas_maximas":..,"vagas_ocupadas":..,
+//            "alunos":[{"ra":..,"nome":..,"notas":[..],"media":..,"situacao":..}]}, ... ]
+//
+// Os alunos são lidos numa única passada pela tabela e distribuídos por turma
+// (contagem + posicionamento, sem ordenação); a escrita usa SaidaBuffer.
+
+#define EXPORTAR_CSV 0
+#define EXPORTAR_JSON 1
+
+typedef struct {
+    long turmas;          // Turmas ativas exportadas
+    long alunos;          // Alunos exportados
+} ResumoExportacao;
+
+int exportar_relatorios(const DadosSistema *sistema, FILE *destino, int formato, ResumoExportacao *resumo);
+
+#endif // EXPORTACAO_H
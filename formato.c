@@ -0,0 +1,500 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "servicos.h"
+#include "formato.h"
+#include "arquivos.h"
+#include "metricas.h"
+
+#define ASSINATURA_FORMATO 0x32414753 // "SGA2"
+
+// As versões 2 e 3 têm o mesmo cabeçalho, sem os campos acrescentados depois delas.
+#define TAM_CABECALHO_V2 offsetof(CabecalhoFormato, proximo_id_turma)
+#define TAM_CABECALHO_V3 offsetof(CabecalhoFormato, tam_celula_texto)
+
+// Formato 1 (sem páginas): cabeçalho com as quantidades e os registros em sequência.
+#define ASSINATURA_FORMATO_1 0x31414753 // "SGA1"
+
+typedef struct {
+    int assinatura;
+    int usados_turmas;
+    int usados_alunos;
+    int total_turmas;
+    int total_alunos;
+} CabecalhoFormato1;
+
+// Layout legado (dump direto da struct com vetores fixos de 20 turmas e 100 alunos).
+#define LEGADO_MAX_TURMAS 20
+#define LEGADO_MAX_ALUNOS 100
+#define TAMANHO_ARQUIVO_LEGADO \
+    (LEGADO_MAX_TURMAS * sizeof(TurmaAntiga) + LEGADO_MAX_ALUNOS * sizeof(AlunoAntigo) + 2 * sizeof(int))
+
+// --- 1. Auxiliares ---
+
+/**
+ * @brief Posiciona o arquivo num deslocamento de 64 bits.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+static int posicionar(FILE *f, long long deslocamento) {
+#ifdef _WIN32
+    return _fseeki64(f, deslocamento, SEEK_SET) == 0;
+#else
+    return fseeko(f, (off_t)deslocamento, SEEK_SET) == 0;
+#endif
+}
+
+/**
+ * @brief Número de páginas necessárias para 'usados' registros.
+ */
+static int paginas_para(int usados) {
+    return (usados + REGISTROS_POR_BLOCO - 1) >> BITS_POR_BLOCO;
+}
+
+/**
+ * @brief Registros que a página 'pagina' deve conter numa tabela com 'usados' slots.
+ */
+static int registros_da_pagina(int usados, int pagina) {
+    int restantes = usados - pagina * REGISTROS_POR_BLOCO;
+    return restantes < REGISTROS_POR_BLOCO ? restantes : REGISTROS_POR_BLOCO;
+}
+
+/**
+ * @brief Bytes que o cabeçalho ocupa no arquivo, conforme a versão de quem gravou.
+ */
+static size_t tam_cabecalho(const CabecalhoFormato *cab) {
+    return cab->versao >= 4 ? sizeof(CabecalhoFormato) : cab->versao == 3 ? TAM_CABECALHO_V3 : TAM_CABECALHO_V2;
+}
+
+/**
+ * @brief Total de entradas do diretório (turmas, alunos e textos).
+ */
+static int paginas_do_arquivo(const CabecalhoFormato *cab) {
+    return cab->paginas_turmas + cab->paginas_alunos + cab->paginas_textos;
+}
+
+/**
+ * @brief CRC do cabeçalho (com o campo do CRC zerado) seguido do diretório.
+ */
+static uint32_t crc_diretorio(const CabecalhoFormato *cab, const EntradaPagina *paginas, int num_paginas) {
+    CabecalhoFormato copia = *cab;
+    copia.crc_diretorio = 0;
+    uint32_t crc = crc32_calcular(0, &copia, tam_cabecalho(cab));
+    return crc32_calcular(crc, paginas, (size_t)num_paginas * sizeof(EntradaPagina));
+}
+
+// --- 2. Gravação ---
+//
+// O cabeçalho e o diretório ocupam o início do arquivo, mas só ficam completos
+// depois de todas as páginas: o espaço é reservado primeiro e preenchido no fim.
+
+typedef struct {
+    FILE *arquivo;
+    CabecalhoFormato cab;
+    EntradaPagina *paginas;
+    int proxima;              // Próxima entrada do diretório a preencher
+    long long posicao;        // Fim do arquivo (onde vai a próxima página)
+} EscritorFormato;
+
+/**
+ * @brief Prepara a gravação e reserva o espaço do cabeçalho e do diretório.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+static int escritor_iniciar(EscritorFormato *e, FILE *f, const DadosSistema *sistema) {
+    memset(&e->cab, 0, sizeof(e->cab));
+    e->cab.assinatura = ASSINATURA_FORMATO;
+    e->cab.versao = VERSAO_FORMATO;
+    e->cab.tam_turma = (int)sizeof(Turma);
+    e->cab.tam_aluno = (int)sizeof(Aluno);
+    e->cab.registros_por_pagina = REGISTROS_POR_BLOCO;
+    e->cab.tam_celula_texto = TAM_CELULA_TEXTO;
+    e->cab.usados_turmas = sistema->turmas.usados;
+    e->cab.usados_alunos = sistema->alunos.usados;
+    e->cab.usados_textos = sistema->textos.usados;
+    e->cab.paginas_turmas = paginas_para(e->cab.usados_turmas);
+    e->cab.paginas_alunos = paginas_para(e->cab.usados_alunos);
+    e->cab.paginas_textos = paginas_para(e->cab.usados_textos);
+
+    int num_paginas = paginas_do_arquivo(&e->cab);
+    e->arquivo = f;
+    e->proxima = 0;
+    e->paginas = calloc((size_t)(num_paginas > 0 ? num_paginas : 1), sizeof(EntradaPagina));
+    if (e->paginas == NULL) return 0;
+
+    e->posicao = (long long)sizeof(CabecalhoFormato) + (long long)num_paginas * (long long)sizeof(EntradaPagina);
+    return fwrite(&e->cab, sizeof(e->cab), 1, f) == 1 &&
+           fwrite(e->paginas, sizeof(EntradaPagina), (size_t)num_paginas, f) == (size_t)num_paginas;
+}
+
+/**
+ * @brief Acrescenta uma página (na ordem: turmas, alunos e textos).
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+static int escritor_pagina(EscritorFormato *e, const void *dados, int registros, size_t tam_registro) {
+    size_t tamanho = (size_t)registros * tam_registro;
+    EntradaPagina *entrada = &e->paginas[e->proxima++];
+    entrada->deslocamento = e->posicao;
+    entrada->registros = registros;
+    entrada->crc = crc32_calcular(0, dados, tamanho);
+
+    e->posicao += (long long)tamanho;
+    return fwrite(dados, 1, tamanho, e->arquivo) == tamanho;
+}
+
+/**
+ * @brief Preenche o cabeçalho e o diretório no início do arquivo e libera o escritor.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+static int escritor_concluir(EscritorFormato *e, const DadosSistema *sistema) {
+    if (e->paginas == NULL) return 0; // escritor_iniciar falhou
+    int num_paginas = paginas_do_arquivo(&e->cab);
+    e->cab.total_turmas = sistema->total_turmas;
+    e->cab.total_alunos = sistema->total_alunos;
+    e->cab.proximo_id_turma = sistema->proximo_id_turma;
+    e->cab.crc_diretorio = crc_diretorio(&e->cab, e->paginas, num_paginas);
+
+    int ok = e->proxima == num_paginas && posicionar(e->arquivo, 0) &&
+             fwrite(&e->cab, sizeof(e->cab), 1, e->arquivo) == 1 &&
+             fwrite(e->paginas, sizeof(EntradaPagina), (size_t)num_paginas, e->arquivo) == (size_t)num_paginas;
+    free(e->paginas);
+    e->paginas = NULL;
+    return ok;
+}
+
+/**
+ * @brief Grava as páginas de um pool, bloco a bloco.
+ */
+static int escrever_pool(EscritorFormato *e, const PoolRegistros *pool) {
+    for (int p = 0; p < paginas_para(pool->usados); p++) {
+        const void *bloco = pool_slot(pool, p << BITS_POR_BLOCO);
+        if (!escritor_pagina(e, bloco, registros_da_pagina(pool->usados, p), pool->tam_registro)) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Grava o estado completo das tabelas num arquivo no formato paginado (com fsync).
+ * Páginas ainda não lidas do arquivo anterior são lidas durante a gravação.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param caminho Arquivo de destino (normalmente um temporário).
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int formato_gravar(const DadosSistema *sistema, const char *caminho) {
+    FILE *f = fopen(caminho, "wb");
+    if (f == NULL) return 0;
+
+    EscritorFormato e;
+    int ok = escritor_iniciar(&e, f, sistema) &&
+             escrever_pool(&e, &sistema->turmas) &&
+             escrever_pool(&e, &sistema->alunos) &&
+             escrever_pool(&e, &sistema->textos);
+    ok = escritor_concluir(&e, sistema) && ok &&
+         arquivo_sincronizar(f);
+    if (ok) metricas_bytes_gravados((unsigned long long)e.posicao);
+    return (fclose(f) == 0) && ok;
+}
+
+// --- 3. Conversão dos Formatos Antigos ---
+//
+// Até a versão 3 (e no formato 1 e no layout legado) o nome ficava dentro do
+// registro, em TAM_NOME_ANTIGO bytes. A conversão lê os registros antigos uma
+// página por vez, direto para as tabelas em memória, e guarda os nomes no heap
+// de textos; quem chama grava o resultado num checkpoint.
+
+/**
+ * @brief Verifica se um cabeçalho "SGA2" de versão anterior pode ser convertido.
+ */
+static int versao_convertivel(const CabecalhoFormato *cab) {
+    return cab->versao >= 2 && cab->versao < VERSAO_FORMATO &&
+           cab->tam_turma == (int)sizeof(TurmaAntiga) && cab->tam_aluno == (int)sizeof(AlunoAntigo) &&
+           cab->registros_por_pagina == REGISTROS_POR_BLOCO;
+}
+
+/**
+ * @brief Guarda no heap um nome do layout antigo (que podia ocupar o campo inteiro, sem '\0').
+ * @return int Referência do nome, ou -1 se faltou memória.
+ */
+static int guardar_nome_antigo(DadosSistema *sistema, const char *nome) {
+    char texto[TAM_NOME_ANTIGO + 1];
+    size_t tamanho = strnlen(nome, TAM_NOME_ANTIGO);
+    memcpy(texto, nome, tamanho);
+    texto[tamanho] = '\0';
+    return guardar_texto(sistema, texto);
+}
+
+/**
+ * @brief Converte uma turma do layout antigo. Só o nome de turmas ativas vai para o heap.
+ * @param sistema Ponteiro para a estrutura DadosSistema (recebe o nome no heap).
+ * @param antiga Registro antigo.
+ * @param nova Registro novo (sobrescrito por inteiro).
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int formato_converter_turma(DadosSistema *sistema, const TurmaAntiga *antiga, Turma *nova) {
+    memset(nova, 0, sizeof(*nova));
+    nova->id = antiga->id;
+    nova->vagas_maximas = antiga->vagas_maximas;
+    nova->vagas_ocupadas = antiga->vagas_ocupadas;
+    nova->ativo = antiga->ativo;
+    nova->nome = antiga->ativo == 1 ? guardar_nome_antigo(sistema, antiga->nome) : 0;
+    return nova->nome >= 0;
+}
+
+/**
+ * @brief Converte um aluno do layout antigo. Só o nome de alunos ativos vai para o heap.
+ * @param sistema Ponteiro para a estrutura DadosSistema (recebe o nome no heap).
+ * @param antigo Registro antigo.
+ * @param novo Registro novo (sobrescrito por inteiro).
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int formato_converter_aluno(DadosSistema *sistema, const AlunoAntigo *antigo, Aluno *novo) {
+    memset(novo, 0, sizeof(*novo));
+    memcpy(novo->ra, antigo->ra, TAM_RA);
+    novo->id_turma = antigo->id_turma;
+    memcpy(novo->notas, antigo->notas, sizeof(novo->notas));
+    novo->media_final = antigo->media_final;
+    novo->ativo = antigo->ativo;
+    novo->nome = antigo->ativo == 1 ? guardar_nome_antigo(sistema, antigo->nome) : 0;
+    return novo->nome >= 0;
+}
+
+/**
+ * @brief Lê 'quantidade' registros antigos de uma tabela, uma página por vez, e os converte.
+ * @param paginas Diretório da tabela (versões 2 e 3, com CRC por página), ou NULL
+ * para registros em sequência a partir da posição atual (formato 1 e legado).
+ * @param pagina Buffer de uma página do maior registro antigo.
+ * @return int 1 se bem-sucedido, 0 em falha de leitura, CRC ou memória.
+ */
+static int converter_tabela(DadosSistema *sistema, FILE *f, const EntradaPagina *paginas, int quantidade,
+                            int alunos, char *pagina) {
+    PoolRegistros *pool = alunos ? &sistema->alunos : &sistema->turmas;
+    size_t tam_registro = alunos ? sizeof(AlunoAntigo) : sizeof(TurmaAntiga);
+
+    for (int p = 0; p < paginas_para(quantidade); p++) {
+        int n = registros_da_pagina(quantidade, p);
+        size_t tamanho = (size_t)n * tam_registro;
+        if (paginas != NULL && (paginas[p].registros != n || !posicionar(f, paginas[p].deslocamento))) return 0;
+        if (fread(pagina, 1, tamanho, f) != tamanho) return 0;
+        if (paginas != NULL && crc32_calcular(0, pagina, tamanho) != paginas[p].crc) return 0;
+        metricas_bytes_lidos(tamanho);
+
+        int primeiro = p << BITS_POR_BLOCO;
+        if (!pool_estender(pool, primeiro + n)) return 0;
+        for (int i = 0; i < n; i++) {
+            int ok = alunos ? formato_converter_aluno(sistema, (const AlunoAntigo *)pagina + i,
+                                                      aluno_em(sistema, primeiro + i))
+                            : formato_converter_turma(sistema, (const TurmaAntiga *)pagina + i,
+                                                      turma_em(sistema, primeiro + i));
+            if (!ok) return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Carrega para a memória um arquivo num formato antigo: "SGA2" versões 2
+ * e 3, formato 1 ("SGA1") ou layout legado (vetores fixos).
+ * O arquivo não é alterado; as tabelas e o heap de textos recebem os dados
+ * convertidos e os nomes ficam marcados no diário, então o chamador deve
+ * gravar o resultado com checkpoint_dados.
+ * @param sistema Ponteiro para a estrutura DadosSistema (pools vazios).
+ * @param caminho Arquivo antigo.
+ * @return int 1 se bem-sucedido, 0 se o arquivo não está num formato conhecido ou houve falha
+ * (as tabelas podem ter ficado pela metade: quem chama as libera).
+ */
+int formato_converter(DadosSistema *sistema, const char *caminho) {
+    FILE *f = fopen(caminho, "rb");
+    if (f == NULL) return 0;
+
+    // Descobre o layout e as quantidades sem ler os registros
+    CabecalhoFormato cab = {0};
+    CabecalhoFormato1 antigo;
+    EntradaPagina *paginas = NULL;
+    int ok = 1;
+    if (fread(&cab, TAM_CABECALHO_V2, 1, f) == 1 && cab.assinatura == ASSINATURA_FORMATO) {
+        int num_paginas = cab.paginas_turmas + cab.paginas_alunos;
+        ok = versao_convertivel(&cab) &&
+             (cab.versao < 3 || fread((char *)&cab + TAM_CABECALHO_V2, TAM_CABECALHO_V3 - TAM_CABECALHO_V2, 1, f) == 1) &&
+             cab.usados_turmas >= 0 && cab.usados_alunos >= 0 &&
+             cab.paginas_turmas == paginas_para(cab.usados_turmas) &&
+             cab.paginas_alunos == paginas_para(cab.usados_alunos);
+        paginas = ok ? malloc((size_t)(num_paginas > 0 ? num_paginas : 1) * sizeof(EntradaPagina)) : NULL;
+        ok = paginas != NULL &&
+             fread(paginas, sizeof(EntradaPagina), (size_t)num_paginas, f) == (size_t)num_paginas &&
+             crc_diretorio(&cab, paginas, num_paginas) == cab.crc_diretorio;
+        antigo.usados_turmas = cab.usados_turmas;
+        antigo.usados_alunos = cab.usados_alunos;
+        antigo.total_turmas = cab.total_turmas;
+        antigo.total_alunos = cab.total_alunos;
+    } else if (fseek(f, 0, SEEK_SET) == 0 && fread(&antigo, sizeof(antigo), 1, f) == 1 &&
+               antigo.assinatura == ASSINATURA_FORMATO_1) {
+        ok = antigo.usados_turmas >= 0 && antigo.usados_alunos >= 0;
+    } else if (fseek(f, 0, SEEK_END) == 0 && ftell(f) == (long)TAMANHO_ARQUIVO_LEGADO) {
+        // Os totais ficam no fim do arquivo, depois dos vetores
+        antigo.usados_turmas = LEGADO_MAX_TURMAS;
+        antigo.usados_alunos = LEGADO_MAX_ALUNOS;
+        ok = fseek(f, -(long)(2 * sizeof(int)), SEEK_END) == 0 &&
+             fread(&antigo.total_turmas, sizeof(int), 1, f) == 1 &&
+             fread(&antigo.total_alunos, sizeof(int), 1, f) == 1 &&
+             fseek(f, 0, SEEK_SET) == 0;
+    } else {
+        ok = 0;
+    }
+
+    char *pagina = ok ? malloc((size_t)REGISTROS_POR_BLOCO * sizeof(AlunoAntigo)) : NULL;
+    ok = pagina != NULL &&
+         converter_tabela(sistema, f, paginas, antigo.usados_turmas, 0, pagina) &&
+         converter_tabela(sistema, f, paginas != NULL ? paginas + cab.paginas_turmas : NULL,
+                          antigo.usados_alunos, 1, pagina);
+    free(pagina);
+    free(paginas);
+    fclose(f);
+    if (!ok) return 0;
+
+    sistema->total_turmas = antigo.total_turmas;
+    sistema->total_alunos = antigo.total_alunos;
+    sistema->proximo_id_turma = cab.proximo_id_turma; // 0 fora da versão 3: derivado das turmas
+    return 1;
+}
+
+// --- 4. Leitura (Carga sob Demanda) ---
+
+/**
+ * @brief Verifica se o arquivo está no formato 1 ou no layout legado (ver formato_converter).
+ */
+static int formato_antigo(FILE *f, int assinatura) {
+    return assinatura == ASSINATURA_FORMATO_1 ||
+           (fseek(f, 0, SEEK_END) == 0 && ftell(f) == (long)TAMANHO_ARQUIVO_LEGADO);
+}
+
+/**
+ * @brief Cria a fonte de carga sob demanda de uma tabela e a associa ao pool.
+ * @return int 1 se bem-sucedido (ou a tabela está vazia), 0 se faltou memória ou o arquivo não abriu.
+ */
+static int associar_fonte(PoolRegistros *pool, const char *caminho, const EntradaPagina *paginas,
+                          int num_paginas, int usados) {
+    if (num_paginas == 0) return 1;
+
+    FontePaginas *fonte = malloc(sizeof(FontePaginas));
+    EntradaPagina *copia = malloc((size_t)num_paginas * sizeof(EntradaPagina));
+    FILE *f = (fonte != NULL && copia != NULL) ? fopen(caminho, "rb") : NULL;
+    if (f == NULL) {
+        free(fonte);
+        free(copia);
+        return 0;
+    }
+    memcpy(copia, paginas, (size_t)num_paginas * sizeof(EntradaPagina));
+    fonte->arquivo = f;
+    fonte->paginas = copia;
+    fonte->pendentes = num_paginas;
+
+    if (!pool_associar_fonte(pool, fonte, num_paginas, usados)) {
+        formato_fechar_fonte(fonte);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Abre o arquivo base: lê e confere cabeçalho e diretório, sem ler nenhuma página.
+ * As páginas são lidas depois, no primeiro acesso a um registro de cada uma.
+ * @param sistema Ponteiro para a estrutura DadosSistema (pools vazios).
+ * @param caminho Caminho do arquivo base.
+ * @return int FORMATO_OK ou um dos códigos de erro de formato.h.
+ */
+int formato_abrir(DadosSistema *sistema, const char *caminho) {
+    FILE *f = fopen(caminho, "rb");
+    if (f == NULL) return FORMATO_AUSENTE;
+
+    CabecalhoFormato cab = {0};
+    if (fread(&cab, TAM_CABECALHO_V2, 1, f) != 1 || cab.assinatura != ASSINATURA_FORMATO) {
+        int antigo = formato_antigo(f, cab.assinatura);
+        fclose(f);
+        return antigo ? FORMATO_ANTIGO : FORMATO_CORROMPIDO;
+    }
+    if (cab.versao < VERSAO_FORMATO) {
+        fclose(f);
+        return versao_convertivel(&cab) ? FORMATO_ANTIGO : FORMATO_INCOMPATIVEL;
+    }
+    if (cab.versao > VERSAO_FORMATO || cab.tam_turma != (int)sizeof(Turma) ||
+        cab.tam_aluno != (int)sizeof(Aluno) || cab.registros_por_pagina != REGISTROS_POR_BLOCO) {
+        fclose(f);
+        return FORMATO_INCOMPATIVEL;
+    }
+    if (fread((char *)&cab + TAM_CABECALHO_V2, sizeof(cab) - TAM_CABECALHO_V2, 1, f) != 1 ||
+        cab.tam_celula_texto != TAM_CELULA_TEXTO ||
+        cab.usados_turmas < 0 || cab.usados_alunos < 0 || cab.usados_textos < 0 ||
+        cab.paginas_turmas != paginas_para(cab.usados_turmas) ||
+        cab.paginas_alunos != paginas_para(cab.usados_alunos) ||
+        cab.paginas_textos != paginas_para(cab.usados_textos)) {
+        fclose(f);
+        return FORMATO_CORROMPIDO;
+    }
+
+    int num_paginas = paginas_do_arquivo(&cab);
+    EntradaPagina *paginas = malloc((size_t)(num_paginas > 0 ? num_paginas : 1) * sizeof(EntradaPagina));
+    if (paginas == NULL) {
+        fclose(f);
+        return FORMATO_SEM_MEMORIA;
+    }
+    int ok = fread(paginas, sizeof(EntradaPagina), (size_t)num_paginas, f) == (size_t)num_paginas &&
+             crc_diretorio(&cab, paginas, num_paginas) == cab.crc_diretorio;
+    fclose(f);
+    if (ok) metricas_bytes_lidos(sizeof(cab) + (size_t)num_paginas * sizeof(EntradaPagina));
+
+    for (int p = 0; ok && p < num_paginas; p++) {
+        int alunos = p - cab.paginas_turmas, textos = alunos - cab.paginas_alunos;
+        int esperado = alunos < 0 ? registros_da_pagina(cab.usados_turmas, p)
+                     : textos < 0 ? registros_da_pagina(cab.usados_alunos, alunos)
+                                  : registros_da_pagina(cab.usados_textos, textos);
+        ok = paginas[p].registros == esperado && paginas[p].deslocamento >= 0;
+    }
+    if (!ok) {
+        free(paginas);
+        return FORMATO_CORROMPIDO;
+    }
+
+    ok = associar_fonte(&sistema->turmas, caminho, paginas, cab.paginas_turmas, cab.usados_turmas) &&
+         associar_fonte(&sistema->alunos, caminho, paginas + cab.paginas_turmas, cab.paginas_alunos,
+                        cab.usados_alunos) &&
+         associar_fonte(&sistema->textos, caminho, paginas + cab.paginas_turmas + cab.paginas_alunos,
+                        cab.paginas_textos, cab.usados_textos);
+    free(paginas);
+    if (!ok) return FORMATO_SEM_MEMORIA;
+
+    sistema->total_turmas = cab.total_turmas;
+    sistema->total_alunos = cab.total_alunos;
+    sistema->proximo_id_turma = cab.proximo_id_turma;
+    return FORMATO_OK;
+}
+
+/**
+ * @brief Lê uma página do arquivo base para o bloco e confere o CRC.
+ * @param fonte Fonte da tabela.
+ * @param pagina Índice da página (= índice do bloco no pool).
+ * @param bloco Bloco de destino (zerado; só o início recebe os registros da página).
+ * @param tam_registro Tamanho do registro da tabela.
+ * @return int 1 se a página foi lida e está íntegra, 0 caso contrário (o bloco fica zerado).
+ */
+int formato_ler_pagina(FontePaginas *fonte, int pagina, char *bloco, size_t tam_registro) {
+    const EntradaPagina *entrada = &fonte->paginas[pagina];
+    size_t tamanho = (size_t)entrada->registros * tam_registro;
+
+    if (posicionar(fonte->arquivo, entrada->deslocamento) &&
+        fread(bloco, 1, tamanho, fonte->arquivo) == tamanho &&
+        crc32_calcular(0, bloco, tamanho) == entrada->crc) {
+        metricas_bytes_lidos(tamanho);
+        return 1;
+    }
+    memset(bloco, 0, tamanho);
+    return 0;
+}
+
+/**
+ * @brief Fecha o arquivo da fonte e libera sua memória.
+ * @param fonte Fonte a liberar.
+ */
+void formato_fechar_fonte(FontePaginas *fonte) {
+    fclose(fonte->arquivo);
+    free(fonte->paginas);
+    free(fonte);
+}
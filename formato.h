@@ -0,0 +1,93 @@
+#ifndef FORMATO_H
+#define FORMATO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "servicos.h"
+
+// --- Formato Paginado do Arquivo de Dados ---
+//
+// O arquivo base descreve a si mesmo: o cabeçalho traz assinatura, versão,
+// tamanho de cada tipo de registro e as quantidades de registros, e é seguido
+// de um diretório com uma entrada por página (posição, registros e CRC-32).
+// Uma página guarda um bloco do PoolRegistros (até REGISTROS_POR_BLOCO
+// registros de um mesmo tipo): primeiro as páginas de turmas, depois as de
+// alunos e, por fim, as do heap de textos (células de TAM_CELULA_TEXTO bytes).
+//
+// A carga lê só o cabeçalho e o diretório; cada página é lida (e tem o CRC
+// conferido) na primeira vez que um registro dela é acessado. Arquivos nos
+// formatos antigos, com o nome dentro do registro, são convertidos para a
+// memória por formato_converter, uma página por vez.
+
+#define VERSAO_FORMATO 4 // 4: nomes no heap de textos (2 e 3 são convertidos por formato_converter)
+
+// Resultados de formato_abrir
+#define FORMATO_OK 1
+#define FORMATO_AUSENTE 0         // Arquivo não existe
+#define FORMATO_ANTIGO -1         // Formato anterior: precisa de formato_converter
+#define FORMATO_INCOMPATIVEL -2   // Versão mais nova ou registros de outro tamanho
+#define FORMATO_CORROMPIDO -3     // Cabeçalho ou diretório inválido
+#define FORMATO_SEM_MEMORIA -4
+
+typedef struct {
+    int assinatura;           // ASSINATURA_FORMATO ("SGA2")
+    int versao;               // VERSAO_FORMATO
+    int tam_turma;            // sizeof(Turma) de quem gravou
+    int tam_aluno;            // sizeof(Aluno) de quem gravou
+    int registros_por_pagina; // REGISTROS_POR_BLOCO de quem gravou
+    int usados_turmas;        // Slots de turma gravados
+    int usados_alunos;        // Slots de aluno gravados
+    int total_turmas;         // Turmas ativas
+    int total_alunos;         // Alunos ativos
+    int paginas_turmas;       // Entradas de turmas no diretório
+    int paginas_alunos;       // Entradas de alunos no diretório
+    uint32_t crc_diretorio;   // CRC-32 do cabeçalho (com este campo zerado) e do diretório
+    int proximo_id_turma;     // Próximo ID de turma a atribuir (versão 3+; 0 = derivar das turmas)
+    int tam_celula_texto;     // TAM_CELULA_TEXTO de quem gravou (versão 4+)
+    int usados_textos;        // Células do heap de textos gravadas
+    int paginas_textos;       // Entradas do heap de textos no diretório
+} CabecalhoFormato;
+
+typedef struct {
+    long long deslocamento;   // Posição da página no arquivo
+    int registros;            // Registros gravados na página
+    uint32_t crc;             // CRC-32 dos bytes da página
+} EntradaPagina;
+
+// Páginas de uma tabela que ainda estão só no arquivo (carga sob demanda).
+typedef struct FontePaginas {
+    FILE *arquivo;            // Arquivo base aberto para leitura
+    EntradaPagina *paginas;   // Uma entrada por bloco do pool
+    int pendentes;            // Páginas ainda não lidas (em 0 o arquivo é fechado)
+} FontePaginas;
+
+// Registros com o nome dentro (arquivo base até a versão 3, diário versão 1 e
+// arquivos mapeados versão 1). São convertidos com o nome interno ao heap.
+#define TAM_NOME_ANTIGO 50
+
+typedef struct {
+    int id;
+    char nome[TAM_NOME_ANTIGO];
+    int vagas_maximas;
+    int vagas_ocupadas;
+    int ativo;
+} TurmaAntiga;
+
+typedef struct {
+    char ra[TAM_RA];
+    char nome[TAM_NOME_ANTIGO];
+    int id_turma;
+    float notas[3];
+    float media_final;
+    int ativo;
+} AlunoAntigo;
+
+int formato_abrir(DadosSistema *sistema, const char *caminho);
+int formato_gravar(const DadosSistema *sistema, const char *caminho);
+int formato_converter(DadosSistema *sistema, const char *caminho);
+int formato_converter_turma(DadosSistema *sistema, const TurmaAntiga *antiga, Turma *nova);
+int formato_converter_aluno(DadosSistema *sistema, const AlunoAntigo *antigo, Aluno *novo);
+int formato_ler_pagina(FontePaginas *fonte, int pagina, char *bloco, size_t tam_registro);
+void formato_fechar_fonte(FontePaginas *fonte);
+
+#endif // FORMATO_H
@@ -0,0 +1,690 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "servicos.h"
+#include "fragmentos.h"
+#include "arquivos.h"
+#include "metricas.h"
+
+#define ASSINATURA_CATALOGO 0x43414753  // "SGAC"
+#define ASSINATURA_SEGMENTO 0x53414753  // "SGAS"
+#define ASSINATURA_TRANSACAO 0x54414753 // "SGAT"
+#define VERSAO_FRAGMENTOS 1
+
+#define TAM_CAMINHO 64
+#define CATALOGO -1                // No lugar do ID da turma: o arquivo é o catálogo
+#define TRANSACAO_SUBSTITUIR 1     // O temporário substitui o arquivo
+#define TRANSACAO_REMOVER 2        // O arquivo é apagado (turma excluída ou sem alunos)
+
+// --- 1. Formato dos Arquivos ---
+//
+// Catálogo:  [CabecalhoCatalogo] + N x ([EntradaCatalogo] + nome)
+// Segmento:  [CabecalhoSegmento] + N x ([RegistroSegmento] + nome)
+// Transação: [CabecalhoTransacao] + N x [EntradaTransacao]
+// Os nomes vão sem o '\0'. O CRC do cabeçalho cobre tudo o que vem depois dele.
+
+typedef struct {
+    int assinatura;       // ASSINATURA_CATALOGO
+    int versao;           // VERSAO_FRAGMENTOS
+    int turmas;           // Entradas (turmas ativas)
+    int total_alunos;     // Alunos ativos (soma das vagas ocupadas)
+    int proximo_id_turma; // Próximo ID de turma (maior que o de toda turma já criada)
+    uint32_t crc;
+} CabecalhoCatalogo;
+
+typedef struct {
+    int id;
+    int vagas_maximas;
+    int vagas_ocupadas;   // Alunos no segmento da turma
+    uint32_t crc_segmento; // CRC do segmento gravado junto com este catálogo
+    int tam_nome;
+} EntradaCatalogo;
+
+typedef struct {
+    int assinatura;       // ASSINATURA_SEGMENTO
+    int versao;
+    int id_turma;
+    int alunos;
+    uint32_t crc;
+} CabecalhoSegmento;
+
+typedef struct {
+    char ra[TAM_RA];
+    float notas[3];
+    float media_final;
+    int tam_nome;
+} RegistroSegmento;
+
+typedef struct {
+    int assinatura;       // ASSINATURA_TRANSACAO
+    int versao;
+    int quantidade;
+    uint32_t crc;
+} CabecalhoTransacao;
+
+typedef struct {
+    int operacao;         // TRANSACAO_SUBSTITUIR ou TRANSACAO_REMOVER
+    int id_turma;         // Segmento da turma, ou CATALOGO
+} EntradaTransacao;
+
+// --- 2. Auxiliares ---
+
+/**
+ * @brief Caminho do catálogo (id_turma = CATALOGO) ou do segmento de uma turma.
+ * @param temporario 1 para o temporário gravado antes da transação.
+ */
+static void caminho_arquivo(char *destino, size_t tamanho, int id_turma, int temporario) {
+    if (id_turma == CATALOGO) {
+        snprintf(destino, tamanho, "%s%s", NOME_CATALOGO, temporario ? ".tmp" : "");
+    } else {
+        snprintf(destino, tamanho, "%s%d.seg%s", PREFIXO_SEGMENTO, id_turma, temporario ? ".tmp" : "");
+    }
+}
+
+static int arquivo_existe(const char *caminho) {
+    FILE *f = fopen(caminho, "rb");
+    if (f == NULL) return 0;
+    fclose(f);
+    return 1;
+}
+
+/**
+ * @brief Garante posições em 'inicio' e 'crc' para os slots de turma [0, turmas).
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int garantir_turmas(Fragmentos *fragmentos, int turmas) {
+    if (turmas <= fragmentos->capacidade) return 1;
+    int nova = fragmentos->capacidade > 0 ? fragmentos->capacidade : 16;
+    while (nova < turmas) nova *= 2;
+
+    int *inicio = realloc(fragmentos->inicio, (size_t)nova * sizeof(int));
+    if (inicio == NULL) return 0;
+    fragmentos->inicio = inicio;
+    uint32_t *crc = realloc(fragmentos->crc, (size_t)nova * sizeof(uint32_t));
+    if (crc == NULL) return 0;
+    fragmentos->crc = crc;
+
+    for (int i = fragmentos->capacidade; i < nova; i++) {
+        fragmentos->inicio[i] = -1;
+        fragmentos->crc[i] = 0;
+    }
+    fragmentos->capacidade = nova;
+    return 1;
+}
+
+/**
+ * @brief Lê um nome gravado sem o '\0' e o acumula no CRC.
+ * @return int 1 se bem-sucedido, 0 se o tamanho é inválido ou o arquivo acabou.
+ */
+static int ler_nome(FILE *f, int tam_nome, char *nome, uint32_t *crc) {
+    if (tam_nome < 0 || tam_nome >= TAM_NOME || fread(nome, 1, (size_t)tam_nome, f) != (size_t)tam_nome) return 0;
+    nome[tam_nome] = '\0';
+    *crc = crc32_calcular(*crc, nome, (size_t)tam_nome);
+    return 1;
+}
+
+static int comparar_ids(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Inicializa o estado do modo fragmentado (desligado).
+ * @param fragmentos Ponteiro para o estado.
+ */
+void fragmentos_inicializar(Fragmentos *fragmentos) {
+    memset(fragmentos, 0, sizeof(*fragmentos));
+}
+
+/**
+ * @brief Libera a memória do estado e o deixa desligado.
+ * @param fragmentos Ponteiro para o estado.
+ */
+void fragmentos_liberar(Fragmentos *fragmentos) {
+    free(fragmentos->inicio);
+    free(fragmentos->crc);
+    free(fragmentos->alterados);
+    fragmentos_inicializar(fragmentos);
+}
+
+/**
+ * @brief Informa se os dados estão no modo fragmentado (catálogo ou transação no disco).
+ * @return int 1 se o catálogo (ou uma transação ainda não aplicada) existe, 0 caso contrário.
+ */
+int fragmentos_existe(void) {
+    return arquivo_existe(NOME_CATALOGO) || arquivo_existe(NOME_TRANSACAO);
+}
+
+// --- 3. Transação (Troca dos Arquivos) ---
+
+/**
+ * @brief Aplica as entradas de uma transação confirmada. Pode ser repetida:
+ * um temporário que não existe mais já foi renomeado.
+ * @return int 1 se todas foram aplicadas, 0 caso contrário.
+ */
+static int aplicar_transacao(const EntradaTransacao *entradas, int quantidade) {
+    int ok = 1;
+    for (int k = 0; k < quantidade; k++) {
+        char destino[TAM_CAMINHO], temporario[TAM_CAMINHO];
+        caminho_arquivo(destino, sizeof(destino), entradas[k].id_turma, 0);
+        if (entradas[k].operacao == TRANSACAO_SUBSTITUIR) {
+            caminho_arquivo(temporario, sizeof(temporario), entradas[k].id_turma, 1);
+            if (arquivo_existe(temporario) && !arquivo_substituir(temporario, destino)) ok = 0;
+        } else if (remove(destino) != 0 && arquivo_existe(destino)) {
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Grava e sincroniza o arquivo de transação: a partir daqui a gravação vale.
+ * @return int 1 se bem-sucedido, 0 caso contrário (o arquivo é apagado).
+ */
+static int gravar_transacao(const EntradaTransacao *entradas, int quantidade) {
+    FILE *f = fopen(NOME_TRANSACAO, "wb");
+    if (f == NULL) return 0;
+    size_t tamanho = (size_t)quantidade * sizeof(EntradaTransacao);
+    CabecalhoTransacao cab = { ASSINATURA_TRANSACAO, VERSAO_FRAGMENTOS, quantidade,
+                               crc32_calcular(0, entradas, tamanho) };
+    int ok = fwrite(&cab, sizeof(cab), 1, f) == 1 && fwrite(entradas, 1, tamanho, f) == tamanho &&
+             arquivo_sincronizar(f);
+    ok = (fclose(f) == 0) && ok;
+    if (ok) {
+        metricas_bytes_gravados(sizeof(cab) + tamanho);
+    } else {
+        remove(NOME_TRANSACAO);
+    }
+    return ok;
+}
+
+/**
+ * @brief Termina uma transação interrompida por uma queda: refaz as trocas de
+ * uma transação confirmada e descarta uma incompleta (os arquivos antigos valem).
+ * @return int 1 se não há transação pendente ao final, 0 caso contrário.
+ */
+static int recuperar_transacao(void) {
+    FILE *f = fopen(NOME_TRANSACAO, "rb");
+    if (f == NULL) return 1;
+
+    CabecalhoTransacao cab;
+    EntradaTransacao *entradas = NULL;
+    int valida = fread(&cab, sizeof(cab), 1, f) == 1 && cab.assinatura == ASSINATURA_TRANSACAO &&
+                 cab.versao == VERSAO_FRAGMENTOS && cab.quantidade > 0 && cab.quantidade <= (1 << 24);
+    if (valida) {
+        entradas = malloc((size_t)cab.quantidade * sizeof(EntradaTransacao));
+        if (entradas == NULL) {
+            fclose(f);
+            printf("ERRO: Memoria insuficiente para concluir a transacao '%s'.\n", NOME_TRANSACAO);
+            return 0;
+        }
+        valida = fread(entradas, sizeof(EntradaTransacao), (size_t)cab.quantidade, f) == (size_t)cab.quantidade &&
+                 crc32_calcular(0, entradas, (size_t)cab.quantidade * sizeof(EntradaTransacao)) == cab.crc;
+    }
+    fclose(f);
+
+    int ok = !valida || aplicar_transacao(entradas, cab.quantidade);
+    free(entradas);
+    if (!ok) {
+        printf("ERRO: Nao foi possivel concluir a transacao '%s'.\n", NOME_TRANSACAO);
+        return 0;
+    }
+    remove(NOME_TRANSACAO);
+    if (valida) printf("AVISO: Gravacao interrompida dos segmentos concluida pela transacao '%s'.\n", NOME_TRANSACAO);
+    return 1;
+}
+
+// --- 4. Leitura ---
+
+/**
+ * @brief Lê o catálogo para a tabela de turmas (vazia). Os alunos ficam nos
+ * segmentos até o primeiro uso. Uma transação pendente é concluída antes.
+ * @param sistema Ponteiro para a estrutura DadosSistema (pools vazios).
+ * @return int 1 se o catálogo foi lido, 0 se não existe ou é inválido.
+ */
+int fragmentos_abrir(DadosSistema *sistema) {
+    Fragmentos *fragmentos = &sistema->fragmentos;
+    if (!recuperar_transacao()) return 0;
+    FILE *f = fopen(NOME_CATALOGO, "rb");
+    if (f == NULL) return 0;
+
+    CabecalhoCatalogo cab;
+    int ok = fread(&cab, sizeof(cab), 1, f) == 1 && cab.assinatura == ASSINATURA_CATALOGO &&
+             cab.versao == VERSAO_FRAGMENTOS && cab.turmas >= 0 && cab.total_alunos >= 0 &&
+             garantir_turmas(fragmentos, cab.turmas) && pool_reservar(&sistema->turmas, cab.turmas);
+
+    uint32_t crc = 0;
+    long alunos = 0;
+    char nome[TAM_NOME];
+    for (int k = 0; ok && k < cab.turmas; k++) {
+        EntradaCatalogo entrada;
+        ok = fread(&entrada, sizeof(entrada), 1, f) == 1;
+        if (!ok) break;
+        crc = crc32_calcular(crc, &entrada, sizeof(entrada));
+        ok = ler_nome(f, entrada.tam_nome, nome, &crc) && entrada.id > 0 &&
+             entrada.vagas_ocupadas >= 0 && entrada.vagas_ocupadas <= entrada.vagas_maximas;
+        int ref = ok ? guardar_texto(sistema, nome) : -1;
+        int i = ref != -1 ? pool_novo_slot(&sistema->turmas) : -1;
+        ok = i != -1;
+        if (!ok) break;
+
+        Turma *turma = turma_em(sistema, i);
+        turma->id = entrada.id;
+        turma->nome = ref;
+        turma->vagas_maximas = entrada.vagas_maximas;
+        turma->vagas_ocupadas = entrada.vagas_ocupadas;
+        turma->ativo = 1;
+        fragmentos->crc[i] = entrada.crc_segmento;
+        alunos += entrada.vagas_ocupadas;
+    }
+    ok = ok && crc == cab.crc && alunos == cab.total_alunos;
+    if (ok) metricas_bytes_lidos((unsigned long long)ftell(f));
+    fclose(f);
+    if (!ok) return 0;
+
+    sistema->total_turmas = cab.turmas;
+    sistema->total_alunos = cab.total_alunos;
+    sistema->proximo_id_turma = cab.proximo_id_turma;
+    fragmentos->ativo = 1;
+    fragmentos->parcial = cab.total_alunos > 0;
+    return 1;
+}
+
+/**
+ * @brief Lê o segmento de uma turma para slots novos, seguidos, no fim da
+ * tabela de alunos (só enquanto há segmentos não lidos; depois não faz nada).
+ * Um segmento ausente, corrompido ou de outra gravação é informado; os alunos
+ * dele ficam inativos e nenhum arquivo é regravado até a próxima carga.
+ * Os índices ainda não foram montados (eles leem todos os segmentos antes),
+ * por isso a leitura pode ser feita a partir de uma consulta const.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param idx_turma Slot da turma (ativa).
+ * @return int 1 se o segmento está em memória, 0 caso contrário.
+ */
+int fragmentos_carregar_turma(const DadosSistema *sistema, int idx_turma) {
+    DadosSistema *cache = (DadosSistema *)sistema;
+    Fragmentos *fragmentos = &cache->fragmentos;
+    if (!fragmentos->parcial) return 1;
+    if (!garantir_turmas(fragmentos, sistema->turmas.usados)) {
+        fragmentos->invalidos++;
+        printf("ERRO: Memoria insuficiente para ler os segmentos das turmas.\n");
+        return 0;
+    }
+    if (fragmentos->inicio[idx_turma] != -1) return 1;
+    METRICA_MEDIR(METRICA_CARREGAR_FRAGMENTO);
+
+    const Turma *turma = turma_em(sistema, idx_turma);
+    int base = sistema->alunos.usados;
+    fragmentos->inicio[idx_turma] = base;
+    char caminho[TAM_CAMINHO];
+    caminho_arquivo(caminho, sizeof(caminho), turma->id, 0);
+    FILE *f = fopen(caminho, "rb");
+    if (f == NULL && turma->vagas_ocupadas == 0) return 1; // Turma sem alunos não tem segmento
+
+    CabecalhoSegmento cab;
+    int ok = f != NULL && fread(&cab, sizeof(cab), 1, f) == 1 && cab.assinatura == ASSINATURA_SEGMENTO &&
+             cab.versao == VERSAO_FRAGMENTOS && cab.id_turma == turma->id &&
+             cab.alunos == turma->vagas_ocupadas && cab.crc == fragmentos->crc[idx_turma] &&
+             pool_estender(&cache->alunos, base + cab.alunos);
+
+    uint32_t crc = 0;
+    char nome[TAM_NOME];
+    for (int k = 0; ok && k < cab.alunos; k++) {
+        RegistroSegmento registro;
+        ok = fread(&registro, sizeof(registro), 1, f) == 1;
+        if (ok) {
+            crc = crc32_calcular(crc, &registro, sizeof(registro));
+            ok = ler_nome(f, registro.tam_nome, nome, &crc);
+        }
+        int ref = ok ? guardar_texto(cache, nome) : -1;
+        ok = ref != -1;
+        if (!ok) break;
+
+        Aluno *aluno = aluno_em(sistema, base + k);
+        memcpy(aluno->ra, registro.ra, TAM_RA);
+        aluno->nome = ref;
+        aluno->id_turma = turma->id;
+        memcpy(aluno->notas, registro.notas, sizeof(aluno->notas));
+        aluno->media_final = registro.media_final;
+        aluno->ativo = 1;
+    }
+    ok = ok && crc == cab.crc;
+    if (ok) metricas_bytes_lidos((unsigned long long)ftell(f));
+    if (f != NULL) fclose(f);
+
+    if (!ok) {
+        for (int i = base; i < sistema->alunos.usados; i++) aluno_em(sistema, i)->ativo = 0;
+        fragmentos->invalidos++;
+        printf("ERRO: Segmento '%s' da turma %d ausente ou corrompido (os arquivos nao serao regravados).\n",
+               caminho, turma->id);
+    }
+    return ok;
+}
+
+/**
+ * @brief Lê os segmentos que ainda faltam. Chamada por tudo o que depende de
+ * todos os alunos (índices, colunas) antes de começar; depois não faz nada.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return int 1 se todos os segmentos estão em memória, 0 se algum não pôde ser lido.
+ */
+int fragmentos_carregar_todos(const DadosSistema *sistema) {
+    Fragmentos *fragmentos = &((DadosSistema *)sistema)->fragmentos;
+    if (!fragmentos->parcial) return 1;
+
+    int ok = 1;
+    for (int i = 0; i < sistema->turmas.usados; i++) {
+        if (turma_em(sistema, i)->ativo == 1 && !fragmentos_carregar_turma(sistema, i)) ok = 0;
+    }
+    fragmentos->parcial = 0;
+    return ok;
+}
+
+/**
+ * @brief Marca o segmento de uma turma para a próxima gravação (o de onde um
+ * aluno alterado sai; o de onde ele fica é achado pelos slots do diário).
+ * @param fragmentos Ponteiro para o estado.
+ * @param id_turma ID da turma.
+ */
+void fragmentos_marcar(Fragmentos *fragmentos, int id_turma) {
+    int n = fragmentos->quantidade;
+    if (n > 0 && fragmentos->alterados[n - 1] == id_turma) return;
+
+    if (n == fragmentos->cap_alterados) {
+        int nova = fragmentos->cap_alterados > 0 ? fragmentos->cap_alterados * 2 : 16;
+        int *novo = realloc(fragmentos->alterados, (size_t)nova * sizeof(int));
+        if (novo == NULL) {
+            fragmentos->incompleto = 1; // Sem memória: a próxima gravação regrava todos os segmentos
+            return;
+        }
+        fragmentos->alterados = novo;
+        fragmentos->cap_alterados = nova;
+    }
+    fragmentos->alterados[fragmentos->quantidade++] = id_turma;
+}
+
+// --- 5. Gravação ---
+
+// Segmento regravado (ou apagado) por fragmentos_gravar
+typedef struct {
+    int idx_turma;        // Slot da turma (-1 = turma excluída)
+    uint32_t crc;         // CRC do segmento novo (0 = segmento apagado)
+    uint32_t crc_antigo;  // Volta para o estado se a gravação não for confirmada
+} SegmentoNovo;
+
+// Alunos de um segmento a regravar: a lista de membros ou, com segmentos
+// ainda não lidos, os slots achados por agrupar_alunos (a lista exigiria todos)
+typedef struct {
+    const int *slots;     // NULL = lista de membros
+    int quantidade;
+} AlunosSegmento;
+
+/**
+ * @brief Grava (com fsync) o segmento de uma turma.
+ * @param alunos Os alunos ativos da turma.
+ * @param crc Recebe o CRC do segmento.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+static int escrever_segmento(const DadosSistema *sistema, int idx_turma, const AlunosSegmento *alunos,
+                             const char *caminho, uint32_t *crc) {
+    const Turma *turma = turma_em(sistema, idx_turma);
+    FILE *f = fopen(caminho, "wb");
+    if (f == NULL) return 0;
+
+    CabecalhoSegmento cab = { ASSINATURA_SEGMENTO, VERSAO_FRAGMENTOS, turma->id, 0, 0 };
+    int ok = fwrite(&cab, sizeof(cab), 1, f) == 1;
+    int i = alunos->slots == NULL ? indice_turmas_primeiro(&sistema->membros, idx_turma)
+                                  : alunos->quantidade > 0 ? alunos->slots[0] : -1;
+    for (int k = 1; ok && i != -1; k++) {
+        const Aluno *aluno = aluno_em(sistema, i);
+        const char *nome = texto_em(sistema, aluno->nome);
+        RegistroSegmento registro;
+        memset(&registro, 0, sizeof(registro)); // O preenchimento entre os campos também entra no CRC
+        memcpy(registro.ra, aluno->ra, TAM_RA);
+        memcpy(registro.notas, aluno->notas, sizeof(registro.notas));
+        registro.media_final = aluno->media_final;
+        registro.tam_nome = (int)strlen(nome);
+
+        cab.crc = crc32_calcular(cab.crc, &registro, sizeof(registro));
+        cab.crc = crc32_calcular(cab.crc, nome, (size_t)registro.tam_nome);
+        ok = fwrite(&registro, sizeof(registro), 1, f) == 1 &&
+             fwrite(nome, 1, (size_t)registro.tam_nome, f) == (size_t)registro.tam_nome;
+        cab.alunos++;
+        i = alunos->slots == NULL ? indice_turmas_proximo(&sistema->membros, i)
+                                  : k < alunos->quantidade ? alunos->slots[k] : -1;
+    }
+    long bytes = ftell(f); // Só para as métricas (sem uso com SEM_METRICAS)
+    (void)bytes;
+    ok = ok && cab.alunos == turma->vagas_ocupadas && fseek(f, 0, SEEK_SET) == 0 &&
+         fwrite(&cab, sizeof(cab), 1, f) == 1 && arquivo_sincronizar(f);
+    ok = (fclose(f) == 0) && ok;
+    if (ok) {
+        metricas_bytes_gravados((unsigned long long)bytes);
+        *crc = cab.crc;
+    }
+    return ok;
+}
+
+/**
+ * @brief Grava (com fsync) o catálogo: as turmas ativas e o CRC do segmento de cada uma.
+ * O próximo ID considera também as turmas excluídas, que não vão para o catálogo.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+static int escrever_catalogo(const DadosSistema *sistema, const char *caminho) {
+    const Fragmentos *fragmentos = &sistema->fragmentos;
+    FILE *f = fopen(caminho, "wb");
+    if (f == NULL) return 0;
+
+    CabecalhoCatalogo cab = { ASSINATURA_CATALOGO, VERSAO_FRAGMENTOS, 0, sistema->total_alunos,
+                              sistema->proximo_id_turma, 0 };
+    int ok = fwrite(&cab, sizeof(cab), 1, f) == 1;
+    for (int i = 0; ok && i < sistema->turmas.usados; i++) {
+        const Turma *turma = turma_em(sistema, i);
+        if (turma->id >= cab.proximo_id_turma) cab.proximo_id_turma = turma->id + 1;
+        if (turma->ativo != 1) continue;
+
+        const char *nome = texto_em(sistema, turma->nome);
+        EntradaCatalogo entrada = { turma->id, turma->vagas_maximas, turma->vagas_ocupadas,
+                                    turma->vagas_ocupadas > 0 ? fragmentos->crc[i] : 0, (int)strlen(nome) };
+        cab.crc = crc32_calcular(cab.crc, &entrada, sizeof(entrada));
+        cab.crc = crc32_calcular(cab.crc, nome, (size_t)entrada.tam_nome);
+        ok = fwrite(&entrada, sizeof(entrada), 1, f) == 1 &&
+             fwrite(nome, 1, (size_t)entrada.tam_nome, f) == (size_t)entrada.tam_nome;
+        cab.turmas++;
+    }
+    long bytes = ftell(f);
+    (void)bytes;
+    ok = ok && fseek(f, 0, SEEK_SET) == 0 && fwrite(&cab, sizeof(cab), 1, f) == 1 && arquivo_sincronizar(f);
+    ok = (fclose(f) == 0) && ok;
+    if (ok) metricas_bytes_gravados((unsigned long long)bytes);
+    return ok;
+}
+
+/**
+ * @brief IDs (ordenados, sem repetição) das turmas cujos segmentos serão regravados.
+ * Completo: todas as turmas ativas. Senão: as turmas de onde saíram e onde
+ * estão os alunos alterados. Turmas excluídas entram para terem o segmento apagado.
+ * @param quantidade Recebe a quantidade de IDs.
+ * @return int* Os IDs (liberar com free), ou NULL se faltou memória.
+ */
+static int *turmas_alteradas(const DadosSistema *sistema, int completo, int *quantidade) {
+    const Fragmentos *fragmentos = &sistema->fragmentos;
+    const ListaSlots *alunos = &sistema->diario.alunos;
+    int maximo = fragmentos->quantidade + (completo ? sistema->turmas.usados : alunos->quantidade);
+    int *ids = malloc((size_t)(maximo > 0 ? maximo : 1) * sizeof(int));
+    if (ids == NULL) return NULL;
+
+    int n = 0;
+    for (int k = 0; k < fragmentos->quantidade; k++) ids[n++] = fragmentos->alterados[k];
+    if (completo) {
+        for (int i = 0; i < sistema->turmas.usados; i++) {
+            const Turma *turma = turma_em(sistema, i);
+            if (turma->ativo == 1) ids[n++] = turma->id;
+        }
+    } else {
+        for (int k = 0; k < alunos->quantidade; k++) {
+            const Aluno *aluno = aluno_em(sistema, alunos->slots[k]);
+            if (aluno->ativo == 1) ids[n++] = aluno->id_turma;
+        }
+    }
+
+    qsort(ids, (size_t)n, sizeof(int), comparar_ids);
+    int unicos = 0;
+    for (int k = 0; k < n; k++) {
+        if (unicos == 0 || ids[unicos - 1] != ids[k]) ids[unicos++] = ids[k];
+    }
+    *quantidade = unicos;
+    return ids;
+}
+
+/**
+ * @brief Agrupa por turma, numa passada pelos slots lidos, os alunos ativos das
+ * turmas de 'ids' (com segmentos ainda não lidos não há lista de membros, e
+ * montá-la leria todos). Os alunos da turma ids[k] ficam em
+ * slots[inicio[k]] .. slots[inicio[k + 1] - 1].
+ * @param ids IDs ordenados das turmas.
+ * @param inicio Recebe quantidade + 1 posições (liberar com free).
+ * @return int* Os slots (liberar com free), ou NULL se faltou memória.
+ */
+static int *agrupar_alunos(const DadosSistema *sistema, const int *ids, int quantidade, int **inicio) {
+    int *contagem = calloc((size_t)quantidade + 1, sizeof(int));
+    if (contagem == NULL) return NULL;
+    for (int i = 0; i < sistema->alunos.usados; i++) {
+        const Aluno *aluno = aluno_em(sistema, i);
+        const int *k = aluno->ativo == 1 ? bsearch(&aluno->id_turma, ids, (size_t)quantidade, sizeof(int), comparar_ids)
+                                         : NULL;
+        if (k != NULL) contagem[k - ids + 1]++;
+    }
+    for (int k = 0; k < quantidade; k++) contagem[k + 1] += contagem[k];
+
+    int *slots = malloc((size_t)(contagem[quantidade] > 0 ? contagem[quantidade] : 1) * sizeof(int));
+    int *proximo = malloc((size_t)(quantidade > 0 ? quantidade : 1) * sizeof(int));
+    if (slots == NULL || proximo == NULL) {
+        free(contagem);
+        free(slots);
+        free(proximo);
+        return NULL;
+    }
+    memcpy(proximo, contagem, (size_t)quantidade * sizeof(int));
+    for (int i = 0; i < sistema->alunos.usados; i++) {
+        const Aluno *aluno = aluno_em(sistema, i);
+        const int *k = aluno->ativo == 1 ? bsearch(&aluno->id_turma, ids, (size_t)quantidade, sizeof(int), comparar_ids)
+                                         : NULL;
+        if (k != NULL) slots[proximo[k - ids]++] = i;
+    }
+    free(proximo);
+    *inicio = contagem;
+    return slots;
+}
+
+/**
+ * @brief Grava as alterações no modo fragmentado: os segmentos das turmas
+ * afetadas e o catálogo, numa transação (ver fragmentos.h). Usa as marcas do
+ * diário (slots alterados) e as turmas marcadas por fragmentos_marcar; quem
+ * chama descarta as marcas do diário depois de uma gravação bem-sucedida.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param completo 1 = regrava todos os segmentos (ativação, checkpoint, compactação).
+ * @return int 1 se bem-sucedido (ou nada mudou), 0 caso contrário (nada no disco muda).
+ */
+int fragmentos_gravar(DadosSistema *sistema, int completo) {
+    Fragmentos *fragmentos = &sistema->fragmentos;
+    const Diario *diario = &sistema->diario;
+    if (fragmentos->invalidos > 0) {
+        printf("ERRO: Ha segmentos de turma corrompidos; os arquivos nao serao sobrescritos.\n");
+        return 0;
+    }
+    completo = completo || fragmentos->incompleto || diario->incompleto;
+    if (!completo && fragmentos->quantidade == 0 && diario->alunos.quantidade == 0 &&
+        diario->turmas.quantidade == 0) {
+        return 1; // Nenhuma turma nem aluno mudou (células novas do heap vão com os registros)
+    }
+
+    // Uma transação que ficou pela metade é concluída antes de outra começar
+    if (!recuperar_transacao()) return 0;
+
+    int quantidade = 0;
+    int *ids = turmas_alteradas(sistema, completo, &quantidade);
+    SegmentoNovo *novos = NULL;
+    EntradaTransacao *entradas = NULL;
+    int *slots = NULL, *inicio = NULL;
+    int ok = ids != NULL && garantir_turmas(fragmentos, sistema->turmas.usados);
+    if (ok) {
+        novos = malloc((size_t)(quantidade > 0 ? quantidade : 1) * sizeof(SegmentoNovo));
+        entradas = malloc((size_t)(quantidade + 1) * sizeof(EntradaTransacao));
+        ok = novos != NULL && entradas != NULL;
+    }
+
+    // Um segmento é regravado inteiro: só os das turmas afetadas precisam estar em memória
+    for (int k = 0; ok && k < quantidade; k++) {
+        novos[k].idx_turma = buscar_turma_por_id(sistema, ids[k]); // -1: turma excluída
+        if (novos[k].idx_turma != -1 && turma_em(sistema, novos[k].idx_turma)->vagas_ocupadas > 0) {
+            ok = fragmentos_carregar_turma(sistema, novos[k].idx_turma);
+        }
+    }
+    if (ok && quantidade > 0) {
+        if (fragmentos->parcial) {
+            ok = (slots = agrupar_alunos(sistema, ids, quantidade, &inicio)) != NULL;
+        } else {
+            ok = sistema->membros.pronto || indice_turmas_reconstruir(sistema, &sistema->membros);
+        }
+    }
+
+    int gravados = 0;
+    for (; ok && gravados < quantidade; gravados++) {
+        SegmentoNovo *novo = &novos[gravados];
+        novo->crc = 0;
+        entradas[gravados].id_turma = ids[gravados];
+        entradas[gravados].operacao = TRANSACAO_REMOVER;
+        if (novo->idx_turma != -1 && turma_em(sistema, novo->idx_turma)->vagas_ocupadas > 0) {
+            char temporario[TAM_CAMINHO];
+            caminho_arquivo(temporario, sizeof(temporario), ids[gravados], 1);
+            AlunosSegmento alunos = { NULL, 0 };
+            if (slots != NULL) {
+                alunos.slots = slots + inicio[gravados];
+                alunos.quantidade = inicio[gravados + 1] - inicio[gravados];
+            }
+            entradas[gravados].operacao = TRANSACAO_SUBSTITUIR;
+            ok = escrever_segmento(sistema, novo->idx_turma, &alunos, temporario, &novo->crc);
+            if (!ok) break;
+        }
+        if (novo->idx_turma != -1) {
+            novo->crc_antigo = fragmentos->crc[novo->idx_turma];
+            fragmentos->crc[novo->idx_turma] = novo->crc;
+        }
+    }
+
+    char temporario[TAM_CAMINHO];
+    caminho_arquivo(temporario, sizeof(temporario), CATALOGO, 1);
+    if (ok) {
+        entradas[quantidade].id_turma = CATALOGO;
+        entradas[quantidade].operacao = TRANSACAO_SUBSTITUIR;
+        ok = escrever_catalogo(sistema, temporario) && gravar_transacao(entradas, quantidade + 1);
+    }
+
+    if (!ok) {
+        // Nada foi confirmado: os arquivos antigos continuam valendo
+        for (int k = 0; novos != NULL && k <= gravados && k < quantidade; k++) {
+            if (k < gravados && novos[k].idx_turma != -1) fragmentos->crc[novos[k].idx_turma] = novos[k].crc_antigo;
+            char caminho[TAM_CAMINHO];
+            caminho_arquivo(caminho, sizeof(caminho), ids[k], 1);
+            remove(caminho);
+        }
+        remove(temporario);
+        printf("ERRO: Falha ao gravar os segmentos das turmas.\n");
+    } else {
+        // Confirmada: se a troca falhar aqui, a próxima carga (ou gravação) a refaz
+        if (aplicar_transacao(entradas, quantidade + 1)) {
+            remove(NOME_TRANSACAO);
+        } else {
+            printf("AVISO: Arquivos confirmados em '%s'; a troca sera concluida na proxima gravacao.\n",
+                   NOME_TRANSACAO);
+        }
+        fragmentos->quantidade = 0;
+        fragmentos->incompleto = 0;
+    }
+    free(ids);
+    free(novos);
+    free(entradas);
+    free(slots);
+    free(inicio);
+    return ok;
+}
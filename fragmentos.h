@@ -0,0 +1,67 @@
+#ifndef FRAGMENTOS_H
+#define FRAGMENTOS_H
+
+#include <stdint.h>
+
+// --- Armazenamento Fragmentado por Turma ---
+//
+// No modo fragmentado os dados não ficam num arquivo único: um catálogo
+// pequeno guarda a tabela de turmas e cada turma tem o seu segmento, com os
+// alunos dela. Os nomes vão dentro dos registros gravados e voltam para o
+// heap de textos na leitura, então cada segmento se lê sozinho.
+//
+//   NOME_CATALOGO                 turmas ativas (ID, vagas, nome) e, de cada
+//                                 uma, o CRC-32 do segmento que vale com ele;
+//   PREFIXO_SEGMENTO "<id>.seg"   alunos ativos da turma (RA, notas, nome).
+//
+// A carga lê só o catálogo. O segmento de uma turma é lido quando uma
+// consulta da turma precisa dele (relatório e estatísticas da turma); o
+// primeiro uso que precisa de todos os alunos (qualquer índice sobre eles,
+// as colunas, uma alteração por RA) lê de uma vez os segmentos que faltam.
+// O servidor monta todos os índices antes de atender (preparar_indices),
+// então nele todos os segmentos são lidos na partida. Uma gravação lê só os
+// segmentos das turmas que ela regrava, e uma transação não lê nenhum: os
+// lidos durante ela voltam a ser lidos do disco se ela for desfeita.
+//
+// salvar_dados regrava só o catálogo e os segmentos das turmas cujos alunos
+// mudaram: a turma onde o aluno está e, numa transferência ou exclusão, a
+// turma de onde ele saiu. Os arquivos novos são gravados como temporários e
+// depois listados no arquivo de transação (NOME_TRANSACAO, com CRC): é ele
+// que confirma a gravação. Só então os temporários substituem os arquivos
+// (renomeação) e a transação é apagada. Uma queda antes da transação deixa
+// os arquivos antigos valendo; depois dela, a carga refaz as renomeações.
+// Assim uma transferência ou a exclusão de uma turma em cascata muda todos
+// os segmentos envolvidos juntos, ou nenhum.
+//
+// O diário (diario.h) não é usado neste modo: cada salvar_dados já deixa os
+// arquivos completos.
+
+#define NOME_CATALOGO "dados_catalogo.dat"
+#define PREFIXO_SEGMENTO "dados_turma_"         // Segmento da turma: dados_turma_<id>.seg
+#define NOME_TRANSACAO "dados_fragmentos.tx"
+
+struct DadosSistema;
+
+typedef struct {
+    int ativo;            // 1 = modo fragmentado
+    int parcial;          // 1 = há segmentos de turmas ativas ainda não lidos
+    int *inicio;          // Por slot de turma: primeiro slot de aluno do segmento lido (-1 = não lido)
+    uint32_t *crc;        // Por slot de turma: CRC do segmento gravado (0 = turma sem segmento)
+    int capacidade;       // Posições alocadas em 'inicio' e 'crc'
+    int *alterados;       // IDs das turmas de onde saíram alunos alterados (com repetições)
+    int quantidade;
+    int cap_alterados;
+    int incompleto;       // Faltou memória ao marcar: a próxima gravação regrava todos os segmentos
+    int invalidos;        // Segmentos que não puderam ser lidos (nada é regravado enquanto > 0)
+} Fragmentos;
+
+void fragmentos_inicializar(Fragmentos *fragmentos);
+void fragmentos_liberar(Fragmentos *fragmentos);
+int fragmentos_existe(void);
+int fragmentos_abrir(struct DadosSistema *sistema);
+int fragmentos_carregar_turma(const struct DadosSistema *sistema, int idx_turma);
+int fragmentos_carregar_todos(const struct DadosSistema *sistema);
+void fragmentos_marcar(Fragmentos *fragmentos, int id_turma);
+int fragmentos_gravar(struct DadosSistema *sistema, int completo);
+
+#endif // FRAGMENTOS_H
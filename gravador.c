@@ -0,0 +1,225 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gravador.h"
+#include "arquivos.h"
+#include "metricas.h"
+
+#ifndef _WIN32
+
+// --- 1. Thread do Gravador ---
+
+/**
+ * @brief Prazo absoluto (relógio monotônico) daqui a 'ms' milissegundos.
+ */
+static struct timespec prazo_em(int ms) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    t.tv_sec += ms / 1000;
+    t.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (t.tv_nsec >= 1000000000L) {
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000L;
+    }
+    return t;
+}
+
+/**
+ * @brief Escreve um lote de confirmações com um único fwrite e um fsync.
+ * @return int 1 se o lote está no disco, 0 em caso de falha.
+ */
+static int escrever_lote(FILE *arquivo, const char *dados, size_t tamanho) {
+    METRICA_MEDIR(METRICA_GRAVACAO_DIARIO);
+    if (fwrite(dados, tamanho, 1, arquivo) != 1) return 0;
+    metricas_bytes_gravados(tamanho);
+    return arquivo_sincronizar(arquivo);
+}
+
+/**
+ * @brief Laço da thread: espera confirmações, junta as que chegam durante o
+ * atraso e as grava. Encerra depois de gravar tudo o que foi entregue.
+ */
+static void *executar_gravador(void *argumento) {
+    Gravador *gravador = argumento;
+    pthread_mutex_lock(&gravador->trava);
+    for (;;) {
+        while (gravador->tamanho == 0 && !gravador->encerrando) {
+            pthread_cond_wait(&gravador->chegada, &gravador->trava);
+        }
+        if (gravador->tamanho == 0) break; // Encerrando, com a fila vazia
+
+        // Junta as confirmações seguintes, até o atraso, o lote cheio ou uma barreira
+        if (gravador->atraso_ms > 0) {
+            struct timespec prazo = prazo_em(gravador->atraso_ms);
+            while (!gravador->encerrando && gravador->barreiras == 0 &&
+                   gravador->tamanho < gravador->lote_bytes &&
+                   pthread_cond_timedwait(&gravador->chegada, &gravador->trava, &prazo) == 0) {
+            }
+        }
+
+        // A fila passa para a reserva: novas confirmações entram enquanto esta é escrita
+        char *lote = gravador->fila;
+        size_t tamanho = gravador->tamanho, capacidade = gravador->capacidade;
+        gravador->fila = gravador->reserva;
+        gravador->capacidade = gravador->cap_reserva;
+        gravador->tamanho = 0;
+        gravador->escrevendo = 1;
+        FILE *arquivo = gravador->arquivo;
+        pthread_mutex_unlock(&gravador->trava);
+
+        int ok = escrever_lote(arquivo, lote, tamanho);
+
+        pthread_mutex_lock(&gravador->trava);
+        gravador->reserva = lote;
+        gravador->cap_reserva = capacidade;
+        gravador->escrevendo = 0;
+        if (!ok) gravador->falhou = 1;
+        pthread_cond_broadcast(&gravador->gravado);
+    }
+    pthread_mutex_unlock(&gravador->trava);
+    return NULL;
+}
+
+// --- 2. Ciclo de Vida ---
+
+/**
+ * @brief Inicia a thread do gravador.
+ * @param gravador Ponteiro para o gravador (não inicializado).
+ * @param atraso_ms Espera para juntar confirmações seguidas (0 = grava assim que chega).
+ * @param lote_bytes Tamanho da fila que dispara a escrita antes do atraso.
+ * @return int 1 se a thread está rodando, 0 caso contrário (o gravador fica inativo).
+ */
+int gravador_iniciar(Gravador *gravador, int atraso_ms, size_t lote_bytes) {
+    memset(gravador, 0, sizeof(*gravador));
+    gravador->atraso_ms = atraso_ms > 0 ? atraso_ms : 0;
+    gravador->lote_bytes = lote_bytes;
+
+    pthread_condattr_t atributos;
+    if (pthread_condattr_init(&atributos) != 0) return 0;
+    pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC); // Prazos imunes a ajustes do relógio
+    int ok = pthread_mutex_init(&gravador->trava, NULL) == 0;
+    if (ok && pthread_cond_init(&gravador->chegada, &atributos) != 0) {
+        pthread_mutex_destroy(&gravador->trava);
+        ok = 0;
+    }
+    if (ok && pthread_cond_init(&gravador->gravado, NULL) != 0) {
+        pthread_cond_destroy(&gravador->chegada);
+        pthread_mutex_destroy(&gravador->trava);
+        ok = 0;
+    }
+    pthread_condattr_destroy(&atributos);
+    if (!ok) return 0;
+
+    if (pthread_create(&gravador->thread, NULL, executar_gravador, gravador) != 0) {
+        pthread_cond_destroy(&gravador->gravado);
+        pthread_cond_destroy(&gravador->chegada);
+        pthread_mutex_destroy(&gravador->trava);
+        return 0;
+    }
+    gravador->ativo = 1;
+    return 1;
+}
+
+/**
+ * @brief Grava o que está na fila, encerra a thread e libera os buffers.
+ * @param gravador Ponteiro para o gravador (iniciado ou inativo).
+ */
+void gravador_encerrar(Gravador *gravador) {
+    if (!gravador->ativo) return;
+    pthread_mutex_lock(&gravador->trava);
+    gravador->encerrando = 1;
+    pthread_cond_signal(&gravador->chegada);
+    pthread_mutex_unlock(&gravador->trava);
+    pthread_join(gravador->thread, NULL);
+
+    pthread_cond_destroy(&gravador->gravado);
+    pthread_cond_destroy(&gravador->chegada);
+    pthread_mutex_destroy(&gravador->trava);
+    free(gravador->fila);
+    free(gravador->reserva);
+    gravador->fila = gravador->reserva = NULL;
+    gravador->ativo = 0;
+}
+
+// --- 3. Entrega e Barreira ---
+
+/**
+ * @brief Entrega uma confirmação completa para ser escrita no diário (O(tamanho), sem E/S).
+ * @param gravador Ponteiro para o gravador ativo.
+ * @param arquivo Diário aberto para acréscimo (o mesmo até a próxima barreira).
+ * @param dados Bytes da confirmação (copiados).
+ * @param tamanho Quantidade de bytes.
+ * @return int 1 se entregue, 0 se faltou memória ou uma escrita anterior falhou.
+ */
+int gravador_entregar(Gravador *gravador, FILE *arquivo, const char *dados, size_t tamanho) {
+    pthread_mutex_lock(&gravador->trava);
+    int ok = !gravador->falhou;
+    if (ok && gravador->tamanho + tamanho > gravador->capacidade) {
+        size_t nova = gravador->capacidade > 0 ? gravador->capacidade : 4096;
+        while (nova < gravador->tamanho + tamanho) nova *= 2;
+        char *fila = realloc(gravador->fila, nova);
+        ok = fila != NULL;
+        if (ok) {
+            gravador->fila = fila;
+            gravador->capacidade = nova;
+        }
+    }
+    if (ok) {
+        memcpy(gravador->fila + gravador->tamanho, dados, tamanho);
+        gravador->tamanho += tamanho;
+        gravador->arquivo = arquivo;
+        pthread_cond_signal(&gravador->chegada);
+    }
+    pthread_mutex_unlock(&gravador->trava);
+    return ok;
+}
+
+/**
+ * @brief Barreira de durabilidade: espera até que tudo o que foi entregue
+ * esteja escrito e sincronizado. Depois dela, quem chama pode fechar ou
+ * trocar o arquivo do diário.
+ * @param gravador Ponteiro para o gravador ativo.
+ * @return int 1 se tudo está no disco, 0 se alguma escrita falhou desde a
+ * barreira anterior (a falha é esquecida: quem chama grava o estado completo).
+ */
+int gravador_aguardar(Gravador *gravador) {
+    pthread_mutex_lock(&gravador->trava);
+    gravador->barreiras++;
+    pthread_cond_signal(&gravador->chegada); // Não espera o fim do atraso
+    while (gravador->tamanho > 0 || gravador->escrevendo) {
+        pthread_cond_wait(&gravador->gravado, &gravador->trava);
+    }
+    gravador->barreiras--;
+    int ok = !gravador->falhou;
+    gravador->falhou = 0;
+    pthread_mutex_unlock(&gravador->trava);
+    return ok;
+}
+
+#else // Sem threads: o gravador nunca fica ativo e o diário grava no próprio salvar_dados
+
+int gravador_iniciar(Gravador *gravador, int atraso_ms, size_t lote_bytes) {
+    memset(gravador, 0, sizeof(*gravador));
+    (void)atraso_ms;
+    (void)lote_bytes;
+    return 0;
+}
+
+void gravador_encerrar(Gravador *gravador) {
+    (void)gravador;
+}
+
+int gravador_entregar(Gravador *gravador, FILE *arquivo, const char *dados, size_t tamanho) {
+    (void)gravador;
+    (void)arquivo;
+    (void)dados;
+    (void)tamanho;
+    return 0;
+}
+
+int gravador_aguardar(Gravador *gravador) {
+    (void)gravador;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef GRAVADOR_H
+#define GRAVADOR_H
+
+#include <stdio.h>
+#include <stddef.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// --- Gravação do Diário em Segundo Plano ---
+//
+// Com um gravador ligado ao diário (diario.h), salvar_dados não espera o
+// disco: a confirmação é montada na hora (cópia dos registros alterados, em
+// memória) e entregue à thread do gravador, que a escreve e faz o fsync.
+// Confirmações que chegam em sequência são juntadas: a thread espera até
+// atraso_ms depois da primeira pendente (ou até juntar lote_bytes) e grava
+// todas com uma escrita e um fsync.
+//
+// O preço é a janela de durabilidade: numa queda, as confirmações ainda na
+// fila (no máximo atraso_ms de operações) se perdem inteiras, nunca pela
+// metade. gravador_aguardar é a barreira: volta quando tudo o que foi
+// entregue está no disco (diario_sincronizar passa por ela).
+//
+// Só a thread do gravador escreve no arquivo do diário enquanto há
+// confirmações pendentes; quem fecha ou troca o arquivo (checkpoint, fim do
+// programa) passa antes pela barreira. Sem threads (Windows), o gravador não
+// é ligado e a gravação continua no próprio salvar_dados.
+
+#define ATRASO_GRAVACAO_PADRAO_MS 200    // Espera para juntar confirmações seguidas
+#define LOTE_GRAVACAO_BYTES (256 * 1024) // Grava antes do atraso quando a fila chega a este tamanho
+
+typedef struct Gravador {
+#ifndef _WIN32
+    pthread_t thread;
+    pthread_mutex_t trava;          // Protege a fila e os campos abaixo
+    pthread_cond_t chegada;         // Chegou confirmação, barreira ou encerramento
+    pthread_cond_t gravado;         // A thread terminou uma escrita
+#endif
+    int ativo;            // 1 = thread rodando
+    int atraso_ms;        // Espera para juntar confirmações (0 = grava assim que chega)
+    size_t lote_bytes;    // Fila que dispara a escrita antes do atraso
+    FILE *arquivo;        // Diário das confirmações pendentes
+    char *fila;           // Confirmações entregues e ainda não escritas, em ordem
+    size_t tamanho;
+    size_t capacidade;
+    char *reserva;        // Buffer da escrita em andamento (trocado com 'fila')
+    size_t cap_reserva;
+    int escrevendo;       // 1 = a thread está escrevendo (fora da trava)
+    int barreiras;        // Barreiras esperando: a thread não espera o atraso
+    int encerrando;
+    int falhou;           // Uma escrita falhou desde a última barreira
+} Gravador;
+
+int gravador_iniciar(Gravador *gravador, int atraso_ms, size_t lote_bytes);
+void gravador_encerrar(Gravador *gravador);
+int gravador_entregar(Gravador *gravador, FILE *arquivo, const char *dados, size_t tamanho);
+int gravador_aguardar(Gravador *gravador);
+
+#endif // GRAVADOR_H
@@ -0,0 +1,837 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "servicos.h"
+#include "indices.h"
+
+// --- 1. Índice Hash por RA ---
+
+#define SLOT_VAZIO -1
+#define CAPACIDADE_INICIAL_RA 64
+
+/**
+ * @brief Hash FNV-1a do RA (string curta, até TAM_RA - 1 caracteres).
+ * @param ra O Registro Acadêmico.
+ * @return unsigned O valor de hash.
+ */
+static unsigned hash_ra(const char *ra) {
+    unsigned h = 2166136261u;
+    for (int i = 0; i < TAM_RA && ra[i] != '\0'; i++) {
+        h ^= (unsigned char)ra[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Inicializa um índice vazio (sem alocação).
+ * @param indice Ponteiro para o índice.
+ */
+void indice_ra_inicializar(IndiceRA *indice) {
+    indice->slots = NULL;
+    indice->hashes = NULL;
+    indice->capacidade = 0;
+    indice->ocupados = 0;
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Libera a memória do índice.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_ra_liberar(IndiceRA *indice) {
+    free(indice->slots);
+    free(indice->hashes);
+    indice_ra_inicializar(indice);
+}
+
+/**
+ * @brief Coloca uma entrada na tabela sem verificar duplicidade nem carga.
+ * @param indice Ponteiro para o índice (com capacidade > ocupados).
+ * @param slot Slot do aluno.
+ * @param h Hash do RA do aluno.
+ */
+static void colocar_entrada(IndiceRA *indice, int slot, unsigned h) {
+    unsigned mascara = (unsigned)indice->capacidade - 1;
+    unsigned pos = h & mascara;
+    while (indice->slots[pos] != SLOT_VAZIO) {
+        pos = (pos + 1) & mascara;
+    }
+    indice->slots[pos] = slot;
+    indice->hashes[pos] = h;
+    indice->ocupados++;
+}
+
+/**
+ * @brief Realoca a tabela com a nova capacidade e reinsere as entradas.
+ * @param indice Ponteiro para o índice.
+ * @param nova_capacidade Potência de 2 maior que o número de entradas.
+ * @return int 1 se bem-sucedido, 0 se faltou memória (o índice antigo é mantido).
+ */
+static int redimensionar(IndiceRA *indice, int nova_capacidade) {
+    int *slots = malloc((size_t)nova_capacidade * sizeof(int));
+    unsigned *hashes = malloc((size_t)nova_capacidade * sizeof(unsigned));
+    if (slots == NULL || hashes == NULL) {
+        free(slots);
+        free(hashes);
+        return 0;
+    }
+    for (int i = 0; i < nova_capacidade; i++) slots[i] = SLOT_VAZIO;
+
+    IndiceRA antigo = *indice;
+    indice->slots = slots;
+    indice->hashes = hashes;
+    indice->capacidade = nova_capacidade;
+    indice->ocupados = 0;
+
+    for (int i = 0; i < antigo.capacidade; i++) {
+        if (antigo.slots[i] != SLOT_VAZIO) {
+            colocar_entrada(indice, antigo.slots[i], antigo.hashes[i]);
+        }
+    }
+    free(antigo.slots);
+    free(antigo.hashes);
+    return 1;
+}
+
+/**
+ * @brief Insere o aluno de um slot no índice (O(1) amortizado).
+ * A tabela dobra de tamanho quando a carga passa de 70%.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @param slot Slot do aluno (já preenchido com o RA).
+ * @return int 1 se inserido, 0 se faltou memória.
+ */
+int indice_ra_inserir(const DadosSistema *sistema, IndiceRA *indice, int slot) {
+    if (!indice->pronto) return 1; // Ainda não montado: a reconstrução incluirá o aluno
+    if ((long)(indice->ocupados + 1) * 10 > (long)indice->capacidade * 7) {
+        int nova = indice->capacidade > 0 ? indice->capacidade * 2 : CAPACIDADE_INICIAL_RA;
+        if (!redimensionar(indice, nova)) return 0;
+    }
+    colocar_entrada(indice, slot, hash_ra(aluno_em(sistema, slot)->ra));
+    return 1;
+}
+
+/**
+ * @brief Procura a posição da tabela que guarda o RA informado.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @param ra O RA procurado.
+ * @return int Posição na tabela, ou -1 se o RA não estiver indexado.
+ */
+static int posicao_do_ra(const DadosSistema *sistema, const IndiceRA *indice, const char *ra) {
+    if (indice->capacidade == 0) return -1;
+
+    unsigned h = hash_ra(ra);
+    unsigned mascara = (unsigned)indice->capacidade - 1;
+    for (unsigned pos = h & mascara; indice->slots[pos] != SLOT_VAZIO; pos = (pos + 1) & mascara) {
+        if (indice->hashes[pos] == h &&
+            strncmp(aluno_em(sistema, indice->slots[pos])->ra, ra, TAM_RA) == 0) {
+            return (int)pos;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Busca o slot do aluno com o RA informado (O(1) esperado).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @param ra O RA procurado.
+ * @return int Slot do aluno, ou -1 se não houver aluno indexado com esse RA.
+ */
+int indice_ra_buscar(const DadosSistema *sistema, const IndiceRA *indice, const char *ra) {
+    int pos = posicao_do_ra(sistema, indice, ra);
+    return pos == -1 ? -1 : indice->slots[pos];
+}
+
+/**
+ * @brief Remove o RA do índice.
+ * Usa remoção com deslocamento para trás (sem marcas de "apagado"), então
+ * o índice não degrada com muitas exclusões.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @param ra O RA a remover (deve ser chamado antes de o registro ser sobrescrito).
+ */
+void indice_ra_remover(const DadosSistema *sistema, IndiceRA *indice, const char *ra) {
+    if (!indice->pronto) return;
+    int pos = posicao_do_ra(sistema, indice, ra);
+    if (pos == -1) return;
+
+    unsigned mascara = (unsigned)indice->capacidade - 1;
+    unsigned vazio = (unsigned)pos;
+    unsigned atual = (vazio + 1) & mascara;
+
+    while (indice->slots[atual] != SLOT_VAZIO) {
+        unsigned ideal = indice->hashes[atual] & mascara;
+        // Move a entrada se a posição vazia estiver entre a posição ideal e a atual (circular)
+        if (((atual - ideal) & mascara) >= ((atual - vazio) & mascara)) {
+            indice->slots[vazio] = indice->slots[atual];
+            indice->hashes[vazio] = indice->hashes[atual];
+            vazio = atual;
+        }
+        atual = (atual + 1) & mascara;
+    }
+    indice->slots[vazio] = SLOT_VAZIO;
+    indice->ocupados--;
+}
+
+/**
+ * @brief Reconstrói o índice a partir de todos os alunos ativos.
+ * Se houver RAs repetidos, prevalece o de menor slot (mesmo resultado da busca linear).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int indice_ra_reconstruir(const DadosSistema *sistema, IndiceRA *indice) {
+    indice_ra_liberar(indice);
+    fragmentos_carregar_todos(sistema); // Segmentos ainda não lidos (um ilegível já foi informado)
+
+    int capacidade = CAPACIDADE_INICIAL_RA;
+    while ((long)sistema->total_alunos * 10 > (long)capacidade * 7) capacidade *= 2;
+    if (!redimensionar(indice, capacidade)) return 0;
+    indice->pronto = 1;
+
+    // Só os registros dos slots ativos são lidos (o filtro vem do mapa de bits)
+    const ColunasNotas *colunas = colunas_montadas(sistema);
+    if (colunas == NULL) {
+        indice_ra_liberar(indice);
+        return 0;
+    }
+    for (int i = colunas_proximo_ativo(colunas, 0); i != -1; i = colunas_proximo_ativo(colunas, i + 1)) {
+        const Aluno *aluno = aluno_em(sistema, i);
+        if (posicao_do_ra(sistema, indice, aluno->ra) == -1) {
+            if (!indice_ra_inserir(sistema, indice, i)) {
+                indice_ra_liberar(indice);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// --- 2. Índice de Membros por Turma ---
+
+/**
+ * @brief Inicializa o índice de membros vazio.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_turmas_inicializar(IndiceTurmas *indice) {
+    pool_inicializar(&indice->elos, sizeof(ElosMembro));
+    pool_inicializar(&indice->listas, sizeof(ListaMembros));
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Libera a memória do índice de membros.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_turmas_liberar(IndiceTurmas *indice) {
+    pool_liberar(&indice->elos);
+    pool_liberar(&indice->listas);
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Estende os pools do índice até cobrirem os slots informados.
+ * Elos e listas novos começam vazios (-1).
+ * @param indice Ponteiro para o índice.
+ * @param slot_aluno Maior slot de aluno que precisa existir.
+ * @param slot_turma Maior slot de turma que precisa existir.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int garantir_slots(IndiceTurmas *indice, int slot_aluno, int slot_turma) {
+    while (indice->elos.usados <= slot_aluno) {
+        int i = pool_novo_slot(&indice->elos);
+        if (i == -1) return 0;
+        ElosMembro *e = pool_slot_escrita(&indice->elos, i);
+        e->turma = e->anterior = e->proximo = -1;
+    }
+    while (indice->listas.usados <= slot_turma) {
+        int i = pool_novo_slot(&indice->listas);
+        if (i == -1) return 0;
+        ListaMembros *l = pool_slot_escrita(&indice->listas, i);
+        l->primeiro = l->ultimo = -1;
+        l->quantidade = 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Acrescenta o aluno ao final da lista da turma (O(1)).
+ * @param indice Ponteiro para o índice.
+ * @param slot_aluno Slot do aluno (não pode estar em outra lista).
+ * @param slot_turma Slot da turma.
+ * @return int 1 se inserido, 0 se faltou memória.
+ */
+int indice_turmas_inserir(IndiceTurmas *indice, int slot_aluno, int slot_turma) {
+    if (!indice->pronto) return 1; // Ainda não montado: a reconstrução incluirá o aluno
+    if (!garantir_slots(indice, slot_aluno, slot_turma)) return 0;
+
+    ElosMembro *e = pool_slot_escrita(&indice->elos, slot_aluno);
+    ListaMembros *l = pool_slot_escrita(&indice->listas, slot_turma);
+
+    e->turma = slot_turma;
+    e->anterior = l->ultimo;
+    e->proximo = -1;
+    if (l->ultimo != -1) {
+        ((ElosMembro *)pool_slot_escrita(&indice->elos, l->ultimo))->proximo = slot_aluno;
+    } else {
+        l->primeiro = slot_aluno;
+    }
+    l->ultimo = slot_aluno;
+    l->quantidade++;
+    return 1;
+}
+
+/**
+ * @brief Retira o aluno da lista em que ele estiver (O(1)). Não faz nada se ele não estiver em nenhuma.
+ * @param indice Ponteiro para o índice.
+ * @param slot_aluno Slot do aluno.
+ */
+void indice_turmas_remover(IndiceTurmas *indice, int slot_aluno) {
+    if (slot_aluno >= indice->elos.usados) return;
+    ElosMembro *e = pool_slot_escrita(&indice->elos, slot_aluno);
+    if (e->turma == -1) return;
+
+    ListaMembros *l = pool_slot_escrita(&indice->listas, e->turma);
+    if (e->anterior != -1) {
+        ((ElosMembro *)pool_slot_escrita(&indice->elos, e->anterior))->proximo = e->proximo;
+    } else {
+        l->primeiro = e->proximo;
+    }
+    if (e->proximo != -1) {
+        ((ElosMembro *)pool_slot_escrita(&indice->elos, e->proximo))->anterior = e->anterior;
+    } else {
+        l->ultimo = e->anterior;
+    }
+    l->quantidade--;
+    e->turma = e->anterior = e->proximo = -1;
+}
+
+/**
+ * @brief Desliga todos os alunos da lista de uma turma (O(tamanho da turma)).
+ * @param indice Ponteiro para o índice.
+ * @param slot_turma Slot da turma.
+ */
+void indice_turmas_esvaziar(IndiceTurmas *indice, int slot_turma) {
+    if (slot_turma >= indice->listas.usados) return;
+    ListaMembros *l = pool_slot_escrita(&indice->listas, slot_turma);
+
+    for (int i = l->primeiro; i != -1; ) {
+        ElosMembro *e = pool_slot_escrita(&indice->elos, i);
+        i = e->proximo;
+        e->turma = e->anterior = e->proximo = -1;
+    }
+    l->primeiro = l->ultimo = -1;
+    l->quantidade = 0;
+}
+
+/**
+ * @brief Reconstrói as listas a partir de todos os alunos ativos, em ordem de slot.
+ * Alunos cuja turma não está ativa ficam fora de qualquer lista.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int indice_turmas_reconstruir(const DadosSistema *sistema, IndiceTurmas *indice) {
+    indice_turmas_liberar(indice);
+    fragmentos_carregar_todos(sistema);
+    if (!garantir_slots(indice, sistema->alunos.usados - 1, sistema->turmas.usados - 1)) {
+        indice_turmas_liberar(indice);
+        return 0;
+    }
+    // A varredura usa só a parte quente (mapa de ativos e turma), sem ler os registros
+    const ColunasNotas *colunas = colunas_montadas(sistema);
+    if (colunas == NULL) {
+        indice_turmas_liberar(indice);
+        return 0;
+    }
+    indice->pronto = 1;
+
+    for (int i = colunas_proximo_ativo(colunas, 0); i != -1; i = colunas_proximo_ativo(colunas, i + 1)) {
+        int slot_turma = buscar_turma_por_id(sistema, colunas->id_turma[i]);
+        if (slot_turma != -1) indice_turmas_inserir(indice, i, slot_turma); // Slots já garantidos
+    }
+    return 1;
+}
+
+// --- 3. Índice Ordenado por Nome (Treap) ---
+//
+// As prioridades do treap vêm de uma mistura (hash) do slot, então não
+// precisam ser guardadas e a altura esperada é O(log n) para qualquer ordem
+// de inserção. Inserção, remoção e busca por prefixo usam recursão com
+// profundidade igual à altura da árvore.
+
+#define NO(indice, slot) ((NoNome *)pool_slot(&(indice)->nos, (slot)))
+
+/**
+ * @brief Prioridade pseudoaleatória (e determinística) do nó de um slot.
+ * @param slot Slot do aluno.
+ * @return uint32_t Prioridade (maior fica mais perto da raiz).
+ */
+static uint32_t prioridade(int slot) {
+    uint32_t x = (uint32_t)slot + 0x9E3779B9u;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Compara as chaves (nome, slot) de dois alunos.
+ * @return int Negativo, zero ou positivo, como strcmp.
+ */
+static int comparar_chaves(const DadosSistema *sistema, int a, int b) {
+    int nome_a = aluno_em(sistema, a)->nome, nome_b = aluno_em(sistema, b)->nome;
+    // Nomes internados: a mesma referência é o mesmo nome, sem comparar os textos
+    int c = nome_a == nome_b ? 0 : strcmp(texto_em(sistema, nome_a), texto_em(sistema, nome_b));
+    if (c != 0) return c;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Inicializa o índice de nomes vazio.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_nomes_inicializar(IndiceNomes *indice) {
+    pool_inicializar(&indice->nos, sizeof(NoNome));
+    indice->raiz = -1;
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Libera a memória do índice de nomes.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_nomes_liberar(IndiceNomes *indice) {
+    pool_liberar(&indice->nos);
+    indice->raiz = -1;
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Divide a subárvore t em L (chaves < chave do slot) e R (chaves > chave do slot).
+ */
+static void dividir(const DadosSistema *sistema, IndiceNomes *indice, int t, int slot, int *l, int *r) {
+    if (t == -1) {
+        *l = *r = -1;
+    } else if (comparar_chaves(sistema, t, slot) < 0) {
+        dividir(sistema, indice, NO(indice, t)->direita, slot, &NO(indice, t)->direita, r);
+        *l = t;
+    } else {
+        dividir(sistema, indice, NO(indice, t)->esquerda, slot, l, &NO(indice, t)->esquerda);
+        *r = t;
+    }
+}
+
+/**
+ * @brief Une duas subárvores em que todas as chaves de l são menores que as de r.
+ * @return int Raiz da subárvore resultante.
+ */
+static int unir(IndiceNomes *indice, int l, int r) {
+    if (l == -1) return r;
+    if (r == -1) return l;
+    if (prioridade(l) > prioridade(r)) {
+        NO(indice, l)->direita = unir(indice, NO(indice, l)->direita, r);
+        return l;
+    }
+    NO(indice, r)->esquerda = unir(indice, l, NO(indice, r)->esquerda);
+    return r;
+}
+
+/**
+ * @brief Insere o slot na subárvore t (desce até achar um nó de prioridade menor).
+ * @return int Nova raiz da subárvore.
+ */
+static int inserir_no(const DadosSistema *sistema, IndiceNomes *indice, int t, int slot) {
+    if (t == -1) return slot;
+    if (prioridade(slot) > prioridade(t)) {
+        dividir(sistema, indice, t, slot, &NO(indice, slot)->esquerda, &NO(indice, slot)->direita);
+        return slot;
+    }
+    if (comparar_chaves(sistema, slot, t) < 0) {
+        NO(indice, t)->esquerda = inserir_no(sistema, indice, NO(indice, t)->esquerda, slot);
+    } else {
+        NO(indice, t)->direita = inserir_no(sistema, indice, NO(indice, t)->direita, slot);
+    }
+    return t;
+}
+
+/**
+ * @brief Insere um aluno (já com o nome preenchido) no índice (O(log n) esperado).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @param slot Slot do aluno.
+ * @return int 1 se inserido, 0 se faltou memória.
+ */
+int indice_nomes_inserir(const DadosSistema *sistema, IndiceNomes *indice, int slot) {
+    if (!indice->pronto) return 1; // Ainda não montado: a reconstrução incluirá o aluno
+    if (!pool_estender(&indice->nos, slot + 1)) return 0;
+
+    NO(indice, slot)->esquerda = -1;
+    NO(indice, slot)->direita = -1;
+    indice->raiz = inserir_no(sistema, indice, indice->raiz, slot);
+    return 1;
+}
+
+/**
+ * @brief Remove o slot da subárvore t, substituindo o nó pela união dos filhos.
+ * @return int Nova raiz da subárvore.
+ */
+static int remover_no(const DadosSistema *sistema, IndiceNomes *indice, int t, int slot) {
+    if (t == -1) return -1;
+    if (t == slot) {
+        int r = unir(indice, NO(indice, t)->esquerda, NO(indice, t)->direita);
+        NO(indice, t)->esquerda = NO(indice, t)->direita = -1;
+        return r;
+    }
+    if (comparar_chaves(sistema, slot, t) < 0) {
+        NO(indice, t)->esquerda = remover_no(sistema, indice, NO(indice, t)->esquerda, slot);
+    } else {
+        NO(indice, t)->direita = remover_no(sistema, indice, NO(indice, t)->direita, slot);
+    }
+    return t;
+}
+
+/**
+ * @brief Remove um aluno do índice (O(log n) esperado).
+ * Deve ser chamada antes de o nome do aluno ser alterado.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @param slot Slot do aluno.
+ */
+void indice_nomes_remover(const DadosSistema *sistema, IndiceNomes *indice, int slot) {
+    if (!indice->pronto) return;
+    indice->raiz = remover_no(sistema, indice, indice->raiz, slot);
+}
+
+// Contexto do qsort usado na reconstrução (qsort não recebe parâmetro extra).
+static const DadosSistema *sistema_em_ordenacao;
+
+static int comparar_slots(const void *a, const void *b) {
+    return comparar_chaves(sistema_em_ordenacao, *(const int *)a, *(const int *)b);
+}
+
+/**
+ * @brief Reconstrói o índice com todos os alunos ativos em O(n log n).
+ * Os slots são ordenados uma vez e a árvore é montada em tempo linear com uma
+ * pilha (árvore cartesiana), sem nenhuma inserção individual.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int indice_nomes_reconstruir(const DadosSistema *sistema, IndiceNomes *indice) {
+    indice_nomes_liberar(indice);
+    fragmentos_carregar_todos(sistema);
+    if (!pool_estender(&indice->nos, sistema->alunos.usados)) return 0;
+
+    const ColunasNotas *colunas = colunas_montadas(sistema);
+    int *ordem = malloc((size_t)(sistema->total_alunos > 0 ? sistema->total_alunos : 1) * sizeof(int));
+    int *pilha = malloc((size_t)(sistema->total_alunos > 0 ? sistema->total_alunos : 1) * sizeof(int));
+    if (colunas == NULL || ordem == NULL || pilha == NULL) {
+        free(ordem);
+        free(pilha);
+        return 0;
+    }
+
+    int n = 0;
+    for (int i = colunas_proximo_ativo(colunas, 0); i != -1 && n < sistema->total_alunos;
+         i = colunas_proximo_ativo(colunas, i + 1)) {
+        ordem[n++] = i;
+    }
+    sistema_em_ordenacao = sistema;
+    qsort(ordem, (size_t)n, sizeof(int), comparar_slots);
+
+    // A pilha guarda o "braço direito" da árvore montada até agora
+    int topo = 0;
+    for (int k = 0; k < n; k++) {
+        int slot = ordem[k];
+        int ultimo_removido = -1;
+        while (topo > 0 && prioridade(pilha[topo - 1]) < prioridade(slot)) {
+            ultimo_removido = pilha[--topo];
+        }
+        NO(indice, slot)->esquerda = ultimo_removido;
+        NO(indice, slot)->direita = -1;
+        if (topo > 0) NO(indice, pilha[topo - 1])->direita = slot;
+        pilha[topo++] = slot;
+    }
+    indice->raiz = topo > 0 ? pilha[0] : -1;
+    indice->pronto = 1;
+
+    free(ordem);
+    free(pilha);
+    return 1;
+}
+
+/**
+ * @brief Percorre em ordem a subárvore t, podando os ramos fora do prefixo.
+ * @return int 0 se a visita pediu para parar, 1 caso contrário.
+ */
+static int percorrer_no(const DadosSistema *sistema, const IndiceNomes *indice, int t,
+                        const char *prefixo, size_t tam_prefixo, VisitaAluno visita, void *contexto) {
+    while (t != -1) {
+        const NoNome *no = pool_slot(&indice->nos, t);
+        int c = tam_prefixo > 0 ? strncmp(texto_em(sistema, aluno_em(sistema, t)->nome), prefixo, tam_prefixo) : 0;
+
+        if (c < 0) {
+            t = no->direita;          // Nome antes do intervalo: só a direita interessa
+        } else if (c > 0) {
+            t = no->esquerda;         // Nome depois do intervalo: só a esquerda interessa
+        } else {
+            if (!percorrer_no(sistema, indice, no->esquerda, prefixo, tam_prefixo, visita, contexto)) return 0;
+            if (!visita(sistema, t, contexto)) return 0;
+            t = no->direita;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Visita em ordem alfabética os alunos cujo nome começa com o prefixo.
+ * Custa O(log n + k) para k alunos visitados.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @param prefixo Prefixo do nome (NULL ou "" visita todos).
+ * @param visita Função chamada para cada aluno (retorna 0 para interromper).
+ * @param contexto Ponteiro repassado à função de visita.
+ * @return int 0 se a visita foi interrompida, 1 caso contrário.
+ */
+int indice_nomes_percorrer(const DadosSistema *sistema, const IndiceNomes *indice,
+                           const char *prefixo, VisitaAluno visita, void *contexto) {
+    size_t tam_prefixo = prefixo != NULL ? strnlen(prefixo, TAM_NOME) : 0;
+    return percorrer_no(sistema, indice, indice->raiz, prefixo, tam_prefixo, visita, contexto);
+}
+
+// --- 4. Índice de IDs de Turma ---
+
+/**
+ * @brief Inicializa o índice de IDs vazio.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_ids_inicializar(IndiceIds *indice) {
+    pool_inicializar(&indice->slots, sizeof(int));
+    indice->maior_id = 0;
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Libera a memória do índice de IDs.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_ids_liberar(IndiceIds *indice) {
+    pool_liberar(&indice->slots);
+    indice->maior_id = 0;
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Associa o ID ao slot (O(1) amortizado). Com slot -1, desfaz a associação.
+ * IDs ainda não vistos entre o último e o novo ficam sem turma (-1).
+ * @param indice Ponteiro para o índice.
+ * @param id ID da turma (> 0).
+ * @param slot Slot da turma, ou -1.
+ * @return int 1 se bem-sucedido (ou índice ainda não montado), 0 se faltou memória.
+ */
+int indice_ids_definir(IndiceIds *indice, int id, int slot) {
+    if (!indice->pronto || id <= 0) return 1;
+    while (indice->slots.usados < id) {
+        int i = pool_novo_slot(&indice->slots);
+        if (i == -1) return 0;
+        *(int *)pool_slot_escrita(&indice->slots, i) = -1;
+    }
+    *(int *)pool_slot_escrita(&indice->slots, id - 1) = slot;
+    if (id > indice->maior_id) indice->maior_id = id;
+    return 1;
+}
+
+/**
+ * @brief Reconstrói o índice a partir de todas as turmas (ativas ou não).
+ * Se houver IDs repetidos, prevalece a turma ativa de menor slot.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int indice_ids_reconstruir(const DadosSistema *sistema, IndiceIds *indice) {
+    indice_ids_liberar(indice);
+    indice->pronto = 1;
+
+    for (int i = 0; i < sistema->turmas.usados; i++) {
+        const Turma *turma = turma_em(sistema, i);
+        if (turma->id <= 0) continue; // Slot nunca usado
+        int atual = indice_ids_buscar(indice, turma->id);
+        if (atual != -1 && (turma->ativo != 1 || turma_em(sistema, atual)->ativo == 1)) continue;
+        if (!indice_ids_definir(indice, turma->id, i)) {
+            indice_ids_liberar(indice);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// --- 5. Slots Livres ---
+
+/**
+ * @brief Inicializa a pilha de slots livres vazia.
+ * @param indice Ponteiro para a pilha.
+ */
+void indice_livres_inicializar(IndiceLivres *indice) {
+    pool_inicializar(&indice->pilha, sizeof(int));
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Libera a memória da pilha de slots livres.
+ * @param indice Ponteiro para a pilha.
+ */
+void indice_livres_liberar(IndiceLivres *indice) {
+    pool_liberar(&indice->pilha);
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Registra um slot que acabou de ficar inativo (O(1) amortizado).
+ * @param indice Ponteiro para a pilha.
+ * @param slot Slot liberado.
+ * @return int 1 se bem-sucedido (ou pilha ainda não montada), 0 se faltou memória.
+ */
+int indice_livres_empilhar(IndiceLivres *indice, int slot) {
+    if (!indice->pronto) return 1;
+    int i = pool_novo_slot(&indice->pilha);
+    if (i == -1) return 0;
+    *(int *)pool_slot(&indice->pilha, i) = slot;
+    return 1;
+}
+
+/**
+ * @brief Retira um slot livre para reaproveitamento (O(1)).
+ * @param indice Ponteiro para a pilha.
+ * @return int O slot, ou -1 se não há slot livre (ou a pilha não está montada).
+ */
+int indice_livres_retirar(IndiceLivres *indice) {
+    if (!indice->pronto || indice->pilha.usados == 0) return -1;
+    return *(int *)pool_slot(&indice->pilha, --indice->pilha.usados);
+}
+
+/**
+ * @brief Reconstrói a pilha com todos os slots inativos da tabela.
+ * Os slots são empilhados do maior para o menor, então os primeiros a serem
+ * reaproveitados são os do início da tabela.
+ * @param indice Ponteiro para a pilha.
+ * @param tabela Pool da tabela (Turma ou Aluno).
+ * @param pos_ativo Deslocamento do campo 'ativo' no registro (offsetof).
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int indice_livres_reconstruir(IndiceLivres *indice, const PoolRegistros *tabela, size_t pos_ativo) {
+    indice_livres_liberar(indice);
+    indice->pronto = 1;
+
+    for (int i = tabela->usados - 1; i >= 0; i--) {
+        int ativo;
+        memcpy(&ativo, (const char *)pool_slot(tabela, i) + pos_ativo, sizeof(int));
+        if (ativo != 1 && !indice_livres_empilhar(indice, i)) {
+            indice_livres_liberar(indice);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// --- 6. Estatísticas por Turma ---
+
+/**
+ * @brief Inicializa o índice de estatísticas vazio.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_estatisticas_inicializar(IndiceEstatisticas *indice) {
+    pool_inicializar(&indice->turmas, sizeof(EstatisticaTurma));
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Libera a memória do índice de estatísticas.
+ * @param indice Ponteiro para o índice.
+ */
+void indice_estatisticas_liberar(IndiceEstatisticas *indice) {
+    pool_liberar(&indice->turmas);
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Soma a média de um aluno às estatísticas da turma (O(1) amortizado).
+ * @param indice Ponteiro para o índice.
+ * @param slot_turma Slot da turma do aluno.
+ * @param media Média final do aluno.
+ * @return int 1 se bem-sucedido (ou índice ainda não montado), 0 se faltou memória.
+ */
+int indice_estatisticas_incluir(IndiceEstatisticas *indice, int slot_turma, float media) {
+    if (!indice->pronto) return 1;
+    while (indice->turmas.usados <= slot_turma) {
+        int i = pool_novo_slot(&indice->turmas);
+        if (i == -1) return 0;
+        memset(pool_slot_escrita(&indice->turmas, i), 0, sizeof(EstatisticaTurma));
+    }
+
+    EstatisticaTurma *e = pool_slot_escrita(&indice->turmas, slot_turma);
+    e->quantidade++;
+    e->soma += media;
+    e->soma_quadrados += (double)media * media;
+    e->situacoes[politica_situacao(&politica_notas, media)]++;
+    return 1;
+}
+
+/**
+ * @brief Retira a média de um aluno das estatísticas da turma (O(1)).
+ * A média informada deve ser a mesma que foi incluída.
+ * @param indice Ponteiro para o índice.
+ * @param slot_turma Slot da turma do aluno.
+ * @param media Média final do aluno.
+ */
+void indice_estatisticas_retirar(IndiceEstatisticas *indice, int slot_turma, float media) {
+    if (!indice->pronto || slot_turma < 0 || slot_turma >= indice->turmas.usados) return;
+
+    EstatisticaTurma *e = pool_slot_escrita(&indice->turmas, slot_turma);
+    if (--e->quantidade == 0) {
+        // Turma vazia: recomeça do zero (não acumula erro de arredondamento)
+        memset(e, 0, sizeof(*e));
+        return;
+    }
+    e->soma -= media;
+    e->soma_quadrados -= (double)media * media;
+    e->situacoes[politica_situacao(&politica_notas, media)]--;
+}
+
+/**
+ * @brief Zera as estatísticas de uma turma (exclusão em cascata).
+ * @param indice Ponteiro para o índice.
+ * @param slot_turma Slot da turma.
+ */
+void indice_estatisticas_zerar(IndiceEstatisticas *indice, int slot_turma) {
+    if (slot_turma < 0 || slot_turma >= indice->turmas.usados) return;
+    memset(pool_slot_escrita(&indice->turmas, slot_turma), 0, sizeof(EstatisticaTurma));
+}
+
+/**
+ * @brief Reconstrói as estatísticas a partir de todos os alunos ativos (O(n)).
+ * Alunos cuja turma não está ativa não são contados.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int indice_estatisticas_reconstruir(const DadosSistema *sistema, IndiceEstatisticas *indice) {
+    indice_estatisticas_liberar(indice);
+    const ColunasNotas *colunas = colunas_montadas(sistema);
+    if (colunas == NULL) return 0;
+    indice->pronto = 1;
+
+    for (int i = colunas_proximo_ativo(colunas, 0); i != -1; i = colunas_proximo_ativo(colunas, i + 1)) {
+        int slot_turma = buscar_turma_por_id(sistema, colunas->id_turma[i]);
+        if (slot_turma != -1 && !indice_estatisticas_incluir(indice, slot_turma, colunas->media[i])) {
+            indice_estatisticas_liberar(indice);
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,165 @@
+#ifndef INDICES_H
+#define INDICES_H
+
+#include "armazenamento.h"
+
+// --- Índices em Memória ---
+//
+// Estruturas auxiliares derivadas das tabelas e mantidas em sincronia pelas
+// funções de CREATE/UPDATE/DELETE de servicos.c. Nada aqui é gravado no arquivo
+// de dados. Cada índice é montado sob demanda (no primeiro uso, não na carga):
+// enquanto 'pronto' for 0, inserções e remoções são ignoradas, pois a
+// reconstrução lerá o estado atual das tabelas.
+
+struct DadosSistema;
+
+// Índice hash (endereçamento aberto, sondagem linear) do RA para o slot do aluno.
+typedef struct {
+    int *slots;           // Slot do aluno em cada posição da tabela (-1 = posição vazia)
+    unsigned *hashes;     // Hash do RA guardado junto, evita strcmp na maioria das colisões
+    int capacidade;       // Potência de 2 (0 enquanto a tabela não foi alocada)
+    int ocupados;         // Entradas válidas
+    int pronto;           // 1 depois de montado por indice_ra_reconstruir
+} IndiceRA;
+
+void indice_ra_inicializar(IndiceRA *indice);
+void indice_ra_liberar(IndiceRA *indice);
+int indice_ra_inserir(const struct DadosSistema *sistema, IndiceRA *indice, int slot);
+int indice_ra_buscar(const struct DadosSistema *sistema, const IndiceRA *indice, const char *ra);
+void indice_ra_remover(const struct DadosSistema *sistema, IndiceRA *indice, const char *ra);
+int indice_ra_reconstruir(const struct DadosSistema *sistema, IndiceRA *indice);
+
+// Índice de membros por turma: uma lista duplamente encadeada por slot de turma,
+// com os elos guardados fora do registro Aluno (um par de elos por slot de aluno).
+// Todos os campos usam -1 como "nenhum".
+typedef struct {
+    int turma;            // Slot da turma em cuja lista o aluno está (-1 = em nenhuma)
+    int anterior;         // Slot do aluno anterior na lista
+    int proximo;          // Slot do próximo aluno na lista
+} ElosMembro;
+
+typedef struct {
+    int primeiro;         // Slot do primeiro aluno da turma
+    int ultimo;           // Slot do último aluno da turma
+    int quantidade;       // Alunos na lista
+} ListaMembros;
+
+typedef struct {
+    PoolRegistros elos;   // ElosMembro, indexado pelo slot do aluno
+    PoolRegistros listas; // ListaMembros, indexado pelo slot da turma
+    int pronto;           // 1 depois de montado por indice_turmas_reconstruir
+} IndiceTurmas;
+
+void indice_turmas_inicializar(IndiceTurmas *indice);
+void indice_turmas_liberar(IndiceTurmas *indice);
+int indice_turmas_inserir(IndiceTurmas *indice, int slot_aluno, int slot_turma);
+void indice_turmas_remover(IndiceTurmas *indice, int slot_aluno);
+void indice_turmas_esvaziar(IndiceTurmas *indice, int slot_turma);
+int indice_turmas_reconstruir(const struct DadosSistema *sistema, IndiceTurmas *indice);
+
+/**
+ * @brief Primeiro aluno (slot) da lista de uma turma, ou -1 se a lista estiver vazia.
+ */
+static inline int indice_turmas_primeiro(const IndiceTurmas *indice, int slot_turma) {
+    if (slot_turma >= indice->listas.usados) return -1;
+    return ((const ListaMembros *)pool_slot(&indice->listas, slot_turma))->primeiro;
+}
+
+/**
+ * @brief Aluno (slot) seguinte na mesma lista de turma, ou -1 no fim da lista.
+ */
+static inline int indice_turmas_proximo(const IndiceTurmas *indice, int slot_aluno) {
+    return ((const ElosMembro *)pool_slot(&indice->elos, slot_aluno))->proximo;
+}
+
+// Índice ordenado por nome: treap (árvore binária de busca balanceada por
+// prioridades pseudoaleatórias) cujos nós são os próprios slots de alunos.
+// A chave é (nome, slot), então nomes repetidos são permitidos.
+typedef struct {
+    int esquerda;         // Slot do filho à esquerda (-1 = nenhum)
+    int direita;          // Slot do filho à direita (-1 = nenhum)
+} NoNome;
+
+typedef struct {
+    PoolRegistros nos;    // NoNome, indexado pelo slot do aluno
+    int raiz;             // Slot do aluno na raiz (-1 = árvore vazia)
+    int pronto;           // 1 depois de montado por indice_nomes_reconstruir
+} IndiceNomes;
+
+// Chamada para cada aluno visitado em ordem alfabética; retornar 0 interrompe o percurso.
+typedef int (*VisitaAluno)(const struct DadosSistema *sistema, int slot, void *contexto);
+
+void indice_nomes_inicializar(IndiceNomes *indice);
+void indice_nomes_liberar(IndiceNomes *indice);
+int indice_nomes_inserir(const struct DadosSistema *sistema, IndiceNomes *indice, int slot);
+void indice_nomes_remover(const struct DadosSistema *sistema, IndiceNomes *indice, int slot);
+int indice_nomes_reconstruir(const struct DadosSistema *sistema, IndiceNomes *indice);
+int indice_nomes_percorrer(const struct DadosSistema *sistema, const IndiceNomes *indice,
+                           const char *prefixo, VisitaAluno visita, void *contexto);
+
+// Índice dos IDs de turma (endereçamento direto): ID -> slot. O ID não é
+// derivado do slot, pois slots liberados são reaproveitados e a compactação
+// move as turmas; cada turma mantém o seu ID e IDs não são reutilizados.
+typedef struct {
+    PoolRegistros slots;  // int, indexado por ID - 1: slot da turma (-1 = nenhuma)
+    int maior_id;         // Maior ID encontrado nas turmas (ativas ou não)
+    int pronto;           // 1 depois de montado por indice_ids_reconstruir
+} IndiceIds;
+
+void indice_ids_inicializar(IndiceIds *indice);
+void indice_ids_liberar(IndiceIds *indice);
+int indice_ids_definir(IndiceIds *indice, int id, int slot);
+int indice_ids_reconstruir(const struct DadosSistema *sistema, IndiceIds *indice);
+
+/**
+ * @brief Slot da turma com o ID informado (O(1)), ou -1 se o ID não existe.
+ */
+static inline int indice_ids_buscar(const IndiceIds *indice, int id) {
+    if (id <= 0 || id > indice->slots.usados) return -1;
+    return *(const int *)pool_slot(&indice->slots, id - 1);
+}
+
+// Slots livres de uma tabela (registros inativos), numa pilha: a inserção
+// reaproveita um slot em O(1) em vez de procurar um registro com ativo == 0.
+typedef struct {
+    PoolRegistros pilha;  // int: slots livres (o topo é o último)
+    int pronto;           // 1 depois de montada por indice_livres_reconstruir
+} IndiceLivres;
+
+void indice_livres_inicializar(IndiceLivres *indice);
+void indice_livres_liberar(IndiceLivres *indice);
+int indice_livres_empilhar(IndiceLivres *indice, int slot);
+int indice_livres_retirar(IndiceLivres *indice);
+int indice_livres_reconstruir(IndiceLivres *indice, const PoolRegistros *tabela, size_t pos_ativo);
+
+// Estatísticas por turma: somas e contagens das médias dos alunos ativos de
+// cada turma, atualizadas em O(1) a cada lançamento, transferência e exclusão.
+// Média e desvio padrão saem das somas, sem percorrer os alunos.
+typedef struct {
+    int quantidade;         // Alunos ativos na turma
+    double soma;            // Soma das médias finais
+    double soma_quadrados;  // Soma dos quadrados das médias finais
+    int situacoes[3];       // Alunos por situação (indexado por SITUACAO_*, ver colunas.h)
+} EstatisticaTurma;
+
+typedef struct {
+    PoolRegistros turmas; // EstatisticaTurma, indexado pelo slot da turma
+    int pronto;           // 1 depois de montado por indice_estatisticas_reconstruir
+} IndiceEstatisticas;
+
+void indice_estatisticas_inicializar(IndiceEstatisticas *indice);
+void indice_estatisticas_liberar(IndiceEstatisticas *indice);
+int indice_estatisticas_incluir(IndiceEstatisticas *indice, int slot_turma, float media);
+void indice_estatisticas_retirar(IndiceEstatisticas *indice, int slot_turma, float media);
+void indice_estatisticas_zerar(IndiceEstatisticas *indice, int slot_turma);
+int indice_estatisticas_reconstruir(const struct DadosSistema *sistema, IndiceEstatisticas *indice);
+
+/**
+ * @brief Estatísticas de uma turma (O(1)), ou NULL se a turma ainda não tem nenhum aluno contado.
+ */
+static inline const EstatisticaTurma *indice_estatisticas_turma(const IndiceEstatisticas *indice, int slot_turma) {
+    if (slot_turma < 0 || slot_turma >= indice->turmas.usados) return NULL;
+    return pool_slot(&indice->turmas, slot_turma);
+}
+
+#endif // INDICES_H
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include "lote.h"
+
+#define MAX_CAMPOS_LOTE 8
+
+// --- 1. Leitura de Campos ---
+
+/**
+ * @brief Separa uma linha CSV em campos, no próprio buffer da linha.
+ * Campos entre aspas podem conter vírgulas; "" dentro deles vira uma aspa.
+ * @param linha Linha terminada em '\0' (é modificada).
+ * @param campos Recebe o início de cada campo.
+ * @param max Tamanho do vetor 'campos'.
+ * @return int Número de campos, ou -1 se as aspas estiverem malformadas ou houver campos demais.
+ */
+static int separar_campos(char *linha, char **campos, int max) {
+    int n = 0;
+    char *p = linha;
+
+    for (;;) {
+        if (n == max) return -1;
+        if (*p == '"') {
+            // Campo entre aspas: copia para trás, desfazendo as aspas dobradas
+            char *escrita = ++p;
+            campos[n++] = escrita;
+            for (;;) {
+                if (*p == '\0') return -1; // Aspas não fechadas
+                if (*p == '"') {
+                    if (p[1] != '"') break;
+                    p++;
+                }
+                *escrita++ = *p++;
+            }
+            p++; // Aspas de fechamento
+            if (*p != ',' && *p != '\0') return -1;
+            *escrita = '\0';
+        } else {
+            campos[n++] = p;
+            while (*p != ',' && *p != '\0') p++;
+        }
+        if (*p == '\0') return n;
+        *p++ = '\0';
+    }
+}
+
+/**
+ * @brief Converte um campo inteiro (o campo inteiro precisa ser numérico).
+ * @return int 1 se válido, 0 caso contrário.
+ */
+static int ler_inteiro(const char *texto, int *valor) {
+    char *fim;
+    errno = 0;
+    long v = strtol(texto, &fim, 10);
+    if (fim == texto || *fim != '\0' || errno != 0 || v < INT_MIN || v > INT_MAX) return 0;
+    *valor = (int)v;
+    return 1;
+}
+
+/**
+ * @brief Converte uma nota (número entre 0 e 10).
+ * @return int 1 se válida, 0 caso contrário.
+ */
+static int ler_nota(const char *texto, float *valor) {
+    char *fim;
+    float v = strtof(texto, &fim);
+    if (fim == texto || *fim != '\0' || !(v >= 0.0f && v <= 10.0f)) return 0;
+    *valor = v;
+    return 1;
+}
+
+// --- 2. Processamento das Linhas ---
+
+/**
+ * @brief Relata uma linha rejeitada (o motivo pode vir de ultima_mensagem, já com "ERRO: ").
+ */
+static void rejeitar(ResumoLote *resumo, long numero, const char *motivo) {
+    if (strncmp(motivo, "ERRO: ", 6) == 0) motivo += 6;
+    printf("ERRO (linha %ld): %s\n", numero, motivo);
+    resumo->erros++;
+}
+
+/**
+ * @brief Valida e executa uma linha de dados.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param linha Linha sem a quebra de linha (é modificada).
+ * @param numero Número da linha no arquivo (para o relatório).
+ * @param nivel_acesso Nível de quem importa (repassado ao lançamento de notas).
+ * @param resumo Contadores da importação.
+ */
+static void processar_linha(DadosSistema *sistema, char *linha, long numero, int nivel_acesso, ResumoLote *resumo) {
+    if (linha[0] == '\0' || linha[0] == '#') return;
+
+    char *campos[MAX_CAMPOS_LOTE];
+    int n = separar_campos(linha, campos, MAX_CAMPOS_LOTE);
+    if (numero == 1 && n > 0 && strcmp(campos[0], "tipo") == 0) return; // Cabeçalho
+
+    resumo->linhas++;
+    if (n < 0) {
+        rejeitar(resumo, numero, "Aspas malformadas ou campos demais.");
+        return;
+    }
+
+    if (strcmp(campos[0], "turma") == 0) {
+        int vagas;
+        if (n != 3) {
+            rejeitar(resumo, numero, "Turma espera 3 campos: turma,nome,vagas.");
+        } else if (campos[1][0] == '\0' || strlen(campos[1]) >= TAM_NOME) {
+            rejeitar(resumo, numero, "Nome da turma vazio ou longo demais.");
+        } else if (!ler_inteiro(campos[2], &vagas)) {
+            rejeitar(resumo, numero, "Numero de vagas invalido.");
+        } else if (!adicionar_turma(sistema, campos[1], vagas)) {
+            rejeitar(resumo, numero, ultima_mensagem());
+        } else {
+            resumo->turmas++;
+        }
+    } else if (strcmp(campos[0], "aluno") == 0) {
+        int id_turma;
+        if (n != 4) {
+            rejeitar(resumo, numero, "Aluno espera 4 campos: aluno,ra,nome,id_turma.");
+        } else if (campos[1][0] == '\0' || strlen(campos[1]) >= TAM_RA) {
+            rejeitar(resumo, numero, "RA vazio ou longo demais.");
+        } else if (campos[2][0] == '\0' || strlen(campos[2]) >= TAM_NOME) {
+            rejeitar(resumo, numero, "Nome do aluno vazio ou longo demais.");
+        } else if (!ler_inteiro(campos[3], &id_turma)) {
+            rejeitar(resumo, numero, "ID de turma invalido.");
+        } else if (!adicionar_aluno(sistema, campos[2], campos[1], id_turma)) {
+            rejeitar(resumo, numero, ultima_mensagem());
+        } else {
+            resumo->alunos++;
+        }
+    } else if (strcmp(campos[0], "notas") == 0) {
+        float n1, n2, n3;
+        if (n != 5) {
+            rejeitar(resumo, numero, "Notas espera 5 campos: notas,ra,n1,n2,n3.");
+        } else if (!ler_nota(campos[2], &n1) || !ler_nota(campos[3], &n2) || !ler_nota(campos[4], &n3)) {
+            rejeitar(resumo, numero, "Nota invalida (use numeros de 0 a 10).");
+        } else if (!lancar_notas_e_atualizar_media(sistema, campos[1], n1, n2, n3, nivel_acesso)) {
+            rejeitar(resumo, numero, ultima_mensagem());
+        } else {
+            resumo->notas++;
+        }
+    } else {
+        rejeitar(resumo, numero, "Tipo de linha desconhecido (use turma, aluno ou notas).");
+    }
+}
+
+// --- 3. Importação ---
+
+/**
+ * @brief Importa um arquivo CSV inteiro (formato em lote.h), sem gravar nada.
+ * A entrada é lida em blocos de TAM_BUFFER_LOTE e as linhas são processadas
+ * direto no buffer. Durante a importação as operações ficam em modo silencioso
+ * e os índices de nomes e de membros são descartados: eles são remontados de
+ * uma vez no primeiro uso, o que sai mais barato que mantê-los linha a linha.
+ * Quem chama grava o resultado uma única vez (main.c usa uma transação, ver transacao.h).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param entrada Arquivo CSV aberto para leitura.
+ * @param nivel_acesso Nível do usuário autenticado; quem chama recusa níveis abaixo de NIVEL_PROFESSOR.
+ * @param resumo Recebe os contadores da importação.
+ * @return int 1 se a entrada foi lida até o fim, 0 em caso de falha de leitura ou de memória.
+ */
+int importar_csv(DadosSistema *sistema, FILE *entrada, int nivel_acesso, ResumoLote *resumo) {
+    memset(resumo, 0, sizeof(*resumo));
+    char *buffer = malloc(TAM_BUFFER_LOTE + 1);
+    if (buffer == NULL) {
+        printf("ERRO: Memoria insuficiente para a importacao.\n");
+        return 0;
+    }
+
+    indice_nomes_liberar(&sistema->nomes);
+    indice_turmas_liberar(&sistema->membros);
+    definir_modo_silencioso(1);
+
+    size_t pendente = 0;      // Bytes de uma linha incompleta no início do buffer
+    long numero = 0;          // Número da última linha processada
+    int descartando = 0;      // Pulando o resto de uma linha maior que o buffer
+    int fim_da_entrada = 0;
+
+    while (!fim_da_entrada) {
+        size_t pedidos = TAM_BUFFER_LOTE - pendente;
+        size_t lidos = fread(buffer + pendente, 1, pedidos, entrada);
+        fim_da_entrada = lidos < pedidos;
+
+        char *p = buffer;
+        char *limite = buffer + pendente + lidos;
+        while (p < limite) {
+            char *quebra = memchr(p, '\n', (size_t)(limite - p));
+            if (quebra == NULL) {
+                if (!fim_da_entrada) break; // Linha continua no próximo bloco
+                quebra = limite;            // Última linha, sem '\n'
+            }
+            *quebra = '\0';
+            numero++;
+            if (descartando) {
+                descartando = 0;
+            } else {
+                if (quebra > p && quebra[-1] == '\r') quebra[-1] = '\0';
+                processar_linha(sistema, p, numero, nivel_acesso, resumo);
+            }
+            p = quebra + 1;
+        }
+
+        pendente = p < limite ? (size_t)(limite - p) : 0;
+        if (pendente == TAM_BUFFER_LOTE) {
+            // Nenhuma quebra de linha num buffer inteiro: rejeita a linha e pula o resto dela
+            if (!descartando) {
+                resumo->linhas++;
+                rejeitar(resumo, numero + 1, "Linha longa demais.");
+            }
+            descartando = 1;
+            pendente = 0;
+        } else if (pendente > 0) {
+            memmove(buffer, p, pendente);
+        }
+    }
+
+    definir_modo_silencioso(0);
+    free(buffer);
+
+    if (ferror(entrada)) {
+        printf("ERRO: Falha de leitura na linha %ld da entrada.\n", numero + 1);
+        return 0;
+    }
+    return 1;
+}
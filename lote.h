@@ -0,0 +1,35 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <stdio.h>
+#include "servicos.h"
+
+// --- Importação em Lote (CSV) ---
+//
+// Uma linha por operação, com o tipo no primeiro campo:
+//
+//   turma,<nome>,<vagas>
+//   aluno,<ra>,<nome>,<id_turma>
+//   notas,<ra>,<n1>,<n2>,<n3>
+//
+// Campos podem vir entre aspas ("Silva, Ana"; aspas internas dobradas: "").
+// Linhas vazias, linhas começando com '#' e um cabeçalho cujo primeiro campo
+// é "tipo" são ignorados. Cada linha passa pelas mesmas funções do menu
+// (adicionar_turma, adicionar_aluno, lancar_notas_e_atualizar_media); uma linha
+// inválida é relatada com o número da linha e não interrompe a importação.
+// A importação exige um usuário de nível professor ou administrador (main.c
+// autentica --login/--senha antes de chamar importar_csv).
+
+#define TAM_BUFFER_LOTE (1 << 20) // Leitura em blocos de 1 MB
+
+typedef struct {
+    long linhas;          // Linhas de dados lidas (sem vazias, comentários e cabeçalho)
+    long turmas;          // Turmas cadastradas
+    long alunos;          // Alunos cadastrados
+    long notas;           // Lançamentos de notas aceitos
+    long erros;           // Linhas rejeitadas
+} ResumoLote;
+
+int importar_csv(DadosSistema *sistema, FILE *entrada, int nivel_acesso, ResumoLote *resumo);
+
+#endif // LOTE_H
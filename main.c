@@ -1,7 +1,24 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
 #include <string.h>
+#include <time.h>
 #include "servicos.h" // Inclui o cabeçalho que define estruturas (DadosSistema) e funções de serviço.
+#include "lote.h"
+#include "exportacao.h"
+#include "consultas.h"
+#include "servidor.h"
+#include "protocolo.h"
+#include "metricas.h"
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fdopen _fdopen
+#else
+#include <unistd.h>
+#endif
 
 // --- Função Auxiliar ---
 
@@ -15,23 +32,338 @@ void limpar_buffer() {
     while ((c = getchar()) != '\n' && c != EOF);
 }
 
+/**
+ * @brief Lê o valor inteiro da opção argv[i] ("--opcao N"), como o benchmark:
+ * falta de valor, texto não numérico ou valor abaixo do mínimo são recusados.
+ * @param minimo Menor valor aceito.
+ * @param valor Recebe o valor.
+ * @return int 1 se lido, 0 caso contrário (a mensagem de erro já foi exibida).
+ */
+static int ler_opcao_inteira(int argc, char *argv[], int i, long minimo, int *valor) {
+    if (i + 1 >= argc) {
+        printf("ERRO: Falta o valor de '%s'.\n", argv[i]);
+        return 0;
+    }
+    char *fim;
+    errno = 0;
+    long v = strtol(argv[i + 1], &fim, 10);
+    if (fim == argv[i + 1] || *fim != '\0' || errno != 0 || v < minimo || v > INT_MAX) {
+        printf("ERRO: Valor invalido para '%s': '%s' (use um inteiro a partir de %ld).\n", argv[i], argv[i + 1], minimo);
+        return 0;
+    }
+    *valor = (int)v;
+    return 1;
+}
+
+/**
+ * @brief Modo em lote: importa um CSV (ou a entrada padrão, com "-") e grava uma única vez.
+ * A importação é uma transação: se a leitura falhar no meio, nada do arquivo fica.
+ * @param nivel_acesso Nível do usuário autenticado (professor ou administrador).
+ * @return int Código de saída: 0 se todas as linhas foram aceitas, 1 caso contrário.
+ */
+int executar_importacao(DadosSistema *sistema, const char *caminho, int nivel_acesso) {
+    FILE *entrada = strcmp(caminho, "-") == 0 ? stdin : fopen(caminho, "rb");
+    if (entrada == NULL) {
+        printf("ERRO: Nao foi possivel abrir '%s' para importacao.\n", caminho);
+        return 1;
+    }
+
+    ResumoLote resumo;
+    clock_t inicio = clock();
+    iniciar_transacao(sistema);
+    int lido = importar_csv(sistema, entrada, nivel_acesso, &resumo);
+    double segundos = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+    if (entrada != stdin) fclose(entrada);
+
+    if (!lido) {
+        desfazer_transacao(sistema);
+        printf("AVISO: Importacao desfeita; nenhuma linha foi gravada.\n");
+    } else if (!confirmar_transacao(sistema)) { // Um único commit para o lote inteiro
+        lido = 0;
+    }
+    printf("%s: %ld linhas em %.2f s (%ld turmas, %ld alunos, %ld notas, %ld rejeitadas).\n",
+           (lido && resumo.erros == 0) ? "SUCESSO" : "AVISO",
+           resumo.linhas, segundos, resumo.turmas, resumo.alunos, resumo.notas, resumo.erros);
+    return (lido && resumo.erros == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Reserva a saída padrão para dados: as mensagens do sistema (carga,
+ * avisos) passam a ir para stderr, e o arquivo retornado escreve no stdout original.
+ * @return FILE* Arquivo ligado ao stdout original, ou NULL em caso de falha.
+ */
+FILE *reservar_saida_padrao(void) {
+    fflush(stdout);
+    int fd = dup(fileno(stdout));
+    if (fd < 0) return NULL;
+    if (dup2(fileno(stderr), fileno(stdout)) < 0) return NULL;
+    return fdopen(fd, "wb");
+}
+
+/**
+ * @brief Modo de exportação: grava os relatórios de todas as turmas em CSV ou JSON.
+ * @param formato "csv" ou "json".
+ * @param destino Arquivo aberto para escrita (o stdout reservado, quando o caminho é "-").
+ * @return int Código de saída: 0 se sucesso, 1 caso contrário.
+ */
+int executar_exportacao(const DadosSistema *sistema, const char *formato, FILE *destino) {
+    ResumoExportacao resumo;
+    clock_t inicio = clock();
+    int ok = exportar_relatorios(sistema, destino, strcmp(formato, "json") == 0 ? EXPORTAR_JSON : EXPORTAR_CSV, &resumo);
+    double segundos = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    if (ok) {
+        printf("SUCESSO: %ld turmas e %ld alunos exportados em %.2f s.\n", resumo.turmas, resumo.alunos, segundos);
+    }
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Modo de consulta: grava em CSV os alunos que passam no filtro (sintaxe em consultas.h).
+ * @param texto Filtro, como "turma=3..9 situacao=recup n2<4".
+ * @param destino Arquivo aberto para escrita (o stdout reservado, quando o caminho é "-").
+ * @return int Código de saída: 0 se sucesso, 1 caso contrário.
+ */
+int executar_consulta(const DadosSistema *sistema, const char *texto, FILE *destino) {
+    FiltroAlunos filtro;
+    const char *erro;
+    if (!filtro_interpretar(texto, &filtro, &erro)) {
+        printf("ERRO: %s\n", erro);
+        return 1;
+    }
+
+    long total;
+    clock_t inicio = clock();
+    int plano = planejar_consulta(sistema, &filtro);
+    int ok = exportar_consulta(sistema, &filtro, destino, &total);
+    double segundos = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    if (ok) {
+        printf("SUCESSO: %ld alunos encontrados em %.3f s (plano: %s).\n", total, segundos, nome_plano(plano));
+    }
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Modo de comandos: executa os pedidos de um arquivo (ou da entrada
+ * padrão, com "-") pelo protocolo em linha e grava uma única vez no fim.
+ * A sessão começa sem login: o primeiro pedido precisa ser LOGIN login;senha.
+ * @param destino Arquivo das respostas (o stdout reservado).
+ * @return int Código de saída: 0 se nenhum pedido foi respondido com ERRO, 1 caso contrário.
+ */
+int executar_modo_comandos(DadosSistema *sistema, const char *caminho, FILE *destino) {
+    FILE *entrada = strcmp(caminho, "-") == 0 ? stdin : fopen(caminho, "rb");
+    if (entrada == NULL) {
+        printf("ERRO: Nao foi possivel abrir '%s' para leitura dos comandos.\n", caminho);
+        return 1;
+    }
+
+    ResumoComandos resumo;
+    clock_t inicio = clock();
+    int lido = executar_comandos(sistema, entrada, destino, &resumo);
+    double segundos = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+    if (entrada != stdin) fclose(entrada);
+
+    salvar_dados(sistema); // Um único commit para todos os pedidos
+    printf("%s: %ld pedidos em %.2f s (%ld com erro).\n",
+           (lido && resumo.erros == 0) ? "SUCESSO" : "AVISO", resumo.pedidos, segundos, resumo.erros);
+    return (lido && resumo.erros == 0) ? 0 : 1;
+}
+
 // --- Função Principal ---
 
-int main() {
+int main(int argc, char *argv[]) {
     DadosSistema sistema;           // Estrutura principal que armazena todos os dados (alunos, turmas).
     int opcao;                      // Variável para armazenar a opção escolhida no menu.
     int nivel_acesso = -1;          // -1 significa que o usuário ainda não está logado.
-    
+    Gravador gravador;              // Grava o diário em segundo plano durante o menu.
+
+    // Com "--exportar <csv|json> [arquivo|-]", só exporta os relatórios e encerra.
+    // O destino é aberto antes da carga: exportando para o stdout, as mensagens
+    // da carga vão para stderr e não se misturam aos dados.
+    const char *formato_exportacao = NULL;
+    FILE *destino_exportacao = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--exportar") != 0) continue;
+        formato_exportacao = i + 1 < argc ? argv[i + 1] : "";
+        if (strcmp(formato_exportacao, "csv") != 0 && strcmp(formato_exportacao, "json") != 0) {
+            printf("ERRO: Use --exportar csv ou --exportar json, seguido do arquivo (ou '-' para a saida padrao).\n");
+            return 1;
+        }
+        const char *caminho = (i + 2 < argc && strncmp(argv[i + 2], "--", 2) != 0) ? argv[i + 2] : "-";
+        destino_exportacao = strcmp(caminho, "-") == 0 ? reservar_saida_padrao() : fopen(caminho, "wb");
+        if (destino_exportacao == NULL) {
+            printf("ERRO: Nao foi possivel abrir '%s' para exportacao.\n", caminho);
+            return 1;
+        }
+        break;
+    }
+
+    // Com "--consultar <filtro> [arquivo|-]", grava em CSV os alunos que passam
+    // no filtro e encerra (saída padrão reservada como na exportação).
+    const char *filtro_consulta = NULL;
+    FILE *destino_consulta = NULL;
+    for (int i = 1; i < argc && formato_exportacao == NULL; i++) {
+        if (strcmp(argv[i], "--consultar") != 0) continue;
+        if (i + 1 >= argc) {
+            printf("ERRO: Informe o filtro apos --consultar (ex: \"turma=3..9 situacao=recup n2<4\").\n");
+            return 1;
+        }
+        filtro_consulta = argv[i + 1];
+        const char *caminho = (i + 2 < argc && strncmp(argv[i + 2], "--", 2) != 0) ? argv[i + 2] : "-";
+        destino_consulta = strcmp(caminho, "-") == 0 ? reservar_saida_padrao() : fopen(caminho, "wb");
+        if (destino_consulta == NULL) {
+            printf("ERRO: Nao foi possivel abrir '%s' para a consulta.\n", caminho);
+            return 1;
+        }
+        break;
+    }
+
+    // Com "--comandos <arquivo|->", executa os pedidos do protocolo em linha
+    // (protocolo.h) e encerra. As respostas vão para o stdout, reservado antes
+    // da carga como na exportação.
+    const char *arquivo_comandos = NULL;
+    FILE *destino_comandos = NULL;
+    for (int i = 1; i < argc && formato_exportacao == NULL && filtro_consulta == NULL; i++) {
+        if (strcmp(argv[i], "--comandos") != 0) continue;
+        if (i + 1 >= argc) {
+            printf("ERRO: Informe o arquivo de comandos apos --comandos (ou '-' para a entrada padrao).\n");
+            return 1;
+        }
+        arquivo_comandos = argv[i + 1];
+        destino_comandos = reservar_saida_padrao();
+        if (destino_comandos == NULL) {
+            printf("ERRO: Nao foi possivel reservar a saida padrao para as respostas.\n");
+            return 1;
+        }
+        break;
+    }
+
+    // Com "--metricas <arquivo>", as métricas das operações são gravadas em CSV
+    // quando o programa termina (em qualquer modo).
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--metricas") != 0) continue;
+        if (i + 1 >= argc || !metricas_gravar_ao_sair(argv[i + 1])) {
+            printf("ERRO: Informe o arquivo apos --metricas.\n");
+            return 1;
+        }
+    }
+
+    // Com "--confirmacoes-por-fsync N", o diário faz um fsync a cada N
+    // confirmações (group commit; padrão 1 = toda confirmação durável). Vale
+    // onde o diário é gravado no próprio salvar_dados: servidor, comandos e
+    // menu sem o gravador; no menu com gravador, a thread já junta as confirmações.
+    int confirmacoes_por_fsync = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--confirmacoes-por-fsync") == 0 &&
+            !ler_opcao_inteira(argc, argv, i, 1, &confirmacoes_por_fsync)) {
+            return 1;
+        }
+    }
+
+    // No menu, o diário é gravado por uma thread em segundo plano, que junta as
+    // confirmações de até "--atraso-gravacao <ms>" (padrão ATRASO_GRAVACAO_PADRAO_MS;
+    // 0 = grava assim que chega; -1 = sem thread, grava no próprio salvar_dados).
+    int atraso_gravacao = ATRASO_GRAVACAO_PADRAO_MS;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--atraso-gravacao") == 0 && !ler_opcao_inteira(argc, argv, i, -1, &atraso_gravacao)) {
+            return 1;
+        }
+    }
+
     // 1. Carrega dados persistentes (de arquivo) para a estrutura do sistema.
     carregar_dados(&sistema);
+    diario_definir_group_commit(&sistema.diario, confirmacoes_por_fsync);
+
+    // Com "--mmap", as tabelas passam para arquivos mapeados em memória; com
+    // "--fragmentar", para um catálogo e um segmento por turma (os dois modos
+    // ficam ativos nas próximas execuções, mesmo sem a opção).
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mmap") == 0) ativar_modo_mapeado(&sistema);
+        if (strcmp(argv[i], "--fragmentar") == 0) ativar_modo_fragmentado(&sistema);
+    }
+
+    if (formato_exportacao != NULL) {
+        int codigo = executar_exportacao(&sistema, formato_exportacao, destino_exportacao);
+        if (fclose(destino_exportacao) != 0) codigo = 1;
+        liberar_dados(&sistema);
+        return codigo;
+    }
+
+    if (filtro_consulta != NULL) {
+        int codigo = executar_consulta(&sistema, filtro_consulta, destino_consulta);
+        if (fclose(destino_consulta) != 0) codigo = 1;
+        liberar_dados(&sistema);
+        return codigo;
+    }
+
+    if (arquivo_comandos != NULL) {
+        int codigo = executar_modo_comandos(&sistema, arquivo_comandos, destino_comandos);
+        if (fclose(destino_comandos) != 0) codigo = 1;
+        liberar_dados(&sistema);
+        return codigo;
+    }
+
+    // Com "--importar <arquivo.csv|->", roda só a importação em lote e encerra.
+    // Exige "--login <login> --senha <senha>" de um professor ou administrador.
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--importar") == 0) {
+            if (i + 1 >= argc) {
+                printf("ERRO: Informe o arquivo CSV apos --importar (ou '-' para a entrada padrao).\n");
+                liberar_dados(&sistema);
+                return 1;
+            }
+            const char *login = NULL, *senha = NULL;
+            for (int j = 1; j + 1 < argc; j++) {
+                if (strcmp(argv[j], "--login") == 0) login = argv[j + 1];
+                else if (strcmp(argv[j], "--senha") == 0) senha = argv[j + 1];
+            }
+            int nivel_importacao = (login != NULL && senha != NULL) ? autenticar_usuario(login, senha) : -1;
+            if (login == NULL || senha == NULL) {
+                printf("ERRO: Informe --login e --senha para importar.\n");
+            } else if (nivel_importacao == -1) {
+                printf("ERRO: Usuario ou senha invalidos.\n");
+            } else if (nivel_importacao < NIVEL_PROFESSOR) {
+                printf("ERRO: A importacao exige nivel de professor ou administrador.\n");
+            }
+            if (nivel_importacao < NIVEL_PROFESSOR) {
+                liberar_dados(&sistema);
+                return 1;
+            }
+            int codigo = executar_importacao(&sistema, argv[i + 1], nivel_importacao);
+            liberar_dados(&sistema);
+            return codigo;
+        }
+    }
+
+    // Com "--servidor [caminho]", atende clientes pelo socket Unix até receber
+    // SIGINT/SIGTERM ("--trabalhadores N" fixa o número de threads).
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--servidor") == 0) {
+            const char *caminho = (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) ? argv[i + 1] : CAMINHO_SOCKET_PADRAO;
+            int trabalhadores = 0;
+            for (int j = 1; j + 1 < argc; j++) {
+                if (strcmp(argv[j], "--trabalhadores") == 0) trabalhadores = atoi(argv[j + 1]);
+            }
+            int codigo = executar_servidor(&sistema, caminho, trabalhadores);
+            salvar_dados(&sistema);
+            liberar_dados(&sistema);
+            return codigo;
+        }
+    }
 
     // 2. Tenta logar o usuário antes de iniciar o loop principal.
     if (!realizar_login(&nivel_acesso)) {
         // Se a função realizar_login retornar 0 (falha), encerra o programa.
         printf("Falha no login ou usuario/senha invalidos. Encerrando o sistema.\n");
+        liberar_dados(&sistema);
         return 1; 
     }
 
+    // No menu, o diário é gravado pela thread do gravador (atraso lido acima).
+    // A opção 17 e a saída esperam a fila.
+    if (atraso_gravacao >= 0) iniciar_gravador(&sistema, &gravador, atraso_gravacao);
+
     // 3. Loop principal do menu (Continua até que a opção de 'Sair' seja escolhida)
     do {
         // 3.1. Exibe o cabeçalho do menu, identificando o nível de acesso do usuário.
@@ -41,7 +373,7 @@ int main() {
                "ALUNO");                                         // Caso contrário (ALUNO)
                
         // Exibe o status atual do sistema (quantas turmas/alunos cadastrados).
-        printf("Turmas: %d / %d | Alunos: %d / %d\n", sistema.total_turmas, MAX_TURMAS, sistema.total_alunos, MAX_ALUNOS);
+        printf("Turmas: %d | Alunos: %d\n", sistema.total_turmas, sistema.total_alunos);
         printf("-----------------------------\n");
         
         // --- Opções Comuns a Professor e Admin (CRUD de dados) ---
@@ -54,18 +386,28 @@ int main() {
 
         // --- Opções Comuns a Todos ---
         printf("4. Gerar Relatorio de Turma (TODOS)\n"); 
+        printf("16. Ranking e Percentis das Medias (Turma ou Geral) (TODOS)\n");
+        printf("12. Estatisticas de Turma (TODOS)\n");
+        printf("14. Buscar por Nome (Trecho ou Aproximado) (TODOS)\n");
+        printf("15. Consultar Alunos por Filtros (Turma, Notas, Situacao, Nome) (TODOS)\n");
+        printf("17. Sincronizar Gravacoes Pendentes no Disco (TODOS)\n");
         
         // --- Opções Exclusivas do Admin (Manutenção e CRUD Total) ---
-        // As opções 5 a 8 só são exibidas se o nível de acesso for ADMINISTRADOR.
+        // As opções 5 a 8 (e as de manutenção, a partir de 10) só são exibidas se o nível de acesso for ADMINISTRADOR.
         if (nivel_acesso == NIVEL_ADMIN) {
-            printf("5. Ordenar Alunos por Nome\n");
+            printf("5. Listar Alunos por Nome (Ordem Alfabetica)\n");
             printf("-----------------------------\n");
             printf("6. EDITAR Dados do Aluno\n");
             printf("7. EXCLUIR Aluno (Logico)\n");
             printf("8. EXCLUIR Turma (Logico + Cascata)\n");
+            printf("13. METRICAS de Operacoes (Contadores e Latencias)\n");
         }
         
         printf("9. Sair\n"); 
+        if (nivel_acesso == NIVEL_ADMIN) {
+            printf("10. COMPACTAR Dados (Remover Excluidos)\n");
+            printf("11. RECALCULAR Medias (Todos os Alunos)\n");
+        }
         printf("Escolha uma opcao: ");
 
         // 3.2. Leitura e tratamento de buffer para a opção escolhida.
@@ -80,9 +422,9 @@ int main() {
         // Verifica se o usuário escolheu uma opção para a qual não tem permissão.
         if (
             (nivel_acesso < NIVEL_PROFESSOR && (opcao >= 1 && opcao <= 3)) || // Bloqueia CRUD (1-3) para ALUNO
-            (nivel_acesso < NIVEL_ADMIN && (opcao >= 5 && opcao <= 8))       // Bloqueia ADMIN features (5-8) para PROF/ALUNO
+            (nivel_acesso < NIVEL_ADMIN && ((opcao >= 5 && opcao <= 8) || opcao >= 10)) // Bloqueia ADMIN features (5-8, 10+) para PROF/ALUNO
         ) {
-            if (opcao != 4 && opcao != 9) { // Permite 4 (Relatório) e 9 (Sair), mesmo que estejam no range.
+            if (opcao != 4 && opcao != 9 && opcao != 12 && opcao != 14 && opcao != 15 && opcao != 16 && opcao != 17) { // Permite 4 (Relatório), 9 (Sair), 12 (Estatísticas), 14 (Busca), 15 (Consulta), 16 (Ranking) e 17 (Sincronizar), mesmo que estejam no range.
                 printf("ACESSO NEGADO: Esta opcao nao esta disponivel para seu nivel de usuario.\n");
                 continue; // Pula o resto do loop e volta para o início do menu.
             }
@@ -105,7 +447,7 @@ int main() {
                     printf("SUCESSO: Turma '%s' cadastrada.\n", nome); 
                     salvar_dados(&sistema); // Salva as alterações no arquivo.
                 } else {
-                    printf("ERRO: Nao foi possivel cadastrar a turma (limite atingido ou erro interno).\n");
+                    printf("ERRO: Nao foi possivel cadastrar a turma.\n");
                 }
                 break;
             }
@@ -167,14 +509,18 @@ int main() {
                 gerar_relatorio_turma(&sistema, id_turma);
                 break;
             }
-            case 5: { // Ordenar Alunos por Nome (ADMIN)
+            case 5: { // Listar Alunos por Nome (ADMIN)
                 if (sistema.total_alunos == 0) { 
-                    printf("AVISO: Nao ha alunos para ordenar.\n"); 
+                    printf("AVISO: Nao ha alunos para listar.\n"); 
                     break; 
                 }
-                ordenar_alunos_por_nome(&sistema); // Chama a função de ordenação (ex: Quicksort, Bubble Sort).
-                salvar_dados(&sistema); 
-                printf("SUCESSO: Lista de alunos ordenada por nome e salva.\n");
+                char prefixo[TAM_NOME];
+                printf("Prefixo do Nome (Deixe Vazio para listar todos): ");
+                fgets(prefixo, TAM_NOME, stdin);
+                prefixo[strcspn(prefixo, "\n")] = 0;
+
+                // A ordem alfabética vem do índice de nomes: nenhum registro é movido nem salvo.
+                listar_alunos_por_nome(&sistema, prefixo);
                 break;
             }
             case 6: { // EDITAR Dados do Aluno (ADMIN)
@@ -228,8 +574,91 @@ int main() {
             case 9: // Sair
                 printf("Encerrando o Sistema Academico...\n");
                 salvar_dados(&sistema); // Garante que a última versão dos dados seja salva.
+                if (!sincronizar_dados(&sistema)) { // Espera o gravador: nada fica só na fila.
+                    printf("ERRO: Nao foi possivel gravar todas as alteracoes.\n");
+                }
+                encerrar_gravador(&sistema);
+                liberar_dados(&sistema); // Devolve a memória das tabelas.
                 printf("Ate logo!\n");
                 break;
+            case 10: // COMPACTAR Dados (ADMIN)
+                // Remove os registros excluídos logicamente e grava o resultado (checkpoint).
+                compactar_dados(&sistema);
+                break;
+            case 11: // RECALCULAR Medias (ADMIN)
+                // Recalcula em massa média e situação de todos os alunos e grava as que mudaram.
+                if (recalcular_medias(&sistema) > 0) {
+                    salvar_dados(&sistema);
+                }
+                break;
+            case 12: { // Estatísticas de Turma (TODOS)
+                int id_turma;
+                listar_todas_turmas(&sistema);
+                printf("ID da Turma para Estatisticas: ");
+                if (scanf("%d", &id_turma) != 1) { limpar_buffer(); printf("ERRO: ID de turma invalido.\n"); break; }
+                limpar_buffer();
+                exibir_estatisticas_turma(&sistema, id_turma);
+                break;
+            }
+            case 13: // METRICAS de Operacoes (ADMIN)
+                metricas_exibir();
+                break;
+            case 14: { // Buscar por Nome (TODOS)
+                char consulta[TAM_NOME];
+                int aproximada;
+                printf("Trecho do nome (turma ou aluno): ");
+                fgets(consulta, TAM_NOME, stdin);
+                consulta[strcspn(consulta, "\n")] = 0;
+                printf("Tipo de busca (0 = contem o trecho, 1 = aproximada): ");
+                if (scanf("%d", &aproximada) != 1 || (aproximada != 0 && aproximada != 1)) {
+                    limpar_buffer();
+                    printf("ERRO: Tipo de busca invalido.\n");
+                    break;
+                }
+                limpar_buffer();
+
+                // Maiúsculas, acentos e pontuação são ignorados; a aproximada tolera erros de digitação.
+                procurar_por_nome(&sistema, consulta, aproximada);
+                break;
+            }
+            case 15: { // Consultar Alunos por Filtros (TODOS)
+                char texto[TAM_NOME];
+                printf("Filtro (ex: turma=3..9 situacao=recup n2<4 nome=Ana): ");
+                fgets(texto, TAM_NOME, stdin);
+                texto[strcspn(texto, "\n")] = 0;
+
+                // Resultado em CSV na tela (ra,nome,id_turma,n1,n2,n3,media,situacao).
+                executar_consulta(&sistema, texto, stdout);
+                break;
+            }
+            case 16: { // Ranking e Percentis das Medias (TODOS)
+                int id_turma, k, ordem;
+                listar_todas_turmas(&sistema);
+                printf("ID da Turma (0 = todas as turmas): ");
+                if (scanf("%d", &id_turma) != 1) { limpar_buffer(); printf("ERRO: ID de turma invalido.\n"); break; }
+                printf("Tamanho do ranking: ");
+                if (scanf("%d", &k) != 1) { limpar_buffer(); printf("ERRO: Tamanho invalido.\n"); break; }
+                printf("Ordem (1 = melhores medias, 0 = piores medias): ");
+                if (scanf("%d", &ordem) != 1 || (ordem != RANKING_MELHORES && ordem != RANKING_PIORES)) {
+                    limpar_buffer();
+                    printf("ERRO: Ordem invalida.\n");
+                    break;
+                }
+                limpar_buffer();
+
+                // Heap de K posições sobre as médias: não ordena a turma (ou a instituição) inteira.
+                exibir_ranking_medias(&sistema, id_turma, k, ordem);
+                exibir_percentis_medias(&sistema, id_turma);
+                break;
+            }
+            case 17: // Sincronizar Gravacoes Pendentes (TODOS)
+                // Barreira: volta quando as alterações já salvas estão no disco, não só na fila do gravador.
+                if (sincronizar_dados(&sistema)) {
+                    printf("SUCESSO: Todas as alteracoes salvas estao gravadas no disco.\n");
+                } else {
+                    printf("ERRO: Nao foi possivel gravar todas as alteracoes.\n");
+                }
+                break;
             default:
                 // Trata opções inválidas (e a opção '0' de entradas não numéricas).
                 printf("Opcao invalida. Por favor, escolha uma opcao valida.\n");
@@ -239,4 +668,4 @@ int main() {
     } while (opcao != 9); // O loop continua enquanto a opção 9 (Sair) não for escolhida.
 
     return 0; // Retorno de sucesso.
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mapeamento.h"
+#include "arquivos.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define ASSINATURA_MAPA 0x4D414753 // "SGAM"
+#define VERSAO_MAPA 1
+
+#ifndef _WIN32
+
+// --- 1. Abertura e Criação ---
+
+/**
+ * @brief Indica se o modo mapeado é suportado nesta plataforma.
+ * @return int 1 se disponível, 0 caso contrário.
+ */
+int mapa_disponivel(void) {
+    return 1;
+}
+
+/**
+ * @brief Verifica se o arquivo mapeado de uma tabela existe.
+ * @param caminho Caminho do arquivo.
+ * @return int 1 se existe, 0 caso contrário.
+ */
+int mapa_existe(const char *caminho) {
+    return access(caminho, F_OK) == 0;
+}
+
+/**
+ * @brief Posição do bloco 'bloco' dentro do arquivo.
+ */
+static off_t deslocamento_bloco(const MapaArquivo *mapa, int bloco) {
+    return (off_t)TAM_CABECALHO_MAPA + (off_t)bloco * (off_t)mapa->tam_bloco;
+}
+
+/**
+ * @brief Cria a descrição do mapeamento para um descritor já aberto.
+ * Recusa tamanhos de bloco que não caem em limites de página (o mmap exige).
+ * @return MapaArquivo* O mapa (sem blocos nem cabeçalho mapeados), ou NULL.
+ */
+static MapaArquivo *novo_mapa(int fd, size_t tam_registro) {
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    size_t tam_bloco = (size_t)REGISTROS_POR_BLOCO * tam_registro;
+    if (TAM_CABECALHO_MAPA % pagina != 0 || tam_bloco % pagina != 0) return NULL;
+
+    MapaArquivo *mapa = malloc(sizeof(MapaArquivo));
+    if (mapa == NULL) return NULL;
+    mapa->fd = fd;
+    mapa->cabecalho = NULL;
+    mapa->tam_bloco = tam_bloco;
+    mapa->pagina = pagina;
+    return mapa;
+}
+
+/**
+ * @brief Mapeia o cabeçalho do arquivo.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+static int mapear_cabecalho(MapaArquivo *mapa) {
+    void *p = mmap(NULL, TAM_CABECALHO_MAPA, PROT_READ | PROT_WRITE, MAP_SHARED, mapa->fd, 0);
+    if (p == MAP_FAILED) return 0;
+    mapa->cabecalho = p;
+    return 1;
+}
+
+/**
+ * @brief Mapeia um bloco que já existe no arquivo.
+ * @return char* Endereço do bloco, ou NULL em caso de falha.
+ */
+static char *mapear_bloco(const MapaArquivo *mapa, int bloco) {
+    void *p = mmap(NULL, mapa->tam_bloco, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   mapa->fd, deslocamento_bloco(mapa, bloco));
+    return p == MAP_FAILED ? NULL : p;
+}
+
+/**
+ * @brief Aumenta o arquivo para caber o bloco informado e o mapeia.
+ * Usado por pool_reservar quando o pool é mapeado (blocos que já estão no
+ * arquivo são só mapeados). O trecho novo do arquivo vem zerado, então os
+ * slots novos nascem inativos como no pool em memória.
+ * @param mapa Ponteiro para o mapa do pool.
+ * @param bloco Índice do bloco a acrescentar (= número atual de blocos).
+ * @return char* Endereço do bloco, ou NULL em caso de falha.
+ */
+char *mapa_novo_bloco(MapaArquivo *mapa, int bloco) {
+    struct stat info;
+    off_t fim = deslocamento_bloco(mapa, bloco + 1);
+    if (fstat(mapa->fd, &info) != 0) return NULL;
+    if (info.st_size < fim && ftruncate(mapa->fd, fim) != 0) return NULL;
+    return mapear_bloco(mapa, bloco);
+}
+
+/**
+ * @brief Mapeia o arquivo de uma tabela num pool vazio (O(número de blocos), sem ler registros).
+ * @param pool Ponteiro para o pool (recém-inicializado, com o tam_registro da tabela).
+ * @param caminho Caminho do arquivo mapeado.
+ * @param ativos Recebe o número de registros ativos gravado no cabeçalho.
+ * @return int 1 se bem-sucedido, 0 se o arquivo não existe, é inválido ou não pôde ser mapeado.
+ */
+int mapa_abrir(PoolRegistros *pool, const char *caminho, int *ativos) {
+    int fd = open(caminho, O_RDWR);
+    if (fd < 0) return 0;
+
+    struct stat info;
+    MapaArquivo *mapa = novo_mapa(fd, pool->tam_registro);
+    if (mapa == NULL || fstat(fd, &info) != 0 || info.st_size < TAM_CABECALHO_MAPA ||
+        !mapear_cabecalho(mapa)) {
+        free(mapa);
+        close(fd);
+        return 0;
+    }
+    pool->mapa = mapa;
+
+    const CabecalhoMapa *cab = mapa->cabecalho;
+    int num_blocos = (int)((info.st_size - TAM_CABECALHO_MAPA) / (off_t)mapa->tam_bloco);
+    if (cab->assinatura != ASSINATURA_MAPA || cab->versao != VERSAO_MAPA ||
+        cab->tam_registro != (int)pool->tam_registro || cab->usados < 0 ||
+        cab->usados > num_blocos * REGISTROS_POR_BLOCO) {
+        pool_liberar(pool);
+        return 0;
+    }
+
+    // Mapeia os blocos já existentes; nenhum registro é lido agora
+    if (!pool_reservar(pool, num_blocos * REGISTROS_POR_BLOCO)) {
+        pool_liberar(pool);
+        return 0;
+    }
+    pool->usados = cab->usados;
+    *ativos = cab->ativos;
+    return 1;
+}
+
+/**
+ * @brief Grava um pool em memória num arquivo mapeado novo e passa o pool a usá-lo.
+ * O arquivo é montado num temporário e renomeado no fim; se algo falhar, o
+ * pool continua em memória, intacto.
+ * @param pool Ponteiro para o pool (em memória).
+ * @param caminho Caminho do arquivo mapeado a criar.
+ * @param ativos Registros ativos, para o cabeçalho.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int mapa_criar(PoolRegistros *pool, const char *caminho, int ativos) {
+    char temporario[256];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+
+    int fd = open(temporario, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return 0;
+
+    MapaArquivo *mapa = novo_mapa(fd, pool->tam_registro);
+    char **blocos = malloc((size_t)(pool->num_blocos > 0 ? pool->num_blocos : 1) * sizeof(char *));
+    int mapeados = 0;
+    int ok = mapa != NULL && blocos != NULL &&
+             ftruncate(fd, deslocamento_bloco(mapa, pool->num_blocos)) == 0 &&
+             mapear_cabecalho(mapa);
+
+    // Copia cada bloco para o seu lugar no arquivo
+    for (; ok && mapeados < pool->num_blocos; mapeados++) {
+        blocos[mapeados] = mapear_bloco(mapa, mapeados);
+        if (blocos[mapeados] == NULL) {
+            ok = 0;
+            break;
+        }
+        memcpy(blocos[mapeados], pool_slot(pool, mapeados << BITS_POR_BLOCO), mapa->tam_bloco);
+    }
+    if (ok) {
+        CabecalhoMapa cab = { ASSINATURA_MAPA, VERSAO_MAPA, (int)pool->tam_registro, pool->usados, ativos, 0 };
+        *mapa->cabecalho = cab;
+        for (int b = 0; ok && b < mapeados; b++) {
+            ok = msync(blocos[b], mapa->tam_bloco, MS_SYNC) == 0;
+        }
+        ok = ok && msync(mapa->cabecalho, TAM_CABECALHO_MAPA, MS_SYNC) == 0 &&
+             arquivo_substituir(temporario, caminho);
+    }
+
+    if (!ok) {
+        for (int b = 0; b < mapeados; b++) munmap(blocos[b], mapa->tam_bloco);
+        if (mapa != NULL && mapa->cabecalho != NULL) munmap(mapa->cabecalho, TAM_CABECALHO_MAPA);
+        free(blocos);
+        free(mapa);
+        close(fd);
+        remove(temporario);
+        return 0;
+    }
+
+    // Troca os blocos em memória pelos mapeados
+    for (int b = 0; b < pool->num_blocos; b++) {
+        free(pool->blocos[b]);
+        pool->blocos[b] = blocos[b];
+    }
+    free(blocos);
+    pool->mapa = mapa;
+    return 1;
+}
+
+// --- 2. Sincronização (msync só do que mudou) ---
+
+/**
+ * @brief Atualiza o cabeçalho com a marca d'água e o total de ativos e o sincroniza.
+ */
+static int sincronizar_cabecalho(const PoolRegistros *pool, int ativos) {
+    MapaArquivo *mapa = pool->mapa;
+    mapa->cabecalho->usados = pool->usados;
+    mapa->cabecalho->ativos = ativos;
+    return msync(mapa->cabecalho, mapa->pagina, MS_SYNC) == 0;
+}
+
+/**
+ * @brief Grava no disco só as páginas que contêm os slots informados.
+ * Páginas vizinhas são agrupadas num único msync.
+ * @param pool Ponteiro para o pool mapeado.
+ * @param slots Slots alterados, em ordem crescente e sem repetição.
+ * @param quantidade Número de slots.
+ * @param ativos Registros ativos, para o cabeçalho.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int mapa_sincronizar_slots(const PoolRegistros *pool, const int *slots, int quantidade, int ativos) {
+    const MapaArquivo *mapa = pool->mapa;
+    size_t mascara_pagina = ~(mapa->pagina - 1);
+    int ok = 1;
+
+    // Intervalo pendente [inicio, fim) dentro do bloco 'bloco_atual'
+    int bloco_atual = -1;
+    size_t inicio = 0, fim = 0;
+
+    for (int i = 0; i < quantidade; i++) {
+        int bloco = slots[i] >> BITS_POR_BLOCO;
+        size_t de = (size_t)(slots[i] & MASCARA_BLOCO) * pool->tam_registro;
+        size_t ate = de + pool->tam_registro;
+        de &= mascara_pagina;
+
+        if (bloco == bloco_atual && de <= fim) {
+            if (ate > fim) fim = ate;
+            continue;
+        }
+        if (bloco_atual != -1) {
+            ok = msync(pool->blocos[bloco_atual] + inicio, fim - inicio, MS_SYNC) == 0 && ok;
+        }
+        bloco_atual = bloco;
+        inicio = de;
+        fim = ate;
+    }
+    if (bloco_atual != -1) {
+        ok = msync(pool->blocos[bloco_atual] + inicio, fim - inicio, MS_SYNC) == 0 && ok;
+    }
+    return sincronizar_cabecalho(pool, ativos) && ok;
+}
+
+/**
+ * @brief Grava no disco todas as páginas alteradas do arquivo (o kernel só escreve as sujas).
+ * @param pool Ponteiro para o pool mapeado.
+ * @param ativos Registros ativos, para o cabeçalho.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int mapa_sincronizar_tudo(const PoolRegistros *pool, int ativos) {
+    int ok = 1;
+    for (int b = 0; b < pool->num_blocos; b++) {
+        ok = msync(pool->blocos[b], pool->mapa->tam_bloco, MS_SYNC) == 0 && ok;
+    }
+    return sincronizar_cabecalho(pool, ativos) && ok;
+}
+
+/**
+ * @brief Desfaz os mapeamentos e fecha o arquivo (chamada por pool_liberar).
+ * Páginas alteradas e não sincronizadas ainda serão gravadas pelo sistema.
+ * @param pool Ponteiro para o pool mapeado.
+ */
+void mapa_fechar(PoolRegistros *pool) {
+    MapaArquivo *mapa = pool->mapa;
+    for (int b = 0; b < pool->num_blocos; b++) {
+        munmap(pool->blocos[b], mapa->tam_bloco);
+    }
+    if (mapa->cabecalho != NULL) munmap(mapa->cabecalho, TAM_CABECALHO_MAPA);
+    close(mapa->fd);
+    free(mapa);
+    pool->mapa = NULL;
+    pool->num_blocos = 0;
+}
+
+#else // _WIN32: sem modo mapeado, o sistema usa o arquivo base + diário
+
+int mapa_disponivel(void) { return 0; }
+int mapa_existe(const char *caminho) { (void)caminho; return 0; }
+int mapa_abrir(PoolRegistros *pool, const char *caminho, int *ativos) {
+    (void)pool; (void)caminho; (void)ativos;
+    return 0;
+}
+int mapa_criar(PoolRegistros *pool, const char *caminho, int ativos) {
+    (void)pool; (void)caminho; (void)ativos;
+    return 0;
+}
+char *mapa_novo_bloco(MapaArquivo *mapa, int bloco) {
+    (void)mapa; (void)bloco;
+    return NULL;
+}
+int mapa_sincronizar_slots(const PoolRegistros *pool, const int *slots, int quantidade, int ativos) {
+    (void)pool; (void)slots; (void)quantidade; (void)ativos;
+    return 0;
+}
+int mapa_sincronizar_tudo(const PoolRegistros *pool, int ativos) {
+    (void)pool; (void)ativos;
+    return 0;
+}
+void mapa_fechar(PoolRegistros *pool) {
+    pool->mapa = NULL;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef MAPEAMENTO_H
+#define MAPEAMENTO_H
+
+#include "armazenamento.h"
+
+// --- Tabelas Mapeadas em Memória (mmap) ---
+//
+// No modo mapeado cada tabela vive num arquivo próprio e os blocos do
+// PoolRegistros apontam direto para o arquivo mapeado: carregar é só abrir e
+// mapear (as páginas vêm do disco sob demanda, no primeiro acesso), e salvar é
+// um msync apenas das páginas que contêm registros alterados.
+//
+// Layout do arquivo: TAM_CABECALHO_MAPA bytes de cabeçalho seguidos dos blocos
+// do pool, um após o outro. Cada bloco é mapeado separadamente, então crescer
+// a tabela só acrescenta um mapeamento e os blocos antigos não mudam de
+// endereço (como no pool em memória). Um bloco tem 4096 registros, portanto
+// ocupa um número inteiro de páginas sempre que sizeof(registro) for múltiplo
+// de página / 4096 (verificado ao abrir).
+//
+// Disponível em sistemas POSIX; no Windows mapa_disponivel() retorna 0 e o
+// sistema continua no modo normal (arquivo base + diário).
+
+#define NOME_MAPA_TURMAS "dados_turmas.map"
+#define NOME_MAPA_ALUNOS "dados_alunos.map"
+#define NOME_MAPA_TEXTOS "dados_textos.map" // Heap dos nomes (ver textos.h)
+#define TAM_CABECALHO_MAPA 65536 // Alinha o primeiro bloco para páginas de até 64 KB
+
+typedef struct {
+    int assinatura;       // ASSINATURA_MAPA
+    int versao;
+    int tam_registro;     // sizeof do registro (recusa arquivos de outra versão das structs)
+    int usados;           // Marca d'água do pool
+    int ativos;           // Registros ativos (total_turmas / total_alunos)
+    int proximo_id;       // Tabela de turmas: próximo ID a atribuir (0 = derivar dos registros)
+} CabecalhoMapa;
+
+typedef struct MapaArquivo {
+    int fd;               // Descritor do arquivo aberto para leitura e escrita
+    CabecalhoMapa *cabecalho; // Cabeçalho mapeado
+    size_t tam_bloco;     // Bytes de um bloco (REGISTROS_POR_BLOCO * tam_registro)
+    size_t pagina;        // Tamanho de página do sistema
+} MapaArquivo;
+
+int mapa_disponivel(void);
+int mapa_existe(const char *caminho);
+int mapa_abrir(PoolRegistros *pool, const char *caminho, int *ativos);
+int mapa_criar(PoolRegistros *pool, const char *caminho, int ativos);
+char *mapa_novo_bloco(MapaArquivo *mapa, int bloco);
+int mapa_sincronizar_slots(const PoolRegistros *pool, const int *slots, int quantidade, int ativos);
+int mapa_sincronizar_tudo(const PoolRegistros *pool, int ativos);
+void mapa_fechar(PoolRegistros *pool);
+
+#endif // MAPEAMENTO_H
@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "metricas.h"
+
+static const char *const nomes_metricas[METRICAS_QUANTIDADE] = {
+    "carregar_dados", "salvar_dados", "checkpoint_dados", "fragmentos_carregar_turma", "gravacao_diario",
+    "preparar_indices", "autenticar_usuario",
+    "buscar_aluno_por_ra", "buscar_turma_por_id", "buscar_nomes", "consultar_alunos", "listar_todas_turmas",
+    "adicionar_turma", "adicionar_aluno",
+    "lancar_notas_e_atualizar_media", "editar_dados_aluno", "excluir_aluno_por_ra", "excluir_turma_por_id",
+    "compactar_dados", "ordenar_alunos_por_nome", "listar_alunos_por_nome", "gerar_relatorio_turma",
+    "resumir_turma", "exibir_estatisticas_turma", "ranking_medias", "percentis_medias", "recalcular_medias",
+    "outras"
+};
+
+/**
+ * @brief Nome da operação medida (o da função de servicos.h).
+ * @param metrica Uma das METRICA_*.
+ * @return const char* O nome.
+ */
+const char *metricas_nome(int metrica) {
+    return nomes_metricas[metrica];
+}
+
+#ifndef SEM_METRICAS
+
+#ifndef _WIN32
+#include <pthread.h>
+static pthread_mutex_t trava_registro = PTHREAD_MUTEX_INITIALIZER;
+#define TRAVAR() pthread_mutex_lock(&trava_registro)
+#define DESTRAVAR() pthread_mutex_unlock(&trava_registro)
+#else
+#define TRAVAR() ((void)0)   // Sem threads: nada a proteger
+#define DESTRAVAR() ((void)0)
+#endif
+
+static long long agora_ns(void) {
+    struct timespec t;
+#ifdef _WIN32
+    timespec_get(&t, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &t);
+#endif
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define relogio() __rdtsc() // Contador de ciclos: poucos ns por leitura
+#else
+#define relogio() ((unsigned long long)agora_ns())
+#endif
+
+// --- 1. Contadores por Thread ---
+//
+// Cada thread escreve só nos próprios contadores (leitura + store relaxado, sem
+// trava no barramento); a exibição soma os de todas as threads com loads
+// relaxados. Os contadores de uma thread encerrada continuam na lista.
+
+typedef struct MetricasThread {
+    TotaisMetrica totais[METRICAS_QUANTIDADE];
+    struct MetricasThread *proxima;
+} MetricasThread;
+
+static MetricasThread *todas_threads = NULL; // Lista de todas as threads que já mediram algo
+static unsigned long long referencia_ciclos; // Relógio e hora na primeira medição (calibração)
+static long long referencia_ns;
+
+static _Thread_local MetricasThread *locais = NULL;
+static _Thread_local int operacao_atual = METRICA_OUTRAS;
+
+#define SOMAR(campo, valor) __atomic_store_n(&(campo), (campo) + (valor), __ATOMIC_RELAXED)
+#define LER(campo) __atomic_load_n(&(campo), __ATOMIC_RELAXED)
+
+/**
+ * @brief Contadores da thread atual, criados e registrados na primeira medição.
+ * @return MetricasThread* Os contadores, ou NULL se faltou memória (a medição é perdida).
+ */
+static MetricasThread *contadores_da_thread(void) {
+    if (locais != NULL) return locais;
+    MetricasThread *novos = calloc(1, sizeof(MetricasThread));
+    if (novos == NULL) return NULL;
+    TRAVAR();
+    if (todas_threads == NULL) {
+        referencia_ciclos = relogio();
+        referencia_ns = agora_ns();
+    }
+    novos->proxima = todas_threads;
+    __atomic_store_n(&todas_threads, novos, __ATOMIC_RELEASE);
+    DESTRAVAR();
+    locais = novos;
+    return novos;
+}
+
+/**
+ * @brief Começa a medir uma operação (use METRICA_MEDIR, que conclui sozinho).
+ * @param metrica Uma das METRICA_*.
+ * @return MarcaMetrica Marca a ser passada para metricas_concluir.
+ */
+MarcaMetrica metricas_iniciar(int metrica) {
+    MarcaMetrica marca = { metrica, operacao_atual, 0 };
+    operacao_atual = metrica;
+    MetricasThread *contadores = contadores_da_thread();
+    if (contadores != NULL && (contadores->totais[metrica].chamadas & (METRICAS_AMOSTRAGEM - 1)) == 0) {
+        marca.inicio = relogio();
+    }
+    return marca;
+}
+
+/**
+ * @brief Conclui a medição: conta a chamada e, se for uma amostra, o tempo e a faixa de latência.
+ * @param marca Marca retornada por metricas_iniciar.
+ */
+void metricas_concluir(MarcaMetrica *marca) {
+    unsigned long long fim = marca->inicio != 0 ? relogio() : 0;
+    operacao_atual = marca->anterior;
+    if (locais == NULL) return; // Sem memória para os contadores: a chamada não é contada
+    TotaisMetrica *t = &locais->totais[marca->metrica];
+    SOMAR(t->chamadas, 1);
+    if (marca->inicio == 0) return;
+
+    unsigned long long ciclos = fim - marca->inicio;
+    int balde = 63 - __builtin_clzll(ciclos | 1);
+    if (balde >= BALDES_LATENCIA) balde = BALDES_LATENCIA - 1;
+    SOMAR(t->medidas, 1);
+    SOMAR(t->ciclos, ciclos);
+    SOMAR(t->baldes[balde], 1);
+}
+
+/**
+ * @brief Conta bytes lidos do disco na operação em andamento nesta thread.
+ */
+void metricas_bytes_lidos(unsigned long long bytes) {
+    MetricasThread *contadores = contadores_da_thread();
+    if (contadores != NULL) SOMAR(contadores->totais[operacao_atual].bytes_lidos, bytes);
+}
+
+/**
+ * @brief Conta bytes gravados no disco na operação em andamento nesta thread.
+ */
+void metricas_bytes_gravados(unsigned long long bytes) {
+    MetricasThread *contadores = contadores_da_thread();
+    if (contadores != NULL) SOMAR(contadores->totais[operacao_atual].bytes_gravados, bytes);
+}
+
+// --- 2. Leitura dos Totais ---
+
+/**
+ * @brief Soma os contadores de uma operação em todas as threads.
+ * @param metrica Uma das METRICA_*.
+ * @param totais Recebe a soma.
+ * @return int 1 se a operação foi chamada (ou movimentou bytes), 0 caso contrário.
+ */
+int metricas_totais(int metrica, TotaisMetrica *totais) {
+    memset(totais, 0, sizeof(*totais));
+    for (MetricasThread *m = __atomic_load_n(&todas_threads, __ATOMIC_ACQUIRE); m != NULL; m = m->proxima) {
+        TotaisMetrica *t = &m->totais[metrica];
+        totais->chamadas += LER(t->chamadas);
+        totais->medidas += LER(t->medidas);
+        totais->ciclos += LER(t->ciclos);
+        totais->bytes_lidos += LER(t->bytes_lidos);
+        totais->bytes_gravados += LER(t->bytes_gravados);
+        for (int b = 0; b < BALDES_LATENCIA; b++) totais->baldes[b] += LER(t->baldes[b]);
+    }
+    return totais->chamadas > 0 || totais->bytes_lidos > 0 || totais->bytes_gravados > 0;
+}
+
+/**
+ * @brief Nanossegundos por ciclo do relógio, calibrado desde a primeira medição.
+ * Se passou pouco tempo desde então, espera alguns milissegundos para calibrar.
+ * @return double A razão (1.0 quando o relógio já é em nanossegundos).
+ */
+double metricas_ns_por_ciclo(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__atomic_load_n(&todas_threads, __ATOMIC_ACQUIRE) == NULL) return 1.0;
+    long long ns;
+    unsigned long long ciclos;
+    do {
+        ns = agora_ns() - referencia_ns;
+        ciclos = relogio() - referencia_ciclos;
+    } while (ns < 10000000LL); // 10 ms bastam para um erro desprezível
+    return (double)ns / (double)ciclos;
+#else
+    return 1.0;
+#endif
+}
+
+#else // SEM_METRICAS
+
+int metricas_totais(int metrica, TotaisMetrica *totais) {
+    (void)metrica;
+    memset(totais, 0, sizeof(*totais));
+    return 0;
+}
+
+double metricas_ns_por_ciclo(void) {
+    return 1.0;
+}
+
+#endif
+
+// --- 3. Exibição e Gravação ---
+
+/**
+ * @brief Latência (ns) abaixo da qual estão 'fracao' das chamadas, pelo histograma.
+ * Retorna o limite superior da faixa: a precisão é de um fator 2.
+ */
+static double percentil_ns(const TotaisMetrica *t, double fracao, double ns_por_ciclo) {
+    if (t->medidas == 0) return 0.0;
+    unsigned long long alvo = (unsigned long long)((double)t->medidas * fracao), acumulado = 0;
+    for (int b = 0; b < BALDES_LATENCIA; b++) {
+        acumulado += t->baldes[b];
+        if (acumulado > alvo || acumulado == t->medidas) return (double)(2ULL << b) * ns_por_ciclo;
+    }
+    return 0.0;
+}
+
+/**
+ * @brief Tempo médio (ns) das amostras e tempo total estimado para todas as chamadas.
+ */
+static void tempos_ns(const TotaisMetrica *t, double ns_por_ciclo, double *media, double *total) {
+    *media = t->medidas > 0 ? (double)t->ciclos * ns_por_ciclo / (double)t->medidas : 0.0;
+    *total = *media * (double)t->chamadas;
+}
+
+/**
+ * @brief Exibe a tabela de métricas das operações chamadas até agora (menu do admin).
+ */
+void metricas_exibir(void) {
+#ifdef SEM_METRICAS
+    printf("AVISO: Metricas desativadas nesta compilacao (SEM_METRICAS).\n");
+#else
+    double ns_por_ciclo = metricas_ns_por_ciclo();
+    printf("\n--- METRICAS DE OPERACOES ---\n");
+    printf("%-32s %10s %12s %11s %11s %11s %11s\n", "Operacao", "Chamadas", "Total(ms)", "Media(us)",
+           "p99(us)", "Lidos(KB)", "Grav.(KB)");
+    int alguma = 0;
+    for (int m = 0; m < METRICAS_QUANTIDADE; m++) {
+        TotaisMetrica t;
+        if (!metricas_totais(m, &t)) continue;
+        double media_ns, total_ns;
+        tempos_ns(&t, ns_por_ciclo, &media_ns, &total_ns);
+        printf("%-32s %10llu %12.2f %11.2f %11.2f %11.1f %11.1f\n", metricas_nome(m), t.chamadas, total_ns / 1e6,
+               media_ns / 1e3, percentil_ns(&t, 0.99, ns_por_ciclo) / 1e3,
+               (double)t.bytes_lidos / 1024.0, (double)t.bytes_gravados / 1024.0);
+        alguma = 1;
+    }
+    if (!alguma) printf("Nenhuma operacao medida ainda.\n");
+    printf("(tempos por amostragem, 1 a cada %d chamadas; p99 com precisao de um fator 2)\n", METRICAS_AMOSTRAGEM);
+#endif
+}
+
+/**
+ * @brief Grava as métricas em CSV, com o histograma de cada operação.
+ * Colunas: operacao,chamadas,amostras,tempo_total_ns,media_ns,p50_ns,p99_ns,
+ * bytes_lidos,bytes_gravados,histograma ("limite_ns:amostras" por faixa não vazia).
+ * O tempo total é estimado pelas amostras (ver METRICAS_AMOSTRAGEM).
+ * @param caminho Arquivo de destino.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int metricas_gravar(const char *caminho) {
+    FILE *f = fopen(caminho, "w");
+    if (f == NULL) return 0;
+
+    double ns_por_ciclo = metricas_ns_por_ciclo();
+    fprintf(f, "operacao,chamadas,amostras,tempo_total_ns,media_ns,p50_ns,p99_ns,bytes_lidos,bytes_gravados,histograma\n");
+    for (int m = 0; m < METRICAS_QUANTIDADE; m++) {
+        TotaisMetrica t;
+        if (!metricas_totais(m, &t)) continue;
+        double media_ns, total_ns;
+        tempos_ns(&t, ns_por_ciclo, &media_ns, &total_ns);
+        fprintf(f, "%s,%llu,%llu,%.0f,%.0f,%.0f,%.0f,%llu,%llu,", metricas_nome(m), t.chamadas, t.medidas, total_ns,
+                media_ns, percentil_ns(&t, 0.5, ns_por_ciclo),
+                percentil_ns(&t, 0.99, ns_por_ciclo), t.bytes_lidos, t.bytes_gravados);
+        const char *separador = "";
+        for (int b = 0; b < BALDES_LATENCIA; b++) {
+            if (t.baldes[b] == 0) continue;
+            fprintf(f, "%s%.0f:%llu", separador, (double)(2ULL << b) * ns_por_ciclo, t.baldes[b]);
+            separador = " ";
+        }
+        fputc('\n', f);
+    }
+    return fclose(f) == 0;
+}
+
+static char caminho_ao_sair[512];
+
+static void gravar_ao_sair(void) {
+    if (!metricas_gravar(caminho_ao_sair)) {
+        fprintf(stderr, "ERRO: Nao foi possivel gravar as metricas em '%s'.\n", caminho_ao_sair);
+    }
+}
+
+/**
+ * @brief Agenda a gravação das métricas para o fim do programa (atexit).
+ * @param caminho Arquivo de destino.
+ * @return int 1 se agendado, 0 se o caminho é longo demais ou o atexit falhou.
+ */
+int metricas_gravar_ao_sair(const char *caminho) {
+    if (strlen(caminho) >= sizeof(caminho_ao_sair)) return 0;
+    strcpy(caminho_ao_sair, caminho);
+    return atexit(gravar_ao_sair) == 0;
+}
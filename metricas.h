@@ -0,0 +1,105 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdio.h>
+
+// --- Métricas das Operações ---
+//
+// Cada operação de servicos.h conta suas chamadas, o tempo gasto e um
+// histograma de latência em faixas de potência de 2, além dos bytes lidos e
+// gravados em disco enquanto ela roda (carga, gravação, páginas lidas sob
+// demanda). Basta uma linha no início da função:
+//
+//   METRICA_MEDIR(METRICA_ADICIONAR_ALUNO);
+//
+// Toda chamada é contada, mas só uma a cada METRICAS_AMOSTRAGEM (por thread e
+// operação, incluindo sempre a primeira) lê o relógio: o histograma e o tempo
+// médio vêm dessas amostras e o tempo total é estimado a partir delas. O
+// relógio é o contador de ciclos (rdtsc) quando disponível, convertido para
+// nanossegundos só na exibição. Os contadores são por thread (sem instruções
+// atômicas com trava no caminho da medição) e somados na leitura.
+// Compilado com -DSEM_METRICAS, METRICA_MEDIR não gera código nenhum.
+
+typedef enum {
+    METRICA_CARREGAR_DADOS,
+    METRICA_SALVAR_DADOS,
+    METRICA_CHECKPOINT_DADOS,
+    METRICA_CARREGAR_FRAGMENTO,
+    METRICA_GRAVACAO_DIARIO,
+    METRICA_PREPARAR_INDICES,
+    METRICA_AUTENTICAR_USUARIO,
+    METRICA_BUSCAR_ALUNO_POR_RA,
+    METRICA_BUSCAR_TURMA_POR_ID,
+    METRICA_BUSCAR_NOMES,
+    METRICA_CONSULTAR_ALUNOS,
+    METRICA_LISTAR_TODAS_TURMAS,
+    METRICA_ADICIONAR_TURMA,
+    METRICA_ADICIONAR_ALUNO,
+    METRICA_LANCAR_NOTAS,
+    METRICA_EDITAR_DADOS_ALUNO,
+    METRICA_EXCLUIR_ALUNO,
+    METRICA_EXCLUIR_TURMA,
+    METRICA_COMPACTAR_DADOS,
+    METRICA_ORDENAR_ALUNOS,
+    METRICA_LISTAR_ALUNOS_POR_NOME,
+    METRICA_GERAR_RELATORIO_TURMA,
+    METRICA_RESUMIR_TURMA,
+    METRICA_EXIBIR_ESTATISTICAS,
+    METRICA_RANKING_MEDIAS,
+    METRICA_PERCENTIS_MEDIAS,
+    METRICA_RECALCULAR_MEDIAS,
+    METRICA_OUTRAS,                // Bytes de E/S fora de qualquer operação medida
+    METRICAS_QUANTIDADE
+} Metrica;
+
+#define BALDES_LATENCIA 40 // Faixa b: [2^b, 2^(b+1)) ciclos do relógio
+#ifndef METRICAS_AMOSTRAGEM
+#define METRICAS_AMOSTRAGEM 16 // Potência de 2; 1 = mede o tempo de toda chamada
+#endif
+
+// Totais de uma operação (soma de todas as threads).
+typedef struct {
+    unsigned long long chamadas;
+    unsigned long long medidas;                   // Chamadas com tempo medido (amostras)
+    unsigned long long ciclos;                    // Tempo das amostras, em ciclos do relógio
+    unsigned long long bytes_lidos;
+    unsigned long long bytes_gravados;
+    unsigned long long baldes[BALDES_LATENCIA];   // Amostras por faixa de latência
+} TotaisMetrica;
+
+#if !defined(SEM_METRICAS) && !defined(__GNUC__)
+#define SEM_METRICAS // METRICA_MEDIR depende de __attribute__((cleanup))
+#endif
+
+#ifndef SEM_METRICAS
+
+typedef struct {
+    int metrica;
+    int anterior;               // Operação em andamento antes desta (chamadas aninhadas)
+    unsigned long long inicio;  // 0 = chamada só contada, sem tempo medido
+} MarcaMetrica;
+
+MarcaMetrica metricas_iniciar(int metrica);
+void metricas_concluir(MarcaMetrica *marca);
+void metricas_bytes_lidos(unsigned long long bytes);
+void metricas_bytes_gravados(unsigned long long bytes);
+
+#define METRICA_MEDIR(metrica) \
+    MarcaMetrica marca_metrica_ __attribute__((cleanup(metricas_concluir), unused)) = metricas_iniciar(metrica)
+
+#else
+
+#define METRICA_MEDIR(metrica) ((void)0)
+#define metricas_bytes_lidos(bytes) ((void)0)
+#define metricas_bytes_gravados(bytes) ((void)0)
+
+#endif
+
+const char *metricas_nome(int metrica);
+int metricas_totais(int metrica, TotaisMetrica *totais);
+double metricas_ns_por_ciclo(void);
+void metricas_exibir(void);
+int metricas_gravar(const char *caminho);
+int metricas_gravar_ao_sair(const char *caminho);
+
+#endif // METRICAS_H
@@ -0,0 +1,552 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include "protocolo.h"
+#include "consultas.h"
+#ifdef _WIN32
+#include <io.h>
+#define read _read
+#else
+#include <unistd.h>
+#endif
+
+// --- 1. Leitura dos Pedidos ---
+
+/**
+ * @brief Separa os argumentos de um pedido ("a;b;c"), no próprio buffer.
+ * @param texto Argumentos (é modificado); vazio = nenhum argumento.
+ * @param campos Recebe o início de cada argumento.
+ * @return int Número de argumentos, ou -1 se houver mais de MAX_CAMPOS_PEDIDO.
+ */
+static int separar_argumentos(char *texto, char **campos) {
+    if (*texto == '\0') return 0;
+    int n = 0;
+    for (;;) {
+        if (n == MAX_CAMPOS_PEDIDO) return -1;
+        campos[n++] = texto;
+        texto = strchr(texto, ';');
+        if (texto == NULL) return n;
+        *texto++ = '\0';
+    }
+}
+
+/**
+ * @brief Converte um argumento inteiro (o argumento inteiro precisa ser numérico).
+ * @return int 1 se válido, 0 caso contrário.
+ */
+static int ler_inteiro(const char *texto, int *valor) {
+    char *fim;
+    errno = 0;
+    long v = strtol(texto, &fim, 10);
+    if (fim == texto || *fim != '\0' || errno != 0 || v < INT_MIN || v > INT_MAX) return 0;
+    *valor = (int)v;
+    return 1;
+}
+
+/**
+ * @brief Converte uma nota (número entre 0 e 10).
+ * @return int 1 se válida, 0 caso contrário.
+ */
+static int ler_nota(const char *texto, float *valor) {
+    char *fim;
+    float v = strtof(texto, &fim);
+    if (fim == texto || *fim != '\0' || !(v >= 0.0f && v <= 10.0f)) return 0;
+    *valor = v;
+    return 1;
+}
+
+// --- 2. Respostas ---
+
+/**
+ * @brief Responde "ERRO <motivo>" (o motivo pode vir de ultima_mensagem, já com "ERRO: " ou "AVISO: ").
+ */
+void responder_erro(Sessao *sessao, const char *motivo) {
+    sessao->erros++;
+    if (strncmp(motivo, "ERRO: ", 6) == 0) motivo += 6;
+    else if (strncmp(motivo, "AVISO: ", 7) == 0) motivo += 7;
+    if (motivo[0] == '\0') motivo = "Operacao nao realizada.";
+    saida_texto(&sessao->saida, "ERRO ");
+    saida_texto(&sessao->saida, motivo);
+    saida_caractere(&sessao->saida, '\n');
+}
+
+/**
+ * @brief Escreve um campo de texto da resposta (';' e quebras de linha viram espaço).
+ */
+static void escrever_campo(Sessao *sessao, const char *texto) {
+    for (; *texto != '\0'; texto++) {
+        char c = *texto;
+        saida_caractere(&sessao->saida, (c == ';' || c == '\n' || c == '\r') ? ' ' : c);
+    }
+}
+
+/**
+ * @brief Escreve "ra;nome;" seguido de notas, média e situação do aluno (sem quebra de linha).
+ * @param com_turma 1 para incluir o ID da turma depois do nome.
+ */
+static void escrever_aluno(Sessao *sessao, const DadosSistema *sistema, const Aluno *aluno, int com_turma) {
+    SaidaBuffer *saida = &sessao->saida;
+    escrever_campo(sessao, aluno->ra);
+    saida_caractere(saida, ';');
+    escrever_campo(sessao, texto_em(sistema, aluno->nome));
+    saida_caractere(saida, ';');
+    if (com_turma) {
+        saida_inteiro(saida, aluno->id_turma);
+        saida_caractere(saida, ';');
+    }
+    for (int n = 0; n < 3; n++) {
+        saida_decimal(saida, aluno->notas[n]);
+        saida_caractere(saida, ';');
+    }
+    saida_decimal(saida, aluno->media_final);
+    saida_caractere(saida, ';');
+    saida_texto(saida, situacao_aluno(aluno));
+}
+
+// --- 3. Comandos ---
+
+static int comando_turmas(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    SaidaBuffer *saida = &sessao->saida;
+    (void)campos;
+
+    saida_texto(saida, "OK ");
+    saida_inteiro(saida, sistema->total_turmas);
+    saida_caractere(saida, '\n');
+    for (int i = 0; i < sistema->turmas.usados; i++) {
+        const Turma *turma = turma_em(sistema, i);
+        if (turma->ativo != 1) continue;
+        saida_inteiro(saida, turma->id);
+        saida_caractere(saida, ';');
+        escrever_campo(sessao, texto_em(sistema, turma->nome));
+        saida_caractere(saida, ';');
+        saida_inteiro(saida, turma->vagas_maximas);
+        saida_caractere(saida, ';');
+        saida_inteiro(saida, turma->vagas_ocupadas);
+        saida_caractere(saida, '\n');
+    }
+    return 0;
+}
+
+static int escrever_linha_relatorio(const DadosSistema *sistema, int slot, void *contexto) {
+    Sessao *sessao = contexto;
+    escrever_aluno(sessao, sistema, aluno_em(sistema, slot), 0);
+    saida_caractere(&sessao->saida, '\n');
+    return 1;
+}
+
+static int comando_relatorio(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    int id_turma, idx_turma;
+    if (!ler_inteiro(campos[0], &id_turma) || (idx_turma = buscar_turma_por_id(sistema, id_turma)) == -1) {
+        responder_erro(sessao, "Turma nao encontrada ou inativa.");
+        return 0;
+    }
+
+    // Só alunos ativos são visitados: vagas_ocupadas é a quantidade deles
+    saida_texto(&sessao->saida, "OK ");
+    saida_inteiro(&sessao->saida, turma_em(sistema, idx_turma)->vagas_ocupadas);
+    saida_caractere(&sessao->saida, '\n');
+    percorrer_alunos_turma(sistema, idx_turma, escrever_linha_relatorio, sessao);
+    return 0;
+}
+
+static int comando_estatisticas(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    ResumoTurma resumo;
+    int id_turma;
+    if (!ler_inteiro(campos[0], &id_turma) || !resumir_turma(sistema, id_turma, &resumo)) {
+        responder_erro(sessao, "Turma nao encontrada ou inativa.");
+        return 0;
+    }
+
+    SaidaBuffer *saida = &sessao->saida;
+    saida_texto(saida, "OK ");
+    saida_inteiro(saida, resumo.alunos);
+    saida_caractere(saida, ';');
+    saida_decimal(saida, resumo.media);
+    saida_caractere(saida, ';');
+    saida_decimal(saida, resumo.desvio_padrao);
+    saida_caractere(saida, ';');
+    saida_inteiro(saida, resumo.aprovados);
+    saida_caractere(saida, ';');
+    saida_inteiro(saida, resumo.recuperacao);
+    saida_caractere(saida, ';');
+    saida_inteiro(saida, resumo.reprovados);
+    saida_caractere(saida, ';');
+    saida_decimal(saida, resumo.taxa_aprovacao);
+    saida_caractere(saida, '\n');
+    return 0;
+}
+
+static int comando_buscar(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    int idx_aluno = buscar_aluno_por_ra(sistema, campos[0]);
+    if (idx_aluno == -1) {
+        responder_erro(sessao, "Aluno nao encontrado ou inativo.");
+        return 0;
+    }
+    saida_texto(&sessao->saida, "OK ");
+    escrever_aluno(sessao, sistema, aluno_em(sistema, idx_aluno), 1);
+    saida_caractere(&sessao->saida, '\n');
+    return 0;
+}
+
+static int comando_procurar(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    int aproximada;
+    if (!ler_inteiro(campos[1], &aproximada) || (aproximada != 0 && aproximada != 1)) {
+        responder_erro(sessao, "Modo deve ser 0 (trecho) ou 1 (aproximada).");
+        return 0;
+    }
+    ResultadoNome resultados[MAX_RESULTADOS_BUSCA];
+    int n = buscar_nomes(sistema, campos[0], aproximada, resultados, MAX_RESULTADOS_BUSCA);
+    if (n < 0) {
+        responder_erro(sessao, "Memoria insuficiente para a busca.");
+        return 0;
+    }
+
+    SaidaBuffer *saida = &sessao->saida;
+    saida_texto(saida, "OK ");
+    saida_inteiro(saida, n);
+    saida_caractere(saida, '\n');
+    for (int k = 0; k < n; k++) {
+        if (resultados[k].tipo == RESULTADO_TURMA) {
+            const Turma *turma = turma_em(sistema, resultados[k].slot);
+            saida_texto(saida, "TURMA;");
+            saida_inteiro(saida, turma->id);
+            saida_caractere(saida, ';');
+            escrever_campo(sessao, texto_em(sistema, turma->nome));
+            saida_caractere(saida, ';');
+            saida_inteiro(saida, turma->id);
+        } else {
+            const Aluno *aluno = aluno_em(sistema, resultados[k].slot);
+            saida_texto(saida, "ALUNO;");
+            escrever_campo(sessao, aluno->ra);
+            saida_caractere(saida, ';');
+            escrever_campo(sessao, texto_em(sistema, aluno->nome));
+            saida_caractere(saida, ';');
+            saida_inteiro(saida, aluno->id_turma);
+        }
+        saida_caractere(saida, ';');
+        saida_decimal(saida, resultados[k].semelhanca);
+        saida_caractere(saida, '\n');
+    }
+    return 0;
+}
+
+// Slots dos alunos encontrados por CONSULTAR (a resposta começa pela quantidade)
+typedef struct {
+    int *slots;
+    long quantidade;
+    long capacidade;
+} ColetaSlots;
+
+static int coletar_slot(const DadosSistema *sistema, int slot, void *contexto) {
+    ColetaSlots *coleta = contexto;
+    (void)sistema;
+    if (coleta->quantidade == coleta->capacidade) {
+        long capacidade = coleta->capacidade > 0 ? coleta->capacidade * 2 : 1024;
+        int *slots = realloc(coleta->slots, (size_t)capacidade * sizeof(int));
+        if (slots == NULL) {
+            coleta->capacidade = -1; // Falta de memória: encerra a consulta
+            return 0;
+        }
+        coleta->slots = slots;
+        coleta->capacidade = capacidade;
+    }
+    coleta->slots[coleta->quantidade++] = slot;
+    return 1;
+}
+
+static int comando_consultar(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    FiltroAlunos filtro;
+    const char *erro;
+    if (!filtro_interpretar(campos[0], &filtro, &erro)) {
+        responder_erro(sessao, erro);
+        return 0;
+    }
+    ColetaSlots coleta = { NULL, 0, 0 };
+    if (consultar_alunos(sistema, &filtro, coletar_slot, &coleta) < 0 || coleta.capacidade < 0) {
+        free(coleta.slots);
+        responder_erro(sessao, "Memoria insuficiente para a consulta.");
+        return 0;
+    }
+
+    saida_texto(&sessao->saida, "OK ");
+    saida_inteiro(&sessao->saida, coleta.quantidade);
+    saida_caractere(&sessao->saida, '\n');
+    for (long k = 0; k < coleta.quantidade; k++) {
+        escrever_aluno(sessao, sistema, aluno_em(sistema, coleta.slots[k]), 1);
+        saida_caractere(&sessao->saida, '\n');
+    }
+    free(coleta.slots);
+    return 0;
+}
+
+static int comando_turma_add(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    int vagas;
+    if (strlen(campos[0]) >= TAM_NOME || !ler_inteiro(campos[1], &vagas)) {
+        responder_erro(sessao, "Nome de turma longo demais ou vagas invalidas.");
+        return 0;
+    }
+    if (!adicionar_turma(sistema, campos[0], vagas)) {
+        responder_erro(sessao, ultima_mensagem());
+        return 0;
+    }
+    saida_texto(&sessao->saida, "OK ");
+    saida_inteiro(&sessao->saida, sistema->proximo_id_turma - 1); // ID recém-entregue
+    saida_caractere(&sessao->saida, '\n');
+    return 1;
+}
+
+static int comando_aluno_add(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    int id_turma;
+    if (strlen(campos[0]) == 0 || strlen(campos[0]) >= TAM_RA || strlen(campos[1]) >= TAM_NOME ||
+        !ler_inteiro(campos[2], &id_turma)) {
+        responder_erro(sessao, "RA, nome ou turma invalidos.");
+        return 0;
+    }
+    if (!adicionar_aluno(sistema, campos[1], campos[0], id_turma)) {
+        responder_erro(sessao, ultima_mensagem());
+        return 0;
+    }
+    saida_texto(&sessao->saida, "OK\n");
+    return 1;
+}
+
+static int comando_notas(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    float notas[3];
+    for (int n = 0; n < 3; n++) {
+        if (!ler_nota(campos[n + 1], &notas[n])) {
+            responder_erro(sessao, "Notas devem estar entre 0 e 10.");
+            return 0;
+        }
+    }
+    if (!lancar_notas_e_atualizar_media(sistema, campos[0], notas[0], notas[1], notas[2], sessao->nivel)) {
+        responder_erro(sessao, ultima_mensagem());
+        return 0;
+    }
+    saida_texto(&sessao->saida, "OK ");
+    saida_decimal(&sessao->saida, aluno_em(sistema, buscar_aluno_por_ra(sistema, campos[0]))->media_final);
+    saida_caractere(&sessao->saida, '\n');
+    return 1;
+}
+
+static int comando_editar(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    int id_turma;
+    if (strlen(campos[1]) >= TAM_NOME || !ler_inteiro(campos[2], &id_turma)) {
+        responder_erro(sessao, "Nome longo demais ou turma invalida.");
+        return 0;
+    }
+    if (!editar_dados_aluno(sistema, campos[0], campos[1], id_turma)) {
+        responder_erro(sessao, ultima_mensagem());
+        return 0;
+    }
+    saida_texto(&sessao->saida, "OK\n");
+    return 1;
+}
+
+static int comando_aluno_del(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    if (!excluir_aluno_por_ra(sistema, campos[0])) {
+        responder_erro(sessao, ultima_mensagem());
+        return 0;
+    }
+    saida_texto(&sessao->saida, "OK\n");
+    return 1;
+}
+
+static int comando_turma_del(Sessao *sessao, DadosSistema *sistema, char **campos) {
+    int id_turma;
+    if (!ler_inteiro(campos[0], &id_turma) || !excluir_turma_por_id(sistema, id_turma)) {
+        responder_erro(sessao, ultima_mensagem());
+        return 0;
+    }
+    saida_texto(&sessao->saida, "OK\n");
+    return 1;
+}
+
+static const Comando comandos[] = {
+    {"TURMAS",       0, NIVEL_ALUNO,     0, 1, comando_turmas},
+    {"RELATORIO",    1, NIVEL_ALUNO,     0, 1, comando_relatorio},
+    {"ESTATISTICAS", 1, NIVEL_ALUNO,     0, 1, comando_estatisticas},
+    {"BUSCAR",       1, NIVEL_ALUNO,     0, 0, comando_buscar},
+    {"PROCURAR",     2, NIVEL_ALUNO,     0, 0, comando_procurar},
+    {"CONSULTAR",    1, NIVEL_ALUNO,     0, 0, comando_consultar},
+    {"TURMA_ADD",    2, NIVEL_PROFESSOR, 1, 0, comando_turma_add},
+    {"ALUNO_ADD",    3, NIVEL_PROFESSOR, 1, 0, comando_aluno_add},
+    {"NOTAS",        4, NIVEL_PROFESSOR, 1, 0, comando_notas},
+    {"EDITAR",       3, NIVEL_ADMIN,     1, 0, comando_editar},
+    {"ALUNO_DEL",    1, NIVEL_ADMIN,     1, 0, comando_aluno_del},
+    {"TURMA_DEL",    1, NIVEL_ADMIN,     1, 0, comando_turma_del},
+};
+
+// --- 4. Interpretação ---
+
+/**
+ * @brief Interpreta um pedido (uma linha, sem a quebra): responde LOGIN, SAIR e
+ * erros de sintaxe ou de acesso, e entrega os demais comandos para execução.
+ * Quem chama executa o comando do jeito que precisar (com trava, sobre uma foto).
+ * @param sessao Sessão do pedido.
+ * @param linha Pedido (é modificado: os argumentos são separados no próprio buffer).
+ * @param comando Recebe o comando a executar (com PEDIDO_EXECUTAR).
+ * @param campos Recebe os argumentos (MAX_CAMPOS_PEDIDO posições).
+ * @return TipoPedido O que falta fazer com o pedido.
+ */
+TipoPedido interpretar_pedido(Sessao *sessao, char *linha, const Comando **comando, char **campos) {
+    char *argumentos = strchr(linha, ' ');
+    if (argumentos != NULL) *argumentos++ = '\0';
+    else argumentos = linha + strlen(linha);
+
+    int n = separar_argumentos(argumentos, campos);
+
+    if (strcmp(linha, "SAIR") == 0) {
+        saida_texto(&sessao->saida, "OK\n");
+        return PEDIDO_SAIR;
+    }
+    if (strcmp(linha, "LOGIN") == 0) {
+        sessao->nivel = n == 2 ? autenticar_usuario(campos[0], campos[1]) : -1;
+        if (sessao->nivel == -1) {
+            responder_erro(sessao, "Usuario ou senha invalidos.");
+        } else {
+            saida_texto(&sessao->saida, "OK ");
+            saida_inteiro(&sessao->saida, sessao->nivel);
+            saida_caractere(&sessao->saida, '\n');
+        }
+        return PEDIDO_RESPONDIDO;
+    }
+
+    *comando = NULL;
+    for (size_t i = 0; i < sizeof(comandos) / sizeof(comandos[0]); i++) {
+        if (strcmp(linha, comandos[i].nome) == 0) *comando = &comandos[i];
+    }
+    if (*comando == NULL) {
+        responder_erro(sessao, "Comando desconhecido.");
+        return PEDIDO_RESPONDIDO;
+    }
+    if (n != (*comando)->campos) {
+        responder_erro(sessao, "Numero de argumentos incorreto.");
+        return PEDIDO_RESPONDIDO;
+    }
+    if (sessao->nivel < (*comando)->nivel_minimo) {
+        responder_erro(sessao, sessao->nivel == -1 ? "Faca LOGIN primeiro." :
+                                                     "Acesso negado para seu nivel de usuario.");
+        return PEDIDO_RESPONDIDO;
+    }
+    return PEDIDO_EXECUTAR;
+}
+
+// --- 5. Modo de Comandos ---
+
+/**
+ * @brief Lê mais bytes da entrada, sem esperar o bloco inteiro: numa entrada
+ * interativa (pipe de outro programa) os pedidos já recebidos são atendidos logo.
+ * @return long Bytes lidos, 0 no fim da entrada ou -1 em caso de falha.
+ */
+static long ler_bloco(FILE *entrada, char *destino, size_t tamanho) {
+    long lidos;
+    do {
+        lidos = (long)read(fileno(entrada), destino, (unsigned)tamanho);
+    } while (lidos < 0 && errno == EINTR);
+    return lidos;
+}
+
+/**
+ * @brief Modo de comandos: executa os pedidos da entrada (protocolo acima) até
+ * SAIR ou o fim da entrada, com uma resposta por pedido em 'destino'.
+ * A sessão começa sem login, como no servidor: só LOGIN e SAIR são aceitos
+ * até um LOGIN válido. A entrada é lida em blocos de TAM_BUFFER_COMANDOS e os
+ * pedidos são interpretados direto no buffer; as respostas são acumuladas e
+ * escritas antes de cada nova leitura da entrada. Nada é gravado: quem chama
+ * grava o resultado uma única vez, com salvar_dados.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param entrada Arquivo de pedidos aberto para leitura.
+ * @param destino Arquivo das respostas.
+ * @param resumo Recebe os contadores de pedidos e de erros.
+ * @return int 1 se a entrada foi lida até o fim (ou até SAIR) e as respostas escritas, 0 caso contrário.
+ */
+int executar_comandos(DadosSistema *sistema, FILE *entrada, FILE *destino, ResumoComandos *resumo) {
+    memset(resumo, 0, sizeof(*resumo));
+    Sessao sessao;
+    sessao.nivel = -1; // LOGIN primeiro
+    sessao.erros = 0;
+    char *buffer = malloc(TAM_BUFFER_COMANDOS + 1);
+    if (buffer == NULL || !saida_iniciar(&sessao.saida, destino)) {
+        printf("ERRO: Memoria insuficiente para o modo de comandos.\n");
+        free(buffer);
+        return 0;
+    }
+
+    // Mensagens das operações viram respostas ERRO, não vão para o terminal
+    definir_modo_silencioso(1);
+
+    size_t pendente = 0;      // Bytes de um pedido incompleto no início do buffer
+    int descartando = 0;      // Pulando o resto de um pedido maior que o buffer
+    int continuar = 1;
+    int lido = 1;
+
+    while (continuar) {
+        saida_descarregar(&sessao.saida);
+        fflush(destino);
+        long lidos = ler_bloco(entrada, buffer + pendente, TAM_BUFFER_COMANDOS - pendente);
+        if (lidos < 0) lido = 0;
+        int fim_da_entrada = lidos <= 0;
+
+        char *p = buffer;
+        char *limite = buffer + pendente + (lidos > 0 ? lidos : 0);
+        while (continuar && p < limite) {
+            char *quebra = memchr(p, '\n', (size_t)(limite - p));
+            if (quebra == NULL) {
+                if (!fim_da_entrada) break; // Pedido continua na próxima leitura
+                quebra = limite;            // Último pedido, sem '\n'
+            }
+            *quebra = '\0';
+            if (descartando) {
+                descartando = 0;
+            } else {
+                if (quebra > p && quebra[-1] == '\r') quebra[-1] = '\0';
+                if (*p != '\0') {
+                    resumo->pedidos++;
+                    const Comando *comando;
+                    char *campos[MAX_CAMPOS_PEDIDO];
+                    switch (interpretar_pedido(&sessao, p, &comando, campos)) {
+                        case PEDIDO_EXECUTAR:
+                            // Os índices são montados no primeiro uso (no modo fragmentado,
+                            // só os segmentos das turmas pedidas são lidos até lá)
+                            definir_modo_silencioso(1); // Zera a última mensagem
+                            comando->executar(&sessao, sistema, campos);
+                            break;
+                        case PEDIDO_SAIR:
+                            continuar = 0;
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            }
+            p = quebra + 1;
+        }
+        if (fim_da_entrada) break;
+
+        pendente = p < limite ? (size_t)(limite - p) : 0;
+        if (pendente == TAM_BUFFER_COMANDOS) {
+            // Nenhuma quebra de linha num buffer inteiro: recusa o pedido e pula o resto dele
+            if (!descartando) {
+                resumo->pedidos++;
+                responder_erro(&sessao, "Pedido longo demais.");
+            }
+            descartando = 1;
+            pendente = 0;
+        } else if (pendente > 0) {
+            memmove(buffer, p, pendente);
+        }
+    }
+
+    definir_modo_silencioso(0);
+    free(buffer);
+    resumo->erros = sessao.erros;
+    if (!saida_concluir(&sessao.saida)) return 0;
+
+    if (!lido) {
+        printf("ERRO: Falha de leitura da entrada de comandos.\n");
+        return 0;
+    }
+    return 1;
+}
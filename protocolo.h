@@ -0,0 +1,73 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stdio.h>
+#include "servicos.h"
+#include "saida.h"
+
+// --- Protocolo de Comandos em Linha ---
+//
+// Usado pelo servidor (servidor.h) e pelo modo de comandos (--comandos), que
+// lê os pedidos de um arquivo ou da entrada padrão. Um pedido por linha,
+// "COMANDO arg1;arg2;...", e uma linha de resposta, "OK [dados]" ou
+// "ERRO mensagem". Respostas com várias linhas começam com "OK n" e trazem n
+// linhas de dados em seguida.
+//
+//   LOGIN login;senha             -> OK nivel
+//   TURMAS                        -> OK n  + n x id;nome;vagas_maximas;vagas_ocupadas
+//   RELATORIO id                  -> OK n  + n x ra;nome;n1;n2;n3;media;situacao
+//   ESTATISTICAS id               -> OK alunos;media;desvio_padrao;aprovados;recup;reprovados;taxa
+//   BUSCAR ra                     -> OK ra;nome;id_turma;n1;n2;n3;media;situacao
+//   PROCURAR texto;modo           -> OK n  + n x TURMA|ALUNO;id|ra;nome;id_turma;semelhanca
+//                                    (modo 0 = nomes com o trecho, 1 = aproximada)
+//   CONSULTAR filtro              -> OK n  + n x ra;nome;id_turma;n1;n2;n3;media;situacao
+//                                    (filtro como "turma=3..9 situacao=recup n2<4", ver consultas.h)
+//   TURMA_ADD nome;vagas          -> OK id                 (PROF/ADMIN)
+//   ALUNO_ADD ra;nome;id_turma    -> OK                    (PROF/ADMIN)
+//   NOTAS ra;n1;n2;n3             -> OK media              (PROF/ADMIN)
+//   EDITAR ra;nome;id_turma       -> OK                    (ADMIN; nome vazio ou turma 0 = mantém)
+//   ALUNO_DEL ra                  -> OK                    (ADMIN)
+//   TURMA_DEL id                  -> OK                    (ADMIN)
+//   SAIR                          -> OK (e encerra a sessão)
+//
+// Os argumentos são separados no próprio buffer da linha, sem alocação, e as
+// respostas são montadas num SaidaBuffer (saida.h).
+
+#define MAX_CAMPOS_PEDIDO 4
+#define TAM_BUFFER_COMANDOS (1 << 20) // Modo de comandos: entrada lida em blocos de 1 MB
+
+typedef struct {
+    int nivel;                       // Nível de acesso do LOGIN (-1 = ainda não autenticado)
+    SaidaBuffer saida;               // Respostas
+    long erros;                      // Respostas ERRO dadas até agora
+} Sessao;
+
+// Comando do protocolo. 'executar' escreve a resposta (OK ou ERRO) a partir
+// de 'sistema' (os dados vivos ou uma foto) e, nos comandos que alteram os
+// dados, retorna 1 se houve alteração a confirmar.
+typedef struct {
+    const char *nome;
+    int campos;                      // Quantidade exata de argumentos
+    int nivel_minimo;                // -1 = não exige LOGIN
+    int altera;                      // 1 = altera os dados (no servidor: trava exclusiva e salvar_dados)
+    int foto;                        // 1 = consulta longa: no servidor, roda sobre uma foto, sem trava
+    int (*executar)(Sessao *sessao, DadosSistema *sistema, char **campos);
+} Comando;
+
+// Resultado da interpretação de um pedido
+typedef enum {
+    PEDIDO_RESPONDIDO,               // Já respondido (LOGIN ou erro de sintaxe/acesso)
+    PEDIDO_EXECUTAR,                 // Falta executar o comando retornado
+    PEDIDO_SAIR                      // SAIR: já respondido, a sessão termina
+} TipoPedido;
+
+typedef struct {
+    long pedidos;                    // Linhas de pedido lidas (sem as vazias)
+    long erros;                      // Pedidos respondidos com ERRO
+} ResumoComandos;
+
+TipoPedido interpretar_pedido(Sessao *sessao, char *linha, const Comando **comando, char **campos);
+void responder_erro(Sessao *sessao, const char *motivo);
+int executar_comandos(DadosSistema *sistema, FILE *entrada, FILE *destino, ResumoComandos *resumo);
+
+#endif // PROTOCOLO_H
@@ -0,0 +1,157 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "saida.h"
+
+// --- 1. Buffer ---
+
+/**
+ * @brief Prepara a saída com buffer para escrever no arquivo indicado.
+ * @param saida Estrutura a inicializar.
+ * @param arquivo Arquivo de destino (já aberto para escrita).
+ * @return int 1 se sucesso, 0 se faltou memória.
+ */
+int saida_iniciar(SaidaBuffer *saida, FILE *arquivo) {
+    saida->arquivo = arquivo;
+    saida->usado = 0;
+    saida->erro = 0;
+    saida->buffer = malloc(TAM_BUFFER_SAIDA);
+    return saida->buffer != NULL;
+}
+
+/**
+ * @brief Escreve no arquivo tudo o que está no buffer.
+ * @param saida Ponteiro para a saída.
+ */
+void saida_descarregar(SaidaBuffer *saida) {
+    if (saida->usado > 0 && !saida->erro &&
+        fwrite(saida->buffer, 1, saida->usado, saida->arquivo) != saida->usado) {
+        saida->erro = 1;
+    }
+    saida->usado = 0;
+}
+
+/**
+ * @brief Descarrega o buffer, faz o fflush do arquivo e libera a memória.
+ * O arquivo continua aberto (fechá-lo é responsabilidade de quem o abriu).
+ * @param saida Ponteiro para a saída.
+ * @return int 1 se tudo foi escrito, 0 se alguma escrita falhou.
+ */
+int saida_concluir(SaidaBuffer *saida) {
+    saida_descarregar(saida);
+    if (fflush(saida->arquivo) != 0) saida->erro = 1;
+    free(saida->buffer);
+    saida->buffer = NULL;
+    return !saida->erro;
+}
+
+/**
+ * @brief Escreve bytes quaisquer.
+ */
+void saida_bytes(SaidaBuffer *saida, const char *dados, size_t tamanho) {
+    while (tamanho > 0) {
+        if (saida->usado == TAM_BUFFER_SAIDA) saida_descarregar(saida);
+        size_t parte = TAM_BUFFER_SAIDA - saida->usado;
+        if (parte > tamanho) parte = tamanho;
+        memcpy(saida->buffer + saida->usado, dados, parte);
+        saida->usado += parte;
+        dados += parte;
+        tamanho -= parte;
+    }
+}
+
+/**
+ * @brief Escreve uma string terminada em '\0', sem escape.
+ */
+void saida_texto(SaidaBuffer *saida, const char *texto) {
+    saida_bytes(saida, texto, strlen(texto));
+}
+
+// --- 2. Números ---
+
+/**
+ * @brief Escreve um inteiro em decimal.
+ */
+void saida_inteiro(SaidaBuffer *saida, long valor) {
+    char digitos[24];
+    int n = sizeof(digitos);
+    unsigned long v = valor < 0 ? 0UL - (unsigned long)valor : (unsigned long)valor;
+
+    do {
+        digitos[--n] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    if (valor < 0) digitos[--n] = '-';
+    saida_bytes(saida, digitos + n, sizeof(digitos) - n);
+}
+
+/**
+ * @brief Escreve um número com 2 casas decimais, com o mesmo resultado de "%.2f".
+ * valor * 100 é exato em double (o float tem 24 bits de mantissa), então o
+ * arredondamento para o centésimo mais próximo, com empate para o par, é o
+ * mesmo que o printf faz. Valores fora da faixa usual caem no snprintf.
+ */
+void saida_decimal(SaidaBuffer *saida, float valor) {
+    if (!(valor > -1e9f && valor < 1e9f)) {
+        char texto[64];
+        int n = snprintf(texto, sizeof(texto), "%.2f", valor);
+        saida_bytes(saida, texto, (size_t)n);
+        return;
+    }
+
+    int negativo = signbit(valor) != 0; // Como o printf: -0.001 sai "-0.00"
+    double centesimos = fabs((double)valor * 100.0);
+    long inteiro = (long)centesimos;
+    double resto = centesimos - (double)inteiro;
+    if (resto > 0.5 || (resto == 0.5 && (inteiro & 1))) inteiro++;
+
+    if (negativo) saida_caractere(saida, '-');
+    saida_inteiro(saida, inteiro / 100);
+    saida_caractere(saida, '.');
+    saida_caractere(saida, (char)('0' + inteiro % 100 / 10));
+    saida_caractere(saida, (char)('0' + inteiro % 10));
+}
+
+// --- 3. Campos com Escape ---
+
+/**
+ * @brief Escreve um campo CSV: entre aspas (com aspas internas dobradas) só se
+ * contiver vírgula, aspas ou quebra de linha.
+ */
+void saida_campo_csv(SaidaBuffer *saida, const char *texto) {
+    size_t tamanho = strcspn(texto, ",\"\r\n");
+    if (texto[tamanho] == '\0') {
+        saida_bytes(saida, texto, tamanho);
+        return;
+    }
+
+    saida_caractere(saida, '"');
+    for (const char *p = texto; *p != '\0'; p++) {
+        if (*p == '"') saida_caractere(saida, '"');
+        saida_caractere(saida, *p);
+    }
+    saida_caractere(saida, '"');
+}
+
+/**
+ * @brief Escreve uma string JSON (entre aspas, com escape de aspas, barra
+ * invertida e caracteres de controle).
+ */
+void saida_string_json(SaidaBuffer *saida, const char *texto) {
+    static const char hexa[] = "0123456789abcdef";
+
+    saida_caractere(saida, '"');
+    for (const unsigned char *p = (const unsigned char *)texto; *p != '\0'; p++) {
+        if (*p == '"' || *p == '\\') {
+            saida_caractere(saida, '\\');
+            saida_caractere(saida, (char)*p);
+        } else if (*p < 0x20) {
+            saida_bytes(saida, "\\u00", 4);
+            saida_caractere(saida, hexa[*p >> 4]);
+            saida_caractere(saida, hexa[*p & 0xF]);
+        } else {
+            saida_caractere(saida, (char)*p);
+        }
+    }
+    saida_caractere(saida, '"');
+}
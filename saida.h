@@ -0,0 +1,41 @@
+#ifndef SAIDA_H
+#define SAIDA_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// --- Saída com Buffer Grande ---
+//
+// Escrita formatada sem printf: o texto é montado num buffer próprio e vai
+// para o arquivo em blocos de TAM_BUFFER_SAIDA com um único fwrite. Números
+// são convertidos à mão (inteiros e decimais com 2 casas, arredondados como
+// o "%.2f"), e há escrita de campos com escape para CSV e para JSON.
+
+#define TAM_BUFFER_SAIDA (1 << 20) // Descarrega em blocos de 1 MB
+
+typedef struct {
+    FILE *arquivo;    // Destino
+    char *buffer;     // Texto ainda não escrito
+    size_t usado;     // Bytes ocupados em 'buffer'
+    int erro;         // 1 se algum fwrite falhou (as escritas seguintes são ignoradas)
+} SaidaBuffer;
+
+int saida_iniciar(SaidaBuffer *saida, FILE *arquivo);
+int saida_concluir(SaidaBuffer *saida);
+void saida_descarregar(SaidaBuffer *saida);
+void saida_bytes(SaidaBuffer *saida, const char *dados, size_t tamanho);
+void saida_texto(SaidaBuffer *saida, const char *texto);
+void saida_inteiro(SaidaBuffer *saida, long valor);
+void saida_decimal(SaidaBuffer *saida, float valor);
+void saida_campo_csv(SaidaBuffer *saida, const char *texto);
+void saida_string_json(SaidaBuffer *saida, const char *texto);
+
+/**
+ * @brief Escreve um caractere (O(1)).
+ */
+static inline void saida_caractere(SaidaBuffer *saida, char c) {
+    if (saida->usado == TAM_BUFFER_SAIDA) saida_descarregar(saida);
+    saida->buffer[saida->usado++] = c;
+}
+
+#endif // SAIDA_H
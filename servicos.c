@@ -1,32 +1,61 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <time.h>
+#include <math.h>
 #include "servicos.h"
+#include "metricas.h"
+#include "arquivos.h"
+#include "formato.h"
 
-// Protótipo da função auxiliar de ordenação (necessária para qsort ou bubble sort)
-void trocar_alunos(Aluno *a, Aluno *b); 
-int buscar_aluno_por_ra(const DadosSistema *sistema, const char *ra);
-int buscar_turma_por_id(const DadosSistema *sistema, int id_turma);
 void calcular_media(Aluno *aluno);
 
+// Média aritmética simples; aprovado com 7, recuperação com 5
+const PoliticaNotas politica_notas = {{1.0f, 1.0f, 1.0f}, 7.0f, 5.0f};
+
+// Percentis: grupos até este tamanho são copiados e ordenados; os maiores passam
+// pela seleção em duas passadas, com uma contagem por faixa (16 bits altos da chave)
+#define LIMIAR_SELECAO_DIRETA 4096
+#define FAIXAS_SELECAO 65536
+
 // --- 1. Autenticação ---
 
 /**
- * @brief Tenta autenticar o usuário no sistema.
- * * Verifica se o login e senha correspondem a um usuário fixo predefinido e, 
- * se sim, define o nível de acesso do usuário.
- * * @param nivel_acesso Ponteiro para armazenar o nível de acesso (0=Aluno, 1=Prof, 2=Admin).
- * @return int 1 se o login for bem-sucedido, 0 caso contrário.
+ * @brief Confere login e senha com os usuários fixos predefinidos (sem ler do terminal).
+ * @param login Login informado.
+ * @param senha Senha informada.
+ * @return int O nível de acesso do usuário (0=Aluno, 1=Prof, 2=Admin), ou -1 se não conferem.
  */
-int realizar_login(int *nivel_acesso) {
+int autenticar_usuario(const char *login, const char *senha) {
+    METRICA_MEDIR(METRICA_AUTENTICAR_USUARIO);
     // Usuários fixos do sistema (você pode customizar isso)
-    Usuario usuarios_fixos[] = {
+    static const Usuario usuarios_fixos[] = {
         {"admin", "master", NIVEL_ADMIN},
         {"222", "senha222", NIVEL_PROFESSOR},
         {"111", "senha111", NIVEL_ALUNO}
     };
     int total_usuarios = sizeof(usuarios_fixos) / sizeof(Usuario);
 
+    // Busca o usuário na lista
+    for (int i = 0; i < total_usuarios; i++) {
+        if (strcmp(login, usuarios_fixos[i].login) == 0 && 
+            strcmp(senha, usuarios_fixos[i].senha) == 0) {
+            return usuarios_fixos[i].nivel_acesso;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Tenta autenticar o usuário no sistema.
+ * * Lê login e senha do terminal e, se correspondem a um usuário fixo
+ * predefinido, define o nível de acesso do usuário.
+ * * @param nivel_acesso Ponteiro para armazenar o nível de acesso (0=Aluno, 1=Prof, 2=Admin).
+ * @return int 1 se o login for bem-sucedido, 0 caso contrário.
+ */
+int realizar_login(int *nivel_acesso) {
     char login[TAM_RA];
     char senha[TAM_SENHA];
 
@@ -39,438 +68,1443 @@ int realizar_login(int *nivel_acesso) {
     fgets(senha, TAM_SENHA, stdin);
     senha[strcspn(senha, "\n")] = 0;
 
-    // Busca o usuário na lista
-    for (int i = 0; i < total_usuarios; i++) {
-        if (strcmp(login, usuarios_fixos[i].login) == 0 && 
-            strcmp(senha, usuarios_fixos[i].senha) == 0) {
-            
-            *nivel_acesso = usuarios_fixos[i].nivel_acesso;
-            printf("\nLogin SUCESSO! Nivel de Acesso: %d.\n", *nivel_acesso);
-            return 1; // Sucesso
-        }
+    *nivel_acesso = autenticar_usuario(login, senha);
+    if (*nivel_acesso != -1) {
+        printf("\nLogin SUCESSO! Nivel de Acesso: %d.\n", *nivel_acesso);
+        return 1; // Sucesso
     }
-
-    *nivel_acesso = -1; // Falha
-    return 0; 
+    return 0; // Falha
 }
 
 
 // --- 2. Persistência de Dados (I/O) ---
 
 /**
- * @brief Carrega a estrutura de dados (alunos, turmas) de um arquivo binário.
- * Se o arquivo não existir ou for inválido, inicializa a estrutura do sistema.
- * @param sistema Ponteiro para a estrutura DadosSistema a ser carregada.
+ * @brief Abre o arquivo base para as tabelas vazias (só cabeçalho e diretório;
+ * as páginas são lidas sob demanda, ver formato.h).
+ * Um arquivo em formato antigo (nome dentro do registro) é convertido para a
+ * memória e regravado no formato atual pelo checkpoint de carregar_dados. Um
+ * arquivo que não pode ser usado é renomeado para NOME_ARQUIVO ".invalido",
+ * em vez de ser sobrescrito pela próxima gravação do sistema vazio.
+ * @param sistema Ponteiro para a estrutura DadosSistema (pools vazios).
+ * @return int 1 se o arquivo foi aberto, 0 se o sistema deve começar vazio.
  */
-void carregar_dados(DadosSistema *sistema) {
-    FILE *f = fopen(NOME_ARQUIVO, "rb");
+static int ler_arquivo_base(DadosSistema *sistema) {
+    int resultado = formato_abrir(sistema, NOME_ARQUIVO);
 
-    if (f == NULL || fread(sistema, sizeof(DadosSistema), 1, f) != 1) {
-        printf("AVISO: Arquivo de dados nao encontrado ou invalido. Inicializando o sistema...\n");
-        // Inicializa o sistema se a leitura falhar
-        sistema->total_turmas = 0;
-        sistema->total_alunos = 0;
-        // Marca todos como inativos (limpeza de memória)
-        for (int i = 0; i < MAX_TURMAS; i++) sistema->turmas[i].ativo = 0;
-        for (int i = 0; i < MAX_ALUNOS; i++) sistema->alunos[i].ativo = 0;
-    } else {
-        printf("SUCESSO: Dados carregados do arquivo '%s'.\n", NOME_ARQUIVO);
-        fclose(f);
+    if (resultado == FORMATO_ANTIGO) {
+        if (formato_converter(sistema, NOME_ARQUIVO)) {
+            // Até o checkpoint, o arquivo no disco continua antigo: nada pode ir para o diário
+            sistema->diario.incompleto = 1;
+            printf("SUCESSO: Arquivo '%s' convertido do formato antigo (sera regravado na versao %d).\n",
+                   NOME_ARQUIVO, VERSAO_FORMATO);
+            return 1;
+        }
+        printf("ERRO: Falha ao converter o arquivo '%s' do formato antigo.\n", NOME_ARQUIVO);
     }
-}
 
-/**
- * @brief Salva a estrutura de dados (alunos, turmas) em um arquivo binário.
- * @param sistema Ponteiro para a estrutura DadosSistema a ser salva.
- */
-void salvar_dados(const DadosSistema *sistema) {
-    FILE *f = fopen(NOME_ARQUIVO, "wb");
-    if (f == NULL) {
-        printf("ERRO: Nao foi possivel abrir o arquivo para salvar os dados.\n");
-        return;
+    switch (resultado) {
+        case FORMATO_OK:
+            return 1;
+        case FORMATO_AUSENTE:
+            return 0;
+        case FORMATO_INCOMPATIVEL:
+            printf("ERRO: '%s' foi gravado por outra versao do sistema (versao ou tamanho dos registros diferente).\n",
+                   NOME_ARQUIVO);
+            break;
+        case FORMATO_SEM_MEMORIA:
+            printf("ERRO: Memoria insuficiente para abrir o arquivo '%s'.\n", NOME_ARQUIVO);
+            break;
+        case FORMATO_CORROMPIDO:
+            printf("ERRO: O cabecalho do arquivo '%s' esta corrompido.\n", NOME_ARQUIVO);
+            break;
     }
 
-    if (fwrite(sistema, sizeof(DadosSistema), 1, f) != 1) {
-        printf("ERRO: Falha ao escrever os dados no arquivo.\n");
-    } else {
-        // printf("SUCESSO: Dados salvos em '%s'.\n", NOME_ARQUIVO); // Comentado para evitar poluição no console
+    pool_liberar(&sistema->turmas);
+    pool_liberar(&sistema->alunos);
+    pool_liberar(&sistema->textos);
+    if (arquivo_substituir(NOME_ARQUIVO, NOME_ARQUIVO ".invalido")) {
+        printf("AVISO: O arquivo foi preservado como '%s'.\n", NOME_ARQUIVO ".invalido");
     }
-
-    fclose(f);
+    return 0;
 }
 
-
-// --- 3. Auxiliares e Busca ---
-
 /**
- * @brief Busca o índice de um aluno ativo pelo RA.
+ * @brief Mapeia o arquivo de uma tabela, sem ler os registros. Um arquivo do
+ * layout antigo (nome dentro do registro) é convertido para a tabela em
+ * memória, com os nomes no heap; quem chama recria o arquivo.
  * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param ra O Registro Acadêmico a ser buscado.
- * @return int O índice do aluno no array, ou -1 se não for encontrado ou estiver inativo.
+ * @param tabela sistema->turmas ou sistema->alunos (vazio).
+ * @param caminho Arquivo mapeado da tabela.
+ * @param ativos Recebe os registros ativos gravados no cabeçalho.
+ * @param proximo_id Recebe o proximo_id gravado no cabeçalho.
+ * @param convertida Recebe 1 se a tabela veio do layout antigo.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
  */
-int buscar_aluno_por_ra(const DadosSistema *sistema, const char *ra) {
-    for (int i = 0; i < MAX_ALUNOS; i++) {
-        // Busca apenas alunos ATIVOS
-        if (sistema->alunos[i].ativo == 1 && strcmp(sistema->alunos[i].ra, ra) == 0) {
-            return i;
-        }
+static int abrir_tabela_mapeada(DadosSistema *sistema, PoolRegistros *tabela, const char *caminho,
+                                int *ativos, int *proximo_id, int *convertida) {
+    *convertida = 0;
+    if (mapa_abrir(tabela, caminho, ativos)) {
+        *proximo_id = tabela->mapa->cabecalho->proximo_id;
+        return 1;
     }
-    return -1;
+
+    int alunos = tabela == &sistema->alunos;
+    PoolRegistros antiga;
+    pool_inicializar(&antiga, alunos ? sizeof(AlunoAntigo) : sizeof(TurmaAntiga));
+    if (!mapa_abrir(&antiga, caminho, ativos)) return 0;
+    *proximo_id = antiga.mapa->cabecalho->proximo_id;
+
+    int ok = pool_estender(tabela, antiga.usados);
+    for (int i = 0; ok && i < antiga.usados; i++) {
+        ok = alunos ? formato_converter_aluno(sistema, pool_slot(&antiga, i), aluno_em(sistema, i))
+                    : formato_converter_turma(sistema, pool_slot(&antiga, i), turma_em(sistema, i));
+    }
+    pool_liberar(&antiga);
+    *convertida = ok;
+    return ok;
 }
 
 /**
- * @brief Busca o índice de uma turma ativa pelo ID.
- * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param id_turma O ID da turma a ser buscado.
- * @return int O índice da turma no array, ou -1 se não for encontrada ou estiver inativa.
+ * @brief Mapeia os arquivos das tabelas e do heap de textos (modo mapeado), sem ler os registros.
+ * Arquivos de tabela do layout antigo são convertidos e recriados; o heap vai
+ * para o disco antes deles, porque as tabelas novas apontam para os nomes.
+ * @param sistema Ponteiro para a estrutura DadosSistema (pools vazios).
+ * @return int 1 se tudo foi mapeado, 0 caso contrário.
  */
-int buscar_turma_por_id(const DadosSistema *sistema, int id_turma) {
-    for (int i = 0; i < MAX_TURMAS; i++) {
-        // Busca apenas turmas ATIVAS e com ID correspondente
-        if (sistema->turmas[i].ativo == 1 && sistema->turmas[i].id == id_turma) {
-            return i;
+static int abrir_tabelas_mapeadas(DadosSistema *sistema) {
+    int ativos, proximo_id, turmas_antigas, alunos_antigos;
+    int textos_mapeados = mapa_existe(NOME_MAPA_TEXTOS) && mapa_abrir(&sistema->textos, NOME_MAPA_TEXTOS, &ativos);
+    int ok = abrir_tabela_mapeada(sistema, &sistema->turmas, NOME_MAPA_TURMAS, &sistema->total_turmas,
+                                  &sistema->proximo_id_turma, &turmas_antigas) &&
+             abrir_tabela_mapeada(sistema, &sistema->alunos, NOME_MAPA_ALUNOS, &sistema->total_alunos,
+                                  &proximo_id, &alunos_antigos);
+
+    if (ok && (turmas_antigas || alunos_antigos)) {
+        ok = (textos_mapeados ? mapa_sincronizar_tudo(&sistema->textos, 0)
+                              : mapa_criar(&sistema->textos, NOME_MAPA_TEXTOS, 0)) &&
+             (!turmas_antigas || mapa_criar(&sistema->turmas, NOME_MAPA_TURMAS, sistema->total_turmas)) &&
+             (!alunos_antigos || mapa_criar(&sistema->alunos, NOME_MAPA_ALUNOS, sistema->total_alunos));
+        if (ok) {
+            sistema->turmas.mapa->cabecalho->proximo_id = sistema->proximo_id_turma;
+            diario_descartar_alteracoes(&sistema->diario); // Os nomes já estão no arquivo do heap
+            printf("SUCESSO: Arquivos mapeados convertidos para o layout com heap de nomes.\n");
         }
+        textos_mapeados = ok;
     }
-    return -1;
+    sistema->mapeado = ok && textos_mapeados;
+    return sistema->mapeado;
 }
 
 /**
- * @brief Exibe uma lista de todas as turmas ativas no sistema.
- * Ajuda o usuário a escolher um ID.
- * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @brief Carrega a estrutura de dados (alunos, turmas) de um arquivo binário.
+ * Depois do arquivo base, reaplica as alterações confirmadas no diário.
+ * Se o arquivo não existir ou for inválido, inicializa a estrutura do sistema.
+ * Arquivos em formatos antigos (inclusive o de vetores fixos) são convertidos.
+ * Do arquivo base só são lidos o cabeçalho e o diretório de páginas; cada
+ * página é lida no primeiro acesso a um de seus registros.
+ * Se existirem os arquivos do modo mapeado, eles são usados no lugar do arquivo
+ * base: a carga só mapeia os arquivos, sem ler os registros. No modo
+ * fragmentado só o catálogo das turmas é lido; os alunos vêm dos segmentos
+ * das turmas, no primeiro uso (ver fragmentos.h). Em todos os modos os
+ * índices em memória são montados no primeiro uso, não aqui.
+ * @param sistema Ponteiro para a estrutura DadosSistema a ser carregada.
  */
-void listar_todas_turmas(const DadosSistema *sistema) {
-    printf("\n--- Turmas Ativas ---\n");
-    int encontrou = 0;
-    for (int i = 0; i < MAX_TURMAS; i++) {
-        if (sistema->turmas[i].ativo == 1) {
-            printf("ID: %d | Nome: %s | Vagas: %d/%d\n", 
-                   sistema->turmas[i].id, 
-                   sistema->turmas[i].nome, 
-                   sistema->turmas[i].vagas_ocupadas, 
-                   sistema->turmas[i].vagas_maximas);
-            encontrou = 1;
+void carregar_dados(DadosSistema *sistema) {
+    METRICA_MEDIR(METRICA_CARREGAR_DADOS);
+    pool_inicializar(&sistema->turmas, sizeof(Turma));
+    pool_inicializar(&sistema->alunos, sizeof(Aluno));
+    pool_inicializar(&sistema->textos, TAM_CELULA_TEXTO);
+    indice_textos_inicializar(&sistema->internados);
+    indice_ra_inicializar(&sistema->indice_ra);
+    indice_turmas_inicializar(&sistema->membros);
+    indice_nomes_inicializar(&sistema->nomes);
+    indice_ids_inicializar(&sistema->ids);
+    indice_livres_inicializar(&sistema->turmas_livres);
+    indice_livres_inicializar(&sistema->alunos_livres);
+    indice_estatisticas_inicializar(&sistema->estatisticas);
+    indice_trigramas_inicializar(&sistema->trigramas);
+    colunas_inicializar(&sistema->colunas);
+    diario_inicializar(&sistema->diario);
+    fragmentos_inicializar(&sistema->fragmentos);
+    transacao_inicializar(&sistema->transacao);
+    sistema->total_turmas = 0;
+    sistema->total_alunos = 0;
+    sistema->proximo_id_turma = 0;
+    sistema->mapeado = 0;
+
+    if (mapa_existe(NOME_MAPA_ALUNOS)) {
+        if (abrir_tabelas_mapeadas(sistema)) {
+            printf("SUCESSO: Dados mapeados dos arquivos '%s' e '%s'.\n", NOME_MAPA_TURMAS, NOME_MAPA_ALUNOS);
+        } else {
+            printf("ERRO: Arquivos mapeados invalidos ou inacessiveis. Inicializando o sistema...\n");
+            liberar_dados(sistema);
         }
+    } else if (fragmentos_existe()) {
+        if (fragmentos_abrir(sistema)) {
+            // Os nomes lidos já estão nos arquivos: nada a gravar
+            diario_descartar_alteracoes(&sistema->diario);
+            printf("SUCESSO: Catalogo '%s' carregado (%d turmas; os alunos sao lidos por turma, no primeiro uso).\n",
+                   NOME_CATALOGO, sistema->total_turmas);
+            return;
+        }
+        printf("ERRO: Catalogo '%s' invalido ou inacessivel. Inicializando o sistema...\n", NOME_CATALOGO);
+        liberar_dados(sistema);
+        if (arquivo_substituir(NOME_CATALOGO, NOME_CATALOGO ".invalido")) {
+            printf("AVISO: O catalogo foi preservado como '%s'.\n", NOME_CATALOGO ".invalido");
+        }
+    } else if (ler_arquivo_base(sistema)) {
+        printf("SUCESSO: Dados carregados do arquivo '%s'.\n", NOME_ARQUIVO);
+    } else {
+        printf("AVISO: Arquivo de dados nao encontrado ou invalido. Inicializando o sistema...\n");
+        // Inicializa o sistema se a leitura falhar (tabelas vazias)
+        liberar_dados(sistema);
     }
-    if (!encontrou) {
-        printf("Nenhuma turma ativa cadastrada.\n");
+
+    // Reaplica as operações confirmadas depois do último checkpoint
+    int reaplicadas = diario_reaplicar(sistema, NOME_DIARIO);
+    if (reaplicadas < 0) {
+        printf("ERRO: Diario '%s' invalido ou de outra versao. Alteracoes nao reaplicadas.\n", NOME_DIARIO);
+    } else if (reaplicadas > 0) {
+        printf("SUCESSO: %d operacoes reaplicadas do diario '%s'.\n", reaplicadas, NOME_DIARIO);
+    }
+    // Dados convertidos de um formato antigo (ficam marcados no diário) ou, no modo
+    // mapeado, imagens aplicadas direto nos arquivos: grava e esvazia o diário
+    if (diario_tem_alteracoes(&sistema->diario) || (reaplicadas > 0 && sistema->mapeado)) {
+        checkpoint_dados(sistema);
     }
-    printf("---------------------\n");
 }
 
 /**
- * @brief Calcula a média aritmética das 3 notas de um aluno.
- * @param aluno Ponteiro para a estrutura Aluno.
+ * @brief Monta os índices em memória (e as colunas dos alunos, das quais eles
+ * são montados) que ainda não foram montados.
+ * Os índices são caches derivados das tabelas, por isso podem ser montados a
+ * partir de uma consulta const. Chamar antes de uso concorrente dos dados.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return int 1 se todos estão prontos, 0 se faltou memória.
  */
-void calcular_media(Aluno *aluno) {
-    aluno->media_final = (aluno->notas[0] + aluno->notas[1] + aluno->notas[2]) / 3.0f;
+int preparar_indices(const DadosSistema *sistema) {
+    METRICA_MEDIR(METRICA_PREPARAR_INDICES);
+    DadosSistema *cache = (DadosSistema *)sistema;
+    int ok = colunas_montadas(sistema) != NULL &&
+             (cache->ids.pronto || indice_ids_reconstruir(sistema, &cache->ids)) &&
+             (cache->indice_ra.pronto || indice_ra_reconstruir(sistema, &cache->indice_ra)) &&
+             (cache->membros.pronto || indice_turmas_reconstruir(sistema, &cache->membros)) &&
+             (cache->nomes.pronto || indice_nomes_reconstruir(sistema, &cache->nomes)) &&
+             (cache->turmas_livres.pronto ||
+              indice_livres_reconstruir(&cache->turmas_livres, &sistema->turmas, offsetof(Turma, ativo))) &&
+             (cache->alunos_livres.pronto ||
+              indice_livres_reconstruir(&cache->alunos_livres, &sistema->alunos, offsetof(Aluno, ativo))) &&
+             (cache->estatisticas.pronto || indice_estatisticas_reconstruir(sistema, &cache->estatisticas)) &&
+             (cache->trigramas.pronto || indice_trigramas_reconstruir(sistema, &cache->trigramas));
+    if (!ok) {
+        printf("ERRO: Memoria insuficiente para indexar os dados carregados.\n");
+    }
+    return ok;
 }
 
-// --- 4. Gerenciamento (CREATE) ---
-
 /**
- * @brief Adiciona uma nova turma ao sistema.
- * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param nome Nome da nova turma.
- * @param vagas Número máximo de vagas.
- * @return int 1 se adicionada com sucesso, 0 caso contrário.
+ * @brief Grava o estado completo no arquivo base (checkpoint) e esvazia o diário.
+ * O arquivo é escrito num temporário, sincronizado e renomeado por cima do
+ * antigo, então uma queda no meio nunca deixa um arquivo base pela metade.
+ * No modo mapeado, o checkpoint é um msync de todas as páginas alteradas; no
+ * modo fragmentado, todos os segmentos e o catálogo são regravados.
+ * @param sistema Ponteiro para a estrutura DadosSistema a ser salva.
+ * @return int 1 se bem-sucedido, 0 caso contrário (o diário continua valendo).
  */
-int adicionar_turma(DadosSistema *sistema, const char *nome, int vagas) {
-    if (sistema->total_turmas >= MAX_TURMAS) {
-        // Limite máximo de turmas atingido
+int checkpoint_dados(DadosSistema *sistema) {
+    METRICA_MEDIR(METRICA_CHECKPOINT_DADOS);
+    if (sistema->transacao.ativa) {
+        printf("AVISO: Ha uma transacao aberta; o estado completo sera gravado depois dela.\n");
         return 0;
     }
-    if (vagas <= 0) {
-        printf("ERRO: O numero de vagas deve ser positivo.\n");
+    if (sistema->fragmentos.ativo) {
+        if (!fragmentos_gravar(sistema, 1)) return 0;
+        diario_descartar_alteracoes(&sistema->diario);
+        return 1;
+    }
+    if (sistema->mapeado) {
+        sistema->turmas.mapa->cabecalho->proximo_id = sistema->proximo_id_turma;
+        if (!mapa_sincronizar_tudo(&sistema->textos, 0) ||
+            !mapa_sincronizar_tudo(&sistema->turmas, sistema->total_turmas) ||
+            !mapa_sincronizar_tudo(&sistema->alunos, sistema->total_alunos)) {
+            printf("ERRO: Falha ao gravar os arquivos mapeados.\n");
+            return 0;
+        }
+        diario_descartar_alteracoes(&sistema->diario);
+        diario_reiniciar(&sistema->diario);
+        return 1;
+    }
+
+    // Confirmações ainda na fila do gravador vão para o diário antes de o arquivo base mudar
+    diario_sincronizar(&sistema->diario);
+
+    // Páginas ainda não lidas precisam estar em memória antes de o arquivo base ser trocado
+    int turmas_integras = pool_carregar_tudo(&sistema->turmas);
+    int alunos_integros = pool_carregar_tudo(&sistema->alunos);
+    int textos_integros = pool_carregar_tudo(&sistema->textos);
+    if (!turmas_integras || !alunos_integros || !textos_integros) {
+        printf("ERRO: O arquivo de dados tem paginas corrompidas e nao sera sobrescrito.\n");
         return 0;
     }
 
-    // Procura a primeira posição inativa (liberada)
-    for (int i = 0; i < MAX_TURMAS; i++) {
-        if (sistema->turmas[i].ativo == 0) {
-            // Inicializa a nova turma
-            sistema->turmas[i].id = i + 1; // ID baseado no índice + 1 (para IDs > 0)
-            strncpy(sistema->turmas[i].nome, nome, TAM_NOME);
-            sistema->turmas[i].vagas_maximas = vagas;
-            sistema->turmas[i].vagas_ocupadas = 0;
-            sistema->turmas[i].ativo = 1;
+    const char *temporario = NOME_ARQUIVO ".tmp";
+    int ok = formato_gravar(sistema, temporario) && arquivo_substituir(temporario, NOME_ARQUIVO);
 
-            sistema->total_turmas++;
-            return 1;
-        }
+    if (!ok) {
+        printf("ERRO: Falha ao escrever os dados no arquivo.\n");
+        remove(temporario);
+        return 0;
     }
-    return 0; // Se não encontrou espaço ativo (embora o check inicial deve cobrir isso)
+
+    // O arquivo base já contém tudo: o diário pode recomeçar vazio
+    diario_descartar_alteracoes(&sistema->diario);
+    diario_reiniciar(&sistema->diario);
+    return 1;
 }
 
 /**
- * @brief Adiciona um novo aluno a uma turma específica.
+ * @brief No modo mapeado, grava no disco só as páginas dos registros marcados.
  * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param nome Nome do aluno.
- * @param ra Registro Acadêmico do aluno.
- * @param id_turma ID da turma a ser matriculado.
- * @return int 1 se adicionado com sucesso, 0 caso contrário.
+ * @return int 1 se bem-sucedido (ou fora do modo mapeado), 0 caso contrário.
  */
-int adicionar_aluno(DadosSistema *sistema, const char *nome, const char *ra, int id_turma) {
-    if (sistema->total_alunos >= MAX_ALUNOS) {
-        printf("ERRO: Limite maximo de alunos atingido.\n");
-        return 0;
-    }
-    if (buscar_aluno_por_ra(sistema, ra) != -1) {
-        printf("ERRO: RA '%s' ja cadastrado.\n", ra);
-        return 0;
-    }
+static int sincronizar_paginas_alteradas(DadosSistema *sistema) {
+    if (!sistema->mapeado) return 1;
+    const Diario *diario = &sistema->diario;
+    sistema->turmas.mapa->cabecalho->proximo_id = sistema->proximo_id_turma;
+    return mapa_sincronizar_slots(&sistema->textos, diario->textos.slots, diario->textos.quantidade, 0) &&
+           mapa_sincronizar_slots(&sistema->turmas, diario->turmas.slots, diario->turmas.quantidade,
+                                  sistema->total_turmas) &&
+           mapa_sincronizar_slots(&sistema->alunos, diario->alunos.slots, diario->alunos.quantidade,
+                                  sistema->total_alunos);
+}
 
-    int idx_turma = buscar_turma_por_id(sistema, id_turma);
-    if (idx_turma == -1) {
-        printf("ERRO: Turma ID %d nao encontrada ou inativa.\n", id_turma);
-        return 0;
-    }
-    if (sistema->turmas[idx_turma].vagas_ocupadas >= sistema->turmas[idx_turma].vagas_maximas) {
-        printf("ERRO: Turma '%s' esta cheia.\n", sistema->turmas[idx_turma].nome);
-        return 0;
-    }
+/**
+ * @brief Salva as alterações feitas desde a última gravação.
+ * Só os registros alterados são acrescentados ao diário (com fsync); quando o
+ * diário passa de LIMITE_DIARIO, o estado completo é gravado por checkpoint_dados.
+ * No modo mapeado, depois do diário, as páginas desses registros recebem msync;
+ * o diário continua garantindo que uma operação que altera vários registros
+ * não fique pela metade numa queda durante o msync.
+ * No modo fragmentado o diário não é usado: só os segmentos das turmas
+ * afetadas e o catálogo são regravados, juntos (ver fragmentos.h).
+ * Com uma transação aberta nada é gravado (ver transacao.h).
+ * Com um gravador ligado (iniciar_gravador), a confirmação vai para a fila da
+ * thread e salvar_dados não espera o disco; sincronizar_dados é a barreira.
+ * @param sistema Ponteiro para a estrutura DadosSistema a ser salva.
+ */
+void salvar_dados(DadosSistema *sistema) {
+    METRICA_MEDIR(METRICA_SALVAR_DADOS);
+    Diario *diario = &sistema->diario;
+    if (sistema->transacao.ativa) return; // Tudo é gravado junto por confirmar_transacao
 
-    // Procura a primeira posição inativa (liberada)
-    for (int i = 0; i < MAX_ALUNOS; i++) {
-        if (sistema->alunos[i].ativo == 0) {
-            // Inicializa o novo aluno
-            strncpy(sistema->alunos[i].ra, ra, TAM_RA);
-            strncpy(sistema->alunos[i].nome, nome, TAM_NOME);
-            sistema->alunos[i].id_turma = id_turma;
-            sistema->alunos[i].notas[0] = 0.0f;
-            sistema->alunos[i].notas[1] = 0.0f;
-            sistema->alunos[i].notas[2] = 0.0f;
-            sistema->alunos[i].media_final = 0.0f;
-            sistema->alunos[i].ativo = 1;
+    if (sistema->fragmentos.ativo) {
+        // Se a gravação falhar, as marcas ficam para a próxima
+        if (fragmentos_gravar(sistema, 0)) diario_descartar_alteracoes(diario);
+        return;
+    }
 
-            // Atualiza contadores
-            sistema->total_alunos++;
-            sistema->turmas[idx_turma].vagas_ocupadas++;
-            return 1;
+    // Caminho normal: só os registros alterados vão para o diário. Um lote de
+    // alterações maior que o próprio limite do diário vai direto para o checkpoint.
+    if (!diario->incompleto && diario_tamanho_pendente(diario) < LIMITE_DIARIO) {
+        if (diario_confirmar(sistema, diario) && sincronizar_paginas_alteradas(sistema)) {
+            diario_descartar_alteracoes(diario);
+            if (diario->tamanho < LIMITE_DIARIO) return;
+        } else {
+            printf("AVISO: Falha ao gravar as alteracoes. Gravando o estado completo...\n");
         }
     }
-    return 0; // Falha (não deve acontecer se o total_alunos for verificado)
+    // Diário grande demais (ou inutilizável): checkpoint com o estado completo
+    checkpoint_dados(sistema);
 }
 
-
-// --- 5. Gerenciamento (UPDATE) ---
-
 /**
- * @brief Lança as notas N1, N2, N3 e atualiza a média de um aluno.
- * Verifica o nível de acesso (deve ser PROFESSOR ou ADMIN).
+ * @brief Libera a memória das tabelas, deixando o sistema vazio.
+ * Confirmações do diário ainda sem fsync são sincronizadas antes.
  * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param ra RA do aluno.
- * @param n1 Nota 1.
- * @param n2 Nota 2.
- * @param n3 Nota 3.
- * @param nivel_acesso Nível de acesso do usuário logado.
- * @return int 1 se as notas foram lançadas e a média atualizada, 0 caso contrário.
  */
-int lancar_notas_e_atualizar_media(DadosSistema *sistema, const char *ra, float n1, float n2, float n3, int nivel_acesso) {
-    if (nivel_acesso < NIVEL_PROFESSOR) {
-        printf("ACESSO NEGADO: Apenas Professor ou Admin podem lancar notas.\n");
-        return 0;
-    }
-    
-    int idx_aluno = buscar_aluno_por_ra(sistema, ra);
-    if (idx_aluno == -1) {
-        printf("ERRO: Aluno com RA '%s' nao encontrado ou inativo.\n", ra);
-        return 0;
+void liberar_dados(DadosSistema *sistema) {
+    // No modo mapeado, tudo o que foi salvo já recebeu msync: o diário não é mais necessário
+    if (sistema->mapeado && !diario_tem_alteracoes(&sistema->diario)) {
+        diario_reiniciar(&sistema->diario);
     }
-    
-    // Atualiza as notas e calcula a média
-    sistema->alunos[idx_aluno].notas[0] = n1;
-    sistema->alunos[idx_aluno].notas[1] = n2;
-    sistema->alunos[idx_aluno].notas[2] = n3;
-    calcular_media(&sistema->alunos[idx_aluno]);
-    
-    printf("SUCESSO: Notas de '%s' lancadas (Media: %.2f).\n", 
-           sistema->alunos[idx_aluno].nome, 
-           sistema->alunos[idx_aluno].media_final);
-    return 1;
+    pool_liberar(&sistema->turmas);
+    pool_liberar(&sistema->alunos);
+    pool_liberar(&sistema->textos);
+    indice_textos_liberar(&sistema->internados);
+    indice_ra_liberar(&sistema->indice_ra);
+    indice_turmas_liberar(&sistema->membros);
+    indice_nomes_liberar(&sistema->nomes);
+    indice_ids_liberar(&sistema->ids);
+    indice_livres_liberar(&sistema->turmas_livres);
+    indice_livres_liberar(&sistema->alunos_livres);
+    indice_estatisticas_liberar(&sistema->estatisticas);
+    indice_trigramas_liberar(&sistema->trigramas);
+    colunas_liberar(&sistema->colunas);
+    diario_liberar(&sistema->diario);
+    fragmentos_liberar(&sistema->fragmentos);
+    transacao_liberar(&sistema->transacao); // Uma transação aberta é descartada
+    sistema->total_turmas = 0;
+    sistema->total_alunos = 0;
+    sistema->proximo_id_turma = 0;
+    sistema->mapeado = 0;
 }
 
 /**
- * @brief Edita o nome e/ou a turma de um aluno.
- * Permite a alteração do nome e/ou a transferência de turma de um aluno ativo.
- * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param ra_antigo RA do aluno a ser editado.
- * @param nome_novo Novo nome (se vazio, mantém o atual).
- * @param id_turma_nova Novo ID da turma (se 0, mantém a atual).
- * @return int 1 se a edição foi bem-sucedida, 0 caso contrário.
+ * @brief Passa as tabelas para o modo mapeado (arquivos .map com mmap).
+ * Os registros atuais são copiados para os arquivos mapeados e, a partir daí,
+ * as próximas cargas só mapeiam esses arquivos (o arquivo base deixa de ser usado).
+ * O heap de textos é criado primeiro e o arquivo de alunos por último: é a
+ * presença dele que ativa o modo.
+ * @param sistema Ponteiro para a estrutura DadosSistema (sem alterações pendentes).
+ * @return int 1 se o modo mapeado está ativo, 0 caso contrário.
  */
-int editar_dados_aluno(DadosSistema *sistema, const char *ra_antigo, const char *nome_novo, int id_turma_nova) {
-    int idx_aluno = buscar_aluno_por_ra(sistema, ra_antigo);
-    if (idx_aluno == -1) {
-        printf("ERRO: Aluno com RA '%s' nao encontrado ou inativo.\n", ra_antigo);
+int ativar_modo_mapeado(DadosSistema *sistema) {
+    if (sistema->mapeado) return 1;
+    if (sistema->fragmentos.ativo) {
+        printf("AVISO: O modo fragmentado esta ativo. Modo mapeado nao ativado.\n");
         return 0;
     }
-    Aluno *aluno = &sistema->alunos[idx_aluno];
-    
-    printf("Editando Aluno: %s (RA: %s)\n", aluno->nome, aluno->ra);
-    int alterado = 0;
-
-    // 1. Atualizar Nome
-    if (strlen(nome_novo) > 0) {
-        strncpy(aluno->nome, nome_novo, TAM_NOME);
-        printf("Nome atualizado para: %s\n", nome_novo);
-        alterado = 1;
+    if (sistema->transacao.ativa) {
+        printf("AVISO: Ha uma transacao aberta. Modo mapeado nao ativado.\n");
+        return 0;
     }
-
-    // 2. Atualizar Turma (Transferência)
-    if (id_turma_nova != 0 && id_turma_nova != aluno->id_turma) {
-        int idx_turma_nova = buscar_turma_por_id(sistema, id_turma_nova);
-        
-        if (idx_turma_nova != -1) {
-            // Verifica vagas na nova turma
-            if (sistema->turmas[idx_turma_nova].vagas_ocupadas < sistema->turmas[idx_turma_nova].vagas_maximas) {
-                
-                // Libera vaga na turma antiga
-                int idx_turma_antiga = buscar_turma_por_id(sistema, aluno->id_turma);
-                if (idx_turma_antiga != -1) {
-                    sistema->turmas[idx_turma_antiga].vagas_ocupadas--;
-                }
-                
-                // Ocupa vaga na nova turma e atualiza o aluno
-                sistema->turmas[idx_turma_nova].vagas_ocupadas++;
-                aluno->id_turma = id_turma_nova;
-                printf("Turma atualizada para ID: %d (%s)\n", id_turma_nova, sistema->turmas[idx_turma_nova].nome);
-                alterado = 1;
-            } else {
-                printf("ERRO: Nova turma ID %d esta cheia. Turma nao alterada.\n", id_turma_nova);
-                return 0; // Falha na edição
-            }
-        } else {
-            printf("AVISO: ID de turma nova %d e invalido. Turma nao alterada.\n", id_turma_nova);
-        }
+    if (!mapa_disponivel()) {
+        printf("AVISO: Modo mapeado indisponivel nesta plataforma. Usando o arquivo '%s'.\n", NOME_ARQUIVO);
+        return 0;
     }
-    
-    if (!alterado) {
-        printf("AVISO: Nenhum dado alterado.\n");
+    if ((sistema->textos.mapa == NULL && !mapa_criar(&sistema->textos, NOME_MAPA_TEXTOS, 0)) ||
+        (sistema->turmas.mapa == NULL &&
+         !mapa_criar(&sistema->turmas, NOME_MAPA_TURMAS, sistema->total_turmas)) ||
+        !mapa_criar(&sistema->alunos, NOME_MAPA_ALUNOS, sistema->total_alunos)) {
+        printf("ERRO: Nao foi possivel criar os arquivos mapeados.\n");
         return 0;
     }
-    
-    printf("SUCESSO: Edicao de dados concluida.\n");
+    sistema->mapeado = 1;
+
+    // Os arquivos mapeados já contêm tudo o que estava no diário
+    diario_descartar_alteracoes(&sistema->diario);
+    diario_reiniciar(&sistema->diario);
+    printf("SUCESSO: Modo mapeado ativado ('%s', '%s', '%s').\n", NOME_MAPA_TURMAS, NOME_MAPA_ALUNOS,
+           NOME_MAPA_TEXTOS);
     return 1;
 }
 
-// --- 6. Gerenciamento (DELETE - Exclusão Lógica) ---
-
 /**
- * @brief Realiza a exclusão lógica de um aluno pelo RA.
- * A vaga na turma é liberada, e o aluno é marcado como inativo.
+ * @brief Passa os dados para o modo fragmentado (catálogo e um segmento por turma).
+ * O estado atual é gravado inteiro nos arquivos novos e, a partir daí, as
+ * próximas cargas leem só o catálogo (o arquivo base deixa de ser usado).
  * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param ra RA do aluno a ser inativado.
- * @return int 1 se o aluno foi excluído logicamente, 0 caso contrário.
+ * @return int 1 se o modo fragmentado está ativo, 0 caso contrário.
  */
-int excluir_aluno_por_ra(DadosSistema *sistema, const char *ra) {
-    int idx_aluno = buscar_aluno_por_ra(sistema, ra);
-    if (idx_aluno == -1) {
-        printf("ERRO: Aluno com RA '%s' nao encontrado ou ja inativo.\n", ra);
+int ativar_modo_fragmentado(DadosSistema *sistema) {
+    if (sistema->fragmentos.ativo) return 1;
+    if (sistema->mapeado) {
+        printf("AVISO: O modo mapeado esta ativo. Modo fragmentado nao ativado.\n");
         return 0;
     }
-
-    // Libera a vaga na turma
-    int idx_turma = buscar_turma_por_id(sistema, sistema->alunos[idx_aluno].id_turma);
-    if (idx_turma != -1) {
-        sistema->turmas[idx_turma].vagas_ocupadas--;
+    if (sistema->transacao.ativa) {
+        printf("AVISO: Ha uma transacao aberta. Modo fragmentado nao ativado.\n");
+        return 0;
+    }
+    // Páginas ainda não lidas do arquivo base vão para os segmentos
+    if (!pool_carregar_tudo(&sistema->turmas) || !pool_carregar_tudo(&sistema->alunos) ||
+        !pool_carregar_tudo(&sistema->textos)) {
+        printf("ERRO: O arquivo de dados tem paginas corrompidas. Modo fragmentado nao ativado.\n");
+        return 0;
+    }
+    sistema->fragmentos.ativo = 1;
+    if (!fragmentos_gravar(sistema, 1)) {
+        sistema->fragmentos.ativo = 0;
+        printf("ERRO: Nao foi possivel criar os segmentos das turmas.\n");
+        return 0;
     }
 
-    // Exclusão Lógica
-    sistema->alunos[idx_aluno].ativo = 0;
-    sistema->total_alunos--;
-
-    printf("SUCESSO: Aluno '%s' (RA: %s) excluido (logicamente) do sistema.\n", 
-           sistema->alunos[idx_aluno].nome, ra);
+    // O catálogo e os segmentos já contêm tudo o que estava no diário
+    diario_descartar_alteracoes(&sistema->diario);
+    diario_reiniciar(&sistema->diario);
+    printf("SUCESSO: Modo fragmentado ativado ('%s' e um arquivo '%s<id>.seg' por turma).\n", NOME_CATALOGO,
+           PREFIXO_SEGMENTO);
     return 1;
 }
 
 /**
- * @brief Realiza a exclusão lógica de uma turma e de todos os seus alunos (Cascata).
+ * @brief Passa a gravação do diário para uma thread em segundo plano (ver
+ * gravador.h): salvar_dados deixa de esperar o disco, e as confirmações
+ * seguidas são juntadas numa escrita. Só no modo com arquivo base: no modo
+ * mapeado o diário precisa estar no disco antes do msync das páginas, e o
+ * modo fragmentado não usa o diário.
  * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param id ID da turma a ser inativada.
- * @return int 1 se a turma foi excluída logicamente, 0 caso contrário.
+ * @param gravador Gravador (não inicializado) que fica ligado ao diário até encerrar_gravador.
+ * @param atraso_ms Espera para juntar confirmações seguidas.
+ * @return int 1 se a gravação em segundo plano está ativa, 0 se continua em salvar_dados.
  */
-int excluir_turma_por_id(DadosSistema *sistema, int id) {
-    int idx_turma = buscar_turma_por_id(sistema, id);
-    if (idx_turma == -1) {
-        printf("ERRO: Turma ID %d nao encontrada ou ja inativa.\n", id);
-        return 0;
-    }
-    
-    int alunos_excluidos = 0;
-    // Exclusão em Cascata (inativa todos os alunos vinculados à turma)
-    for (int i = 0; i < MAX_ALUNOS; i++) {
-        // Verifica se o aluno está ativo E pertence a esta turma
-        if (sistema->alunos[i].ativo == 1 && sistema->alunos[i].id_turma == id) {
-            sistema->alunos[i].ativo = 0; // Inativa o aluno
-            sistema->total_alunos--;      // Reduz o contador global
-            alunos_excluidos++;
-        }
-    }
-    
-    // Exclusão Lógica da Turma
-    sistema->turmas[idx_turma].ativo = 0;
-    sistema->turmas[idx_turma].vagas_ocupadas = 0; // Zera as vagas ocupadas, pois todos os alunos foram inativados
-    sistema->total_turmas--;
-
-    printf("SUCESSO: Turma '%s' (ID %d) excluida (logicamente).\n", 
-           sistema->turmas[idx_turma].nome, id);
-    printf("AVISO: %d alunos vinculados tambem foram inativados (cascata).\n", alunos_excluidos);
+int iniciar_gravador(DadosSistema *sistema, Gravador *gravador, int atraso_ms) {
+    if (sistema->mapeado || sistema->fragmentos.ativo) return 0;
+    if (!gravador_iniciar(gravador, atraso_ms, LOTE_GRAVACAO_BYTES)) return 0;
+    sistema->diario.gravador = gravador;
     return 1;
 }
 
-// --- 7. Lógica e Relatórios (READ) ---
-
 /**
- * @brief Função auxiliar de troca para o algoritmo de ordenação (ex: Bubble Sort).
- * @param a Ponteiro para o primeiro aluno.
- * @param b Ponteiro para o segundo aluno.
+ * @brief Grava o que está na fila do gravador, encerra a thread e volta a
+ * gravar o diário no próprio salvar_dados.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
  */
-void trocar_alunos(Aluno *a, Aluno *b) {
-    Aluno temp = *a;
-    *a = *b;
-    *b = temp;
+void encerrar_gravador(DadosSistema *sistema) {
+    if (sistema->diario.gravador == NULL) return;
+    diario_sincronizar(&sistema->diario);
+    gravador_encerrar(sistema->diario.gravador);
+    sistema->diario.gravador = NULL;
 }
 
 /**
- * @brief Ordena a lista de alunos ativos no sistema por nome (Bubble Sort simples).
- * Nota: Uma implementação mais eficiente como QuickSort seria recomendada em um sistema real.
+ * @brief Barreira de durabilidade: volta quando tudo o que salvar_dados já
+ * aceitou está no disco (a fila do gravador escrita, o group commit sincronizado).
  * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return int 1 se tudo está no disco, 0 se uma gravação falhou (o estado completo é gravado por checkpoint).
  */
-void ordenar_alunos_por_nome(DadosSistema *sistema) {
-    int i, j;
-    
-    // Implementação Bubble Sort simplificada
-    for (i = 0; i < MAX_ALUNOS - 1; i++) {
-        if (sistema->alunos[i].ativo == 0) continue; // Ignora inativos
-        
-        for (j = i + 1; j < MAX_ALUNOS; j++) {
-             if (sistema->alunos[j].ativo == 0) continue; // Ignora inativos
-            
-            // Compara os nomes. Se o aluno[i] for maior que aluno[j], troca
-            if (strcmp(sistema->alunos[i].nome, sistema->alunos[j].nome) > 0) {
-                trocar_alunos(&sistema->alunos[i], &sistema->alunos[j]);
-            }
-        }
+int sincronizar_dados(DadosSistema *sistema) {
+    if (diario_sincronizar(&sistema->diario)) return 1;
+    printf("AVISO: Falha ao gravar o diario. Gravando o estado completo...\n");
+    return checkpoint_dados(sistema);
+}
+
+
+// --- 3. Auxiliares e Busca ---
+
+// Montagem sob demanda dos índices (caches derivados das tabelas, ver indices.h).
+// Se faltar memória, o índice fica vazio e a consulta não encontra nada.
+
+static void montar_indice_ra(const DadosSistema *sistema) {
+    DadosSistema *cache = (DadosSistema *)sistema;
+    if (!cache->indice_ra.pronto && !indice_ra_reconstruir(sistema, &cache->indice_ra)) {
+        printf("ERRO: Memoria insuficiente para montar o indice de RA.\n");
     }
-    // A mensagem de sucesso é dada no main.c
 }
 
-/**
- * @brief Gera e exibe o relatório de todos os alunos ativos em uma turma.
- * @param sistema Ponteiro para a estrutura DadosSistema.
- * @param id_turma ID da turma para a qual o relatório será gerado.
+static void montar_indice_membros(const DadosSistema *sistema) {
+    DadosSistema *cache = (DadosSistema *)sistema;
+    if (!cache->membros.pronto && !indice_turmas_reconstruir(sistema, &cache->membros)) {
+        printf("ERRO: Memoria insuficiente para montar o indice de turmas.\n");
+    }
+}
+
+static void montar_indice_nomes(const DadosSistema *sistema) {
+    DadosSistema *cache = (DadosSistema *)sistema;
+    if (!cache->nomes.pronto && !indice_nomes_reconstruir(sistema, &cache->nomes)) {
+        printf("ERRO: Memoria insuficiente para montar o indice de nomes.\n");
+    }
+}
+
+static void montar_indice_ids(const DadosSistema *sistema) {
+    DadosSistema *cache = (DadosSistema *)sistema;
+    if (!cache->ids.pronto && !indice_ids_reconstruir(sistema, &cache->ids)) {
+        printf("ERRO: Memoria insuficiente para montar o indice de IDs de turma.\n");
+    }
+}
+
+static void montar_indice_estatisticas(const DadosSistema *sistema) {
+    DadosSistema *cache = (DadosSistema *)sistema;
+    if (!cache->estatisticas.pronto && !indice_estatisticas_reconstruir(sistema, &cache->estatisticas)) {
+        printf("ERRO: Memoria insuficiente para montar as estatisticas das turmas.\n");
+    }
+}
+
+static void montar_indice_trigramas(const DadosSistema *sistema) {
+    DadosSistema *cache = (DadosSistema *)sistema;
+    if (!cache->trigramas.pronto && !indice_trigramas_reconstruir(sistema, &cache->trigramas)) {
+        printf("ERRO: Memoria insuficiente para montar o indice de busca por nome.\n");
+    }
+}
+
+// Percurso dos alunos ativos de uma turma: a lista de membros ou, no modo
+// fragmentado com segmentos ainda não lidos, a faixa de slots seguidos em que
+// o segmento da turma foi lido (só ele é lido; a lista exigiria todos).
+typedef struct {
+    const IndiceTurmas *membros; // NULL = percurso pela faixa do segmento
+    int fim;              // Fim da faixa do segmento (exclusivo)
+} AlunosTurma;
+
+static int alunos_turma_proximo(const DadosSistema *sistema, AlunosTurma *percurso, int slot) {
+    if (percurso->membros != NULL) return indice_turmas_proximo(percurso->membros, slot);
+    // Um segmento que não pôde ser lido deixa os slots inativos
+    while (++slot < percurso->fim) {
+        if (aluno_em(sistema, slot)->ativo == 1) return slot;
+    }
+    return -1;
+}
+
+static int alunos_turma_primeiro(const DadosSistema *sistema, int idx_turma, AlunosTurma *percurso) {
+    if (!sistema->fragmentos.parcial) {
+        montar_indice_membros(sistema);
+        percurso->membros = &sistema->membros;
+        return indice_turmas_primeiro(percurso->membros, idx_turma);
+    }
+    fragmentos_carregar_turma(sistema, idx_turma); // Um erro de leitura já foi informado
+    int inicio = sistema->fragmentos.inicio[idx_turma];
+    percurso->membros = NULL;
+    percurso->fim = inicio + turma_em(sistema, idx_turma)->vagas_ocupadas;
+    return alunos_turma_proximo(sistema, percurso, inicio - 1);
+}
+
+/**
+ * @brief Visita os alunos ativos de uma turma, na ordem do relatório. No modo
+ * fragmentado, enquanto há segmentos não lidos, só o segmento da turma é lido.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param idx_turma Slot da turma (ativa).
+ * @param visita Chamada para cada aluno; retornar 0 interrompe o percurso.
+ * @param contexto Repassado para a visita.
+ * @return int Quantidade de alunos visitados.
+ */
+int percorrer_alunos_turma(const DadosSistema *sistema, int idx_turma, VisitaAluno visita, void *contexto) {
+    int visitados = 0;
+    AlunosTurma percurso;
+    for (int i = alunos_turma_primeiro(sistema, idx_turma, &percurso); i != -1;
+         i = alunos_turma_proximo(sistema, &percurso, i)) {
+        visitados++;
+        if (!visita(sistema, i, contexto)) break;
+    }
+    return visitados;
+}
+
+/**
+ * @brief Busca o índice de um aluno ativo pelo RA (O(1) esperado, via índice hash).
+ * Apenas alunos ATIVOS estão no índice.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param ra O Registro Acadêmico a ser buscado.
+ * @return int O índice do aluno no array, ou -1 se não for encontrado ou estiver inativo.
+ */
+int buscar_aluno_por_ra(const DadosSistema *sistema, const char *ra) {
+    METRICA_MEDIR(METRICA_BUSCAR_ALUNO_POR_RA);
+    montar_indice_ra(sistema);
+    return indice_ra_buscar(sistema, &sistema->indice_ra, ra);
+}
+
+/**
+ * @brief Busca o índice de uma turma ativa pelo ID (O(1), via índice de IDs).
+ * O ID não depende do slot: slots são reaproveitados e a compactação move as turmas.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id_turma O ID da turma a ser buscado.
+ * @return int O índice da turma no array, ou -1 se não for encontrada ou estiver inativa.
+ */
+int buscar_turma_por_id(const DadosSistema *sistema, int id_turma) {
+    METRICA_MEDIR(METRICA_BUSCAR_TURMA_POR_ID);
+    montar_indice_ids(sistema);
+    int i = indice_ids_buscar(&sistema->ids, id_turma);
+    if (i == -1) return -1;
+
+    // Busca apenas turmas ATIVAS e com ID correspondente
+    const Turma *turma = turma_em(sistema, i);
+    if (turma->ativo == 1 && turma->id == id_turma) {
+        return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Retorna a turma do slot para alteração, marcando-a para a próxima gravação.
+ * Toda escrita em registros passa por turma_para_escrita / aluno_para_escrita,
+ * assim salvar_dados sabe exatamente quais registros mudaram (e uma transação
+ * aberta guarda a imagem anterior deles).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param idx Slot da turma.
+ * @return Turma* O registro, pronto para ser alterado.
+ */
+static Turma *turma_para_escrita(DadosSistema *sistema, int idx) {
+    diario_marcar(&sistema->diario, &sistema->diario.turmas, idx);
+    transacao_guardar_imagem(&sistema->transacao, &sistema->transacao.turmas, &sistema->turmas,
+                             sistema->transacao.usados_turmas, idx);
+    return pool_slot_escrita(&sistema->turmas, idx);
+}
+
+/**
+ * @brief Retorna o aluno do slot para alteração, marcando-o para a próxima gravação.
+ * No modo fragmentado, o segmento da turma em que o aluno está agora também é
+ * marcado: numa transferência ou exclusão, ele precisa sair de lá.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param idx Slot do aluno.
+ * @return Aluno* O registro, pronto para ser alterado.
+ */
+static Aluno *aluno_para_escrita(DadosSistema *sistema, int idx) {
+    diario_marcar(&sistema->diario, &sistema->diario.alunos, idx);
+    transacao_guardar_imagem(&sistema->transacao, &sistema->transacao.alunos, &sistema->alunos,
+                             sistema->transacao.usados_alunos, idx);
+    Aluno *aluno = pool_slot_escrita(&sistema->alunos, idx);
+    if (sistema->fragmentos.ativo && aluno->ativo == 1) fragmentos_marcar(&sistema->fragmentos, aluno->id_turma);
+    return aluno;
+}
+
+/**
+ * @brief Guarda um nome no heap de textos (O(tamanho do nome) esperado), marcando
+ * as células novas para a próxima gravação. Um nome já guardado é reaproveitado;
+ * um nome novo entra no índice de busca por nome.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param texto O nome.
+ * @return int Referência para gravar no registro, ou -1 se faltou memória.
+ */
+int guardar_texto(DadosSistema *sistema, const char *texto) {
+    int celulas;
+    int ref = textos_guardar(&sistema->textos, &sistema->internados, texto, &celulas);
+    for (int c = 0; c < celulas; c++) {
+        diario_marcar(&sistema->diario, &sistema->diario.textos, ref + c);
+    }
+    if (celulas > 0 && !indice_trigramas_inserir(&sistema->trigramas, &sistema->textos, ref)) {
+        indice_trigramas_liberar(&sistema->trigramas); // Remontado na próxima busca
+    }
+    return ref;
+}
+
+/**
+ * @brief Entrega um slot para um registro novo: um slot inativo, se houver (O(1)),
+ * ou um novo no final da tabela (O(1) amortizado).
+ * @param tabela Pool da tabela.
+ * @param livres Pilha de slots livres da tabela (montada aqui no primeiro uso).
+ * @param pos_ativo Deslocamento do campo 'ativo' no registro.
+ * @return int O slot, ou -1 se faltou memória.
+ */
+static int reservar_slot(PoolRegistros *tabela, IndiceLivres *livres, size_t pos_ativo) {
+    if (!livres->pronto && !indice_livres_reconstruir(livres, tabela, pos_ativo)) {
+        return pool_novo_slot(tabela); // Sem memória para a pilha: usa o final da tabela
+    }
+    int slot = indice_livres_retirar(livres);
+    return slot != -1 ? slot : pool_novo_slot(tabela);
+}
+
+/**
+ * @brief Soma a média de um aluno às estatísticas da turma (idx_turma -1 = nenhuma).
+ * Se faltar memória, as estatísticas são descartadas e remontadas na próxima consulta.
+ */
+static void estatisticas_incluir(DadosSistema *sistema, int idx_turma, float media) {
+    if (idx_turma != -1 && !indice_estatisticas_incluir(&sistema->estatisticas, idx_turma, media)) {
+        indice_estatisticas_liberar(&sistema->estatisticas);
+    }
+}
+
+/**
+ * @brief Próximo ID de turma. IDs só crescem: nunca repetem o de uma turma
+ * existente ou excluída, mesmo depois de uma compactação.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return int O ID, ou -1 se o índice de IDs não pôde ser montado.
+ */
+static int novo_id_turma(DadosSistema *sistema) {
+    montar_indice_ids(sistema);
+    if (!sistema->ids.pronto) return -1;
+    if (sistema->proximo_id_turma <= sistema->ids.maior_id) {
+        sistema->proximo_id_turma = sistema->ids.maior_id + 1;
+    }
+    return sistema->proximo_id_turma++;
+}
+
+/**
+ * @brief Exibe uma lista de todas as turmas ativas no sistema.
+ * Ajuda o usuário a escolher um ID.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ */
+void listar_todas_turmas(const DadosSistema *sistema) {
+    METRICA_MEDIR(METRICA_LISTAR_TODAS_TURMAS);
+    printf("\n--- Turmas Ativas ---\n");
+    int encontrou = 0;
+    for (int i = 0; i < sistema->turmas.usados; i++) {
+        const Turma *turma = turma_em(sistema, i);
+        if (turma->ativo == 1) {
+            printf("ID: %d | Nome: %s | Vagas: %d/%d\n", 
+                   turma->id, 
+                   texto_em(sistema, turma->nome), 
+                   turma->vagas_ocupadas, 
+                   turma->vagas_maximas);
+            encontrou = 1;
+        }
+    }
+    if (!encontrou) {
+        printf("Nenhuma turma ativa cadastrada.\n");
+    }
+    printf("---------------------\n");
+}
+
+// Contexto da junção dos nomes encontrados com os alunos (visita do índice de nomes)
+typedef struct {
+    int ref;                  // Nome procurado
+    const char *texto;
+    float semelhanca;
+    ResultadoNome *resultados;
+    int n;
+    int max;
+} JuncaoNome;
+
+/**
+ * @brief Acrescenta aos resultados o aluno visitado se ele usa o nome procurado.
+ * Os alunos com o mesmo nome vêm juntos no índice, logo no início do prefixo.
+ */
+static int juntar_aluno(const DadosSistema *sistema, int slot, void *contexto) {
+    JuncaoNome *juncao = contexto;
+    int nome = aluno_em(sistema, slot)->nome;
+    if (nome != juncao->ref && strcmp(texto_em(sistema, nome), juncao->texto) != 0) return 0; // Passou do nome
+    if (nome == juncao->ref) {
+        juncao->resultados[juncao->n].tipo = RESULTADO_ALUNO;
+        juncao->resultados[juncao->n].slot = slot;
+        juncao->resultados[juncao->n].semelhanca = juncao->semelhanca;
+        juncao->n++;
+    }
+    return juncao->n < juncao->max;
+}
+
+/**
+ * @brief Procura turmas e alunos ativos pelo nome, por trecho ou por semelhança.
+ * Os nomes vêm do índice de trigramas (ver trigramas.h) e cada nome é levado,
+ * pelo índice de nomes, aos alunos que o usam (O(log n) por nome) e, se o nome
+ * também é de turmas, às turmas.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param consulta Trecho ou nome aproximado (maiúsculas e acentos são ignorados).
+ * @param aproximada 1 = tolera erros de digitação, 0 = nomes que contêm o trecho.
+ * @param resultados Recebe os registros, do nome mais ao menos semelhante.
+ * @param max Quantidade máxima de resultados (1 a MAX_RESULTADOS_BUSCA).
+ * @return int Quantidade de resultados, ou -1 se faltou memória para os índices.
+ */
+int buscar_nomes(const DadosSistema *sistema, const char *consulta, int aproximada, ResultadoNome *resultados, int max) {
+    METRICA_MEDIR(METRICA_BUSCAR_NOMES);
+    montar_indice_trigramas(sistema);
+    montar_indice_nomes(sistema);
+    if (!sistema->trigramas.pronto || !sistema->nomes.pronto) return -1;
+    if (max > MAX_RESULTADOS_BUSCA) max = MAX_RESULTADOS_BUSCA;
+
+    // Todo nome encontrado tem pelo menos um registro ativo: 'max' nomes bastam
+    ResultadoTexto nomes[MAX_RESULTADOS_BUSCA];
+    int encontrados = indice_trigramas_buscar(&sistema->trigramas, &sistema->textos, consulta, aproximada, nomes, max);
+
+    JuncaoNome juncao = { 0, NULL, 0.0f, resultados, 0, max };
+    for (int k = 0; k < encontrados && juncao.n < max; k++) {
+        juncao.ref = nomes[k].ref;
+        juncao.texto = texto_em(sistema, nomes[k].ref);
+        juncao.semelhanca = nomes[k].semelhanca;
+        int antes = juncao.n;
+        indice_nomes_percorrer(sistema, &sistema->nomes, juncao.texto, juntar_aluno, &juncao);
+
+        // O que sobra dos usos do nome são turmas: sem sobra, a tabela de turmas nem é lida
+        int turmas = indice_trigramas_usos(&sistema->trigramas, juncao.ref) - (juncao.n - antes);
+        for (int i = 0; i < sistema->turmas.usados && turmas > 0 && juncao.n < max; i++) {
+            const Turma *turma = turma_em(sistema, i);
+            if (turma->ativo == 1 && turma->nome == juncao.ref) {
+                resultados[juncao.n].tipo = RESULTADO_TURMA;
+                resultados[juncao.n].slot = i;
+                resultados[juncao.n].semelhanca = juncao.semelhanca;
+                juncao.n++;
+                turmas--;
+            }
+        }
+    }
+    return juncao.n;
+}
+
+/**
+ * @brief Exibe as turmas e alunos encontrados pela busca por nome.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param consulta Trecho ou nome aproximado.
+ * @param aproximada 1 = busca aproximada, 0 = busca por trecho.
+ */
+void procurar_por_nome(const DadosSistema *sistema, const char *consulta, int aproximada) {
+    ResultadoNome resultados[MAX_RESULTADOS_BUSCA];
+    int n = buscar_nomes(sistema, consulta, aproximada, resultados, MAX_RESULTADOS_BUSCA);
+    if (n < 0) return; // Falta de memória já foi informada
+
+    printf("\n--- Busca por Nome (%s '%s') ---\n", aproximada ? "parecido com" : "contendo", consulta);
+    printf("| %-5s | %-10s | %-40s | %5s | %6s |\n", "Tipo", "RA/ID", "Nome", "Turma", "Semel.");
+    printf("---------------------------------------------------------------------------------\n");
+    for (int k = 0; k < n; k++) {
+        if (resultados[k].tipo == RESULTADO_TURMA) {
+            const Turma *turma = turma_em(sistema, resultados[k].slot);
+            printf("| %-5s | %-10d | %-40s | %5d | %6.2f |\n", "Turma", turma->id,
+                   texto_em(sistema, turma->nome), turma->id, resultados[k].semelhanca);
+        } else {
+            const Aluno *aluno = aluno_em(sistema, resultados[k].slot);
+            printf("| %-5s | %-10s | %-40s | %5d | %6.2f |\n", "Aluno", aluno->ra,
+                   texto_em(sistema, aluno->nome), aluno->id_turma, resultados[k].semelhanca);
+        }
+    }
+    if (n == 0) {
+        printf("Nenhum nome encontrado.\n");
+    }
+    printf("---------------------------------------------------------------------------------\n");
+}
+
+// Mensagens das operações de CREATE/UPDATE/DELETE. No modo silencioso
+// (processamento em lote) nada é impresso: mensagens de sucesso são ignoradas
+// e a última mensagem de erro/aviso fica guardada para quem chamou.
+// Estado por thread: no modo servidor, cada trabalhador guarda as próprias mensagens
+#if defined(_MSC_VER)
+#define POR_THREAD __declspec(thread)
+#else
+#define POR_THREAD _Thread_local
+#endif
+
+static POR_THREAD int modo_silencioso = 0;
+static POR_THREAD char ultima_mensagem_erro[160] = "";
+
+/**
+ * @brief Exibe (ou, no modo silencioso, guarda) uma mensagem de operação. Mesmo uso do printf.
+ */
+static void mensagem(const char *formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    if (!modo_silencioso) {
+        vprintf(formato, args);
+    } else if (strncmp(formato, "SUCESSO", 7) != 0) {
+        vsnprintf(ultima_mensagem_erro, sizeof(ultima_mensagem_erro), formato, args);
+        ultima_mensagem_erro[strcspn(ultima_mensagem_erro, "\n")] = 0;
+    }
+    va_end(args);
+}
+
+/**
+ * @brief Liga ou desliga o modo silencioso das operações (ver mensagem).
+ * @param ativo 1 para silenciar, 0 para voltar a imprimir.
+ */
+void definir_modo_silencioso(int ativo) {
+    modo_silencioso = ativo;
+    ultima_mensagem_erro[0] = 0;
+}
+
+/**
+ * @brief Última mensagem de erro ou aviso guardada no modo silencioso.
+ * @return const char* A mensagem (sem quebra de linha), ou "" se não houve nenhuma.
+ */
+const char *ultima_mensagem(void) {
+    return ultima_mensagem_erro;
+}
+
+/**
+ * @brief Calcula a média das 3 notas de um aluno (segundo politica_notas).
+ * @param aluno Ponteiro para a estrutura Aluno.
+ */
+void calcular_media(Aluno *aluno) {
+    aluno->media_final = politica_media(&politica_notas, aluno->notas[0], aluno->notas[1], aluno->notas[2]);
+}
+
+// --- 4. Gerenciamento (CREATE) ---
+
+/**
+ * @brief Adiciona uma nova turma ao sistema.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param nome Nome da nova turma.
+ * @param vagas Número máximo de vagas.
+ * @return int 1 se adicionada com sucesso, 0 caso contrário.
+ */
+int adicionar_turma(DadosSistema *sistema, const char *nome, int vagas) {
+    METRICA_MEDIR(METRICA_ADICIONAR_TURMA);
+    if (vagas <= 0) {
+        mensagem("ERRO: O numero de vagas deve ser positivo.\n");
+        return 0;
+    }
+    if (strlen(nome) >= TAM_NOME) {
+        mensagem("ERRO: O nome da turma passa de %d caracteres.\n", TAM_NOME - 1);
+        return 0;
+    }
+
+    // Slot de uma turma excluída ou novo no final da tabela (O(1))
+    int nome_ref = guardar_texto(sistema, nome);
+    int id = nome_ref != -1 ? novo_id_turma(sistema) : -1;
+    int i = id != -1 ? reservar_slot(&sistema->turmas, &sistema->turmas_livres, offsetof(Turma, ativo)) : -1;
+    if (i == -1) {
+        mensagem("ERRO: Memoria insuficiente para cadastrar a turma.\n");
+        return 0;
+    }
+
+    // Inicializa a nova turma (o ID da turma excluída que ocupava o slot deixa de apontar para ele)
+    Turma *turma = turma_para_escrita(sistema, i);
+    if (turma->id > 0 && indice_ids_buscar(&sistema->ids, turma->id) == i) {
+        indice_ids_definir(&sistema->ids, turma->id, -1);
+    }
+    turma->id = id;
+    turma->nome = nome_ref;
+    turma->vagas_maximas = vagas;
+    turma->vagas_ocupadas = 0;
+    turma->ativo = 1;
+
+    if (!indice_ids_definir(&sistema->ids, id, i)) {
+        turma->ativo = 0;
+        indice_livres_empilhar(&sistema->turmas_livres, i);
+        mensagem("ERRO: Memoria insuficiente para cadastrar a turma.\n");
+        return 0;
+    }
+
+    indice_trigramas_usar(&sistema->trigramas, nome_ref, 1);
+    sistema->total_turmas++;
+    return 1;
+}
+
+/**
+ * @brief Adiciona um novo aluno a uma turma específica.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param nome Nome do aluno.
+ * @param ra Registro Acadêmico do aluno.
+ * @param id_turma ID da turma a ser matriculado.
+ * @return int 1 se adicionado com sucesso, 0 caso contrário.
+ */
+int adicionar_aluno(DadosSistema *sistema, const char *nome, const char *ra, int id_turma) {
+    METRICA_MEDIR(METRICA_ADICIONAR_ALUNO);
+    if (strlen(nome) >= TAM_NOME) {
+        mensagem("ERRO: O nome do aluno passa de %d caracteres.\n", TAM_NOME - 1);
+        return 0;
+    }
+    if (strlen(ra) == 0 || strlen(ra) >= TAM_RA) {
+        mensagem("ERRO: O RA precisa ter de 1 a %d caracteres.\n", TAM_RA - 1);
+        return 0;
+    }
+    if (buscar_aluno_por_ra(sistema, ra) != -1) {
+        mensagem("ERRO: RA '%s' ja cadastrado.\n", ra);
+        return 0;
+    }
+    if (!sistema->indice_ra.pronto) { // Sem o índice não há como garantir que o RA é único
+        mensagem("ERRO: Memoria insuficiente para indexar os RAs.\n");
+        return 0;
+    }
+
+    int idx_turma = buscar_turma_por_id(sistema, id_turma);
+    if (idx_turma == -1) {
+        mensagem("ERRO: Turma ID %d nao encontrada ou inativa.\n", id_turma);
+        return 0;
+    }
+    const Turma *turma = turma_em(sistema, idx_turma);
+    if (turma->vagas_ocupadas >= turma->vagas_maximas) {
+        mensagem("ERRO: Turma '%s' esta cheia.\n", texto_em(sistema, turma->nome));
+        return 0;
+    }
+
+    // Slot de um aluno excluído ou novo no final da tabela (O(1))
+    int nome_ref = guardar_texto(sistema, nome);
+    int i = nome_ref != -1 ? reservar_slot(&sistema->alunos, &sistema->alunos_livres, offsetof(Aluno, ativo)) : -1;
+    if (i == -1) {
+        mensagem("ERRO: Memoria insuficiente para cadastrar o aluno.\n");
+        return 0;
+    }
+
+    // Inicializa o novo aluno
+    Aluno *aluno = aluno_para_escrita(sistema, i);
+    memcpy(aluno->ra, ra, strlen(ra) + 1);
+    aluno->nome = nome_ref;
+    aluno->id_turma = id_turma;
+    aluno->notas[0] = 0.0f;
+    aluno->notas[1] = 0.0f;
+    aluno->notas[2] = 0.0f;
+    aluno->media_final = 0.0f;
+    aluno->ativo = 1;
+
+    if (!indice_turmas_inserir(&sistema->membros, i, idx_turma)) {
+        aluno->ativo = 0;
+        indice_livres_empilhar(&sistema->alunos_livres, i);
+        colunas_atualizar(sistema, &sistema->colunas, i);
+        mensagem("ERRO: Memoria insuficiente para cadastrar o aluno.\n");
+        return 0;
+    }
+    if (!indice_ra_inserir(sistema, &sistema->indice_ra, i)) {
+        indice_turmas_remover(&sistema->membros, i);
+        aluno->ativo = 0;
+        indice_livres_empilhar(&sistema->alunos_livres, i);
+        colunas_atualizar(sistema, &sistema->colunas, i);
+        mensagem("ERRO: Memoria insuficiente para cadastrar o aluno.\n");
+        return 0;
+    }
+    if (!indice_nomes_inserir(sistema, &sistema->nomes, i)) {
+        indice_ra_remover(sistema, &sistema->indice_ra, aluno->ra);
+        indice_turmas_remover(&sistema->membros, i);
+        aluno->ativo = 0;
+        indice_livres_empilhar(&sistema->alunos_livres, i);
+        colunas_atualizar(sistema, &sistema->colunas, i);
+        mensagem("ERRO: Memoria insuficiente para cadastrar o aluno.\n");
+        return 0;
+    }
+
+    // Atualiza contadores
+    colunas_atualizar(sistema, &sistema->colunas, i);
+    estatisticas_incluir(sistema, idx_turma, aluno->media_final);
+    indice_trigramas_usar(&sistema->trigramas, nome_ref, 1);
+    sistema->total_alunos++;
+    turma_para_escrita(sistema, idx_turma)->vagas_ocupadas++;
+    return 1;
+}
+
+
+// --- 5. Gerenciamento (UPDATE) ---
+
+/**
+ * @brief Lança as notas N1, N2, N3 e atualiza a média de um aluno.
+ * Verifica o nível de acesso (deve ser PROFESSOR ou ADMIN).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param ra RA do aluno.
+ * @param n1 Nota 1.
+ * @param n2 Nota 2.
+ * @param n3 Nota 3.
+ * @param nivel_acesso Nível de acesso do usuário logado.
+ * @return int 1 se as notas foram lançadas e a média atualizada, 0 caso contrário.
+ */
+int lancar_notas_e_atualizar_media(DadosSistema *sistema, const char *ra, float n1, float n2, float n3, int nivel_acesso) {
+    METRICA_MEDIR(METRICA_LANCAR_NOTAS);
+    if (nivel_acesso < NIVEL_PROFESSOR) {
+        mensagem("ACESSO NEGADO: Apenas Professor ou Admin podem lancar notas.\n");
+        return 0;
+    }
+    
+    int idx_aluno = buscar_aluno_por_ra(sistema, ra);
+    if (idx_aluno == -1) {
+        mensagem("ERRO: Aluno com RA '%s' nao encontrado ou inativo.\n", ra);
+        return 0;
+    }
+    
+    // Atualiza as notas e calcula a média (a média antiga sai das estatísticas da turma)
+    Aluno *aluno = aluno_para_escrita(sistema, idx_aluno);
+    int idx_turma = buscar_turma_por_id(sistema, aluno->id_turma);
+    indice_estatisticas_retirar(&sistema->estatisticas, idx_turma, aluno->media_final);
+    aluno->notas[0] = n1;
+    aluno->notas[1] = n2;
+    aluno->notas[2] = n3;
+    calcular_media(aluno);
+    colunas_atualizar(sistema, &sistema->colunas, idx_aluno);
+    estatisticas_incluir(sistema, idx_turma, aluno->media_final);
+    
+    mensagem("SUCESSO: Notas de '%s' lancadas (Media: %.2f).\n", 
+             texto_em(sistema, aluno->nome), 
+             aluno->media_final);
+    return 1;
+}
+
+/**
+ * @brief Edita o nome e/ou a turma de um aluno.
+ * Permite a alteração do nome e/ou a transferência de turma de um aluno ativo.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param ra_antigo RA do aluno a ser editado.
+ * @param nome_novo Novo nome (se vazio, mantém o atual).
+ * @param id_turma_nova Novo ID da turma (se 0, mantém a atual).
+ * @return int 1 se a edição foi bem-sucedida, 0 caso contrário.
+ */
+int editar_dados_aluno(DadosSistema *sistema, const char *ra_antigo, const char *nome_novo, int id_turma_nova) {
+    METRICA_MEDIR(METRICA_EDITAR_DADOS_ALUNO);
+    int idx_aluno = buscar_aluno_por_ra(sistema, ra_antigo);
+    if (idx_aluno == -1) {
+        mensagem("ERRO: Aluno com RA '%s' nao encontrado ou inativo.\n", ra_antigo);
+        return 0;
+    }
+    Aluno *aluno = aluno_em(sistema, idx_aluno);
+    
+    mensagem("Editando Aluno: %s (RA: %s)\n", texto_em(sistema, aluno->nome), aluno->ra);
+    int alterado = 0;
+
+    // 1. Atualizar Nome
+    if (strlen(nome_novo) > 0) {
+        if (strlen(nome_novo) >= TAM_NOME) {
+            mensagem("ERRO: O nome do aluno passa de %d caracteres.\n", TAM_NOME - 1);
+            return 0;
+        }
+        int nome_ref = guardar_texto(sistema, nome_novo);
+        if (nome_ref == -1) {
+            mensagem("ERRO: Memoria insuficiente para atualizar o nome.\n");
+            return 0;
+        }
+        // O aluno sai do índice de nomes e volta na nova posição alfabética
+        indice_nomes_remover(sistema, &sistema->nomes, idx_aluno);
+        aluno = aluno_para_escrita(sistema, idx_aluno);
+        indice_trigramas_usar(&sistema->trigramas, aluno->nome, -1);
+        indice_trigramas_usar(&sistema->trigramas, nome_ref, 1);
+        aluno->nome = nome_ref;
+        if (!indice_nomes_inserir(sistema, &sistema->nomes, idx_aluno)) {
+            // O nome já mudou (e está no diário): o índice é descartado e remontado no próximo uso
+            indice_nomes_liberar(&sistema->nomes);
+        }
+        mensagem("Nome atualizado para: %s\n", nome_novo);
+        alterado = 1;
+    }
+
+    // 2. Atualizar Turma (Transferência)
+    if (id_turma_nova != 0 && id_turma_nova != aluno->id_turma) {
+        int idx_turma_nova = buscar_turma_por_id(sistema, id_turma_nova);
+        
+        if (idx_turma_nova != -1) {
+            const Turma *turma_nova = turma_em(sistema, idx_turma_nova);
+            // Verifica vagas na nova turma
+            if (turma_nova->vagas_ocupadas < turma_nova->vagas_maximas) {
+                
+                // Move o aluno para a lista de membros da nova turma, antes de qualquer outra
+                // alteração: se faltar memória, nada mudou além do índice, descartado e remontado no próximo uso
+                indice_turmas_remover(&sistema->membros, idx_aluno);
+                if (!indice_turmas_inserir(&sistema->membros, idx_aluno, idx_turma_nova)) {
+                    indice_turmas_liberar(&sistema->membros);
+                    mensagem("ERRO: Memoria insuficiente para transferir o aluno.\n");
+                    return 0;
+                }
+
+                // Libera vaga na turma antiga
+                int idx_turma_antiga = buscar_turma_por_id(sistema, aluno->id_turma);
+                if (idx_turma_antiga != -1) {
+                    turma_para_escrita(sistema, idx_turma_antiga)->vagas_ocupadas--;
+                }
+                indice_estatisticas_retirar(&sistema->estatisticas, idx_turma_antiga, aluno->media_final);
+
+                // Ocupa vaga na nova turma e atualiza o aluno
+                turma_para_escrita(sistema, idx_turma_nova)->vagas_ocupadas++;
+                aluno = aluno_para_escrita(sistema, idx_aluno);
+                aluno->id_turma = id_turma_nova;
+                colunas_atualizar(sistema, &sistema->colunas, idx_aluno);
+                estatisticas_incluir(sistema, idx_turma_nova, aluno->media_final);
+                // turma_nova pode apontar para o bloco antigo, trocado por turma_para_escrita
+                mensagem("Turma atualizada para ID: %d (%s)\n", id_turma_nova, texto_em(sistema, turma_em(sistema, idx_turma_nova)->nome));
+                alterado = 1;
+            } else {
+                mensagem("ERRO: Nova turma ID %d esta cheia. Turma nao alterada.\n", id_turma_nova);
+                return 0; // Falha na edição
+            }
+        } else {
+            mensagem("AVISO: ID de turma nova %d e invalido. Turma nao alterada.\n", id_turma_nova);
+        }
+    }
+    
+    if (!alterado) {
+        mensagem("AVISO: Nenhum dado alterado.\n");
+        return 0;
+    }
+    
+    mensagem("SUCESSO: Edicao de dados concluida.\n");
+    return 1;
+}
+
+// --- 6. Gerenciamento (DELETE - Exclusão Lógica) ---
+
+/**
+ * @brief Realiza a exclusão lógica de um aluno pelo RA.
+ * A vaga na turma é liberada, e o aluno é marcado como inativo.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param ra RA do aluno a ser inativado.
+ * @return int 1 se o aluno foi excluído logicamente, 0 caso contrário.
+ */
+int excluir_aluno_por_ra(DadosSistema *sistema, const char *ra) {
+    METRICA_MEDIR(METRICA_EXCLUIR_ALUNO);
+    int idx_aluno = buscar_aluno_por_ra(sistema, ra);
+    if (idx_aluno == -1) {
+        mensagem("ERRO: Aluno com RA '%s' nao encontrado ou ja inativo.\n", ra);
+        return 0;
+    }
+
+    Aluno *aluno = aluno_para_escrita(sistema, idx_aluno);
+
+    // Libera a vaga na turma
+    int idx_turma = buscar_turma_por_id(sistema, aluno->id_turma);
+    if (idx_turma != -1) {
+        turma_para_escrita(sistema, idx_turma)->vagas_ocupadas--;
+    }
+    indice_estatisticas_retirar(&sistema->estatisticas, idx_turma, aluno->media_final);
+
+    // Exclusão Lógica (sai do índice antes de ficar inativo)
+    indice_ra_remover(sistema, &sistema->indice_ra, aluno->ra);
+    indice_turmas_remover(&sistema->membros, idx_aluno);
+    indice_nomes_remover(sistema, &sistema->nomes, idx_aluno);
+    indice_trigramas_usar(&sistema->trigramas, aluno->nome, -1);
+    aluno->ativo = 0;
+    indice_livres_empilhar(&sistema->alunos_livres, idx_aluno);
+    colunas_atualizar(sistema, &sistema->colunas, idx_aluno);
+    sistema->total_alunos--;
+
+    mensagem("SUCESSO: Aluno '%s' (RA: %s) excluido (logicamente) do sistema.\n", 
+             texto_em(sistema, aluno->nome), ra);
+    return 1;
+}
+
+/**
+ * @brief Realiza a exclusão lógica de uma turma e de todos os seus alunos (Cascata).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id ID da turma a ser inativada.
+ * @return int 1 se a turma foi excluída logicamente, 0 caso contrário.
+ */
+int excluir_turma_por_id(DadosSistema *sistema, int id) {
+    METRICA_MEDIR(METRICA_EXCLUIR_TURMA);
+    int idx_turma = buscar_turma_por_id(sistema, id);
+    if (idx_turma == -1) {
+        mensagem("ERRO: Turma ID %d nao encontrada ou ja inativa.\n", id);
+        return 0;
+    }
+    
+    int alunos_excluidos = 0;
+    // Exclusão em Cascata (inativa todos os alunos vinculados à turma).
+    // Percorre só a lista de membros da turma: O(tamanho da turma).
+    montar_indice_membros(sistema);
+    for (int i = indice_turmas_primeiro(&sistema->membros, idx_turma); i != -1;
+         i = indice_turmas_proximo(&sistema->membros, i)) {
+        Aluno *aluno = aluno_para_escrita(sistema, i);
+        indice_ra_remover(sistema, &sistema->indice_ra, aluno->ra);
+        indice_nomes_remover(sistema, &sistema->nomes, i);
+        indice_trigramas_usar(&sistema->trigramas, aluno->nome, -1);
+        aluno->ativo = 0;             // Inativa o aluno
+        indice_livres_empilhar(&sistema->alunos_livres, i);
+        colunas_atualizar(sistema, &sistema->colunas, i);
+        sistema->total_alunos--;      // Reduz o contador global
+        alunos_excluidos++;
+    }
+    indice_turmas_esvaziar(&sistema->membros, idx_turma);
+    indice_estatisticas_zerar(&sistema->estatisticas, idx_turma);
+    
+    // Exclusão Lógica da Turma
+    Turma *turma = turma_para_escrita(sistema, idx_turma);
+    indice_trigramas_usar(&sistema->trigramas, turma->nome, -1);
+    turma->ativo = 0;
+    turma->vagas_ocupadas = 0; // Zera as vagas ocupadas, pois todos os alunos foram inativados
+    indice_livres_empilhar(&sistema->turmas_livres, idx_turma);
+    sistema->total_turmas--;
+
+    mensagem("SUCESSO: Turma '%s' (ID %d) excluida (logicamente).\n", 
+             texto_em(sistema, turma->nome), id);
+    mensagem("AVISO: %d alunos vinculados tambem foram inativados (cascata).\n", alunos_excluidos);
+    return 1;
+}
+
+// --- 7. Lógica e Relatórios (READ) ---
+
+/**
+ * @brief Reconstrói do zero o índice alfabético dos alunos ativos (O(n log n)).
+ * Os registros não são movidos: a ordem por nome é mantida incrementalmente pelo
+ * índice em toda inserção, renomeação e exclusão, então esta função só é útil
+ * para garantir um índice recém-montado (ex: após manutenção dos dados).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ */
+void ordenar_alunos_por_nome(DadosSistema *sistema) {
+    METRICA_MEDIR(METRICA_ORDENAR_ALUNOS);
+    if (!indice_nomes_reconstruir(sistema, &sistema->nomes)) {
+        printf("ERRO: Memoria insuficiente para reconstruir o indice de nomes.\n");
+    }
+    // A mensagem de sucesso é dada no main.c
+}
+
+/**
+ * @brief Exibe uma linha da listagem alfabética (função de visita do índice de nomes).
+ */
+static int exibir_aluno_listagem(const DadosSistema *sistema, int slot, void *contexto) {
+    const Aluno *aluno = aluno_em(sistema, slot);
+    int *encontrados = contexto;
+
+    printf("| %-10s | %-40s | %5d | %5.2f |\n", aluno->ra, texto_em(sistema, aluno->nome), aluno->id_turma,
+           aluno->media_final);
+    (*encontrados)++;
+    return 1;
+}
+
+/**
+ * @brief Lista os alunos ativos em ordem alfabética, percorrendo o índice de nomes.
+ * Com prefixo, lista só os nomes que começam com ele (O(log n + k)).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param prefixo Prefixo do nome (vazio ou NULL lista todos).
+ */
+void listar_alunos_por_nome(const DadosSistema *sistema, const char *prefixo) {
+    METRICA_MEDIR(METRICA_LISTAR_ALUNOS_POR_NOME);
+    printf("\n--- Alunos em Ordem Alfabetica");
+    if (prefixo != NULL && prefixo[0] != '\0') printf(" (prefixo '%s')", prefixo);
+    printf(" ---\n");
+    printf("| %-10s | %-40s | %5s | %5s |\n", "RA", "Nome", "Turma", "Media");
+    printf("----------------------------------------------------------------------\n");
+
+    int encontrados = 0;
+    montar_indice_nomes(sistema);
+    indice_nomes_percorrer(sistema, &sistema->nomes, prefixo, exibir_aluno_listagem, &encontrados);
+
+    if (encontrados == 0) {
+        printf("Nenhum aluno encontrado.\n");
+    }
+    printf("----------------------------------------------------------------------\n");
+}
+
+/**
+ * @brief Situação do aluno pela média final (mesmo critério em relatórios e exportações).
+ * @param aluno Ponteiro para o aluno.
+ * @return const char* "Aprovado" (>= 7), "Recup." (>= 5) ou "Reprovado" (ver politica_notas).
+ */
+const char *situacao_aluno(const Aluno *aluno) {
+    static const char *const nomes[] = {"Reprovado", "Recup.", "Aprovado"}; // Indexado por SITUACAO_*
+    return nomes[politica_situacao(&politica_notas, aluno->media_final)];
+}
+
+/**
+ * @brief Calcula o resumo estatístico de uma turma a partir das somas mantidas
+ * por turma (O(1), sem percorrer os alunos). No modo fragmentado, enquanto há
+ * segmentos não lidos, as somas são feitas só sobre o segmento da turma.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id_turma ID da turma.
+ * @param resumo Recebe o resumo.
+ * @return int 1 se bem-sucedido, 0 se a turma não existe ou faltou memória.
+ */
+int resumir_turma(const DadosSistema *sistema, int id_turma, ResumoTurma *resumo) {
+    METRICA_MEDIR(METRICA_RESUMIR_TURMA);
+    int idx_turma = buscar_turma_por_id(sistema, id_turma);
+    if (idx_turma == -1) return 0;
+
+    const EstatisticaTurma *e;
+    EstatisticaTurma segmento = {0};
+    if (sistema->fragmentos.parcial) {
+        // Montar o índice leria todos os segmentos
+        AlunosTurma percurso;
+        for (int i = alunos_turma_primeiro(sistema, idx_turma, &percurso); i != -1;
+             i = alunos_turma_proximo(sistema, &percurso, i)) {
+            float media = aluno_em(sistema, i)->media_final;
+            segmento.quantidade++;
+            segmento.soma += media;
+            segmento.soma_quadrados += (double)media * media;
+            segmento.situacoes[politica_situacao(&politica_notas, media)]++;
+        }
+        e = &segmento;
+    } else {
+        montar_indice_estatisticas(sistema);
+        if (!sistema->estatisticas.pronto) return 0;
+        e = indice_estatisticas_turma(&sistema->estatisticas, idx_turma);
+    }
+
+    memset(resumo, 0, sizeof(*resumo));
+    if (e == NULL || e->quantidade == 0) return 1;
+
+    double media = e->soma / e->quantidade;
+    double variancia = e->soma_quadrados / e->quantidade - media * media;
+    resumo->alunos = e->quantidade;
+    resumo->media = (float)media;
+    resumo->desvio_padrao = variancia > 0.0 ? (float)sqrt(variancia) : 0.0f; // Arredondamento pode dar < 0
+    resumo->aprovados = e->situacoes[SITUACAO_APROVADO];
+    resumo->recuperacao = e->situacoes[SITUACAO_RECUPERACAO];
+    resumo->reprovados = e->situacoes[SITUACAO_REPROVADO];
+    resumo->taxa_aprovacao = 100.0f * (float)resumo->aprovados / (float)resumo->alunos;
+    return 1;
+}
+
+/**
+ * @brief Exibe as estatísticas de uma turma (média, desvio padrão e situações).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id_turma ID da turma.
+ */
+void exibir_estatisticas_turma(const DadosSistema *sistema, int id_turma) {
+    METRICA_MEDIR(METRICA_EXIBIR_ESTATISTICAS);
+    int idx_turma = buscar_turma_por_id(sistema, id_turma);
+    if (idx_turma == -1) {
+        printf("ERRO: Turma ID %d nao encontrada ou inativa.\n", id_turma);
+        return;
+    }
+    ResumoTurma resumo;
+    if (!resumir_turma(sistema, id_turma, &resumo)) return; // Falta de memória já foi informada
+
+    const Turma *turma = turma_em(sistema, idx_turma);
+    printf("\n--- ESTATISTICAS: Turma %s (ID %d) ---\n", texto_em(sistema, turma->nome), turma->id);
+    printf("Alunos: %d\n", resumo.alunos);
+    printf("Media da turma: %.2f | Desvio padrao: %.2f\n", resumo.media, resumo.desvio_padrao);
+    printf("Aprovados: %d | Recup.: %d | Reprovados: %d\n",
+           resumo.aprovados, resumo.recuperacao, resumo.reprovados);
+    printf("Taxa de aprovacao: %.1f%%\n", resumo.taxa_aprovacao);
+}
+
+/**
+ * @brief Gera e exibe o relatório de todos os alunos ativos em uma turma.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id_turma ID da turma para a qual o relatório será gerado.
  */
 void gerar_relatorio_turma(const DadosSistema *sistema, int id_turma) {
+    METRICA_MEDIR(METRICA_GERAR_RELATORIO_TURMA);
     int idx_turma = buscar_turma_por_id(sistema, id_turma);
     if (idx_turma == -1) {
         printf("ERRO: Turma ID %d nao encontrada ou inativa.\n", id_turma);
         return;
     }
     
-    const Turma *turma = &sistema->turmas[idx_turma];
-    printf("\n--- RELATORIO: Turma %s (ID %d) ---\n", turma->nome, turma->id);
+    const Turma *turma = turma_em(sistema, idx_turma);
+    printf("\n--- RELATORIO: Turma %s (ID %d) ---\n", texto_em(sistema, turma->nome), turma->id);
     printf("Total de Vagas: %d | Ocupadas: %d\n", turma->vagas_maximas, turma->vagas_ocupadas);
     printf("------------------------------------------------------------------------------------------------\n");
     printf("| %-10s | %-40s | %5s | %5s | %5s | %5s | %-8s |\n", 
@@ -478,31 +1512,22 @@ void gerar_relatorio_turma(const DadosSistema *sistema, int id_turma) {
     printf("------------------------------------------------------------------------------------------------\n");
 
     int alunos_na_turma = 0;
-    for (int i = 0; i < MAX_ALUNOS; i++) {
-        // Verifica se o aluno está ativo E pertence a esta turma
-        if (sistema->alunos[i].ativo == 1 && sistema->alunos[i].id_turma == id_turma) {
-            const Aluno *aluno = &sistema->alunos[i];
-            
-            // Determina a Situação
-            const char *situacao;
-            if (aluno->media_final >= 7.0f) {
-                situacao = "Aprovado";
-            } else if (aluno->media_final >= 5.0f) {
-                situacao = "Recup.";
-            } else {
-                situacao = "Reprovado";
-            }
+    // Percorre só os alunos da turma (todos ativos): O(tamanho da turma)
+    AlunosTurma percurso;
+    for (int i = alunos_turma_primeiro(sistema, idx_turma, &percurso); i != -1;
+         i = alunos_turma_proximo(sistema, &percurso, i)) {
+        const Aluno *aluno = aluno_em(sistema, i);
+        const char *situacao = situacao_aluno(aluno);
 
-            printf("| %-10s | %-40s | %5.2f | %5.2f | %5.2f | %5.2f | %-8s |\n", 
-                   aluno->ra, 
-                   aluno->nome, 
-                   aluno->notas[0], 
-                   aluno->notas[1], 
-                   aluno->notas[2], 
-                   aluno->media_final,
-                   situacao);
-            alunos_na_turma++;
-        }
+        printf("| %-10s | %-40s | %5.2f | %5.2f | %5.2f | %5.2f | %-8s |\n", 
+               aluno->ra, 
+               texto_em(sistema, aluno->nome), 
+               aluno->notas[0], 
+               aluno->notas[1], 
+               aluno->notas[2], 
+               aluno->media_final,
+               situacao);
+        alunos_na_turma++;
     }
 
     if (alunos_na_turma == 0) {
@@ -510,3 +1535,723 @@ void gerar_relatorio_turma(const DadosSistema *sistema, int id_turma) {
     }
     printf("------------------------------------------------------------------------------------------------\n");
 }
+
+// Grupo de alunos de um ranking ou percentil: uma turma (lista de membros) ou
+// todos os alunos ativos (mapa de ativos das colunas, uma palavra por vez).
+// A média vem das colunas.
+typedef struct {
+    const ColunasNotas *colunas;
+    const IndiceTurmas *membros;
+    int idx_turma;        // Slot da turma, ou -1 = todos os alunos ativos
+    int alunos;           // Alunos ativos no grupo
+    int palavra;          // Percurso de todos os alunos: palavra atual do mapa de ativos
+    unsigned long long bits; // Bits da palavra atual ainda não visitados
+} GrupoMedias;
+
+/**
+ * @brief Prepara o percurso do grupo (monta as colunas e, numa turma, a lista de membros).
+ * @return int 1 se pronto, 0 se a turma não existe ou faltou memória.
+ */
+static int grupo_abrir(const DadosSistema *sistema, int id_turma, GrupoMedias *grupo) {
+    grupo->colunas = colunas_montadas(sistema);
+    grupo->membros = &sistema->membros;
+    grupo->idx_turma = -1;
+    grupo->alunos = sistema->total_alunos;
+    if (grupo->colunas == NULL) return 0;
+    if (id_turma == TURMAS_TODAS) return 1;
+
+    grupo->idx_turma = buscar_turma_por_id(sistema, id_turma);
+    if (grupo->idx_turma == -1) return 0;
+    montar_indice_membros(sistema);
+    grupo->alunos = turma_em(sistema, grupo->idx_turma)->vagas_ocupadas; // A lista só tem alunos ativos
+    return sistema->membros.pronto;
+}
+
+static inline int grupo_proximo(GrupoMedias *grupo, int slot) {
+    if (grupo->idx_turma != -1) return indice_turmas_proximo(grupo->membros, slot);
+    int palavras = (grupo->colunas->quantidade + BITS_POR_PALAVRA_ATIVOS - 1) / BITS_POR_PALAVRA_ATIVOS;
+    while (grupo->bits == 0) {
+        if (++grupo->palavra >= palavras) return -1;
+        grupo->bits = grupo->colunas->ativos[grupo->palavra];
+    }
+#if defined(__GNUC__)
+    int bit = __builtin_ctzll(grupo->bits);
+#else
+    int bit = 0;
+    while (!((grupo->bits >> bit) & 1u)) bit++;
+#endif
+    grupo->bits &= grupo->bits - 1;
+    return grupo->palavra * BITS_POR_PALAVRA_ATIVOS + bit;
+}
+
+static inline int grupo_primeiro(GrupoMedias *grupo) {
+    if (grupo->idx_turma != -1) return indice_turmas_primeiro(grupo->membros, grupo->idx_turma);
+    grupo->palavra = -1;
+    grupo->bits = 0;
+    return grupo_proximo(grupo, -1);
+}
+
+typedef struct {
+    float media;
+    int slot;
+} ItemRanking;
+
+/**
+ * @brief 1 se 'a' vem antes de 'b' no ranking: média maior (menor, em
+ * RANKING_PIORES) e, no empate, o RA menor.
+ */
+static inline int antes_no_ranking(const DadosSistema *sistema, ItemRanking a, ItemRanking b, int ordem) {
+    if (a.media != b.media) return ordem == RANKING_MELHORES ? a.media > b.media : a.media < b.media;
+    return strcmp(aluno_em(sistema, a.slot)->ra, aluno_em(sistema, b.slot)->ra) < 0;
+}
+
+// Heap de tamanho limitado: a raiz é o último colocado entre os guardados
+static void ranking_subir(const DadosSistema *sistema, ItemRanking *heap, int i, int ordem) {
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (!antes_no_ranking(sistema, heap[pai], heap[i], ordem)) return;
+        ItemRanking troca = heap[pai];
+        heap[pai] = heap[i];
+        heap[i] = troca;
+        i = pai;
+    }
+}
+
+static void ranking_descer(const DadosSistema *sistema, ItemRanking *heap, int n, int i, int ordem) {
+    for (;;) {
+        int ultimo = i, esq = 2 * i + 1, dir = 2 * i + 2;
+        if (esq < n && antes_no_ranking(sistema, heap[ultimo], heap[esq], ordem)) ultimo = esq;
+        if (dir < n && antes_no_ranking(sistema, heap[ultimo], heap[dir], ordem)) ultimo = dir;
+        if (ultimo == i) return;
+        ItemRanking troca = heap[ultimo];
+        heap[ultimo] = heap[i];
+        heap[i] = troca;
+        i = ultimo;
+    }
+}
+
+/**
+ * @brief Os K melhores (ou piores) alunos pela média final, de uma turma ou de
+ * todas. Uma passada pelas médias das colunas com um heap de K posições:
+ * O(n log K), e a maioria dos alunos sai na comparação com a raiz.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id_turma ID da turma, ou TURMAS_TODAS.
+ * @param k Tamanho do ranking.
+ * @param ordem RANKING_MELHORES (média decrescente) ou RANKING_PIORES (crescente); empates pelo RA.
+ * @param slots Recebe os slots dos alunos, do primeiro ao último colocado (K posições).
+ * @return int Alunos no ranking (até K), ou -1 se a turma não existe ou faltou memória.
+ */
+int ranking_medias(const DadosSistema *sistema, int id_turma, int k, int ordem, int *slots) {
+    METRICA_MEDIR(METRICA_RANKING_MEDIAS);
+    GrupoMedias grupo;
+    if (!grupo_abrir(sistema, id_turma, &grupo)) return -1;
+    if (k > grupo.alunos) k = grupo.alunos;
+    if (k <= 0) return 0;
+    ItemRanking *heap = malloc((size_t)k * sizeof(ItemRanking));
+    if (heap == NULL) return -1;
+
+    int n = 0;
+    for (int slot = grupo_primeiro(&grupo); slot != -1; slot = grupo_proximo(&grupo, slot)) {
+        ItemRanking item = { grupo.colunas->media[slot], slot };
+        if (n < k) {
+            heap[n] = item;
+            ranking_subir(sistema, heap, n++, ordem);
+        } else if (antes_no_ranking(sistema, item, heap[0], ordem)) {
+            heap[0] = item;
+            ranking_descer(sistema, heap, n, 0, ordem);
+        }
+    }
+
+    // Retira sempre o último colocado: os slots saem de trás para a frente
+    for (int m = n; m > 0; m--) {
+        slots[m - 1] = heap[0].slot;
+        heap[0] = heap[m - 1];
+        ranking_descer(sistema, heap, m - 1, 0, ordem);
+    }
+    free(heap);
+    return n;
+}
+
+/**
+ * @brief Chave inteira com a mesma ordem do float (negativos invertidos, sinal trocado).
+ */
+static inline unsigned chave_ordenavel(float valor) {
+    unsigned bits;
+    memcpy(&bits, &valor, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+static int comparar_floats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Inverso de chave_ordenavel.
+ */
+static inline float valor_da_chave(unsigned chave) {
+    unsigned bits = (chave & 0x80000000u) ? (chave & 0x7FFFFFFFu) : ~chave;
+    float valor;
+    memcpy(&valor, &bits, sizeof(valor));
+    return valor;
+}
+
+/**
+ * @brief Valores de posições da ordem crescente das médias do grupo (seleção
+ * em duas passadas, sem ordenar o grupo inteiro). A primeira passada conta as
+ * médias por faixa de chave (os 16 bits altos de chave_ordenavel); a segunda
+ * copia só as médias das faixas que contêm as posições pedidas, que são
+ * ordenadas à parte (ou, se grandes, contadas pelos 16 bits baixos). O(n) no
+ * total; grupos pequenos são copiados e ordenados de uma vez.
+ * @param posicoes Posições pedidas (0 a alunos - 1).
+ * @param valores Recebe a média de cada posição.
+ * @return int 1 se sucesso, 0 se faltou memória.
+ */
+static int selecionar_posicoes(GrupoMedias *grupo, const int *posicoes, int quantidade, float *valores) {
+    const float *media = grupo->colunas->media;
+    if (grupo->alunos <= LIMIAR_SELECAO_DIRETA) {
+        float *todas = malloc((size_t)grupo->alunos * sizeof(float));
+        if (todas == NULL) return 0;
+        int n = 0;
+        for (int slot = grupo_primeiro(grupo); slot != -1 && n < grupo->alunos; slot = grupo_proximo(grupo, slot)) {
+            todas[n++] = media[slot];
+        }
+        qsort(todas, (size_t)n, sizeof(float), comparar_floats);
+        for (int p = 0; p < quantidade; p++) valores[p] = n > 0 ? todas[posicoes[p] < n ? posicoes[p] : n - 1] : 0.0f;
+        free(todas);
+        return 1;
+    }
+
+    // 1ª passada: quantas médias em cada faixa; 'inicio' vira a posição da primeira média de cada faixa
+    int *inicio = calloc(FAIXAS_SELECAO + 1, sizeof(int));
+    int *destino = malloc(FAIXAS_SELECAO * sizeof(int)); // Posição de cópia da faixa (-1 = faixa não pedida)
+    if (inicio == NULL || destino == NULL) {
+        free(inicio);
+        free(destino);
+        return 0;
+    }
+    for (int slot = grupo_primeiro(grupo); slot != -1; slot = grupo_proximo(grupo, slot)) {
+        inicio[(chave_ordenavel(media[slot]) >> 16) + 1]++;
+    }
+    for (int f = 1; f <= FAIXAS_SELECAO; f++) inicio[f] += inicio[f - 1];
+
+    int total = inicio[FAIXAS_SELECAO];
+    if (total == 0) {
+        for (int p = 0; p < quantidade; p++) valores[p] = 0.0f;
+        free(inicio);
+        free(destino);
+        return 1;
+    }
+
+    // Faixa de cada posição pedida (busca binária em 'inicio') e espaço de cópia das faixas pedidas
+    int faixa_da_posicao[2 * MAX_PERCENTIS];
+    int copiados = 0;
+    for (int f = 0; f < FAIXAS_SELECAO; f++) destino[f] = -1;
+    for (int p = 0; p < quantidade; p++) {
+        int posicao = posicoes[p] < total ? posicoes[p] : total - 1;
+        int esq = 0, dir = FAIXAS_SELECAO - 1;
+        while (esq < dir) { // Última faixa com inicio <= posição
+            int meio = (esq + dir + 1) / 2;
+            if (inicio[meio] <= posicao) esq = meio;
+            else dir = meio - 1;
+        }
+        faixa_da_posicao[p] = esq;
+        if (destino[esq] == -1) {
+            destino[esq] = copiados;
+            copiados += inicio[esq + 1] - inicio[esq];
+        }
+    }
+
+    // 2ª passada: copia as médias das faixas pedidas ('destino' avança até o fim da cópia da faixa)
+    float *copia = malloc((size_t)copiados * sizeof(float));
+    if (copia == NULL) {
+        free(inicio);
+        free(destino);
+        return 0;
+    }
+    for (int slot = grupo_primeiro(grupo); slot != -1; slot = grupo_proximo(grupo, slot)) {
+        unsigned faixa = chave_ordenavel(media[slot]) >> 16;
+        if (destino[faixa] != -1) copia[destino[faixa]++] = media[slot];
+    }
+
+    // Cada faixa pedida é ordenada uma vez; numa faixa grande (típico de médias
+    // repetidas), as chaves só diferem nos 16 bits baixos e são contadas por eles
+    // em O(tamanho), e o valor sai da própria chave
+    int ok = 1;
+    int *contagem = NULL;
+    int faixa_contada = -1;
+    for (int p = 0; p < quantidade && ok; p++) {
+        int f = faixa_da_posicao[p];
+        int tamanho = inicio[f + 1] - inicio[f];
+        float *faixa = copia + destino[f] - tamanho;
+        int posicao = (posicoes[p] < total ? posicoes[p] : total - 1) - inicio[f];
+        if (tamanho > LIMIAR_SELECAO_DIRETA) {
+            if (faixa_contada != f) {
+                if (contagem == NULL && (contagem = malloc(FAIXAS_SELECAO * sizeof(int))) == NULL) {
+                    ok = 0;
+                    break;
+                }
+                memset(contagem, 0, FAIXAS_SELECAO * sizeof(int));
+                for (int i = 0; i < tamanho; i++) contagem[chave_ordenavel(faixa[i]) & 0xFFFFu]++;
+                faixa_contada = f;
+            }
+            unsigned baixos = 0;
+            for (int antes = 0; antes + contagem[baixos] <= posicao; baixos++) antes += contagem[baixos];
+            valores[p] = valor_da_chave(((unsigned)f << 16) | baixos);
+            continue;
+        }
+        int ordenada = 0;
+        for (int q = 0; q < p && !ordenada; q++) ordenada = faixa_da_posicao[q] == f;
+        if (!ordenada) qsort(faixa, (size_t)tamanho, sizeof(float), comparar_floats);
+        valores[p] = faixa[posicao];
+    }
+
+    free(contagem);
+    free(inicio);
+    free(destino);
+    free(copia);
+    return ok;
+}
+
+/**
+ * @brief Percentis das médias finais de uma turma ou de todos os alunos, com
+ * interpolação linear entre as duas posições vizinhas (o percentil 50 é a
+ * mediana; com número par de alunos, a média das duas centrais).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id_turma ID da turma, ou TURMAS_TODAS.
+ * @param percentis Percentis pedidos, de 0 a 100 (valores fora são limitados).
+ * @param quantidade Quantidade de percentis (até MAX_PERCENTIS).
+ * @param valores Recebe a média de cada percentil (0 se o grupo está vazio).
+ * @return int Alunos no grupo, ou -1 se a turma não existe ou faltou memória.
+ */
+int percentis_medias(const DadosSistema *sistema, int id_turma, const float *percentis, int quantidade, float *valores) {
+    METRICA_MEDIR(METRICA_PERCENTIS_MEDIAS);
+    GrupoMedias grupo;
+    if (quantidade < 0 || quantidade > MAX_PERCENTIS || !grupo_abrir(sistema, id_turma, &grupo)) return -1;
+    if (grupo.alunos == 0) {
+        for (int p = 0; p < quantidade; p++) valores[p] = 0.0f;
+        return 0;
+    }
+
+    // Cada percentil precisa das duas posições vizinhas na ordem crescente
+    int posicoes[2 * MAX_PERCENTIS];
+    float vizinhos[2 * MAX_PERCENTIS];
+    double fracoes[MAX_PERCENTIS];
+    for (int p = 0; p < quantidade; p++) {
+        double percentil = percentis[p] < 0.0f ? 0.0 : percentis[p] > 100.0f ? 100.0 : percentis[p];
+        double posicao = percentil / 100.0 * (grupo.alunos - 1);
+        int abaixo = (int)floor(posicao);
+        posicoes[2 * p] = abaixo;
+        posicoes[2 * p + 1] = abaixo + 1 < grupo.alunos ? abaixo + 1 : abaixo;
+        fracoes[p] = posicao - abaixo;
+    }
+    if (!selecionar_posicoes(&grupo, posicoes, 2 * quantidade, vizinhos)) return -1;
+    for (int p = 0; p < quantidade; p++) {
+        valores[p] = (float)(vizinhos[2 * p] + fracoes[p] * (vizinhos[2 * p + 1] - vizinhos[2 * p]));
+    }
+    return grupo.alunos;
+}
+
+/**
+ * @brief Exibe o ranking das médias de uma turma ou de todas as turmas.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id_turma ID da turma, ou TURMAS_TODAS.
+ * @param k Tamanho do ranking.
+ * @param ordem RANKING_MELHORES ou RANKING_PIORES.
+ */
+void exibir_ranking_medias(const DadosSistema *sistema, int id_turma, int k, int ordem) {
+    int idx_turma = id_turma == TURMAS_TODAS ? -1 : buscar_turma_por_id(sistema, id_turma);
+    if (id_turma != TURMAS_TODAS && idx_turma == -1) {
+        printf("ERRO: Turma ID %d nao encontrada ou inativa.\n", id_turma);
+        return;
+    }
+    if (k <= 0) {
+        printf("ERRO: O tamanho do ranking deve ser positivo.\n");
+        return;
+    }
+    int *slots = malloc((size_t)k * sizeof(int));
+    int n = slots != NULL ? ranking_medias(sistema, id_turma, k, ordem, slots) : -1;
+    if (n < 0) {
+        printf("ERRO: Memoria insuficiente para o ranking.\n");
+        free(slots);
+        return;
+    }
+
+    if (idx_turma == -1) {
+        printf("\n--- RANKING: %d %s medias (Todas as turmas) ---\n", k, ordem == RANKING_MELHORES ? "melhores" : "piores");
+    } else {
+        printf("\n--- RANKING: %d %s medias (Turma %s, ID %d) ---\n", k, ordem == RANKING_MELHORES ? "melhores" : "piores",
+               texto_em(sistema, turma_em(sistema, idx_turma)->nome), id_turma);
+    }
+    printf("-------------------------------------------------------------------------------------\n");
+    printf("| %5s | %-10s | %-40s | %5s | %5s | %-8s |\n", "Pos.", "RA", "Nome", "Turma", "Media", "Situacao");
+    printf("-------------------------------------------------------------------------------------\n");
+    for (int i = 0; i < n; i++) {
+        const Aluno *aluno = aluno_em(sistema, slots[i]);
+        printf("| %5d | %-10s | %-40s | %5d | %5.2f | %-8s |\n", i + 1, aluno->ra, texto_em(sistema, aluno->nome),
+               aluno->id_turma, aluno->media_final, situacao_aluno(aluno));
+    }
+    if (n == 0) {
+        printf("|                                Nenhum aluno ativo.                                |\n");
+    }
+    printf("-------------------------------------------------------------------------------------\n");
+    free(slots);
+}
+
+/**
+ * @brief Exibe a distribuição das médias (mínima, percentis 10/25/75/90,
+ * mediana e máxima) de uma turma ou de todos os alunos.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param id_turma ID da turma, ou TURMAS_TODAS.
+ */
+void exibir_percentis_medias(const DadosSistema *sistema, int id_turma) {
+    static const float percentis[] = {0.0f, 10.0f, 25.0f, 50.0f, 75.0f, 90.0f, 100.0f};
+    float valores[7];
+    int alunos = percentis_medias(sistema, id_turma, percentis, 7, valores);
+    if (alunos < 0) {
+        if (id_turma != TURMAS_TODAS && buscar_turma_por_id(sistema, id_turma) == -1) {
+            printf("ERRO: Turma ID %d nao encontrada ou inativa.\n", id_turma);
+        } else {
+            printf("ERRO: Memoria insuficiente para os percentis.\n");
+        }
+        return;
+    }
+
+    if (id_turma == TURMAS_TODAS) {
+        printf("\n--- PERCENTIS DAS MEDIAS (Todas as turmas) ---\n");
+    } else {
+        printf("\n--- PERCENTIS DAS MEDIAS (Turma ID %d) ---\n", id_turma);
+    }
+    printf("Alunos: %d\n", alunos);
+    if (alunos == 0) return;
+    printf("Minima: %.2f | P10: %.2f | P25: %.2f | Mediana: %.2f | P75: %.2f | P90: %.2f | Maxima: %.2f\n",
+           valores[0], valores[1], valores[2], valores[3], valores[4], valores[5], valores[6]);
+}
+
+// --- 8. Manutenção (Compactação) ---
+
+/**
+ * @brief Copia os registros ativos de uma tabela para um pool novo, na ordem dos slots.
+ * @param origem Tabela atual (com todas as páginas carregadas).
+ * @param destino Pool que recebe a cópia (é inicializado aqui).
+ * @param pos_ativo Deslocamento do campo 'ativo' no registro.
+ * @return int 1 se bem-sucedido, 0 se faltou memória (o pool novo é liberado).
+ */
+static int copiar_ativos(const PoolRegistros *origem, PoolRegistros *destino, size_t pos_ativo) {
+    pool_inicializar(destino, origem->tam_registro);
+    for (int i = 0; i < origem->usados; i++) {
+        const char *registro = pool_slot(origem, i);
+        int ativo;
+        memcpy(&ativo, registro + pos_ativo, sizeof(int));
+        if (ativo != 1) continue;
+
+        int novo = pool_novo_slot(destino);
+        if (novo == -1) {
+            pool_liberar(destino);
+            return 0;
+        }
+        memcpy(pool_slot(destino, novo), registro, origem->tam_registro);
+    }
+    return 1;
+}
+
+/**
+ * @brief Monta um heap de textos só com os nomes dos registros copiados e
+ * passa os registros a apontar para ele.
+ * @param sistema Dados atuais (heap de onde os nomes são lidos).
+ * @param turmas Turmas já compactadas.
+ * @param alunos Alunos já compactados.
+ * @param textos Heap novo (é inicializado aqui).
+ * @param internados Índice de internação do heap novo (é inicializado aqui).
+ * @return int 1 se bem-sucedido, 0 se faltou memória (o heap novo é liberado).
+ */
+static int copiar_textos(const DadosSistema *sistema, PoolRegistros *turmas, PoolRegistros *alunos,
+                         PoolRegistros *textos, IndiceTextos *internados) {
+    pool_inicializar(textos, TAM_CELULA_TEXTO);
+    indice_textos_inicializar(internados);
+    int ok = 1;
+    for (int i = 0; ok && i < turmas->usados; i++) {
+        Turma *turma = pool_slot(turmas, i);
+        turma->nome = textos_guardar(textos, internados, texto_em(sistema, turma->nome), NULL);
+        ok = turma->nome != -1;
+    }
+    for (int i = 0; ok && i < alunos->usados; i++) {
+        Aluno *aluno = pool_slot(alunos, i);
+        aluno->nome = textos_guardar(textos, internados, texto_em(sistema, aluno->nome), NULL);
+        ok = aluno->nome != -1;
+    }
+    if (!ok) {
+        pool_liberar(textos);
+        indice_textos_liberar(internados);
+    }
+    return ok;
+}
+
+/**
+ * @brief Troca uma tabela pela sua versão compactada.
+ * No modo mapeado, a versão compactada é gravada num arquivo .map novo, que
+ * substitui o antigo por renomeação.
+ * @param tabela Tabela atual (é liberada).
+ * @param compactada Versão compactada, em memória (passa a ser a tabela).
+ * @param caminho_mapa Arquivo mapeado da tabela (usado só no modo mapeado).
+ * @param ativos Registros ativos, para o cabeçalho do arquivo mapeado.
+ * @return int 1 se bem-sucedido, 0 caso contrário (a tabela atual fica intacta).
+ */
+static int substituir_tabela(PoolRegistros *tabela, PoolRegistros *compactada, const char *caminho_mapa, int ativos) {
+    if (tabela->mapa != NULL && !mapa_criar(compactada, caminho_mapa, ativos)) {
+        pool_liberar(compactada);
+        return 0;
+    }
+    pool_liberar(tabela);
+    *tabela = *compactada;
+    return 1;
+}
+
+/**
+ * @brief Descarta todos os índices em memória (são remontados no próximo uso).
+ */
+static void descartar_indices(DadosSistema *sistema) {
+    indice_ra_liberar(&sistema->indice_ra);
+    indice_turmas_liberar(&sistema->membros);
+    indice_nomes_liberar(&sistema->nomes);
+    indice_ids_liberar(&sistema->ids);
+    indice_livres_liberar(&sistema->turmas_livres);
+    indice_livres_liberar(&sistema->alunos_livres);
+    indice_estatisticas_liberar(&sistema->estatisticas);
+    indice_trigramas_liberar(&sistema->trigramas);
+    colunas_liberar(&sistema->colunas);
+}
+
+/**
+ * @brief Remove de vez os registros excluídos logicamente (vacuum).
+ * Os registros ativos são copiados, na ordem atual, para tabelas sem buracos,
+ * e os índices são remontados. Os IDs das turmas não mudam (os alunos continuam
+ * apontando para as mesmas turmas) e os IDs removidos não são reutilizados.
+ * O heap de textos é refeito só com os nomes em uso, exceto no modo mapeado:
+ * lá cada arquivo é trocado separadamente, e tabelas e heap precisam mudar juntos.
+ * O resultado é gravado por checkpoint: as imagens do diário se referem aos
+ * slots antigos, por isso o diário é esvaziado antes da compactação.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return int 1 se bem-sucedido, 0 caso contrário.
+ */
+int compactar_dados(DadosSistema *sistema) {
+    METRICA_MEDIR(METRICA_COMPACTAR_DADOS);
+    if (!checkpoint_dados(sistema)) {
+        printf("ERRO: Compactacao cancelada (nao foi possivel gravar o estado atual).\n");
+        return 0;
+    }
+
+    // O maior ID já usado precisa ser conhecido antes de as turmas excluídas sumirem
+    montar_indice_ids(sistema);
+    if (!sistema->ids.pronto) return 0;
+    if (sistema->proximo_id_turma <= sistema->ids.maior_id) {
+        sistema->proximo_id_turma = sistema->ids.maior_id + 1;
+    }
+
+    PoolRegistros turmas, alunos, textos;
+    IndiceTextos internados;
+    if (!copiar_ativos(&sistema->turmas, &turmas, offsetof(Turma, ativo))) {
+        printf("ERRO: Memoria insuficiente para compactar os dados.\n");
+        return 0;
+    }
+    if (!copiar_ativos(&sistema->alunos, &alunos, offsetof(Aluno, ativo))) {
+        pool_liberar(&turmas);
+        printf("ERRO: Memoria insuficiente para compactar os dados.\n");
+        return 0;
+    }
+    if (!sistema->mapeado && !copiar_textos(sistema, &turmas, &alunos, &textos, &internados)) {
+        pool_liberar(&turmas);
+        pool_liberar(&alunos);
+        printf("ERRO: Memoria insuficiente para compactar os dados.\n");
+        return 0;
+    }
+    int turmas_removidas = sistema->turmas.usados - turmas.usados;
+    int alunos_removidos = sistema->alunos.usados - alunos.usados;
+    int celulas_removidas = 0;
+    if (!sistema->mapeado) {
+        celulas_removidas = sistema->textos.usados - textos.usados;
+        pool_liberar(&sistema->textos);
+        indice_textos_liberar(&sistema->internados);
+        sistema->textos = textos;
+        sistema->internados = internados;
+    }
+
+    // Turmas primeiro: como os alunos apontam para o ID da turma, que não muda,
+    // as tabelas continuam consistentes mesmo se só a primeira troca acontecer.
+    int ok = substituir_tabela(&sistema->turmas, &turmas, NOME_MAPA_TURMAS, turmas.usados);
+    if (ok) {
+        sistema->total_turmas = sistema->turmas.usados;
+        ok = substituir_tabela(&sistema->alunos, &alunos, NOME_MAPA_ALUNOS, alunos.usados);
+        if (ok) sistema->total_alunos = sistema->alunos.usados;
+    } else {
+        pool_liberar(&alunos);
+    }
+    descartar_indices(sistema);
+
+    // Os slots mudaram: a próxima gravação não pode usar o diário, só o checkpoint
+    sistema->diario.incompleto = 1;
+    if (!ok || !checkpoint_dados(sistema)) {
+        printf("ERRO: Falha ao gravar os dados compactados.\n");
+        return 0;
+    }
+
+    printf("SUCESSO: Compactacao concluida (%d slots de turmas, %d de alunos e %d celulas de nomes liberados).\n",
+           turmas_removidas, alunos_removidos, celulas_removidas);
+    return 1;
+}
+
+// --- 9. Operações em Massa ---
+
+/**
+ * @brief Recalcula a média final e a situação de todos os alunos (ex: após mudar
+ * politica_notas). O cálculo é feito nas colunas de notas, vários alunos por
+ * instrução; só os registros cuja média mudou são regravados (e vão para o diário).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return long Número de médias alteradas, ou -1 se faltou memória.
+ */
+long recalcular_medias(DadosSistema *sistema) {
+    METRICA_MEDIR(METRICA_RECALCULAR_MEDIAS);
+    ColunasNotas *colunas = &sistema->colunas;
+    if (!colunas->pronto && !colunas_reconstruir(sistema, colunas)) {
+        printf("ERRO: Memoria insuficiente para montar as colunas de notas.\n");
+        return -1;
+    }
+
+    clock_t inicio = clock();
+    long mudaram = colunas_recalcular(colunas, &politica_notas);
+    double ms = (double)(clock() - inicio) * 1000.0 / CLOCKS_PER_SEC;
+
+    long alterados = 0;
+    if (mudaram > 0) {
+        // Devolve aos registros só as médias que mudaram (os slots inativos ficam como estão)
+        for (int i = 0; i < colunas->quantidade; i++) {
+            if (!(colunas->situacao[i] & COLUNA_ALTERADA)) continue;
+            colunas->situacao[i] &= (unsigned char)~COLUNA_ALTERADA;
+            if (colunas_ativo(colunas, i)) {
+                Aluno *aluno = aluno_para_escrita(sistema, i);
+                int idx_turma = buscar_turma_por_id(sistema, aluno->id_turma);
+                indice_estatisticas_retirar(&sistema->estatisticas, idx_turma, aluno->media_final);
+                aluno->media_final = colunas->media[i];
+                estatisticas_incluir(sistema, idx_turma, aluno->media_final);
+                alterados++;
+            } else {
+                colunas_atualizar(sistema, colunas, i);
+            }
+        }
+    }
+
+    printf("SUCESSO: %ld medias recalculadas em %d alunos (nucleo %s, %.3f ms).\n",
+           alterados, colunas->quantidade, colunas_nucleo(), ms);
+    return alterados;
+}
+
+// --- 10. Transações ---
+
+/**
+ * @brief Abre uma transação: as operações seguintes são gravadas juntas por
+ * confirmar_transacao ou desfeitas em memória por desfazer_transacao (ver transacao.h).
+ * Alterações anteriores ainda não salvas continuam pendentes e entram na confirmação.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return int 1 se a transação foi aberta, 0 se já havia uma aberta.
+ */
+int iniciar_transacao(DadosSistema *sistema) {
+    Transacao *transacao = &sistema->transacao;
+    if (transacao->ativa) {
+        printf("AVISO: Ja existe uma transacao aberta.\n");
+        return 0;
+    }
+    transacao_liberar(transacao);
+    transacao->ativa = 1;
+    transacao->usados_turmas = sistema->turmas.usados;
+    transacao->usados_alunos = sistema->alunos.usados;
+    transacao->usados_textos = sistema->textos.usados;
+    transacao->total_turmas = sistema->total_turmas;
+    transacao->total_alunos = sistema->total_alunos;
+    transacao->proximo_id_turma = sistema->proximo_id_turma;
+    transacao->marcas_turmas = sistema->diario.turmas.quantidade;
+    transacao->marcas_alunos = sistema->diario.alunos.quantidade;
+    transacao->marcas_textos = sistema->diario.textos.quantidade;
+    transacao->marcas_fragmentos = sistema->fragmentos.quantidade;
+    return 1;
+}
+
+/**
+ * @brief Grava de uma vez tudo o que foi feito na transação e a fecha: uma
+ * confirmação no diário, com fsync mesmo com group commit (ou, no modo
+ * fragmentado, uma transação de segmentos).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return int 1 se gravada, 0 se não há transação aberta ou a gravação falhou
+ * (a transação continua aberta: pode ser confirmada de novo ou desfeita).
+ */
+int confirmar_transacao(DadosSistema *sistema) {
+    Transacao *transacao = &sistema->transacao;
+    if (!transacao->ativa) {
+        printf("AVISO: Nenhuma transacao aberta.\n");
+        return 0;
+    }
+    transacao->ativa = 0;
+    salvar_dados(sistema);
+
+    // salvar_dados só descarta as marcas depois de gravar
+    if (!diario_tem_alteracoes(&sistema->diario) && sistema->fragmentos.quantidade == 0 &&
+        diario_sincronizar(&sistema->diario)) {
+        transacao_liberar(transacao);
+        return 1;
+    }
+    transacao->ativa = 1;
+    printf("ERRO: Falha ao gravar a transacao. Ela continua aberta.\n");
+    return 0;
+}
+
+/**
+ * @brief Desfaz em memória, sem reler os arquivos, tudo o que foi feito na
+ * transação e a fecha: os registros voltam às imagens guardadas, as tabelas e
+ * o heap voltam às marcas d'água do início e os índices são remontados no
+ * próximo uso. Nada é gravado.
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @return int 1 se desfeita, 0 se não há transação aberta ou faltou memória
+ * para as imagens (a transação é fechada e as alterações ficam pendentes).
+ */
+int desfazer_transacao(DadosSistema *sistema) {
+    Transacao *transacao = &sistema->transacao;
+    if (!transacao->ativa) {
+        printf("AVISO: Nenhuma transacao aberta.\n");
+        return 0;
+    }
+    if (transacao->sem_memoria) {
+        transacao_liberar(transacao);
+        printf("ERRO: Memoria insuficiente para desfazer a transacao. As alteracoes serao gravadas normalmente.\n");
+        return 0;
+    }
+
+    transacao_restaurar(&transacao->turmas, &sistema->turmas);
+    transacao_restaurar(&transacao->alunos, &sistema->alunos);
+    pool_truncar(&sistema->turmas, transacao->usados_turmas);
+    pool_truncar(&sistema->alunos, transacao->usados_alunos);
+    pool_truncar(&sistema->textos, transacao->usados_textos);
+    sistema->total_turmas = transacao->total_turmas;
+    sistema->total_alunos = transacao->total_alunos;
+    sistema->proximo_id_turma = transacao->proximo_id_turma;
+
+    // As listas só crescem durante a transação: as marcas dela são as do final
+    sistema->diario.turmas.quantidade = transacao->marcas_turmas;
+    sistema->diario.alunos.quantidade = transacao->marcas_alunos;
+    sistema->diario.textos.quantidade = transacao->marcas_textos;
+    sistema->fragmentos.quantidade = transacao->marcas_fragmentos;
+
+    // Segmentos lidos durante a transação ficaram além das marcas d'água: voltam
+    // a ser lidos do disco, que ainda tem o estado de antes dela
+    Fragmentos *fragmentos = &sistema->fragmentos;
+    for (int i = 0; i < fragmentos->capacidade; i++) {
+        if (fragmentos->inicio[i] >= transacao->usados_alunos) {
+            fragmentos->inicio[i] = -1;
+            fragmentos->parcial = 1;
+        }
+    }
+
+    // Os índices acompanharam as operações desfeitas
+    descartar_indices(sistema);
+    indice_textos_liberar(&sistema->internados);
+    transacao_liberar(transacao);
+    return 1;
+}
@@ -2,11 +2,19 @@
 #define SERVICOS_H
 
 #include <stdio.h> 
+#include "armazenamento.h"
+#include "indices.h"
+#include "diario.h"
+#include "mapeamento.h"
+#include "colunas.h"
+#include "textos.h"
+#include "trigramas.h"
+#include "fragmentos.h"
+#include "transacao.h"
+#include "gravador.h"
 
 // --- Constantes Globais ---
-#define MAX_ALUNOS 100
-#define MAX_TURMAS 20
-#define TAM_NOME 50
+#define TAM_NOME 1024 // Maior nome aceito na entrada, com o '\0' (o registro guarda só a referência)
 #define TAM_RA 10
 #define NOME_ARQUIVO "dados_sistema.bin"
 
@@ -25,7 +33,7 @@ typedef struct {
 // --- Estruturas de Dados (Sincronizadas) ---
 typedef struct {
     int id;
-    char nome[TAM_NOME];
+    int nome;             // Referência no heap de textos (ver texto_em)
     int vagas_maximas;
     int vagas_ocupadas;
     int ativo;
@@ -33,31 +41,118 @@ typedef struct {
 
 typedef struct {
     char ra[TAM_RA];
-    char nome[TAM_NOME];
+    int nome;             // Referência no heap de textos (ver texto_em)
     int id_turma;
     float notas[3]; 
     float media_final; 
     int ativo; 
 } Aluno;
 
-typedef struct {
-    Turma turmas[MAX_TURMAS];
-    Aluno alunos[MAX_ALUNOS];
-    int total_turmas;
-    int total_alunos;
+// Tabelas crescentes (sem limite fixo): os slots [0, usados) de cada pool
+// guardam registros ativos ou inativos (exclusão lógica). Slots inativos são
+// reaproveitados por novas inserções e removidos de vez por compactar_dados.
+typedef struct DadosSistema {
+    PoolRegistros turmas; // Registros do tipo Turma
+    PoolRegistros alunos; // Registros do tipo Aluno
+    PoolRegistros textos; // Heap dos nomes (células de TAM_CELULA_TEXTO bytes, ver textos.h)
+    int total_turmas;     // Turmas ativas
+    int total_alunos;     // Alunos ativos
+    IndiceRA indice_ra;   // RA -> slot do aluno (somente em memória)
+    IndiceTextos internados; // Texto -> referência no heap, para não repetir nomes (somente em memória)
+    IndiceTurmas membros; // Turma -> lista de slots de alunos (somente em memória)
+    IndiceNomes nomes;    // Alunos em ordem alfabética (somente em memória)
+    IndiceIds ids;        // ID da turma -> slot (somente em memória)
+    IndiceLivres turmas_livres; // Slots de turmas inativas, para reaproveitamento (somente em memória)
+    IndiceLivres alunos_livres; // Slots de alunos inativos, para reaproveitamento (somente em memória)
+    IndiceEstatisticas estatisticas; // Somas e contagens das médias por turma (somente em memória)
+    IndiceTrigramas trigramas; // Trigrama -> nomes do heap, para a busca por nome (somente em memória)
+    ColunasNotas colunas; // Notas e médias em vetores contíguos, para operações em massa (somente em memória)
+    int proximo_id_turma; // Próximo ID de turma (IDs não são reutilizados; 0 = ainda não conhecido)
+    Diario diario;        // Registros alterados e arquivo de diário (write-ahead log)
+    int mapeado;          // 1 = tabelas nos arquivos .map (modo mmap), 0 = arquivo base
+    Fragmentos fragmentos; // Modo fragmentado: catálogo e um segmento por turma (ver fragmentos.h)
+    Transacao transacao;  // Transação aberta por iniciar_transacao (ver transacao.h)
 } DadosSistema;
 
+// Acesso O(1) ao registro de um slot (0 <= idx < pool.usados).
+static inline Turma *turma_em(const DadosSistema *sistema, int idx) {
+    return (Turma *)pool_slot(&sistema->turmas, idx);
+}
+static inline Aluno *aluno_em(const DadosSistema *sistema, int idx) {
+    return (Aluno *)pool_slot(&sistema->alunos, idx);
+}
+
+// Nome guardado numa referência do heap de textos (O(1)).
+static inline const char *texto_em(const DadosSistema *sistema, int ref) {
+    return texto_no_heap(&sistema->textos, ref);
+}
+
+// Critério de média e situação usado em todo o sistema (ver colunas.h).
+extern const PoliticaNotas politica_notas;
+
+// Resumo estatístico das médias dos alunos ativos de uma turma.
+typedef struct {
+    int alunos;           // Alunos ativos
+    float media;          // Média das médias finais
+    float desvio_padrao;  // Desvio padrão (populacional) das médias finais
+    int aprovados;        // Alunos com situação "Aprovado"
+    int recuperacao;      // Alunos com situação "Recup."
+    int reprovados;       // Alunos com situação "Reprovado"
+    float taxa_aprovacao; // Aprovados / alunos, em % (0 se a turma está vazia)
+} ResumoTurma;
+
+// Turma ou aluno encontrado pela busca por nome.
+#define RESULTADO_TURMA 0
+#define RESULTADO_ALUNO 1
+#define MAX_RESULTADOS_BUSCA 20
+
+typedef struct {
+    int tipo;             // RESULTADO_TURMA ou RESULTADO_ALUNO
+    int slot;             // Slot do registro na tabela correspondente
+    float semelhanca;     // Semelhança do nome com a consulta (0 a 1, ver trigramas.h)
+} ResultadoNome;
+
+// Rankings e percentis das médias finais (ranking_medias, percentis_medias).
+#define TURMAS_TODAS 0        // No lugar do ID da turma: todos os alunos ativos
+#define RANKING_PIORES 0      // Médias em ordem crescente
+#define RANKING_MELHORES 1    // Médias em ordem decrescente
+#define MAX_PERCENTIS 16      // Percentis por chamada de percentis_medias
+
 // --- Protótipos das Funções ---
 
 // Autenticação
 int realizar_login(int *nivel_acesso);
+int autenticar_usuario(const char *login, const char *senha);
 
 // I/O (Persistência)
 void carregar_dados(DadosSistema *sistema);
-void salvar_dados(const DadosSistema *sistema);
-
-// Auxiliares (Relatório)
+void salvar_dados(DadosSistema *sistema);
+int checkpoint_dados(DadosSistema *sistema);
+void liberar_dados(DadosSistema *sistema);
+int ativar_modo_mapeado(DadosSistema *sistema);
+int ativar_modo_fragmentado(DadosSistema *sistema);
+int iniciar_gravador(DadosSistema *sistema, Gravador *gravador, int atraso_ms);
+void encerrar_gravador(DadosSistema *sistema);
+int sincronizar_dados(DadosSistema *sistema);
+int preparar_indices(const DadosSistema *sistema);
+int guardar_texto(DadosSistema *sistema, const char *texto);
+
+// Transações (várias operações, uma gravação; ver transacao.h)
+int iniciar_transacao(DadosSistema *sistema);
+int confirmar_transacao(DadosSistema *sistema);
+int desfazer_transacao(DadosSistema *sistema);
+
+// Mensagens (modo silencioso para operações em lote)
+void definir_modo_silencioso(int ativo);
+const char *ultima_mensagem(void);
+
+// Auxiliares (Busca e Relatório)
+int buscar_aluno_por_ra(const DadosSistema *sistema, const char *ra);
+int buscar_turma_por_id(const DadosSistema *sistema, int id_turma);
+int percorrer_alunos_turma(const DadosSistema *sistema, int idx_turma, VisitaAluno visita, void *contexto);
 void listar_todas_turmas(const DadosSistema *sistema);
+int buscar_nomes(const DadosSistema *sistema, const char *consulta, int aproximada, ResultadoNome *resultados, int max);
+void procurar_por_nome(const DadosSistema *sistema, const char *consulta, int aproximada);
 
 // Gerenciamento (CREATE)
 int adicionar_turma(DadosSistema *sistema, const char *nome, int vagas);
@@ -70,10 +165,20 @@ int editar_dados_aluno(DadosSistema *sistema, const char *ra_antigo, const char
 // Gerenciamento (DELETE - Exclusão Lógica)
 int excluir_aluno_por_ra(DadosSistema *sistema, const char *ra);
 int excluir_turma_por_id(DadosSistema *sistema, int id);
+int compactar_dados(DadosSistema *sistema);
 
 // Lógica e Relatórios (READ)
 void ordenar_alunos_por_nome(DadosSistema *sistema);
+void listar_alunos_por_nome(const DadosSistema *sistema, const char *prefixo);
 void gerar_relatorio_turma(const DadosSistema *sistema, int id_turma);
+const char *situacao_aluno(const Aluno *aluno);
+int resumir_turma(const DadosSistema *sistema, int id_turma, ResumoTurma *resumo);
+void exibir_estatisticas_turma(const DadosSistema *sistema, int id_turma);
+int ranking_medias(const DadosSistema *sistema, int id_turma, int k, int ordem, int *slots);
+int percentis_medias(const DadosSistema *sistema, int id_turma, const float *percentis, int quantidade, float *valores);
+void exibir_ranking_medias(const DadosSistema *sistema, int id_turma, int k, int ordem);
+void exibir_percentis_medias(const DadosSistema *sistema, int id_turma);
+long recalcular_medias(DadosSistema *sistema);
 
 
-#endif // SERVICOS_H
\ No newline at end of file
+#endif // SERVICOS_H
\ No newline at end of file
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "servidor.h"
+#include "versoes.h"
+#include "protocolo.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#ifndef _WIN32
+
+typedef struct {
+    DadosSistema *sistema;
+    pthread_rwlock_t dados;          // Consultas compartilham, alterações são exclusivas
+    GerenteVersoes versoes;          // Fotos usadas pelos relatórios (lidos fora da trava)
+    pthread_mutex_t trava_fila;      // Protege a fila, 'encerrando' e 'conexoes'
+    pthread_cond_t fila_sinal;       // Chegou conexão na fila (ou o servidor está encerrando)
+    int fila[TAM_FILA_CONEXOES];     // Conexões aceitas aguardando trabalhador (fila circular)
+    int fila_inicio;
+    int fila_quantidade;
+    int encerrando;                  // 1 = os trabalhadores devem terminar
+    int conexoes[MAX_TRABALHADORES]; // Conexão atendida por cada trabalhador (-1 = nenhuma)
+} Servidor;
+
+typedef struct {
+    Servidor *servidor;
+    int indice;                      // Posição em servidor->conexoes
+    pthread_t thread;
+} Trabalhador;
+
+static volatile sig_atomic_t sinal_encerrar = 0;
+
+// --- 1. Atendimento ---
+
+/**
+ * @brief Executa um pedido (uma linha, sem a quebra) e escreve a resposta.
+ * @return int 0 se a conexão deve ser encerrada (SAIR), 1 caso contrário.
+ */
+static int atender_pedido(Servidor *servidor, Sessao *sessao, char *linha) {
+    const Comando *comando;
+    char *campos[MAX_CAMPOS_PEDIDO];
+    TipoPedido tipo = interpretar_pedido(sessao, linha, &comando, campos);
+    if (tipo != PEDIDO_EXECUTAR) return tipo != PEDIDO_SAIR;
+
+    if (!comando->altera) {
+        // A trava de leitura só cobre a abertura da foto: o relatório roda
+        // sobre ela enquanto as alterações seguem. Sem foto (modo mapeado ou
+        // falta de memória), a consulta inteira fica sob a trava.
+        pthread_rwlock_rdlock(&servidor->dados);
+        DadosSistema *foto = comando->foto ? foto_abrir(&servidor->versoes) : NULL;
+        if (foto != NULL) {
+            pthread_rwlock_unlock(&servidor->dados);
+            comando->executar(sessao, foto, campos);
+            foto_fechar(&servidor->versoes, foto);
+            return 1;
+        }
+        comando->executar(sessao, servidor->sistema, campos);
+        pthread_rwlock_unlock(&servidor->dados);
+        return 1;
+    }
+
+    pthread_rwlock_wrlock(&servidor->dados);
+    definir_modo_silencioso(1); // Zera a última mensagem desta thread
+    if (comando->executar(sessao, servidor->sistema, campos)) {
+        salvar_dados(servidor->sistema); // Confirmado antes de a resposta sair
+    }
+    // Um índice descartado por falta de memória é remontado aqui, sob a trava
+    // exclusiva: as consultas nunca montam caches.
+    preparar_indices(servidor->sistema);
+    pthread_rwlock_unlock(&servidor->dados);
+    return 1;
+}
+
+/**
+ * @brief Atende uma conexão até o cliente enviar SAIR ou fechar o socket.
+ * @param servidor Estado do servidor.
+ * @param cliente Socket da conexão (continua aberto ao retornar).
+ */
+static void atender_conexao(Servidor *servidor, int cliente) {
+    Sessao sessao;
+    sessao.nivel = -1;
+    sessao.erros = 0;
+
+    FILE *entrada = fdopen(dup(cliente), "r");
+    FILE *resposta = fdopen(dup(cliente), "w");
+    if (entrada == NULL || resposta == NULL || !saida_iniciar(&sessao.saida, resposta)) {
+        if (entrada != NULL) fclose(entrada);
+        if (resposta != NULL) fclose(resposta);
+        return;
+    }
+
+    char linha[TAM_LINHA_PEDIDO];
+    int continuar = 1;
+    while (continuar && fgets(linha, sizeof(linha), entrada) != NULL) {
+        size_t tamanho = strcspn(linha, "\r\n");
+        if (linha[tamanho] == '\0' && !feof(entrada)) {
+            // Pedido longo demais: descarta o resto da linha
+            int c;
+            while ((c = fgetc(entrada)) != '\n' && c != EOF);
+            responder_erro(&sessao, "Pedido longo demais.");
+        } else {
+            linha[tamanho] = '\0';
+            continuar = atender_pedido(servidor, &sessao, linha);
+        }
+        // Uma escrita por resposta (fora da trava, salvo respostas maiores que o buffer)
+        saida_descarregar(&sessao.saida);
+        if (fflush(resposta) != 0 || sessao.saida.erro) break;
+    }
+
+    saida_concluir(&sessao.saida);
+    fclose(resposta);
+    fclose(entrada);
+}
+
+// --- 2. Trabalhadores e Fila de Conexões ---
+
+/**
+ * @brief Coloca uma conexão aceita na fila dos trabalhadores.
+ * @return int 1 se enfileirada, 0 se a fila está cheia.
+ */
+static int enfileirar_conexao(Servidor *servidor, int cliente) {
+    pthread_mutex_lock(&servidor->trava_fila);
+    int ok = servidor->fila_quantidade < TAM_FILA_CONEXOES;
+    if (ok) {
+        int fim = (servidor->fila_inicio + servidor->fila_quantidade) % TAM_FILA_CONEXOES;
+        servidor->fila[fim] = cliente;
+        servidor->fila_quantidade++;
+        pthread_cond_signal(&servidor->fila_sinal);
+    }
+    pthread_mutex_unlock(&servidor->trava_fila);
+    return ok;
+}
+
+/**
+ * @brief Espera a próxima conexão da fila e a registra como atendida pelo trabalhador.
+ * @return int O socket, ou -1 se o servidor está encerrando.
+ */
+static int retirar_conexao(Servidor *servidor, int indice) {
+    pthread_mutex_lock(&servidor->trava_fila);
+    while (servidor->fila_quantidade == 0 && !servidor->encerrando) {
+        pthread_cond_wait(&servidor->fila_sinal, &servidor->trava_fila);
+    }
+    int cliente = -1;
+    if (!servidor->encerrando) {
+        cliente = servidor->fila[servidor->fila_inicio];
+        servidor->fila_inicio = (servidor->fila_inicio + 1) % TAM_FILA_CONEXOES;
+        servidor->fila_quantidade--;
+    }
+    servidor->conexoes[indice] = cliente;
+    pthread_mutex_unlock(&servidor->trava_fila);
+    return cliente;
+}
+
+static void *executar_trabalhador(void *argumento) {
+    Trabalhador *trabalhador = argumento;
+    Servidor *servidor = trabalhador->servidor;
+
+    definir_modo_silencioso(1); // Mensagens das operações viram respostas, não vão para o terminal
+    int cliente;
+    while ((cliente = retirar_conexao(servidor, trabalhador->indice)) != -1) {
+        atender_conexao(servidor, cliente);
+
+        // Sai da lista antes de fechar: o desligamento nunca usa um descritor já reaproveitado
+        pthread_mutex_lock(&servidor->trava_fila);
+        servidor->conexoes[trabalhador->indice] = -1;
+        pthread_mutex_unlock(&servidor->trava_fila);
+        close(cliente);
+    }
+    return NULL;
+}
+
+// --- 3. Ciclo do Servidor ---
+
+static void tratar_sinal(int sinal) {
+    (void)sinal;
+    sinal_encerrar = 1;
+}
+
+/**
+ * @brief Indica se já há um servidor atendendo no endereço (um socket antigo pode ter ficado para trás).
+ */
+static int endereco_em_uso(const struct sockaddr_un *endereco) {
+    int teste = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (teste < 0) return 0;
+    int em_uso = connect(teste, (const struct sockaddr *)endereco, sizeof(*endereco)) == 0;
+    close(teste);
+    return em_uso;
+}
+
+/**
+ * @brief Cria o socket de escuta no caminho indicado (substitui um socket abandonado).
+ * @return int O socket, ou -1 em caso de erro (já informado).
+ */
+static int abrir_escuta(const char *caminho) {
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        printf("ERRO: Caminho do socket '%s' longo demais.\n", caminho);
+        return -1;
+    }
+    strcpy(endereco.sun_path, caminho);
+
+    int escuta = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (escuta < 0) {
+        printf("ERRO: Nao foi possivel criar o socket (%s).\n", strerror(errno));
+        return -1;
+    }
+    int ok = bind(escuta, (struct sockaddr *)&endereco, sizeof(endereco)) == 0;
+    if (!ok && errno == EADDRINUSE && !endereco_em_uso(&endereco)) {
+        unlink(caminho);
+        ok = bind(escuta, (struct sockaddr *)&endereco, sizeof(endereco)) == 0;
+    }
+    if (!ok || listen(escuta, TAM_FILA_CONEXOES) != 0) {
+        printf("ERRO: Nao foi possivel atender em '%s' (%s).\n", caminho,
+               errno == EADDRINUSE ? "outro servidor ja esta ativo" : strerror(errno));
+        close(escuta);
+        return -1;
+    }
+    return escuta;
+}
+
+/**
+ * @brief Modo servidor: atende clientes no socket Unix até receber SIGINT ou SIGTERM.
+ * Todas as páginas e índices são carregados antes: as consultas rodam em
+ * paralelo sob trava compartilhada e não podem montar nada sob demanda.
+ * @param sistema Ponteiro para a estrutura DadosSistema (já carregada).
+ * @param caminho Caminho do socket.
+ * @param trabalhadores Threads trabalhadoras (0 = duas por núcleo, no mínimo TRABALHADORES_MINIMO).
+ * @return int Código de saída: 0 se encerrado normalmente, 1 em caso de erro.
+ */
+int executar_servidor(DadosSistema *sistema, const char *caminho, int trabalhadores) {
+    int turmas_integras = pool_carregar_tudo(&sistema->turmas);
+    int alunos_integros = pool_carregar_tudo(&sistema->alunos);
+    int textos_integros = pool_carregar_tudo(&sistema->textos);
+    if (!turmas_integras || !alunos_integros || !textos_integros) {
+        printf("AVISO: Paginas invalidas no arquivo de dados foram carregadas zeradas.\n");
+    }
+    if (!preparar_indices(sistema)) return 1;
+
+    // Cada trabalhador atende uma conexão por vez: o padrão folga além dos núcleos
+    // para que clientes ociosos não deixem os demais esperando na fila.
+    if (trabalhadores <= 0) {
+        trabalhadores = 2 * (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (trabalhadores < TRABALHADORES_MINIMO) trabalhadores = TRABALHADORES_MINIMO;
+    }
+    if (trabalhadores > MAX_TRABALHADORES) trabalhadores = MAX_TRABALHADORES;
+
+    int escuta = abrir_escuta(caminho);
+    if (escuta < 0) return 1;
+
+    Servidor servidor;
+    memset(&servidor, 0, sizeof(servidor));
+    servidor.sistema = sistema;
+    versoes_inicializar(&servidor.versoes, sistema);
+    pthread_rwlockattr_t atributos;
+    pthread_rwlockattr_init(&atributos);
+#if defined(__GLIBC__)
+    // Sem preferência pelo escritor, um fluxo contínuo de consultas adiaria as alterações indefinidamente
+    pthread_rwlockattr_setkind_np(&atributos, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&servidor.dados, &atributos);
+    pthread_rwlockattr_destroy(&atributos);
+    pthread_mutex_init(&servidor.trava_fila, NULL);
+    pthread_cond_init(&servidor.fila_sinal, NULL);
+    for (int i = 0; i < MAX_TRABALHADORES; i++) servidor.conexoes[i] = -1;
+
+    // SIGINT/SIGTERM interrompem o accept da thread principal (sem SA_RESTART);
+    // os trabalhadores nascem com esses sinais bloqueados. SIGPIPE é ignorado:
+    // um cliente que fecha no meio da resposta só encerra a própria conexão.
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratar_sinal;
+    sigemptyset(&acao.sa_mask);
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    sigset_t bloqueados, anteriores;
+    sigemptyset(&bloqueados);
+    sigaddset(&bloqueados, SIGINT);
+    sigaddset(&bloqueados, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &bloqueados, &anteriores);
+    Trabalhador grupo[MAX_TRABALHADORES];
+    int iniciados = 0;
+    for (; iniciados < trabalhadores; iniciados++) {
+        grupo[iniciados].servidor = &servidor;
+        grupo[iniciados].indice = iniciados;
+        if (pthread_create(&grupo[iniciados].thread, NULL, executar_trabalhador, &grupo[iniciados]) != 0) break;
+    }
+    pthread_sigmask(SIG_SETMASK, &anteriores, NULL);
+
+    if (iniciados == 0) {
+        printf("ERRO: Nao foi possivel iniciar as threads do servidor.\n");
+        sinal_encerrar = 1;
+    } else {
+        printf("SUCESSO: Servidor atendendo em '%s' com %d trabalhadores (Ctrl+C encerra).\n", caminho, iniciados);
+        fflush(stdout);
+    }
+
+    while (!sinal_encerrar) {
+        int cliente = accept(escuta, NULL, NULL);
+        if (cliente < 0) {
+            if (errno != EINTR) printf("AVISO: Falha ao aceitar conexao (%s).\n", strerror(errno));
+            continue;
+        }
+        if (!enfileirar_conexao(&servidor, cliente)) {
+            static const char ocupado[] = "ERRO Servidor ocupado, tente novamente.\n";
+            if (write(cliente, ocupado, sizeof(ocupado) - 1) < 0) {
+                // O cliente já foi embora: nada a fazer
+            }
+            close(cliente);
+        }
+    }
+
+    // Encerramento: derruba as conexões em atendimento e espera os trabalhadores
+    pthread_mutex_lock(&servidor.trava_fila);
+    servidor.encerrando = 1;
+    for (int i = 0; i < iniciados; i++) {
+        if (servidor.conexoes[i] != -1) shutdown(servidor.conexoes[i], SHUT_RDWR);
+    }
+    pthread_cond_broadcast(&servidor.fila_sinal);
+    pthread_mutex_unlock(&servidor.trava_fila);
+    for (int i = 0; i < iniciados; i++) pthread_join(grupo[i].thread, NULL);
+    for (int i = 0; i < servidor.fila_quantidade; i++) {
+        close(servidor.fila[(servidor.fila_inicio + i) % TAM_FILA_CONEXOES]);
+    }
+
+    close(escuta);
+    unlink(caminho);
+    pthread_cond_destroy(&servidor.fila_sinal);
+    pthread_mutex_destroy(&servidor.trava_fila);
+    pthread_rwlock_destroy(&servidor.dados);
+    versoes_liberar(&servidor.versoes); // Nenhuma foto aberta: os trabalhadores já terminaram
+
+    printf("SUCESSO: Servidor encerrado.\n");
+    return iniciados == 0;
+}
+
+#else // _WIN32: sem sockets Unix, o sistema roda só no modo interativo
+
+int executar_servidor(DadosSistema *sistema, const char *caminho, int trabalhadores) {
+    (void)sistema;
+    (void)caminho;
+    (void)trabalhadores;
+    printf("ERRO: O modo servidor nao esta disponivel nesta plataforma.\n");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include "servicos.h"
+
+// --- Modo Servidor (Socket Unix) ---
+//
+// Um único processo é dono de DadosSistema e atende vários clientes por um
+// socket Unix local, com um grupo fixo de threads trabalhadoras (uma conexão
+// por trabalhador de cada vez). Consultas rodam em paralelo sob trava de
+// leitura; alterações são serializadas sob trava de escrita e confirmadas
+// (salvar_dados) antes da resposta. Relatórios (TURMAS, RELATORIO,
+// ESTATISTICAS) rodam sobre uma foto dos dados (versoes.h) e só seguram a
+// trava de leitura para abri-la: um relatório longo não atrasa as alterações.
+//
+// Protocolo: o de protocolo.h, com LOGIN obrigatório antes dos demais comandos.
+
+#define CAMINHO_SOCKET_PADRAO "sistema.sock"
+#define MAX_TRABALHADORES 64
+#define TRABALHADORES_MINIMO 8 // Padrão mínimo de threads (cada uma atende uma conexão por vez)
+#define TAM_LINHA_PEDIDO 512   // Pedidos maiores são recusados
+#define TAM_FILA_CONEXOES 128  // Conexões aceitas aguardando um trabalhador livre
+
+int executar_servidor(DadosSistema *sistema, const char *caminho, int trabalhadores);
+
+#endif // SERVIDOR_H
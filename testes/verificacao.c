@@ -0,0 +1,513 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include "servicos.h"
+#include "arquivos.h"
+#include "diario.h"
+#include "fragmentos.h"
+#ifdef _WIN32
+#include <direct.h>
+#define chdir _chdir
+#define criar_diretorio(caminho) _mkdir(caminho)
+#define remover_diretorio(caminho) _rmdir(caminho)
+#define DISPOSITIVO_NULO "NUL"
+#else
+#include <unistd.h>
+#include <sys/stat.h>
+#define criar_diretorio(caminho) mkdir(caminho, 0755)
+#define remover_diretorio(caminho) rmdir(caminho)
+#define DISPOSITIVO_NULO "/dev/null"
+#endif
+
+// --- Verificação da Recuperação e da Busca (make check) ---
+//
+// Cada caso roda num diretório vazio dentro de DIRETORIO_VERIFICACAO, grava
+// dados pelas funções de servicos.h, mexe nos arquivos como uma queda
+// deixaria e confere, pelo estado recarregado, o que a recuperação fez:
+//   - diário: cauda cortada ou corrompida descarta só a última confirmação;
+//     com group commit, o fsync vem a cada N confirmações;
+//   - transação: desfazer volta ao estado do início, em memória e no disco;
+//   - fragmentos: uma transação de segmentos confirmada e não aplicada é
+//     concluída na próxima carga; uma gravação lê só os segmentos que regrava
+//     e uma transação desfeita volta a ler do disco os que leu.
+// E a busca aproximada por nome acha erros de digitação comuns (letras
+// trocadas de lugar, letra faltando).
+// As mensagens do sistema vão para o dispositivo nulo; o resultado, para stderr.
+
+#define DIRETORIO_VERIFICACAO "verificacao_dados"
+#define TAM_LINHA 256
+
+static int falhas = 0;
+
+#define VERIFICAR(condicao) \
+    do { \
+        if (!(condicao)) { \
+            fprintf(stderr, "  FALHA %s:%d: %s\n", __FILE__, __LINE__, #condicao); \
+            falhas++; \
+        } \
+    } while (0)
+
+// --- 1. Estado Comparável ---
+
+// Turmas e alunos ativos em linhas de texto ordenadas: a ordem dos slots não conta
+typedef struct {
+    char (*linhas)[TAM_LINHA];
+    int quantidade;
+} Estado;
+
+static int comparar_linhas(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+/**
+ * @brief Fotografa as turmas e os alunos ativos (lê os segmentos que faltam).
+ */
+static Estado fotografar(const DadosSistema *sistema) {
+    Estado estado = { NULL, 0 };
+    if (!preparar_indices(sistema)) return estado;
+    estado.linhas = malloc((size_t)(sistema->turmas.usados + sistema->alunos.usados + 1) * TAM_LINHA);
+    if (estado.linhas == NULL) return estado;
+
+    for (int i = 0; i < sistema->turmas.usados; i++) {
+        const Turma *turma = turma_em(sistema, i);
+        if (turma->ativo != 1) continue;
+        snprintf(estado.linhas[estado.quantidade++], TAM_LINHA, "T %d %s %d %d", turma->id,
+                 texto_em(sistema, turma->nome), turma->vagas_maximas, turma->vagas_ocupadas);
+    }
+    for (int i = 0; i < sistema->alunos.usados; i++) {
+        const Aluno *aluno = aluno_em(sistema, i);
+        if (aluno->ativo != 1) continue;
+        snprintf(estado.linhas[estado.quantidade++], TAM_LINHA, "A %s %s %d %.2f %.2f %.2f %.2f", aluno->ra,
+                 texto_em(sistema, aluno->nome), aluno->id_turma, aluno->notas[0], aluno->notas[1],
+                 aluno->notas[2], aluno->media_final);
+    }
+    qsort(estado.linhas, (size_t)estado.quantidade, TAM_LINHA, comparar_linhas);
+    return estado;
+}
+
+static int estados_iguais(const Estado *a, const Estado *b) {
+    if (a->linhas == NULL || b->linhas == NULL || a->quantidade != b->quantidade) return 0;
+    for (int i = 0; i < a->quantidade; i++) {
+        if (strcmp(a->linhas[i], b->linhas[i]) != 0) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Recarrega os dados do disco e compara com o estado esperado.
+ */
+static int recarregado_igual(const Estado *esperado) {
+    DadosSistema sistema;
+    carregar_dados(&sistema);
+    Estado estado = fotografar(&sistema);
+    int iguais = estados_iguais(&estado, esperado);
+    free(estado.linhas);
+    liberar_dados(&sistema);
+    return iguais;
+}
+
+// --- 2. Arquivos ---
+
+static long tamanho_arquivo(const char *caminho) {
+    FILE *f = fopen(caminho, "rb");
+    if (f == NULL) return -1;
+    long tamanho = arquivo_tamanho(f);
+    fclose(f);
+    return tamanho;
+}
+
+/**
+ * @brief Lê o arquivo inteiro (para restaurá-lo depois de corrompê-lo).
+ */
+static char *ler_arquivo(const char *caminho, long *tamanho) {
+    *tamanho = tamanho_arquivo(caminho);
+    FILE *f = fopen(caminho, "rb");
+    char *dados = *tamanho > 0 ? malloc((size_t)*tamanho) : NULL;
+    if (f == NULL || dados == NULL || fread(dados, 1, (size_t)*tamanho, f) != (size_t)*tamanho) {
+        free(dados);
+        dados = NULL;
+    }
+    if (f != NULL) fclose(f);
+    return dados;
+}
+
+static int escrever_arquivo(const char *caminho, const char *dados, long tamanho) {
+    FILE *f = fopen(caminho, "wb");
+    if (f == NULL) return 0;
+    int ok = fwrite(dados, 1, (size_t)tamanho, f) == (size_t)tamanho;
+    return (fclose(f) == 0) && ok;
+}
+
+/**
+ * @brief Entra num diretório vazio só do caso (apaga o que sobrou de uma execução anterior).
+ */
+static int entrar_caso(const char *nome) {
+    if (chdir(DIRETORIO_VERIFICACAO) != 0) return 0;
+    criar_diretorio(nome);
+    if (chdir(nome) != 0) return 0;
+    DIR *diretorio = opendir(".");
+    if (diretorio == NULL) return 0;
+    for (struct dirent *entrada = readdir(diretorio); entrada != NULL; entrada = readdir(diretorio)) {
+        if (entrada->d_name[0] != '.') remove(entrada->d_name);
+    }
+    closedir(diretorio);
+    return 1;
+}
+
+static void sair_caso(void) {
+    if (chdir("../..") != 0) falhas++;
+}
+
+// --- 3. Operações ---
+
+/**
+ * @brief Cadastra 'turmas' turmas com 'por_turma' alunos cada e lança notas.
+ * Os RAs começam em 'primeiro_ra', para lotes diferentes não colidirem.
+ */
+static void popular(DadosSistema *sistema, int turmas, int por_turma, int primeiro_ra) {
+    char nome[64], ra[TAM_RA];
+    for (int t = 0; t < turmas; t++) {
+        snprintf(nome, sizeof(nome), "Turma %d", primeiro_ra + t);
+        if (!adicionar_turma(sistema, nome, por_turma + 5)) continue;
+        int id_turma = sistema->proximo_id_turma - 1;
+        for (int k = 0; k < por_turma; k++) {
+            int numero = primeiro_ra + t * por_turma + k;
+            snprintf(ra, sizeof(ra), "%d", numero);
+            snprintf(nome, sizeof(nome), "Aluno %d Silva", numero);
+            adicionar_aluno(sistema, nome, ra, id_turma);
+            lancar_notas_e_atualizar_media(sistema, ra, (float)(numero % 11), (float)((numero * 7) % 11),
+                                           (float)((numero * 3) % 11), NIVEL_ADMIN);
+        }
+    }
+}
+
+/**
+ * @brief Altera registros existentes: notas, nome, transferência e exclusões.
+ */
+static void alterar(DadosSistema *sistema, int primeiro_ra) {
+    char ra[TAM_RA];
+    snprintf(ra, sizeof(ra), "%d", primeiro_ra);
+    lancar_notas_e_atualizar_media(sistema, ra, 10.0f, 9.5f, 9.0f, NIVEL_ADMIN);
+    snprintf(ra, sizeof(ra), "%d", primeiro_ra + 1);
+    editar_dados_aluno(sistema, ra, "Nome Trocado Souza", 0);
+    snprintf(ra, sizeof(ra), "%d", primeiro_ra + 2);
+    editar_dados_aluno(sistema, ra, "", turma_em(sistema, 1)->id); // Transferência
+    snprintf(ra, sizeof(ra), "%d", primeiro_ra + 3);
+    excluir_aluno_por_ra(sistema, ra);
+}
+
+// --- 4. Casos ---
+
+/**
+ * @brief Diário: a recarga reaplica todas as confirmações; com a última
+ * cortada ou com um byte trocado, só ela é descartada.
+ */
+static void caso_diario(void) {
+    if (!entrar_caso("diario")) {
+        falhas++;
+        return;
+    }
+    DadosSistema sistema;
+    carregar_dados(&sistema);
+    popular(&sistema, 3, 10, 1000);
+    salvar_dados(&sistema); // Primeiro arquivo base
+
+    popular(&sistema, 1, 5, 2000);
+    salvar_dados(&sistema);
+    long antes = tamanho_arquivo(NOME_DIARIO);
+    Estado anterior = fotografar(&sistema);
+
+    alterar(&sistema, 1000);
+    popular(&sistema, 1, 5, 3000);
+    salvar_dados(&sistema);
+    long depois = tamanho_arquivo(NOME_DIARIO);
+    Estado final = fotografar(&sistema);
+    liberar_dados(&sistema);
+
+    VERIFICAR(antes > 0 && depois > antes); // As duas gravações foram para o diário
+    VERIFICAR(!estados_iguais(&anterior, &final));
+    VERIFICAR(recarregado_igual(&final));
+
+    long tamanho;
+    char *copia = ler_arquivo(NOME_DIARIO, &tamanho);
+    VERIFICAR(copia != NULL && tamanho == depois);
+
+    // Um byte trocado no meio da última confirmação: o CRC a descarta
+    if (copia != NULL) {
+        copia[(antes + depois) / 2] ^= 0x5A;
+        VERIFICAR(escrever_arquivo(NOME_DIARIO, copia, tamanho));
+        copia[(antes + depois) / 2] ^= 0x5A;
+        VERIFICAR(recarregado_igual(&anterior));
+        VERIFICAR(tamanho_arquivo(NOME_DIARIO) == antes);
+    }
+
+    // A última confirmação cortada no meio (queda durante a escrita)
+    if (copia != NULL) {
+        VERIFICAR(escrever_arquivo(NOME_DIARIO, copia, tamanho));
+        VERIFICAR(arquivo_truncar(NOME_DIARIO, depois - 1));
+        VERIFICAR(recarregado_igual(&anterior));
+        VERIFICAR(tamanho_arquivo(NOME_DIARIO) == antes);
+    }
+
+    free(copia);
+    free(anterior.linhas);
+    free(final.linhas);
+    sair_caso();
+}
+
+/**
+ * @brief Group commit: com N confirmações por fsync, as confirmações ficam
+ * pendentes até a N-ésima (ou até diario_sincronizar) e a recarga vê todas.
+ */
+static void caso_group_commit(void) {
+    if (!entrar_caso("group_commit")) {
+        falhas++;
+        return;
+    }
+    DadosSistema sistema;
+    carregar_dados(&sistema);
+    diario_definir_group_commit(&sistema.diario, 3);
+    popular(&sistema, 2, 5, 1000);
+    salvar_dados(&sistema);
+    VERIFICAR(sistema.diario.confirmacoes_pendentes == 1);
+    VERIFICAR(diario_sincronizar(&sistema.diario) && sistema.diario.confirmacoes_pendentes == 0);
+
+    alterar(&sistema, 1000);
+    salvar_dados(&sistema);
+    popular(&sistema, 1, 2, 2000);
+    salvar_dados(&sistema);
+    VERIFICAR(sistema.diario.confirmacoes_pendentes == 2);
+    alterar(&sistema, 1005);
+    salvar_dados(&sistema);
+    VERIFICAR(sistema.diario.confirmacoes_pendentes == 0); // A terceira faz o fsync
+
+    popular(&sistema, 1, 2, 3000);
+    salvar_dados(&sistema);
+    VERIFICAR(sistema.diario.confirmacoes_pendentes == 1);
+    VERIFICAR(diario_sincronizar(&sistema.diario) && sistema.diario.confirmacoes_pendentes == 0);
+    Estado final = fotografar(&sistema);
+    liberar_dados(&sistema);
+    VERIFICAR(recarregado_igual(&final));
+
+    free(final.linhas);
+    sair_caso();
+}
+
+/**
+ * @brief Transação: desfeita, volta ao estado do início (em memória e no
+ * disco); confirmada, sobrevive à recarga.
+ */
+static void caso_transacao(void) {
+    if (!entrar_caso("transacao")) {
+        falhas++;
+        return;
+    }
+    DadosSistema sistema;
+    carregar_dados(&sistema);
+    popular(&sistema, 3, 10, 1000);
+    salvar_dados(&sistema);
+    popular(&sistema, 1, 3, 2000); // Alterações pendentes antes da transação
+    Estado inicio = fotografar(&sistema);
+
+    VERIFICAR(iniciar_transacao(&sistema));
+    popular(&sistema, 2, 4, 3000);
+    alterar(&sistema, 1000);
+    salvar_dados(&sistema); // Nada é gravado com a transação aberta
+    excluir_turma_por_id(&sistema, turma_em(&sistema, 0)->id);
+    VERIFICAR(desfazer_transacao(&sistema));
+
+    Estado desfeito = fotografar(&sistema);
+    VERIFICAR(estados_iguais(&desfeito, &inicio));
+    salvar_dados(&sistema);
+    VERIFICAR(recarregado_igual(&inicio));
+
+    VERIFICAR(iniciar_transacao(&sistema));
+    popular(&sistema, 1, 4, 4000);
+    alterar(&sistema, 1010);
+    VERIFICAR(confirmar_transacao(&sistema));
+    Estado confirmado = fotografar(&sistema);
+    VERIFICAR(!estados_iguais(&confirmado, &inicio));
+    VERIFICAR(recarregado_igual(&confirmado));
+    liberar_dados(&sistema);
+
+    free(inicio.linhas);
+    free(desfeito.linhas);
+    free(confirmado.linhas);
+    sair_caso();
+}
+
+/**
+ * @brief Fragmentos: a troca dos arquivos falha depois da transação
+ * confirmada (o segmento de destino é um diretório), como numa queda; a
+ * próxima carga conclui a troca e chega ao estado gravado.
+ */
+static void caso_fragmentos(void) {
+    if (!entrar_caso("fragmentos")) {
+        falhas++;
+        return;
+    }
+    DadosSistema sistema;
+    carregar_dados(&sistema);
+    popular(&sistema, 3, 10, 1000);
+    salvar_dados(&sistema);
+    VERIFICAR(ativar_modo_fragmentado(&sistema));
+
+    // A primeira turma recebe notas novas; o segmento dela fica bloqueado por um diretório
+    char segmento[64], guardado[80];
+    snprintf(segmento, sizeof(segmento), "%s%d.seg", PREFIXO_SEGMENTO, turma_em(&sistema, 0)->id);
+    snprintf(guardado, sizeof(guardado), "%s.antigo", segmento);
+    VERIFICAR(rename(segmento, guardado) == 0);
+    VERIFICAR(criar_diretorio(segmento) == 0);
+
+    lancar_notas_e_atualizar_media(&sistema, "1000", 1.0f, 2.0f, 3.0f, NIVEL_ADMIN);
+    salvar_dados(&sistema);
+    Estado gravado = fotografar(&sistema);
+    liberar_dados(&sistema);
+    VERIFICAR(tamanho_arquivo(NOME_TRANSACAO) > 0); // Confirmada, troca pendente
+
+    // O disco como uma queda no meio da troca deixaria: segmento antigo, catálogo novo
+    VERIFICAR(remover_diretorio(segmento) == 0);
+    VERIFICAR(rename(guardado, segmento) == 0);
+
+    VERIFICAR(recarregado_igual(&gravado));
+    VERIFICAR(tamanho_arquivo(NOME_TRANSACAO) == -1);
+    VERIFICAR(recarregado_igual(&gravado)); // E continua valendo sem a transação
+
+    free(gravado.linhas);
+    sair_caso();
+}
+
+static int segmentos_lidos(const DadosSistema *sistema) {
+    int lidos = 0;
+    for (int i = 0; i < sistema->turmas.usados && i < sistema->fragmentos.capacidade; i++) {
+        if (turma_em(sistema, i)->ativo == 1 && sistema->fragmentos.inicio[i] != -1) lidos++;
+    }
+    return lidos;
+}
+
+/**
+ * @brief Fragmentos lidos sob demanda: gravar uma turma nova não lê os
+ * segmentos das outras; uma transação desfeita esquece os segmentos lidos
+ * durante ela, que voltam a ser lidos do disco com o estado do início.
+ */
+static void caso_fragmentos_sob_demanda(void) {
+    if (!entrar_caso("sob_demanda")) {
+        falhas++;
+        return;
+    }
+    DadosSistema sistema;
+    carregar_dados(&sistema);
+    popular(&sistema, 4, 6, 1000);
+    salvar_dados(&sistema);
+    VERIFICAR(ativar_modo_fragmentado(&sistema));
+    liberar_dados(&sistema);
+
+    carregar_dados(&sistema);
+    VERIFICAR(sistema.fragmentos.parcial && segmentos_lidos(&sistema) == 0);
+    VERIFICAR(adicionar_turma(&sistema, "Turma Nova", 10));
+    salvar_dados(&sistema);
+    VERIFICAR(segmentos_lidos(&sistema) == 0);
+    Estado inicio = fotografar(&sistema);
+    liberar_dados(&sistema);
+    VERIFICAR(recarregado_igual(&inicio));
+
+    carregar_dados(&sistema);
+    ResumoTurma resumo;
+    VERIFICAR(iniciar_transacao(&sistema));
+    VERIFICAR(segmentos_lidos(&sistema) == 0);
+    VERIFICAR(resumir_turma(&sistema, turma_em(&sistema, 0)->id, &resumo) && resumo.alunos == 6);
+    alterar(&sistema, 1000); // Lê os segmentos que faltam
+    VERIFICAR(segmentos_lidos(&sistema) > 1);
+    VERIFICAR(desfazer_transacao(&sistema));
+    VERIFICAR(sistema.fragmentos.parcial && segmentos_lidos(&sistema) == 0);
+
+    VERIFICAR(resumir_turma(&sistema, turma_em(&sistema, 0)->id, &resumo) && resumo.alunos == 6);
+    Estado desfeito = fotografar(&sistema);
+    VERIFICAR(estados_iguais(&desfeito, &inicio));
+    salvar_dados(&sistema);
+    liberar_dados(&sistema);
+    VERIFICAR(recarregado_igual(&inicio));
+
+    free(inicio.linhas);
+    free(desfeito.linhas);
+    sair_caso();
+}
+
+/**
+ * @brief Busca aproximada: letras transpostas ou faltando ainda acham o nome,
+ * o nome exato vem antes dos que só o contêm, e um nome distante não aparece.
+ */
+static void caso_busca_aproximada(void) {
+    if (!entrar_caso("busca")) {
+        falhas++;
+        return;
+    }
+    DadosSistema sistema;
+    carregar_dados(&sistema);
+    VERIFICAR(adicionar_turma(&sistema, "Turma Busca", 10));
+    int id_turma = sistema.proximo_id_turma - 1;
+    VERIFICAR(adicionar_aluno(&sistema, "Maria", "101", id_turma));
+    VERIFICAR(adicionar_aluno(&sistema, "Maria Silva", "102", id_turma));
+    VERIFICAR(adicionar_aluno(&sistema, "Carla Souza Lima", "103", id_turma));
+    VERIFICAR(adicionar_aluno(&sistema, "Pedro Rocha", "104", id_turma));
+
+    static const struct {
+        const char *consulta;
+        const char *primeiro; // Nome do primeiro resultado (NULL = nenhum resultado)
+    } buscas[] = {
+        {"Mraia", "Maria"},          // Letras vizinhas transpostas
+        {"Maira", "Maria"},
+        {"Crla", "Carla Souza Lima"}, // Letra faltando
+        {"Carla Lmia", "Carla Souza Lima"},
+        {"Maria", "Maria"},
+        {"Xavier", NULL},
+    };
+    ResultadoNome resultados[MAX_RESULTADOS_BUSCA];
+    for (size_t i = 0; i < sizeof(buscas) / sizeof(buscas[0]); i++) {
+        int n = buscar_nomes(&sistema, buscas[i].consulta, 1, resultados, MAX_RESULTADOS_BUSCA);
+        if (buscas[i].primeiro == NULL) {
+            VERIFICAR(n == 0);
+        } else {
+            VERIFICAR(n > 0 && resultados[0].tipo == RESULTADO_ALUNO &&
+                      strcmp(texto_em(&sistema, aluno_em(&sistema, resultados[0].slot)->nome), buscas[i].primeiro) == 0);
+        }
+    }
+    VERIFICAR(buscar_nomes(&sistema, "Mraia", 1, resultados, MAX_RESULTADOS_BUSCA) == 2); // "Maria" e "Maria Silva"
+    liberar_dados(&sistema);
+    sair_caso();
+}
+
+// --- 5. Função Principal ---
+
+int main(void) {
+    static const struct {
+        const char *nome;
+        void (*executar)(void);
+    } casos[] = {
+        {"diario (cauda cortada e CRC)", caso_diario},
+        {"diario (group commit)", caso_group_commit},
+        {"transacao (desfazer e confirmar)", caso_transacao},
+        {"fragmentos (transacao pendente)", caso_fragmentos},
+        {"fragmentos (leitura sob demanda)", caso_fragmentos_sob_demanda},
+        {"busca aproximada (letras trocadas)", caso_busca_aproximada},
+    };
+
+    criar_diretorio(DIRETORIO_VERIFICACAO); // Pode já existir
+    fflush(stdout);
+    if (freopen(DISPOSITIVO_NULO, "w", stdout) == NULL) {
+        fprintf(stderr, "AVISO: As mensagens do sistema serao misturadas aos resultados.\n");
+    }
+    definir_modo_silencioso(1);
+
+    int falharam = 0;
+    for (size_t i = 0; i < sizeof(casos) / sizeof(casos[0]); i++) {
+        int antes = falhas;
+        casos[i].executar();
+        fprintf(stderr, "%s %s\n", falhas == antes ? "OK   " : "FALHA", casos[i].nome);
+        if (falhas != antes) falharam++;
+    }
+    fprintf(stderr, "%d de %d casos passaram.\n", (int)(sizeof(casos) / sizeof(casos[0])) - falharam,
+            (int)(sizeof(casos) / sizeof(casos[0])));
+    return falharam == 0 ? 0 : 1;
+}
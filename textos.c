@@ -0,0 +1,231 @@
+#include <stdlib.h>
+#include <string.h>
+#include "textos.h"
+
+#define REF_VAZIA 0
+#define CAPACIDADE_INICIAL_TEXTOS 64
+
+// --- 1. Índice de Internação ---
+
+/**
+ * @brief Hash FNV-1a do texto.
+ * @param texto Texto terminado em '\0'.
+ * @return unsigned O valor de hash.
+ */
+static unsigned hash_texto(const char *texto) {
+    unsigned h = 2166136261u;
+    for (; *texto != '\0'; texto++) {
+        h ^= (unsigned char)*texto;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Número de células ocupadas por um texto de 'tamanho' caracteres (com o '\0').
+ */
+static int celulas_do_texto(size_t tamanho) {
+    return (int)((tamanho + TAM_CELULA_TEXTO) / TAM_CELULA_TEXTO);
+}
+
+/**
+ * @brief Inicializa um índice vazio (sem alocação).
+ * @param indice Ponteiro para o índice.
+ */
+void indice_textos_inicializar(IndiceTextos *indice) {
+    indice->refs = NULL;
+    indice->hashes = NULL;
+    indice->capacidade = 0;
+    indice->ocupados = 0;
+    indice->pronto = 0;
+}
+
+/**
+ * @brief Libera a memória do índice (volta a ser montado no próximo uso).
+ * @param indice Ponteiro para o índice.
+ */
+void indice_textos_liberar(IndiceTextos *indice) {
+    free(indice->refs);
+    free(indice->hashes);
+    indice_textos_inicializar(indice);
+}
+
+/**
+ * @brief Coloca uma entrada na tabela sem verificar duplicidade nem carga.
+ */
+static void colocar_texto(IndiceTextos *indice, int ref, unsigned h) {
+    unsigned mascara = (unsigned)indice->capacidade - 1;
+    unsigned pos = h & mascara;
+    while (indice->refs[pos] != REF_VAZIA) {
+        pos = (pos + 1) & mascara;
+    }
+    indice->refs[pos] = ref;
+    indice->hashes[pos] = h;
+    indice->ocupados++;
+}
+
+/**
+ * @brief Realoca a tabela com a nova capacidade e reinsere as entradas.
+ * @return int 1 se bem-sucedido, 0 se faltou memória (a tabela antiga é mantida).
+ */
+static int redimensionar_textos(IndiceTextos *indice, int nova_capacidade) {
+    int *refs = calloc((size_t)nova_capacidade, sizeof(int));
+    unsigned *hashes = malloc((size_t)nova_capacidade * sizeof(unsigned));
+    if (refs == NULL || hashes == NULL) {
+        free(refs);
+        free(hashes);
+        return 0;
+    }
+
+    IndiceTextos antigo = *indice;
+    indice->refs = refs;
+    indice->hashes = hashes;
+    indice->capacidade = nova_capacidade;
+    indice->ocupados = 0;
+
+    for (int i = 0; i < antigo.capacidade; i++) {
+        if (antigo.refs[i] != REF_VAZIA) colocar_texto(indice, antigo.refs[i], antigo.hashes[i]);
+    }
+    free(antigo.refs);
+    free(antigo.hashes);
+    return 1;
+}
+
+/**
+ * @brief Procura no índice o texto informado.
+ * @return int Referência do texto no heap, ou REF_VAZIA se ele não está indexado.
+ */
+static int procurar_texto(const PoolRegistros *heap, const IndiceTextos *indice, const char *texto, unsigned h) {
+    if (indice->capacidade == 0) return REF_VAZIA;
+    unsigned mascara = (unsigned)indice->capacidade - 1;
+    for (unsigned pos = h & mascara; indice->refs[pos] != REF_VAZIA; pos = (pos + 1) & mascara) {
+        if (indice->hashes[pos] == h && strcmp(texto_no_heap(heap, indice->refs[pos]), texto) == 0) {
+            return indice->refs[pos];
+        }
+    }
+    return REF_VAZIA;
+}
+
+/**
+ * @brief Indexa um texto já gravado no heap, dobrando a tabela quando a carga passa de 50%.
+ * @return int 1 se indexado, 0 se faltou memória.
+ */
+static int indexar_texto(IndiceTextos *indice, int ref, unsigned h) {
+    if ((long)(indice->ocupados + 1) * 2 > (long)indice->capacidade) {
+        int nova = indice->capacidade > 0 ? indice->capacidade * 2 : CAPACIDADE_INICIAL_TEXTOS;
+        if (!redimensionar_textos(indice, nova)) return 0;
+    }
+    colocar_texto(indice, ref, h);
+    return 1;
+}
+
+/**
+ * @brief Monta o índice percorrendo o heap inteiro (O(células)).
+ * Os textos repetidos que possam existir (gravados sem o índice) ficam com a primeira cópia.
+ * @param heap Heap de textos.
+ * @param indice Ponteiro para o índice.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int indice_textos_reconstruir(const PoolRegistros *heap, IndiceTextos *indice) {
+    indice_textos_liberar(indice);
+    if (!redimensionar_textos(indice, CAPACIDADE_INICIAL_TEXTOS)) return 0;
+
+    for (int ref = textos_primeiro(heap); ref != -1; ref = textos_proximo(heap, ref)) {
+        const char *texto = texto_no_heap(heap, ref);
+        unsigned h = hash_texto(texto);
+        if (procurar_texto(heap, indice, texto, h) == REF_VAZIA && !indexar_texto(indice, ref, h)) {
+            indice_textos_liberar(indice);
+            return 0;
+        }
+    }
+    indice->pronto = 1;
+    return 1;
+}
+
+// --- 2. Percurso do Heap ---
+
+/**
+ * @brief Primeiro texto válido a partir da célula 'ref' (inclusive).
+ * Células que começam com '\0' são as de sobra no fim de um bloco; um texto
+ * sem terminador dentro do bloco (heap vindo de um arquivo danificado) é pulado
+ * até o fim do bloco.
+ * @return int A referência, ou -1 se não há mais textos.
+ */
+static int texto_a_partir_de(const PoolRegistros *heap, int ref) {
+    while (ref > 0 && ref < heap->usados) {
+        const char *texto = texto_no_heap(heap, ref);
+        int resto = REGISTROS_POR_BLOCO - (ref & MASCARA_BLOCO);
+        if (texto[0] == '\0') {
+            ref++;
+        } else if (strnlen(texto, (size_t)resto * TAM_CELULA_TEXTO) < (size_t)resto * TAM_CELULA_TEXTO) {
+            return ref;
+        } else {
+            ref += resto;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Primeiro texto do heap, para percorrer todos em ordem de referência:
+ * for (ref = textos_primeiro(heap); ref != -1; ref = textos_proximo(heap, ref)).
+ * @param heap Heap de textos.
+ * @return int A referência, ou -1 se o heap não tem textos.
+ */
+int textos_primeiro(const PoolRegistros *heap) {
+    return texto_a_partir_de(heap, 1);
+}
+
+/**
+ * @brief Texto seguinte ao da referência 'ref' (que deve ser um texto válido).
+ * @param heap Heap de textos.
+ * @param ref Referência do texto atual.
+ * @return int A referência, ou -1 se 'ref' é o último texto.
+ */
+int textos_proximo(const PoolRegistros *heap, int ref) {
+    return texto_a_partir_de(heap, ref + celulas_do_texto(strlen(texto_no_heap(heap, ref))));
+}
+
+// --- 3. Gravação ---
+
+/**
+ * @brief Guarda um texto no heap, reaproveitando a cópia que já estiver lá (internação).
+ * Um texto novo vai para o fim do heap; se não couber no resto do bloco atual,
+ * começa no bloco seguinte. Sem memória para o índice, o texto é gravado sem
+ * procurar cópia (o resultado continua correto, só ocupa mais espaço).
+ * @param heap Heap de textos.
+ * @param indice Índice de internação do heap (montado aqui se preciso).
+ * @param texto Texto a guardar.
+ * @param celulas_novas Recebe quantas células foram gravadas a partir da referência
+ * retornada (0 se o texto já existia). Pode ser NULL.
+ * @return int Referência do texto, ou -1 se ele passa de TAM_MAX_TEXTO ou faltou memória.
+ */
+int textos_guardar(PoolRegistros *heap, IndiceTextos *indice, const char *texto, int *celulas_novas) {
+    if (celulas_novas != NULL) *celulas_novas = 0;
+    if (texto[0] == '\0') return REF_VAZIA;
+    size_t tamanho = strlen(texto);
+    if (tamanho > TAM_MAX_TEXTO) return -1;
+
+    if (!indice->pronto) indice_textos_reconstruir(heap, indice);
+    unsigned h = hash_texto(texto);
+    if (indice->pronto) {
+        int existente = procurar_texto(heap, indice, texto, h);
+        if (existente != REF_VAZIA) return existente;
+    }
+
+    int celulas = celulas_do_texto(tamanho);
+    int ref = heap->usados > 0 ? heap->usados : 1; // Célula 0 reservada para o texto vazio
+    if ((ref & MASCARA_BLOCO) + celulas > REGISTROS_POR_BLOCO) {
+        ref = (ref | MASCARA_BLOCO) + 1; // Sobra do bloco fica zerada
+    }
+    if (!pool_estender(heap, ref + celulas)) return -1;
+
+    // As células do texto são consecutivas dentro de um bloco
+    char *destino = pool_slot_escrita(heap, ref);
+    memcpy(destino, texto, tamanho);
+    memset(destino + tamanho, 0, (size_t)celulas * TAM_CELULA_TEXTO - tamanho);
+
+    if (indice->pronto && !indexar_texto(indice, ref, h)) indice_textos_liberar(indice);
+    if (celulas_novas != NULL) *celulas_novas = celulas;
+    return ref;
+}
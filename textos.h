@@ -0,0 +1,54 @@
+#ifndef TEXTOS_H
+#define TEXTOS_H
+
+#include "armazenamento.h"
+
+// --- Heap de Textos (Nomes de Tamanho Variável) ---
+//
+// Os nomes de turmas e alunos não ficam dentro dos registros: cada registro
+// guarda só uma referência (int) para o texto num heap à parte. O heap é um
+// PoolRegistros de células de TAM_CELULA_TEXTO bytes, então é paginado no
+// arquivo base, registrado no diário, mapeado e compartilhado com as fotos
+// exatamente como as tabelas.
+//
+// Um texto ocupa células consecutivas de um mesmo bloco, terminado em '\0' e
+// com o resto da última célula zerado; a referência é o índice da primeira
+// célula. A célula 0 é reservada: a referência 0 é o texto vazio, que é o que
+// todo registro zerado (slot novo ou página perdida) enxerga.
+//
+// Textos iguais são gravados uma única vez (internação): um índice hash em
+// memória, montado no primeiro uso a partir do próprio heap, leva do texto à
+// referência. Textos que nenhum registro usa mais (nome alterado, aluno
+// excluído) continuam no heap até a compactação (compactar_dados).
+
+#define TAM_CELULA_TEXTO 16
+#define TAM_MAX_TEXTO (REGISTROS_POR_BLOCO * TAM_CELULA_TEXTO - 1) // Um texto não atravessa blocos
+
+// Índice hash (endereçamento aberto, sondagem linear) do texto para a referência.
+typedef struct {
+    int *refs;            // Referência do texto em cada posição da tabela (0 = posição vazia)
+    unsigned *hashes;     // Hash do texto guardado junto, evita strcmp na maioria das colisões
+    int capacidade;       // Potência de 2 (0 enquanto a tabela não foi alocada)
+    int ocupados;         // Entradas válidas
+    int pronto;           // 1 depois de montado por indice_textos_reconstruir
+} IndiceTextos;
+
+void indice_textos_inicializar(IndiceTextos *indice);
+void indice_textos_liberar(IndiceTextos *indice);
+int indice_textos_reconstruir(const PoolRegistros *heap, IndiceTextos *indice);
+int textos_guardar(PoolRegistros *heap, IndiceTextos *indice, const char *texto, int *celulas_novas);
+int textos_primeiro(const PoolRegistros *heap);
+int textos_proximo(const PoolRegistros *heap, int ref);
+
+/**
+ * @brief Texto de uma referência (O(1)). Referências fora do heap valem como texto vazio.
+ * @param heap Heap de textos.
+ * @param ref Referência guardada no registro.
+ * @return const char* O texto (válido enquanto o bloco não for trocado, como os registros).
+ */
+static inline const char *texto_no_heap(const PoolRegistros *heap, int ref) {
+    if (ref <= 0 || ref >= heap->usados) return "";
+    return (const char *)pool_slot(heap, ref);
+}
+
+#endif // TEXTOS_H
@@ -0,0 +1,74 @@
+#include <stdlib.h>
+#include <string.h>
+#include "transacao.h"
+
+/**
+ * @brief Inicializa uma transação fechada, sem nenhuma imagem guardada.
+ * @param transacao Ponteiro para a transação.
+ */
+void transacao_inicializar(Transacao *transacao) {
+    memset(transacao, 0, sizeof(*transacao));
+}
+
+static void liberar_imagens(ImagensAnteriores *imagens) {
+    free(imagens->slots);
+    free(imagens->registros);
+    memset(imagens, 0, sizeof(*imagens));
+}
+
+/**
+ * @brief Descarta as imagens guardadas e fecha a transação.
+ * @param transacao Ponteiro para a transação.
+ */
+void transacao_liberar(Transacao *transacao) {
+    liberar_imagens(&transacao->turmas);
+    liberar_imagens(&transacao->alunos);
+    transacao_inicializar(transacao);
+}
+
+/**
+ * @brief Guarda a imagem atual de um registro, antes de ele ser alterado (O(1) amortizado).
+ * Nada é guardado fora de uma transação, para slots que não existiam no início
+ * (somem quando a marca d'água volta) nem quando a última imagem já é do mesmo slot.
+ * Se faltar memória, a transação fica marcada como impossível de desfazer.
+ * @param transacao Ponteiro para a transação.
+ * @param imagens Lista de imagens da tabela.
+ * @param tabela Pool da tabela.
+ * @param usados_inicio Marca d'água da tabela no início da transação.
+ * @param slot Slot que vai ser alterado.
+ */
+void transacao_guardar_imagem(Transacao *transacao, ImagensAnteriores *imagens, const PoolRegistros *tabela,
+                              int usados_inicio, int slot) {
+    if (!transacao->ativa || transacao->sem_memoria || slot >= usados_inicio) return;
+    int n = imagens->quantidade;
+    if (n > 0 && imagens->slots[n - 1] == slot) return;
+
+    if (n == imagens->capacidade) {
+        int nova = imagens->capacidade > 0 ? imagens->capacidade * 2 : 64;
+        int *slots = realloc(imagens->slots, (size_t)nova * sizeof(int));
+        if (slots != NULL) imagens->slots = slots;
+        char *registros = slots != NULL ? realloc(imagens->registros, (size_t)nova * tabela->tam_registro) : NULL;
+        if (registros == NULL) {
+            transacao->sem_memoria = 1;
+            return;
+        }
+        imagens->registros = registros;
+        imagens->capacidade = nova;
+    }
+    imagens->slots[n] = slot;
+    memcpy(imagens->registros + (size_t)n * tabela->tam_registro, pool_slot(tabela, slot), tabela->tam_registro);
+    imagens->quantidade++;
+}
+
+/**
+ * @brief Devolve aos registros as imagens guardadas, da última para a primeira:
+ * cada slot termina com a imagem mais antiga, a do início da transação.
+ * @param imagens Lista de imagens da tabela.
+ * @param tabela Pool da tabela.
+ */
+void transacao_restaurar(const ImagensAnteriores *imagens, PoolRegistros *tabela) {
+    for (int k = imagens->quantidade - 1; k >= 0; k--) {
+        memcpy(pool_slot_escrita(tabela, imagens->slots[k]),
+               imagens->registros + (size_t)k * tabela->tam_registro, tabela->tam_registro);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef TRANSACAO_H
+#define TRANSACAO_H
+
+#include "armazenamento.h"
+
+// --- Transações (Várias Operações, Uma Gravação) ---
+//
+// iniciar_transacao / confirmar_transacao / desfazer_transacao (servicos.h)
+// agrupam uma sequência de operações (cadastrar a turma, matricular os alunos,
+// lançar as notas) numa unidade: ou todas ficam gravadas, ou nenhuma.
+//
+// Enquanto a transação está aberta, salvar_dados não grava nada. A
+// confirmação é um único salvar_dados: uma só confirmação no diário, com um
+// fsync (no modo fragmentado, uma só transação de segmentos), então a
+// recuperação depois de uma queda vê todas as operações ou nenhuma.
+//
+// Para desfazer em memória, sem reler os arquivos, a transação guarda a
+// imagem anterior de cada registro a cada escrita (turma_para_escrita /
+// aluno_para_escrita; escritas seguidas no mesmo registro guardam uma só) e
+// o estado do início: marcas d'água das tabelas e do heap, contadores e o
+// tamanho das listas de registros alterados do diário. Registros novos no
+// final das tabelas não precisam de imagem: a marca d'água volta e eles
+// somem. Os índices, mantidos pelas operações, são descartados e remontados
+// no próximo uso.
+
+typedef struct {
+    int *slots;           // Slot de cada imagem, na ordem em que foram guardadas
+    char *registros;      // Imagens anteriores (tam_registro bytes cada)
+    int quantidade;
+    int capacidade;
+} ImagensAnteriores;
+
+typedef struct {
+    int ativa;            // 1 = transação aberta
+    int sem_memoria;      // Faltou memória para uma imagem: a transação não pode mais ser desfeita
+    ImagensAnteriores turmas;
+    ImagensAnteriores alunos;
+    int usados_turmas;    // Marcas d'água das tabelas e do heap no início
+    int usados_alunos;
+    int usados_textos;
+    int total_turmas;     // Contadores no início
+    int total_alunos;
+    int proximo_id_turma;
+    int marcas_turmas;    // Tamanho das listas do diário (e das turmas marcadas do modo fragmentado) no início
+    int marcas_alunos;
+    int marcas_textos;
+    int marcas_fragmentos;
+} Transacao;
+
+void transacao_inicializar(Transacao *transacao);
+void transacao_liberar(Transacao *transacao);
+void transacao_guardar_imagem(Transacao *transacao, ImagensAnteriores *imagens, const PoolRegistros *tabela,
+                              int usados_inicio, int slot);
+void transacao_restaurar(const ImagensAnteriores *imagens, PoolRegistros *tabela);
+
+#endif // TRANSACAO_H
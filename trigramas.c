@@ -0,0 +1,642 @@
+#include <stdlib.h>
+#include <string.h>
+#include "servicos.h"
+#include "trigramas.h"
+
+#define TAM_NORMALIZADO 1024 // Nomes maiores são indexados só até aqui
+#define MAX_TRIGRAMAS_TEXTO (2 * TAM_NORMALIZADO + 1)
+#define CAPACIDADE_INICIAL_TRIGRAMAS 1024
+#define TAM_PALAVRA_EDICAO 64 // Palavras maiores só casam, na busca aproximada, por igualdade
+#define MAX_PALAVRAS_CONSULTA 8 // Palavras além destas são ignoradas na busca aproximada
+
+// --- 1. Normalização e Extração dos Trigramas ---
+
+// Letras do Latin-1 (U+00C0 a U+00FF; em UTF-8, 0xC3 seguido de 0x80 a 0xBF)
+// sem o acento, indexadas pelos 6 bits baixos do segundo byte. Espaço = separador.
+static const char sem_acento[64] = "aaaaaaaceeeeiiiidnooooo ouuuuyts"
+                                   "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+
+/**
+ * @brief Normaliza um texto para a busca: minúsculas, sem acentos, palavras
+ * separadas por um único espaço e sem espaços nas pontas. Pontuação separa
+ * palavras; outros bytes acima de 127 são mantidos como letras.
+ * @param texto Texto original.
+ * @param destino Recebe o texto normalizado (terminado em '\0').
+ * @param tam_destino Tamanho de 'destino' (o resultado é truncado se preciso).
+ * @return size_t Tamanho do texto normalizado.
+ */
+size_t trigramas_normalizar(const char *texto, char *destino, size_t tam_destino) {
+    size_t n = 0;
+    int espaco = 0; // Há um separador pendente antes da próxima letra
+    for (const unsigned char *p = (const unsigned char *)texto; *p != '\0' && n + 1 < tam_destino; p++) {
+        char c;
+        if (*p == 0xC3 && p[1] >= 0x80 && p[1] <= 0xBF) {
+            c = sem_acento[*++p & 0x3F];
+        } else if (*p >= 'A' && *p <= 'Z') {
+            c = (char)(*p - 'A' + 'a');
+        } else if ((*p >= 'a' && *p <= 'z') || (*p >= '0' && *p <= '9') || *p >= 0x80) {
+            c = (char)*p;
+        } else {
+            c = ' ';
+        }
+
+        if (c == ' ') {
+            espaco = n > 0;
+            continue;
+        }
+        if (espaco) {
+            if (n + 2 >= tam_destino) break;
+            destino[n++] = ' ';
+            espaco = 0;
+        }
+        destino[n++] = c;
+    }
+    destino[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Junta três caracteres num trigrama (nunca 0: os textos normalizados não têm '\0').
+ */
+static unsigned trigrama(char a, char b, char c) {
+    return ((unsigned)(unsigned char)a << 16) | ((unsigned)(unsigned char)b << 8) | (unsigned)(unsigned char)c;
+}
+
+static int comparar_trigramas(const void *a, const void *b) {
+    unsigned x = *(const unsigned *)a, y = *(const unsigned *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Ordena os trigramas e remove os repetidos.
+ * @return int Quantidade de trigramas distintos.
+ */
+static int ordenar_unicos(unsigned *trigramas, int n) {
+    if (n == 0) return 0;
+    qsort(trigramas, (size_t)n, sizeof(unsigned), comparar_trigramas);
+    int unicos = 1;
+    for (int i = 1; i < n; i++) {
+        if (trigramas[i] != trigramas[unicos - 1]) trigramas[unicos++] = trigramas[i];
+    }
+    return unicos;
+}
+
+/**
+ * @brief Trigramas de um trecho de texto, completado com 'antes' espaços no
+ * início e 'depois' espaços no fim (sem passar de 'max').
+ * @return int Quantidade de trigramas gravados (com repetidos).
+ */
+static int trigramas_do_trecho(const char *trecho, int tamanho, int antes, int depois,
+                               unsigned *trigramas, int max) {
+    int total = antes + tamanho + depois, n = 0;
+    for (int i = 0; i + 2 < total && n < max; i++) {
+        char c[3];
+        for (int k = 0; k < 3; k++) {
+            int pos = i + k - antes;
+            c[k] = pos < 0 || pos >= tamanho ? ' ' : trecho[pos];
+        }
+        trigramas[n++] = trigrama(c[0], c[1], c[2]);
+    }
+    return n;
+}
+
+/**
+ * @brief Trigramas distintos de um texto normalizado, com cada palavra
+ * completada por dois espaços antes e um depois (como é indexado).
+ * @return int Quantidade de trigramas distintos.
+ */
+static int trigramas_completos(const char *normal, unsigned *trigramas, int max) {
+    int n = 0;
+    for (const char *p = normal; *p != '\0' && n < max;) {
+        int tamanho = (int)strcspn(p, " ");
+        n += trigramas_do_trecho(p, tamanho, 2, 1, trigramas + n, max - n);
+        p += tamanho;
+        if (*p == ' ') p++;
+    }
+    return ordenar_unicos(trigramas, n);
+}
+
+/**
+ * @brief Trigramas que todo nome contendo o trecho normalizado também tem.
+ * A primeira palavra do trecho pode ser o fim de uma palavra do nome e a
+ * última pode ser o começo de outra, por isso só as palavras do meio são
+ * completadas dos dois lados.
+ * @return int Quantidade de trigramas distintos (0 = trecho curto demais para filtrar).
+ */
+static int trigramas_do_trecho_procurado(const char *normal, unsigned *trigramas, int max) {
+    int n = 0;
+    for (const char *p = normal; *p != '\0' && n < max;) {
+        int tamanho = (int)strcspn(p, " ");
+        int primeira = p == normal, ultima = p[tamanho] == '\0';
+        n += trigramas_do_trecho(p, tamanho, primeira ? 0 : 2, ultima ? 0 : 1, trigramas + n, max - n);
+        p += tamanho;
+        if (*p == ' ') p++;
+    }
+    return ordenar_unicos(trigramas, n);
+}
+
+// --- 2. Montagem e Manutenção ---
+
+/**
+ * @brief Inicializa um índice vazio (sem alocação).
+ * @param indice Ponteiro para o índice.
+ */
+void indice_trigramas_inicializar(IndiceTrigramas *indice) {
+    memset(indice, 0, sizeof(*indice));
+}
+
+/**
+ * @brief Libera a memória do índice (volta a ser montado no próximo uso).
+ * @param indice Ponteiro para o índice.
+ */
+void indice_trigramas_liberar(IndiceTrigramas *indice) {
+    for (int i = 0; i < indice->num_listas; i++) free(indice->listas[i].refs);
+    free(indice->listas);
+    free(indice->chaves);
+    free(indice->posicoes);
+    free(indice->usos);
+    indice_trigramas_inicializar(indice);
+}
+
+/**
+ * @brief Posição inicial de um trigrama na tabela hash.
+ */
+static unsigned posicao_inicial(const IndiceTrigramas *indice, unsigned t) {
+    unsigned h = t * 0x9E3779B1u;
+    h ^= h >> 15;
+    return h & ((unsigned)indice->capacidade - 1);
+}
+
+/**
+ * @brief Lista invertida de um trigrama (O(1) esperado).
+ * @return const ListaTrigrama* A lista, ou NULL se nenhum texto tem o trigrama.
+ */
+static const ListaTrigrama *lista_do_trigrama(const IndiceTrigramas *indice, unsigned t) {
+    if (indice->capacidade == 0) return NULL;
+    unsigned mascara = (unsigned)indice->capacidade - 1;
+    for (unsigned pos = posicao_inicial(indice, t); indice->chaves[pos] != 0; pos = (pos + 1) & mascara) {
+        if (indice->chaves[pos] == t) return &indice->listas[indice->posicoes[pos]];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Realoca a tabela hash com a nova capacidade e reinsere os trigramas.
+ * @return int 1 se bem-sucedido, 0 se faltou memória (a tabela antiga é mantida).
+ */
+static int redimensionar_tabela(IndiceTrigramas *indice, int nova_capacidade) {
+    unsigned *chaves = calloc((size_t)nova_capacidade, sizeof(unsigned));
+    int *posicoes = malloc((size_t)nova_capacidade * sizeof(int));
+    if (chaves == NULL || posicoes == NULL) {
+        free(chaves);
+        free(posicoes);
+        return 0;
+    }
+    unsigned *chaves_antigas = indice->chaves;
+    int *posicoes_antigas = indice->posicoes;
+    int capacidade_antiga = indice->capacidade;
+    indice->chaves = chaves;
+    indice->posicoes = posicoes;
+    indice->capacidade = nova_capacidade;
+
+    unsigned mascara = (unsigned)nova_capacidade - 1;
+    for (int i = 0; i < capacidade_antiga; i++) {
+        if (chaves_antigas[i] == 0) continue;
+        unsigned pos = posicao_inicial(indice, chaves_antigas[i]);
+        while (chaves[pos] != 0) pos = (pos + 1) & mascara;
+        chaves[pos] = chaves_antigas[i];
+        posicoes[pos] = posicoes_antigas[i];
+    }
+    free(chaves_antigas);
+    free(posicoes_antigas);
+    return 1;
+}
+
+/**
+ * @brief Lista invertida de um trigrama, criada vazia se ainda não existe.
+ * @return ListaTrigrama* A lista, ou NULL se faltou memória.
+ */
+static ListaTrigrama *obter_lista(IndiceTrigramas *indice, unsigned t) {
+    ListaTrigrama *lista = (ListaTrigrama *)lista_do_trigrama(indice, t);
+    if (lista != NULL) return lista;
+
+    // Carga máxima de 50% na tabela hash
+    if ((long)(indice->num_listas + 1) * 2 > (long)indice->capacidade &&
+        !redimensionar_tabela(indice, indice->capacidade > 0 ? indice->capacidade * 2 : CAPACIDADE_INICIAL_TRIGRAMAS)) {
+        return NULL;
+    }
+    if (indice->num_listas == indice->cap_listas) {
+        int nova = indice->cap_listas > 0 ? indice->cap_listas * 2 : CAPACIDADE_INICIAL_TRIGRAMAS;
+        ListaTrigrama *listas = realloc(indice->listas, (size_t)nova * sizeof(ListaTrigrama));
+        if (listas == NULL) return NULL;
+        indice->listas = listas;
+        indice->cap_listas = nova;
+    }
+
+    unsigned mascara = (unsigned)indice->capacidade - 1;
+    unsigned pos = posicao_inicial(indice, t);
+    while (indice->chaves[pos] != 0) pos = (pos + 1) & mascara;
+    indice->chaves[pos] = t;
+    indice->posicoes[pos] = indice->num_listas;
+    lista = &indice->listas[indice->num_listas++];
+    lista->refs = NULL;
+    lista->quantidade = 0;
+    lista->capacidade = 0;
+    return lista;
+}
+
+/**
+ * @brief Acrescenta uma referência à lista, mantendo a ordem crescente.
+ * As referências novas vêm do fim do heap, então quase sempre vão para o fim.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int incluir_na_lista(ListaTrigrama *lista, int ref) {
+    if (lista->quantidade == lista->capacidade) {
+        int nova = lista->capacidade > 0 ? lista->capacidade * 2 : 4;
+        int *refs = realloc(lista->refs, (size_t)nova * sizeof(int));
+        if (refs == NULL) return 0;
+        lista->refs = refs;
+        lista->capacidade = nova;
+    }
+    int pos = lista->quantidade;
+    while (pos > 0 && lista->refs[pos - 1] > ref) pos--;
+    if (pos > 0 && lista->refs[pos - 1] == ref) return 1;
+    memmove(lista->refs + pos + 1, lista->refs + pos, (size_t)(lista->quantidade - pos) * sizeof(int));
+    lista->refs[pos] = ref;
+    lista->quantidade++;
+    return 1;
+}
+
+/**
+ * @brief Garante uma posição em 'usos' para a referência (capacidade dobra).
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int garantir_textos(IndiceTrigramas *indice, int ref) {
+    if (ref < indice->cap_textos) return 1;
+    int nova = indice->cap_textos > 0 ? indice->cap_textos : CAPACIDADE_INICIAL_TRIGRAMAS;
+    while (nova <= ref) nova *= 2;
+
+    int *usos = realloc(indice->usos, (size_t)nova * sizeof(int));
+    if (usos == NULL) return 0;
+    indice->usos = usos;
+    memset(indice->usos + indice->cap_textos, 0, (size_t)(nova - indice->cap_textos) * sizeof(int));
+    indice->cap_textos = nova;
+    return 1;
+}
+
+/**
+ * @brief Indexa o texto da referência (sem verificar 'pronto').
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int indexar_texto(IndiceTrigramas *indice, const PoolRegistros *heap, int ref) {
+    char normal[TAM_NORMALIZADO];
+    unsigned trigramas[MAX_TRIGRAMAS_TEXTO];
+    trigramas_normalizar(texto_no_heap(heap, ref), normal, sizeof(normal));
+    int n = trigramas_completos(normal, trigramas, MAX_TRIGRAMAS_TEXTO);
+
+    if (!garantir_textos(indice, ref)) return 0;
+    for (int i = 0; i < n; i++) {
+        ListaTrigrama *lista = obter_lista(indice, trigramas[i]);
+        if (lista == NULL || !incluir_na_lista(lista, ref)) return 0;
+    }
+    indice->textos++;
+    return 1;
+}
+
+/**
+ * @brief Monta o índice com todos os textos do heap e conta quantas turmas e
+ * alunos ativos usam cada um (O(caracteres do heap + registros ativos)).
+ * @param sistema Ponteiro para a estrutura DadosSistema.
+ * @param indice Ponteiro para o índice.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+int indice_trigramas_reconstruir(const DadosSistema *sistema, IndiceTrigramas *indice) {
+    indice_trigramas_liberar(indice);
+    const ColunasNotas *colunas = colunas_montadas(sistema);
+    if (colunas == NULL) return 0;
+
+    for (int ref = textos_primeiro(&sistema->textos); ref != -1; ref = textos_proximo(&sistema->textos, ref)) {
+        if (!indexar_texto(indice, &sistema->textos, ref)) {
+            indice_trigramas_liberar(indice);
+            return 0;
+        }
+    }
+    indice->pronto = 1;
+
+    for (int i = 0; i < sistema->turmas.usados; i++) {
+        const Turma *turma = turma_em(sistema, i);
+        if (turma->ativo == 1) indice_trigramas_usar(indice, turma->nome, 1);
+    }
+    for (int i = colunas_proximo_ativo(colunas, 0); i != -1; i = colunas_proximo_ativo(colunas, i + 1)) {
+        indice_trigramas_usar(indice, aluno_em(sistema, i)->nome, 1);
+    }
+    return 1;
+}
+
+/**
+ * @brief Indexa um texto que acabou de ser gravado no heap (O(tamanho do texto)).
+ * Ignorado enquanto o índice não está montado.
+ * @param indice Ponteiro para o índice.
+ * @param heap Heap de textos.
+ * @param ref Referência do texto novo.
+ * @return int 1 se bem-sucedido, 0 se faltou memória (o índice deve ser descartado).
+ */
+int indice_trigramas_inserir(IndiceTrigramas *indice, const PoolRegistros *heap, int ref) {
+    if (!indice->pronto || ref <= 0) return 1;
+    return indexar_texto(indice, heap, ref);
+}
+
+/**
+ * @brief Soma 'delta' aos registros ativos que usam o texto (O(1)).
+ * Chamada quando uma turma ou aluno ativo passa a usar (+1) ou deixa de usar (-1) o nome.
+ * @param indice Ponteiro para o índice.
+ * @param ref Referência do nome.
+ * @param delta +1 ou -1.
+ */
+void indice_trigramas_usar(IndiceTrigramas *indice, int ref, int delta) {
+    if (!indice->pronto || ref <= 0 || ref >= indice->cap_textos) return;
+    indice->usos[ref] += delta;
+}
+
+// --- 3. Busca ---
+
+/**
+ * @brief Coloca um resultado entre os 'max' melhores, em ordem decrescente de
+ * semelhança (empate: menor referência primeiro).
+ */
+static void guardar_resultado(ResultadoTexto *resultados, int *n, int max, int ref, float semelhanca) {
+    if (*n == max && semelhanca <= resultados[max - 1].semelhanca) return;
+    int pos = *n < max ? (*n)++ : max - 1;
+    while (pos > 0 && (resultados[pos - 1].semelhanca < semelhanca ||
+                       (resultados[pos - 1].semelhanca == semelhanca && resultados[pos - 1].ref > ref))) {
+        resultados[pos] = resultados[pos - 1];
+        pos--;
+    }
+    resultados[pos].ref = ref;
+    resultados[pos].semelhanca = semelhanca;
+}
+
+/**
+ * @brief Indica se a lista contém a referência (busca binária).
+ */
+static int lista_contem(const ListaTrigrama *lista, int ref) {
+    int inicio = 0, fim = lista->quantidade;
+    while (inicio < fim) {
+        int meio = inicio + (fim - inicio) / 2;
+        if (lista->refs[meio] < ref) inicio = meio + 1;
+        else fim = meio;
+    }
+    return inicio < lista->quantidade && lista->refs[inicio] == ref;
+}
+
+static int comparar_listas(const void *a, const void *b) {
+    int x = (*(const ListaTrigrama *const *)a)->quantidade, y = (*(const ListaTrigrama *const *)b)->quantidade;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Confirma um candidato da busca por trecho e o guarda com a fração do
+ * nome coberta pelo trecho.
+ */
+static void conferir_trecho(const IndiceTrigramas *indice, const PoolRegistros *heap, int ref,
+                            const char *trecho, size_t tam_trecho, ResultadoTexto *resultados, int *n, int max) {
+    if (ref >= indice->cap_textos || indice->usos[ref] <= 0) return;
+    char normal[TAM_NORMALIZADO];
+    size_t tamanho = trigramas_normalizar(texto_no_heap(heap, ref), normal, sizeof(normal));
+    if (tamanho > 0 && strstr(normal, trecho) != NULL) {
+        guardar_resultado(resultados, n, max, ref, (float)tam_trecho / (float)tamanho);
+    }
+}
+
+/**
+ * @brief Busca por trecho: os candidatos são a interseção das listas dos
+ * trigramas do trecho (a partir da menor), confirmados por strstr.
+ * Trechos curtos demais para ter trigramas (uma palavra de até 2 letras)
+ * percorrem todos os textos do heap.
+ */
+static int buscar_trecho(const IndiceTrigramas *indice, const PoolRegistros *heap, const char *trecho,
+                         size_t tam_trecho, ResultadoTexto *resultados, int max) {
+    unsigned trigramas[MAX_TRIGRAMAS_CONSULTA];
+    const ListaTrigrama *listas[MAX_TRIGRAMAS_CONSULTA];
+    int nq = trigramas_do_trecho_procurado(trecho, trigramas, MAX_TRIGRAMAS_CONSULTA);
+    int n = 0;
+
+    if (nq == 0) {
+        for (int ref = textos_primeiro(heap); ref != -1; ref = textos_proximo(heap, ref)) {
+            conferir_trecho(indice, heap, ref, trecho, tam_trecho, resultados, &n, max);
+        }
+        return n;
+    }
+    for (int i = 0; i < nq; i++) {
+        listas[i] = lista_do_trigrama(indice, trigramas[i]);
+        if (listas[i] == NULL) return 0; // Nenhum texto tem este trigrama
+    }
+    qsort(listas, (size_t)nq, sizeof(listas[0]), comparar_listas);
+
+    for (int k = 0; k < listas[0]->quantidade; k++) {
+        int ref = listas[0]->refs[k], em_todas = 1;
+        for (int i = 1; i < nq && em_todas; i++) em_todas = lista_contem(listas[i], ref);
+        if (em_todas) conferir_trecho(indice, heap, ref, trecho, tam_trecho, resultados, &n, max);
+    }
+    return n;
+}
+
+/**
+ * @brief Distância de edição entre duas palavras (inserção, remoção, troca de
+ * uma letra ou transposição de duas vizinhas, cada uma custando 1), parando
+ * assim que passa de 'limite'. Palavras de TAM_PALAVRA_EDICAO letras ou mais
+ * só são comparadas por igualdade.
+ * @return int A distância, ou limite + 1 se ela passa do limite.
+ */
+static int distancia_edicao(const char *a, int na, const char *b, int nb, int limite) {
+    if (na - nb > limite || nb - na > limite) return limite + 1;
+    if (na >= TAM_PALAVRA_EDICAO || nb >= TAM_PALAVRA_EDICAO) {
+        return na == nb && memcmp(a, b, (size_t)na) == 0 ? 0 : limite + 1;
+    }
+    int linhas[3][TAM_PALAVRA_EDICAO + 1];
+    int *penultima = linhas[0], *anterior = linhas[1], *atual = linhas[2];
+    for (int j = 0; j <= nb; j++) anterior[j] = j;
+    for (int i = 1; i <= na; i++) {
+        int menor = atual[0] = i;
+        for (int j = 1; j <= nb; j++) {
+            int v = anterior[j - 1] + (a[i - 1] != b[j - 1]);
+            if (anterior[j] + 1 < v) v = anterior[j] + 1;
+            if (atual[j - 1] + 1 < v) v = atual[j - 1] + 1;
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1] && penultima[j - 2] + 1 < v) {
+                v = penultima[j - 2] + 1;
+            }
+            atual[j] = v;
+            if (v < menor) menor = v;
+        }
+        if (menor > limite) return limite + 1;
+        int *livre = penultima;
+        penultima = anterior;
+        anterior = atual;
+        atual = livre;
+    }
+    return anterior[nb] <= limite ? anterior[nb] : limite + 1;
+}
+
+// Palavra da consulta aproximada e as listas dos seus trigramas
+typedef struct {
+    const char *texto;
+    int tamanho;
+    int erros;            // Edições toleradas (ERROS_TOLERADOS)
+    int minimo;           // Trigramas que um nome com a palavra a até 'erros' edições tem
+    int curtas;           // Listas mais curtas onde todo candidato aparece
+    int num_trigramas;
+} PalavraConsulta;
+
+/**
+ * @brief Semelhança de um nome com as palavras da consulta: cada palavra
+ * precisa estar a até 'erros' edições de alguma palavra do nome e vale
+ * 1 - distância / maior tamanho; a soma é dividida pelo maior número de
+ * palavras (da consulta ou do nome), então palavras sobrando no nome pesam contra.
+ * @return float Semelhança (0 a 1), ou -1 se alguma palavra não casa.
+ */
+static float semelhanca_palavras(const char *normal, const PalavraConsulta *palavras, int num_palavras) {
+    float soma = 0.0f;
+    int palavras_nome = 0;
+    for (const char *p = normal; *p != '\0'; palavras_nome++) {
+        p += strcspn(p, " ");
+        if (*p == ' ') p++;
+    }
+    for (int q = 0; q < num_palavras; q++) {
+        const PalavraConsulta *palavra = &palavras[q];
+        float melhor = -1.0f;
+        for (const char *p = normal; *p != '\0';) {
+            int tamanho = (int)strcspn(p, " ");
+            int d = distancia_edicao(palavra->texto, palavra->tamanho, p, tamanho, palavra->erros);
+            if (d <= palavra->erros) {
+                int maior = tamanho > palavra->tamanho ? tamanho : palavra->tamanho;
+                float s = 1.0f - (float)d / (float)maior;
+                if (s > melhor) melhor = s;
+            }
+            p += tamanho;
+            if (*p == ' ') p++;
+        }
+        if (melhor < 0.0f) return -1.0f;
+        soma += melhor;
+    }
+    return soma / (float)(palavras_nome > num_palavras ? palavras_nome : num_palavras);
+}
+
+/**
+ * @brief Listas dos trigramas de uma palavra da consulta, da mais curta para a
+ * mais longa (trigramas que nenhum texto tem não entram), e quantos
+ * trigramas um nome precisa compartilhar com ela.
+ * Cada edição muda no máximo 4 trigramas da palavra (a transposição, 4; as
+ * outras, 3), então uma palavra a até 'erros' edições compartilha pelo menos
+ * num_trigramas - 4 * erros deles: todo candidato está em alguma das
+ * num_trigramas - minimo + 1 listas mais curtas (as que não existem contam como vazias).
+ * @return int Quantidade de listas que existem.
+ */
+static int listas_da_palavra(const IndiceTrigramas *indice, PalavraConsulta *palavra,
+                             const ListaTrigrama **listas) {
+    unsigned trigramas[MAX_TRIGRAMAS_CONSULTA];
+    int n = trigramas_do_trecho(palavra->texto, palavra->tamanho, 2, 1, trigramas, MAX_TRIGRAMAS_CONSULTA);
+    n = ordenar_unicos(trigramas, n);
+    int nl = 0;
+    for (int i = 0; i < n; i++) {
+        const ListaTrigrama *lista = lista_do_trigrama(indice, trigramas[i]);
+        if (lista != NULL) listas[nl++] = lista;
+    }
+    qsort(listas, (size_t)nl, sizeof(listas[0]), comparar_listas);
+
+    palavra->num_trigramas = n;
+    palavra->minimo = n - 4 * palavra->erros;
+    if (palavra->minimo < 1) palavra->minimo = 1;
+    palavra->curtas = (n - palavra->minimo + 1) - (n - nl); // Sem as vazias
+    return nl;
+}
+
+/**
+ * @brief Busca aproximada, palavra a palavra (ver trigramas.h).
+ * Os candidatos vêm da palavra da consulta com as listas curtas mais baratas:
+ * elas são percorridas intercaladas em ordem de referência, a contagem de
+ * trigramas é completada por busca binária nas outras listas da palavra, e
+ * quem tem o mínimo é conferido por distância de edição contra todas as palavras.
+ */
+static int buscar_aproximado(const IndiceTrigramas *indice, const PoolRegistros *heap, const char *consulta,
+                             ResultadoTexto *resultados, int max) {
+    PalavraConsulta palavras[MAX_PALAVRAS_CONSULTA];
+    const ListaTrigrama *listas[MAX_TRIGRAMAS_CONSULTA];
+    int cursores[MAX_TRIGRAMAS_CONSULTA];
+    int num_palavras = 0, guia = -1;
+    long custo_guia = 0;
+
+    for (const char *p = consulta; *p != '\0' && num_palavras < MAX_PALAVRAS_CONSULTA;) {
+        PalavraConsulta *palavra = &palavras[num_palavras];
+        palavra->texto = p;
+        palavra->tamanho = (int)strcspn(p, " ");
+        palavra->erros = ERROS_TOLERADOS(palavra->tamanho);
+        p += palavra->tamanho;
+        if (*p == ' ') p++;
+
+        int nl = listas_da_palavra(indice, palavra, listas);
+        if (palavra->curtas <= 0) return 0; // Nenhum nome tem trigramas suficientes desta palavra
+        long custo = 0;
+        for (int i = 0; i < palavra->curtas && i < nl; i++) custo += listas[i]->quantidade;
+        if (guia == -1 || custo < custo_guia) {
+            guia = num_palavras;
+            custo_guia = custo;
+        }
+        num_palavras++;
+    }
+    if (guia == -1) return 0;
+
+    const PalavraConsulta *palavra = &palavras[guia];
+    int nl = listas_da_palavra(indice, &palavras[guia], listas);
+    int curtas = palavra->curtas;
+    for (int i = 0; i < curtas; i++) cursores[i] = 0;
+
+    char normal[TAM_NORMALIZADO];
+    int n = 0;
+    for (;;) {
+        // Menor referência ainda não vista nas listas curtas, e em quantas delas aparece
+        int ref = -1, compartilhados = 0;
+        for (int i = 0; i < curtas; i++) {
+            if (cursores[i] < listas[i]->quantidade && (ref == -1 || listas[i]->refs[cursores[i]] < ref)) {
+                ref = listas[i]->refs[cursores[i]];
+            }
+        }
+        if (ref == -1) break;
+        for (int i = 0; i < curtas; i++) {
+            if (cursores[i] < listas[i]->quantidade && listas[i]->refs[cursores[i]] == ref) {
+                cursores[i]++;
+                compartilhados++;
+            }
+        }
+        if (ref >= indice->cap_textos || indice->usos[ref] <= 0) continue;
+
+        for (int i = curtas; i < nl && compartilhados < palavra->minimo; i++) {
+            compartilhados += lista_contem(listas[i], ref);
+        }
+        if (compartilhados < palavra->minimo) continue;
+
+        trigramas_normalizar(texto_no_heap(heap, ref), normal, sizeof(normal));
+        float semelhanca = semelhanca_palavras(normal, palavras, num_palavras);
+        if (semelhanca >= 0.0f) guardar_resultado(resultados, &n, max, ref, semelhanca);
+    }
+    return n;
+}
+
+/**
+ * @brief Procura nomes em uso por trecho ou por semelhança.
+ * O índice só é lido: várias buscas podem rodar juntas sobre o mesmo índice.
+ * @param indice Índice montado.
+ * @param heap Heap de textos.
+ * @param consulta Texto procurado.
+ * @param aproximada 1 = busca aproximada (semelhança), 0 = nomes que contêm o trecho.
+ * @param resultados Recebe os melhores resultados, do mais ao menos semelhante.
+ * @param max Quantidade máxima de resultados (> 0).
+ * @return int Quantidade de resultados.
+ */
+int indice_trigramas_buscar(const IndiceTrigramas *indice, const PoolRegistros *heap, const char *consulta,
+                            int aproximada, ResultadoTexto *resultados, int max) {
+    char normal[TAM_NORMALIZADO];
+    size_t tamanho = trigramas_normalizar(consulta, normal, sizeof(normal));
+    if (tamanho == 0 || !indice->pronto) return 0;
+    return aproximada ? buscar_aproximado(indice, heap, normal, resultados, max)
+                      : buscar_trecho(indice, heap, normal, tamanho, resultados, max);
+}
@@ -0,0 +1,82 @@
+#ifndef TRIGRAMAS_H
+#define TRIGRAMAS_H
+
+#include "armazenamento.h"
+
+// --- Busca por Nome (Índice de Trigramas) ---
+//
+// Índice invertido dos nomes guardados no heap de textos (textos.h): cada
+// trigrama (3 caracteres seguidos do nome normalizado) leva à lista, em ordem
+// crescente, das referências dos textos que o contêm. Como os nomes são
+// internados, um texto vale para todas as turmas e alunos com aquele nome, e
+// um texto nunca muda: só entra no índice quando é gravado no heap.
+//
+// A normalização ignora maiúsculas, acentos (UTF-8 do Latin-1) e pontuação.
+// Cada palavra é completada com dois espaços antes e um depois, como no
+// pg_trgm ("ana" -> "  a", " an", "ana", "na "), então o começo e o fim das
+// palavras pesam na semelhança.
+//
+// Duas buscas:
+//   - trecho: nomes que contêm o texto procurado (os trigramas do trecho
+//     filtram os candidatos, a confirmação é por strstr no nome normalizado);
+//   - aproximada: cada palavra da consulta precisa estar a até
+//     ERROS_TOLERADOS edições (letra inserida, removida, trocada ou duas
+//     vizinhas transpostas: "Mraia", "Maira" e "Crla" acham "Maria" e
+//     "Carla") de alguma palavra do nome. Os trigramas só escolhem os
+//     candidatos (os que compartilham trigramas suficientes com uma palavra);
+//     a semelhança é a média de 1 - distância / tamanho das palavras,
+//     dividida pelo maior número de palavras (da consulta ou do nome).
+//
+// O índice guarda também quantos registros ativos usam cada texto ('usos'),
+// mantido pelas inserções, renomeações e exclusões de servicos.c: textos que
+// ninguém usa mais (continuam no heap até a compactação) não aparecem nos
+// resultados. Como os outros índices, é montado no primeiro uso.
+
+#define ERROS_TOLERADOS(tamanho) ((tamanho) <= 2 ? 0 : (tamanho) <= 5 ? 1 : 2) // Por palavra da consulta
+#define MAX_TRIGRAMAS_CONSULTA 256 // Consultas maiores usam só os primeiros trigramas
+
+// Lista invertida de um trigrama
+typedef struct {
+    int *refs;            // Referências dos textos com o trigrama, em ordem crescente
+    int quantidade;
+    int capacidade;
+} ListaTrigrama;
+
+typedef struct {
+    unsigned *chaves;     // Trigrama de cada posição da tabela hash (0 = posição vazia)
+    int *posicoes;        // Posição da lista do trigrama em 'listas'
+    int capacidade;       // Potência de 2 (0 enquanto a tabela não foi alocada)
+    ListaTrigrama *listas; // Uma lista por trigrama distinto
+    int num_listas;
+    int cap_listas;
+    int *usos;            // Registros ativos que usam o texto, indexado pela referência
+    int cap_textos;       // Posições alocadas em 'usos'
+    int textos;           // Textos indexados
+    int pronto;           // 1 depois de montado por indice_trigramas_reconstruir
+} IndiceTrigramas;
+
+// Um nome encontrado
+typedef struct {
+    int ref;              // Referência do texto no heap
+    float semelhanca;     // 0 a 1 (na busca por trecho: fração do nome coberta pelo trecho)
+} ResultadoTexto;
+
+struct DadosSistema;
+
+void indice_trigramas_inicializar(IndiceTrigramas *indice);
+void indice_trigramas_liberar(IndiceTrigramas *indice);
+int indice_trigramas_reconstruir(const struct DadosSistema *sistema, IndiceTrigramas *indice);
+int indice_trigramas_inserir(IndiceTrigramas *indice, const PoolRegistros *heap, int ref);
+void indice_trigramas_usar(IndiceTrigramas *indice, int ref, int delta);
+int indice_trigramas_buscar(const IndiceTrigramas *indice, const PoolRegistros *heap, const char *consulta,
+                            int aproximada, ResultadoTexto *resultados, int max);
+size_t trigramas_normalizar(const char *texto, char *destino, size_t tam_destino);
+
+/**
+ * @brief Registros ativos que usam o texto (O(1); 0 se o índice não está montado).
+ */
+static inline int indice_trigramas_usos(const IndiceTrigramas *indice, int ref) {
+    return indice->pronto && ref > 0 && ref < indice->cap_textos ? indice->usos[ref] : 0;
+}
+
+#endif // TRIGRAMAS_H
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "versoes.h"
+
+#define MAX_POOLS_VERSIONADOS 7
+
+#ifndef _WIN32
+#define TRAVAR(gerente) pthread_mutex_lock(&(gerente)->trava)
+#define DESTRAVAR(gerente) pthread_mutex_unlock(&(gerente)->trava)
+#else
+#define TRAVAR(gerente) ((void)0)   // Sem threads: nada a proteger
+#define DESTRAVAR(gerente) ((void)0)
+#endif
+
+// --- 1. Pools com Versões ---
+
+/**
+ * @brief Lista os pools que as fotos copiam: tabelas, heap de textos e índices usados pelos relatórios.
+ * @param sistema Dados (vivos ou a vista de uma foto).
+ * @param pools Recebe os endereços dos pools (MAX_POOLS_VERSIONADOS posições).
+ * @return int Quantidade de pools.
+ */
+static int pools_versionados(DadosSistema *sistema, PoolRegistros **pools) {
+    pools[0] = &sistema->turmas;
+    pools[1] = &sistema->alunos;
+    pools[2] = &sistema->membros.elos;
+    pools[3] = &sistema->membros.listas;
+    pools[4] = &sistema->ids.slots;
+    pools[5] = &sistema->estatisticas.turmas;
+    pools[6] = &sistema->textos;
+    return MAX_POOLS_VERSIONADOS;
+}
+
+/**
+ * @brief Guarda um bloco que saiu do pool enquanto fotos ainda podem vê-lo.
+ * Chamada com a trava do gerente. Sem memória para o registro, o programa é
+ * encerrado: quem escreve não tem como desistir da escrita (ver pool_slot_escrita).
+ */
+static void aposentar_bloco(GerenteVersoes *gerente, char *bloco) {
+    BlocoAposentado *aposentado = malloc(sizeof(BlocoAposentado));
+    if (aposentado == NULL) {
+        fprintf(stderr, "ERRO: Memoria insuficiente para preservar uma foto dos dados. Encerrando.\n");
+        exit(EXIT_FAILURE);
+    }
+    aposentado->bloco = bloco;
+    aposentado->epoca = gerente->epoca;
+    aposentado->proximo = NULL;
+    if (gerente->ultimo_aposentado != NULL) gerente->ultimo_aposentado->proximo = aposentado;
+    else gerente->aposentados = aposentado;
+    gerente->ultimo_aposentado = aposentado;
+}
+
+/**
+ * @brief Libera os blocos aposentados que nenhuma foto aberta pode ver.
+ * Chamada com a trava do gerente.
+ */
+static void recolher_aposentados(GerenteVersoes *gerente) {
+    while (gerente->aposentados != NULL &&
+           (gerente->mais_antiga == NULL || gerente->aposentados->epoca <= gerente->mais_antiga->epoca)) {
+        BlocoAposentado *aposentado = gerente->aposentados;
+        gerente->aposentados = aposentado->proximo;
+        free(aposentado->bloco);
+        free(aposentado);
+    }
+    if (gerente->aposentados == NULL) gerente->ultimo_aposentado = NULL;
+}
+
+/**
+ * @brief Cópia na escrita: o pool passa a usar uma cópia do bloco que está numa foto.
+ * Chamada por pool_slot_escrita (só por quem altera os dados). Se as fotos que
+ * viam o bloco já fecharam, basta desmarcá-lo.
+ * @param pool Ponteiro para o pool.
+ * @param bloco Índice do bloco prestes a ser alterado.
+ */
+void versoes_separar_bloco(PoolRegistros *pool, int bloco) {
+    GerenteVersoes *gerente = pool->versoes;
+    TRAVAR(gerente);
+    pool->compartilhado[bloco] = 0;
+    if (gerente->abertas > 0) {
+        size_t tamanho = (size_t)REGISTROS_POR_BLOCO * pool->tam_registro;
+        char *copia = malloc(tamanho);
+        if (copia == NULL) {
+            fprintf(stderr, "ERRO: Memoria insuficiente para preservar uma foto dos dados. Encerrando.\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(copia, pool->blocos[bloco], tamanho);
+        aposentar_bloco(gerente, pool->blocos[bloco]);
+        pool->blocos[bloco] = copia;
+    }
+    DESTRAVAR(gerente);
+}
+
+/**
+ * @brief Desliga o pool das fotos antes de ele ser liberado (chamada por pool_liberar).
+ * Os blocos que fotos abertas ainda veem passam para o gerente; os demais
+ * continuam no pool e são liberados normalmente.
+ * @param pool Ponteiro para o pool.
+ */
+void versoes_soltar_pool(PoolRegistros *pool) {
+    GerenteVersoes *gerente = pool->versoes;
+    TRAVAR(gerente);
+    for (int b = 0; b < pool->blocos_compartilhados; b++) {
+        if (pool->compartilhado[b] && gerente->abertas > 0) {
+            aposentar_bloco(gerente, pool->blocos[b]);
+            pool->blocos[b] = NULL;
+        }
+    }
+    free(pool->compartilhado);
+    pool->compartilhado = NULL;
+    pool->blocos_compartilhados = 0;
+    pool->versoes = NULL;
+    DESTRAVAR(gerente);
+}
+
+// --- 2. Gerente ---
+
+/**
+ * @brief Inicializa o gerente de fotos dos dados informados (nenhuma foto aberta).
+ * @param gerente Ponteiro para o gerente.
+ * @param sistema Dados vivos.
+ */
+void versoes_inicializar(GerenteVersoes *gerente, DadosSistema *sistema) {
+    memset(gerente, 0, sizeof(*gerente));
+#ifndef _WIN32
+    pthread_mutex_init(&gerente->trava, NULL);
+#endif
+    gerente->sistema = sistema;
+    gerente->epoca = 1;
+}
+
+/**
+ * @brief Libera o gerente. Todas as fotos já devem estar fechadas.
+ * Os pools voltam a ser escritos sem cópia.
+ * @param gerente Ponteiro para o gerente.
+ */
+void versoes_liberar(GerenteVersoes *gerente) {
+    PoolRegistros *pools[MAX_POOLS_VERSIONADOS];
+    int n = pools_versionados(gerente->sistema, pools);
+    for (int i = 0; i < n; i++) {
+        if (pools[i]->versoes != gerente) continue;
+        free(pools[i]->compartilhado);
+        pools[i]->compartilhado = NULL;
+        pools[i]->blocos_compartilhados = 0;
+        pools[i]->versoes = NULL;
+    }
+    recolher_aposentados(gerente);
+#ifndef _WIN32
+    pthread_mutex_destroy(&gerente->trava);
+#endif
+}
+
+// --- 3. Fotos ---
+
+/**
+ * @brief Marca todos os blocos atuais do pool como compartilhados com uma foto.
+ * @return int 1 se bem-sucedido, 0 se faltou memória.
+ */
+static int compartilhar_blocos(GerenteVersoes *gerente, PoolRegistros *pool) {
+    if (pool->blocos_compartilhados < pool->num_blocos) {
+        unsigned char *marcas = realloc(pool->compartilhado, (size_t)pool->num_blocos);
+        if (marcas == NULL) return 0;
+        pool->compartilhado = marcas;
+        pool->blocos_compartilhados = pool->num_blocos;
+    }
+    if (pool->blocos_compartilhados > 0) memset(pool->compartilhado, 1, (size_t)pool->blocos_compartilhados);
+    pool->versoes = gerente;
+    return 1;
+}
+
+/**
+ * @brief Abre uma foto dos dados (O(blocos), sem copiar registros).
+ * Ninguém pode estar alterando os dados durante a chamada. A vista retornada
+ * é privada de quem abriu: pode ser lida sem trava até foto_fechar. Índices
+ * que a foto não copia (RA, nomes, internação, busca por nome) começam vazios e, se usados, são montados
+ * só para a vista.
+ * @param gerente Ponteiro para o gerente.
+ * @return DadosSistema* A vista, ou NULL se fotos não estão disponíveis
+ * (modo mapeado, páginas ainda no arquivo, índices não montados ou falta de memória).
+ */
+DadosSistema *foto_abrir(GerenteVersoes *gerente) {
+    DadosSistema *sistema = gerente->sistema;
+    if (sistema->mapeado || sistema->turmas.fonte != NULL || sistema->alunos.fonte != NULL ||
+        sistema->textos.fonte != NULL || sistema->fragmentos.parcial) return NULL;
+    // Índices copiados precisam estar montados: a vista não pode montá-los sobre blocos compartilhados
+    if (!sistema->membros.pronto || !sistema->ids.pronto || !sistema->estatisticas.pronto) return NULL;
+
+    Foto *foto = malloc(sizeof(Foto));
+    if (foto == NULL) return NULL;
+
+    // A trava cobre a leitura dos pools vivos: outras fotos podem estar sendo abertas
+    TRAVAR(gerente);
+    foto->vista = *sistema;
+
+    PoolRegistros *vivos[MAX_POOLS_VERSIONADOS], *copias[MAX_POOLS_VERSIONADOS];
+    int n = pools_versionados(sistema, vivos);
+    pools_versionados(&foto->vista, copias);
+
+    // Diretórios próprios para a vista (os blocos são os mesmos)
+    int copiados = 0;
+    for (; copiados < n; copiados++) {
+        PoolRegistros *copia = copias[copiados];
+        size_t tamanho = (size_t)(copia->num_blocos > 0 ? copia->num_blocos : 1) * sizeof(char *);
+        copia->blocos = malloc(tamanho);
+        if (copia->blocos == NULL) break;
+        if (copia->num_blocos > 0) memcpy(copia->blocos, vivos[copiados]->blocos, (size_t)copia->num_blocos * sizeof(char *));
+        copia->cap_diretorio = copia->num_blocos;
+        copia->versoes = NULL;
+        copia->compartilhado = NULL;
+        copia->blocos_compartilhados = 0;
+    }
+
+    int ok = copiados == n;
+    for (int i = 0; ok && i < n; i++) ok = compartilhar_blocos(gerente, vivos[i]);
+    if (ok) {
+        foto->epoca = gerente->epoca++;
+        foto->proxima = NULL;
+        foto->anterior = gerente->mais_recente;
+        if (gerente->mais_recente != NULL) gerente->mais_recente->proxima = foto;
+        else gerente->mais_antiga = foto;
+        gerente->mais_recente = foto;
+        gerente->abertas++;
+    }
+    DESTRAVAR(gerente);
+
+    if (!ok) {
+        // Marcas já feitas só causam cópias a mais: o bloco é desmarcado na próxima escrita
+        for (int i = 0; i < copiados; i++) free(copias[i]->blocos);
+        free(foto);
+        return NULL;
+    }
+
+    // O que não é copiado começa vazio na vista
+    DadosSistema *vista = &foto->vista;
+    indice_ra_inicializar(&vista->indice_ra);
+    indice_textos_inicializar(&vista->internados);
+    indice_nomes_inicializar(&vista->nomes);
+    indice_livres_inicializar(&vista->turmas_livres);
+    indice_livres_inicializar(&vista->alunos_livres);
+    indice_trigramas_inicializar(&vista->trigramas);
+    colunas_inicializar(&vista->colunas);
+    diario_inicializar(&vista->diario);
+    return vista;
+}
+
+/**
+ * @brief Fecha uma foto e libera os blocos antigos que só ela ainda via.
+ * @param gerente Ponteiro para o gerente.
+ * @param vista Vista retornada por foto_abrir.
+ */
+void foto_fechar(GerenteVersoes *gerente, DadosSistema *vista) {
+    Foto *foto = (Foto *)vista;
+
+    // Índices montados só para a vista
+    indice_ra_liberar(&vista->indice_ra);
+    indice_textos_liberar(&vista->internados);
+    indice_nomes_liberar(&vista->nomes);
+    indice_livres_liberar(&vista->turmas_livres);
+    indice_livres_liberar(&vista->alunos_livres);
+    indice_trigramas_liberar(&vista->trigramas);
+    colunas_liberar(&vista->colunas);
+    diario_liberar(&vista->diario);
+
+    PoolRegistros *copias[MAX_POOLS_VERSIONADOS];
+    int n = pools_versionados(vista, copias);
+    for (int i = 0; i < n; i++) free(copias[i]->blocos); // Só o diretório: os blocos são do pool ou do gerente
+
+    TRAVAR(gerente);
+    if (foto->anterior != NULL) foto->anterior->proxima = foto->proxima;
+    else gerente->mais_antiga = foto->proxima;
+    if (foto->proxima != NULL) foto->proxima->anterior = foto->anterior;
+    else gerente->mais_recente = foto->anterior;
+    gerente->abertas--;
+    recolher_aposentados(gerente);
+    DESTRAVAR(gerente);
+
+    free(foto);
+}
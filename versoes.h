@@ -0,0 +1,59 @@
+#ifndef VERSOES_H
+#define VERSOES_H
+
+#include "servicos.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// --- Fotos dos Dados (Leituras MVCC) ---
+//
+// Uma foto é uma visão somente leitura de DadosSistema num instante: as
+// tabelas de turmas e alunos e os índices usados pelos relatórios (IDs,
+// membros por turma, estatísticas) são copiados só no diretório de blocos.
+// Enquanto a foto está aberta, quem altera um bloco compartilhado passa a
+// usar uma cópia dele (pool_slot_escrita); a foto continua com o bloco
+// antigo. Cada bloco substituído é guardado com a época em que saiu do pool
+// e liberado quando fecha a última foto mais antiga que essa época.
+//
+// Assim um relatório longo roda sobre a foto sem trava nenhuma, enquanto
+// lançamentos e edições continuam confirmando. Só o modo em memória tem
+// fotos: no modo mapeado os blocos são o próprio arquivo e não podem ser
+// trocados por cópias (foto_abrir retorna NULL).
+//
+// Abrir uma foto exige que ninguém esteja alterando os dados no momento (no
+// servidor, sob a trava de leitura); fechar pode acontecer a qualquer hora.
+
+typedef struct BlocoAposentado {
+    char *bloco;                    // Versão antiga de um bloco, vista só por fotos
+    unsigned long epoca;            // Época em que saiu do pool: fotos anteriores a ela podem vê-lo
+    struct BlocoAposentado *proximo;
+} BlocoAposentado;
+
+typedef struct Foto {
+    DadosSistema vista;             // Primeiro campo: o ponteiro da vista é o da foto
+    unsigned long epoca;            // Época em que a foto foi aberta
+    struct Foto *anterior;
+    struct Foto *proxima;
+} Foto;
+
+typedef struct GerenteVersoes {
+#ifndef _WIN32
+    pthread_mutex_t trava;          // Protege fotos, aposentados e as marcas de compartilhamento
+#endif
+    DadosSistema *sistema;          // Dados vivos
+    unsigned long epoca;            // Época atual (avança a cada foto aberta)
+    Foto *mais_antiga;              // Fotos abertas, em ordem de época
+    Foto *mais_recente;
+    int abertas;                    // Quantidade de fotos abertas
+    BlocoAposentado *aposentados;   // Blocos antigos ainda vistos por fotos, em ordem de época
+    BlocoAposentado *ultimo_aposentado;
+} GerenteVersoes;
+
+void versoes_inicializar(GerenteVersoes *gerente, DadosSistema *sistema);
+void versoes_liberar(GerenteVersoes *gerente);
+DadosSistema *foto_abrir(GerenteVersoes *gerente);
+void foto_fechar(GerenteVersoes *gerente, DadosSistema *vista);
+
+#endif // VERSOES_H